@@ -0,0 +1,157 @@
+/***************************************************************************//**
+ * @file main_s0.c
+ * @brief This project uses AES-CCM to encrypt and authenticate a framed
+ * payload in place, then verifies and decrypts it in place.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_chip.h"
+#include "em_emu.h"
+#include "aead_frame.h"
+#include <string.h>
+
+// Frame header size, e.g. a link layer header that is sent in clear
+#define HEADER_SIZE 8
+
+// Note: change this to change the number of payload bytes (any size up to
+// PAYLOAD_MAX_SIZE)
+#define PAYLOAD_SIZE 23
+#define PAYLOAD_MAX_SIZE 64
+
+// Number of bytes to make up a 128 bit key (16 * 8 = 128)
+#define KEY_SIZE 16
+
+// Note: change this to change the key
+// Note: must be 128 bits
+const static uint8_t key[KEY_SIZE] = {
+  0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+  0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF
+};
+
+// Note: a nonce must never be used twice with the same key. A real link would
+// build it from the source address and a frame counter.
+const static uint8_t nonce[AEAD_FRAME_NONCE_SIZE] = {
+  0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xA0,
+  0xA1, 0xA2, 0xA3, 0xA4, 0xA5
+};
+
+// Expected ciphertext and tag for the default header, payload, key and nonce
+// (RFC 3610, packet vector #1)
+const static uint8_t expectedData[PAYLOAD_SIZE + AEAD_FRAME_TAG_SIZE] = {
+  0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2,
+  0xF0, 0x66, 0xD0, 0xC2, 0xC0, 0xF9, 0x89, 0x80,
+  0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84, 0x17,
+  0xE8, 0xD1, 0x2C, 0xFD, 0xF9, 0x26, 0xE0
+};
+
+// The frame buffer, with headroom for the header and nonce and tailroom for
+// the tag. The payload is built, encrypted and decrypted in this buffer only.
+static uint8_t frame[AEAD_FRAME_OVERHEAD(HEADER_SIZE) + PAYLOAD_MAX_SIZE];
+
+// Length of the sealed frame
+static size_t frameLength;
+
+// A flag indicating whether the encryption/decryption process succeeded
+// Note: This is only volatile to ensure that it doesn't get optimized out by
+// the compiler before the user checks its value. It's not actually necessary.
+static volatile bool isError;
+
+/**************************************************************************//**
+ * @brief
+ *    Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint8_t *payload;
+  size_t payloadLength;
+
+  // Chip errata
+  CHIP_Init();
+
+  // Enable AES clock
+  CMU_ClockEnable(cmuClock_AES, true);
+
+  isError = (aeadFrameSetKey(key, 128) != 0);
+
+  // Build the frame: header at the start, payload written directly into the
+  // frame at its final position
+  payload = aeadFramePayload(frame, HEADER_SIZE);
+  for (uint32_t i = 0; i < HEADER_SIZE; i++) {
+    frame[i] = i;
+  }
+  for (uint32_t i = 0; i < PAYLOAD_SIZE; i++) {
+    payload[i] = HEADER_SIZE + i;
+  }
+
+  // Encrypt the payload in place, authenticate header and payload and append
+  // the nonce and tag (one pass over the payload, no copy)
+  if (aeadFrameSeal(frame, sizeof(frame), HEADER_SIZE, PAYLOAD_SIZE, nonce,
+                    &frameLength) != 0) {
+    isError = true;
+  }
+
+  // Check the sealed payload and tag against the expected data
+  if (memcmp(payload, expectedData, sizeof(expectedData)) != 0) {
+    isError = true;
+  }
+
+  // Verify the tag and decrypt the payload in place, as a receiver would
+  if (aeadFrameOpen(frame, frameLength, HEADER_SIZE, &payloadLength) != 0
+      || payloadLength != PAYLOAD_SIZE) {
+    isError = true;
+  }
+
+  // Check whether decrypted result is identical to the original data
+  for (uint32_t i = 0; i < PAYLOAD_SIZE; i++) {
+    if (payload[i] != HEADER_SIZE + i) {
+      isError = true;
+    }
+  }
+
+  // A frame with a modified header must be rejected
+  aeadFrameSeal(frame, sizeof(frame), HEADER_SIZE, PAYLOAD_SIZE, nonce,
+                &frameLength);
+  frame[0] ^= 1;
+  if (aeadFrameOpen(frame, frameLength, HEADER_SIZE, &payloadLength)
+      != AEAD_FRAME_ERR_AUTH_FAILED) {
+    isError = true;
+  }
+
+  aeadFrameFree();
+
+  // Pause the debugger here to check if the isError variable is true/false
+  while (1) {
+    EMU_EnterEM1();
+  }
+}
@@ -0,0 +1,14 @@
+// Host stand-in for em_aes.h, used by the tests in the parent directory.
+// host_aes.c implements the ECB functions with mbed TLS.
+#ifndef EM_AES_H
+#define EM_AES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void AES_ECB128(uint8_t *out, const uint8_t *in, unsigned int len,
+                const uint8_t *key, bool encrypt);
+void AES_ECB256(uint8_t *out, const uint8_t *in, unsigned int len,
+                const uint8_t *key, bool encrypt);
+
+#endif // EM_AES_H
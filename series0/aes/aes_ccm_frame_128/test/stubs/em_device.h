@@ -0,0 +1,12 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// It selects the AES peripheral path of aead_frame.c.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+#define AES_PRESENT
+#define AES_COUNT                       (1)
+#define AES_CTRL_AES256                 (0x1UL << 0)
+
+#endif // EM_DEVICE_H
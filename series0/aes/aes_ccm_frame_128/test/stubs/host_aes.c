@@ -0,0 +1,35 @@
+// Host stand-in for the emlib AES ECB functions, used by the tests in the
+// parent directory. Like the AES peripheral, it works on whole 16-byte
+// blocks and allows out to be the same buffer as in.
+#include "em_aes.h"
+#include "mbedtls/aes.h"
+
+static void hostAesEcb(uint8_t *out, const uint8_t *in, unsigned int len,
+                       const uint8_t *key, unsigned int keyBits, bool encrypt)
+{
+  mbedtls_aes_context ctx;
+
+  mbedtls_aes_init(&ctx);
+  if (encrypt) {
+    mbedtls_aes_setkey_enc(&ctx, key, keyBits);
+  } else {
+    mbedtls_aes_setkey_dec(&ctx, key, keyBits);
+  }
+  for (; len >= 16; len -= 16, in += 16, out += 16) {
+    mbedtls_aes_crypt_ecb(&ctx, encrypt ? MBEDTLS_AES_ENCRYPT
+                          : MBEDTLS_AES_DECRYPT, in, out);
+  }
+  mbedtls_aes_free(&ctx);
+}
+
+void AES_ECB128(uint8_t *out, const uint8_t *in, unsigned int len,
+                const uint8_t *key, bool encrypt)
+{
+  hostAesEcb(out, in, len, key, 128, encrypt);
+}
+
+void AES_ECB256(uint8_t *out, const uint8_t *in, unsigned int len,
+                const uint8_t *key, bool encrypt)
+{
+  hostAesEcb(out, in, len, key, 256, encrypt);
+}
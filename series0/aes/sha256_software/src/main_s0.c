@@ -0,0 +1,203 @@
+/***************************************************************************//**
+ * @file main_s0.c
+ * @brief This project hashes data with a software SHA-256 tuned for
+ * Cortex-M0+/M3 and compares its speed with the mbed TLS SHA-256.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_emu.h"
+#include "mbedtls/sha256.h"
+#include "sha256_sw.h"
+#include <stdbool.h>
+#include <string.h>
+
+// Note: change this to change the number of bytes hashed in the benchmark
+//       (the start of the flash is hashed, so it must fit in the flash)
+#define BENCH_SIZE 2048
+
+// Size of a short message, the largest that fits in one padded block
+#define SHORT_SIZE 55
+
+// SysTick is used as cycle counter, since Cortex-M0+ has no DWT cycle counter
+#define SYSTICK_MAX SysTick_LOAD_RELOAD_Msk
+
+// FIPS 180-2 examples, "abc" and the two-block 448 bit message
+static const char message1[] = "abc";
+static const char message2[] =
+  "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+static const uint8_t expected1[SHA256_SW_DIGEST_SIZE] = {
+  0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA,
+  0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+  0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C,
+  0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+};
+
+static const uint8_t expected2[SHA256_SW_DIGEST_SIZE] = {
+  0x24, 0x8D, 0x6A, 0x61, 0xD2, 0x06, 0x38, 0xB8,
+  0xE5, 0xC0, 0x26, 0x93, 0x0C, 0x3E, 0x60, 0x39,
+  0xA3, 0x3C, 0xE4, 0x59, 0x64, 0xFF, 0x21, 0x67,
+  0xF6, 0xEC, 0xED, 0xD4, 0x19, 0xDB, 0x06, 0xC1
+};
+
+// Digests of the benchmark data
+uint8_t digestSw[SHA256_SW_DIGEST_SIZE];
+uint8_t digestMbedtls[SHA256_SW_DIGEST_SIZE];
+
+// Cycles per byte when hashing BENCH_SIZE bytes
+uint32_t cyclesPerByteSw;
+uint32_t cyclesPerByteMbedtls;
+
+// Cycles to hash a SHORT_SIZE byte message
+uint32_t cyclesShortSw;
+uint32_t cyclesShortMbedtls;
+
+// A flag indicating whether a digest did not match
+// Note: This is only volatile to ensure that it doesn't get optimized out by
+// the compiler before the user checks its value. It's not actually necessary.
+static volatile bool isError;
+
+/**************************************************************************//**
+ * @brief
+ *    Start the SysTick counter at the core clock
+ *****************************************************************************/
+static void cycleCounterStart(void)
+{
+  SysTick->LOAD = SYSTICK_MAX;
+  SysTick->VAL = 0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Read the SysTick counter
+ *
+ * @return
+ *    Cycles counted since start, modulo 2^24. SysTick counts down.
+ *****************************************************************************/
+static uint32_t cycleCounterGet(void)
+{
+  return (SYSTICK_MAX - SysTick->VAL) & SYSTICK_MAX;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Check the software SHA-256 against known answers, one-shot, streamed
+ *    and resumed from a midstate
+ *****************************************************************************/
+static bool checkKnownAnswers(void)
+{
+  uint8_t digest[SHA256_SW_DIGEST_SIZE];
+  sha256Sw_TypeDef ctx;
+  sha256SwMidstate_TypeDef midstate;
+  bool ok = true;
+
+  sha256Sw((const uint8_t *) message1, strlen(message1), digest);
+  ok &= memcmp(digest, expected1, sizeof(digest)) == 0;
+
+  // Feed the message in two uneven parts
+  sha256SwInit(&ctx);
+  sha256SwUpdate(&ctx, (const uint8_t *) message2, 5);
+  sha256SwUpdate(&ctx, (const uint8_t *) message2 + 5, strlen(message2) - 5);
+  sha256SwFinish(&ctx, digest);
+  ok &= memcmp(digest, expected2, sizeof(digest)) == 0;
+
+  // Hash the first block of the benchmark data once, then resume twice from
+  // its midstate and compare with hashing from the start
+  sha256SwInit(&ctx);
+  sha256SwUpdate(&ctx, (const uint8_t *) FLASH_BASE, SHA256_SW_BLOCK_SIZE);
+  ok &= sha256SwMidstateGet(&ctx, &midstate) == 0;
+  for (uint32_t i = 0; i < 2; i++) {
+    sha256SwMidstateSet(&ctx, &midstate);
+    sha256SwUpdate(&ctx, (const uint8_t *) FLASH_BASE + SHA256_SW_BLOCK_SIZE,
+                   SHORT_SIZE + i);
+    sha256SwFinish(&ctx, digest);
+    mbedtls_sha256_ret((const uint8_t *) FLASH_BASE,
+                       SHA256_SW_BLOCK_SIZE + SHORT_SIZE + i,
+                       digestMbedtls, 0);
+    ok &= memcmp(digest, digestMbedtls, sizeof(digest)) == 0;
+  }
+
+  return ok;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Main function
+ *****************************************************************************/
+int main(void)
+{
+  const uint8_t *data = (const uint8_t *) FLASH_BASE;
+  uint32_t cycles;
+
+  // Chip errata
+  CHIP_Init();
+
+  isError = !checkKnownAnswers();
+
+  cycleCounterStart();
+
+  // Hash the start of the flash with both implementations
+  cycles = cycleCounterGet();
+  sha256Sw(data, BENCH_SIZE, digestSw);
+  cycles = (cycleCounterGet() - cycles) & SYSTICK_MAX;
+  cyclesPerByteSw = (cycles + BENCH_SIZE / 2) / BENCH_SIZE;
+
+  cycles = cycleCounterGet();
+  mbedtls_sha256_ret(data, BENCH_SIZE, digestMbedtls, 0);
+  cycles = (cycleCounterGet() - cycles) & SYSTICK_MAX;
+  cyclesPerByteMbedtls = (cycles + BENCH_SIZE / 2) / BENCH_SIZE;
+
+  if (memcmp(digestSw, digestMbedtls, sizeof(digestSw)) != 0) {
+    isError = true;
+  }
+
+  // Hash a short message, where the per-call overhead counts most
+  cycles = cycleCounterGet();
+  sha256Sw(data, SHORT_SIZE, digestSw);
+  cyclesShortSw = (cycleCounterGet() - cycles) & SYSTICK_MAX;
+
+  cycles = cycleCounterGet();
+  mbedtls_sha256_ret(data, SHORT_SIZE, digestMbedtls, 0);
+  cyclesShortMbedtls = (cycleCounterGet() - cycles) & SYSTICK_MAX;
+
+  if (memcmp(digestSw, digestMbedtls, sizeof(digestSw)) != 0) {
+    isError = true;
+  }
+
+  // Pause the debugger here to check isError and the cycle counts
+  while (1) {
+    EMU_EnterEM1();
+  }
+}
@@ -0,0 +1,308 @@
+/***************************************************************************//**
+ * @file sha256_sw.c
+ * @brief Software SHA-256 for devices without a hash accelerator
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "sha256_sw.h"
+#include <string.h>
+
+// The compression function keeps the eight working variables in locals, so
+// that the compiler can hold them in registers, and runs the rounds eight at
+// a time with the variables renamed instead of shifted. The message schedule
+// is computed in place in a 16-word window. The round constants are const
+// and stay in flash.
+
+#define ROTR(x, n)      (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define SIGMA0(x)       (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define SIGMA1(x)       (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define GAMMA0(x)       (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define GAMMA1(x)       (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+#define CH(x, y, z)     ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z)    (((x) & (y)) | ((z) & ((x) | (y))))
+
+// Next schedule word, W[i] for i >= 16, written over W[i - 16]
+#define SCHEDULE(w, i)                                  \
+  ((w)[(i) & 15] += GAMMA1((w)[((i) - 2) & 15])         \
+                    + (w)[((i) - 7) & 15]               \
+                    + GAMMA0((w)[((i) - 15) & 15]))
+
+#define ROUND(a, b, c, d, e, f, g, h, k, x)             \
+  do {                                                  \
+    (h) += SIGMA1(e) + CH(e, f, g) + (k) + (x);         \
+    (d) += (h);                                         \
+    (h) += SIGMA0(a) + MAJ(a, b, c);                    \
+  } while (0)
+
+// Eight rounds starting at round i, with the message word given by W(j)
+#define ROUNDS8(i, W)                                   \
+  do {                                                  \
+    ROUND(a, b, c, d, e, f, g, h, k[(i) + 0], W((i) + 0)); \
+    ROUND(h, a, b, c, d, e, f, g, k[(i) + 1], W((i) + 1)); \
+    ROUND(g, h, a, b, c, d, e, f, k[(i) + 2], W((i) + 2)); \
+    ROUND(f, g, h, a, b, c, d, e, k[(i) + 3], W((i) + 3)); \
+    ROUND(e, f, g, h, a, b, c, d, k[(i) + 4], W((i) + 4)); \
+    ROUND(d, e, f, g, h, a, b, c, k[(i) + 5], W((i) + 5)); \
+    ROUND(c, d, e, f, g, h, a, b, k[(i) + 6], W((i) + 6)); \
+    ROUND(b, c, d, e, f, g, h, a, k[(i) + 7], W((i) + 7)); \
+  } while (0)
+
+#define W_LOAD(j)       (w[j])
+#define W_NEXT(j)       (SCHEDULE(w, j))
+
+static const uint32_t k[64] = {
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+  0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+  0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+  0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+  0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+  0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+  0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+  0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+  0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+static const uint32_t initialState[8] = {
+  0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+  0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+/***************************************************************************//**
+ * @brief Clear memory in a way the compiler cannot remove
+ ******************************************************************************/
+static void sha256SwWipe(void *buf, size_t len)
+{
+  volatile uint8_t *p = buf;
+
+  while (len-- > 0) {
+    *p++ = 0;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Run the compression function over a number of whole blocks
+ *
+ * @param state Chaining value, updated in place.
+ * @param data Input blocks, with any alignment.
+ * @param blocks Number of 64-byte blocks.
+ ******************************************************************************/
+static void sha256SwCompress(uint32_t state[8], const uint8_t *data,
+                             size_t blocks)
+{
+  uint32_t w[16];
+  uint32_t a, b, c, d, e, f, g, h;
+  uint32_t t;
+  int i;
+
+  while (blocks-- > 0) {
+    // Load big-endian words, memcpy keeps unaligned input safe on Cortex-M0+
+    for (i = 0; i < 16; i++) {
+      memcpy(&t, data + 4 * i, sizeof(t));
+      w[i] = __REV(t);
+    }
+
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
+    e = state[4];
+    f = state[5];
+    g = state[6];
+    h = state[7];
+
+    ROUNDS8(0, W_LOAD);
+    ROUNDS8(8, W_LOAD);
+    for (i = 16; i < 64; i += 16) {
+      ROUNDS8(i, W_NEXT);
+      ROUNDS8(i + 8, W_NEXT);
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+
+    data += SHA256_SW_BLOCK_SIZE;
+  }
+
+  // Do not leave message words on the stack
+  sha256SwWipe(w, sizeof(w));
+}
+
+/***************************************************************************//**
+ * @brief Start a new hash
+ ******************************************************************************/
+void sha256SwInit(sha256Sw_TypeDef *ctx)
+{
+  memcpy(ctx->state, initialState, sizeof(ctx->state));
+  ctx->count[0] = 0;
+  ctx->count[1] = 0;
+}
+
+/***************************************************************************//**
+ * @brief Hash more data
+ *
+ * @details Whole blocks are compressed directly from the input, only a
+ * partial block at the start or end is copied to the context.
+ ******************************************************************************/
+void sha256SwUpdate(sha256Sw_TypeDef *ctx, const uint8_t *data, size_t len)
+{
+  size_t used = ctx->count[0] & (SHA256_SW_BLOCK_SIZE - 1);
+  size_t fill;
+  size_t blocks;
+
+  if (len == 0) {
+    return;
+  }
+
+  ctx->count[0] += (uint32_t)len;
+  if (ctx->count[0] < (uint32_t)len) {
+    ctx->count[1]++;
+  }
+
+  if (used > 0) {
+    fill = SHA256_SW_BLOCK_SIZE - used;
+    if (len < fill) {
+      memcpy(ctx->buffer + used, data, len);
+      return;
+    }
+    memcpy(ctx->buffer + used, data, fill);
+    sha256SwCompress(ctx->state, ctx->buffer, 1);
+    data += fill;
+    len -= fill;
+  }
+
+  blocks = len / SHA256_SW_BLOCK_SIZE;
+  if (blocks > 0) {
+    sha256SwCompress(ctx->state, data, blocks);
+    data += blocks * SHA256_SW_BLOCK_SIZE;
+    len -= blocks * SHA256_SW_BLOCK_SIZE;
+  }
+
+  if (len > 0) {
+    memcpy(ctx->buffer, data, len);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Pad, output the digest and wipe the context
+ ******************************************************************************/
+void sha256SwFinish(sha256Sw_TypeDef *ctx,
+                    uint8_t digest[SHA256_SW_DIGEST_SIZE])
+{
+  size_t used = ctx->count[0] & (SHA256_SW_BLOCK_SIZE - 1);
+  uint32_t bitsHigh = (ctx->count[1] << 3) | (ctx->count[0] >> 29);
+  uint32_t bitsLow = ctx->count[0] << 3;
+  uint32_t t;
+  int i;
+
+  ctx->buffer[used++] = 0x80;
+  if (used > SHA256_SW_BLOCK_SIZE - 8) {
+    memset(ctx->buffer + used, 0, SHA256_SW_BLOCK_SIZE - used);
+    sha256SwCompress(ctx->state, ctx->buffer, 1);
+    used = 0;
+  }
+  memset(ctx->buffer + used, 0, SHA256_SW_BLOCK_SIZE - 8 - used);
+
+  t = __REV(bitsHigh);
+  memcpy(ctx->buffer + SHA256_SW_BLOCK_SIZE - 8, &t, sizeof(t));
+  t = __REV(bitsLow);
+  memcpy(ctx->buffer + SHA256_SW_BLOCK_SIZE - 4, &t, sizeof(t));
+  sha256SwCompress(ctx->state, ctx->buffer, 1);
+
+  for (i = 0; i < 8; i++) {
+    t = __REV(ctx->state[i]);
+    memcpy(digest + 4 * i, &t, sizeof(t));
+  }
+
+  sha256SwWipe(ctx, sizeof(*ctx));
+}
+
+/***************************************************************************//**
+ * @brief Hash a message in one call
+ ******************************************************************************/
+void sha256Sw(const uint8_t *data, size_t len,
+              uint8_t digest[SHA256_SW_DIGEST_SIZE])
+{
+  sha256Sw_TypeDef ctx;
+
+  sha256SwInit(&ctx);
+  sha256SwUpdate(&ctx, data, len);
+  sha256SwFinish(&ctx, digest);
+}
+
+/***************************************************************************//**
+ * @brief Save the chaining value of a context
+ *
+ * @return 0 on success, or SHA256_SW_ERR_NOT_ALIGNED if the data hashed so
+ * far is not a whole number of blocks (or more than 2^32 blocks).
+ ******************************************************************************/
+int sha256SwMidstateGet(const sha256Sw_TypeDef *ctx,
+                        sha256SwMidstate_TypeDef *midstate)
+{
+  if ((ctx->count[0] & (SHA256_SW_BLOCK_SIZE - 1)) != 0
+      || ctx->count[1] >= (1UL << 6)) {
+    return SHA256_SW_ERR_NOT_ALIGNED;
+  }
+
+  memcpy(midstate->state, ctx->state, sizeof(midstate->state));
+  midstate->blocks = (ctx->count[1] << 26) | (ctx->count[0] >> 6);
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Start a hash from a saved chaining value
+ *
+ * @details The context continues as if the blocks of the midstate had just
+ * been hashed with sha256SwUpdate().
+ ******************************************************************************/
+void sha256SwMidstateSet(sha256Sw_TypeDef *ctx,
+                         const sha256SwMidstate_TypeDef *midstate)
+{
+  memcpy(ctx->state, midstate->state, sizeof(ctx->state));
+  ctx->count[0] = midstate->blocks * SHA256_SW_BLOCK_SIZE;
+  ctx->count[1] = midstate->blocks >> 26;
+}
@@ -0,0 +1,81 @@
+/***************************************************************************//**
+ * @file sha256_sw.h
+ * @brief Software SHA-256 for devices without a hash accelerator
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef SHA256_SW_H
+#define SHA256_SW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHA256_SW_BLOCK_SIZE            (64)
+#define SHA256_SW_DIGEST_SIZE           (32)
+
+// Returned by sha256SwMidstateGet() if the context is not at a block boundary
+#define SHA256_SW_ERR_NOT_ALIGNED       (-0x5B00)
+
+// Streaming context
+typedef struct {
+  uint32_t state[8];                      // Chaining value
+  uint32_t count[2];                      // Bytes hashed, low and high word
+  uint8_t buffer[SHA256_SW_BLOCK_SIZE];   // Partial block
+} sha256Sw_TypeDef;
+
+// Chaining value after a whole number of blocks, e.g. of a fixed prefix or
+// of an HMAC inner/outer key block. Restoring it skips hashing the prefix.
+typedef struct {
+  uint32_t state[8];
+  uint32_t blocks;                        // Blocks hashed into state
+} sha256SwMidstate_TypeDef;
+
+void sha256SwInit(sha256Sw_TypeDef *ctx);
+void sha256SwUpdate(sha256Sw_TypeDef *ctx, const uint8_t *data, size_t len);
+void sha256SwFinish(sha256Sw_TypeDef *ctx,
+                    uint8_t digest[SHA256_SW_DIGEST_SIZE]);
+void sha256Sw(const uint8_t *data, size_t len,
+              uint8_t digest[SHA256_SW_DIGEST_SIZE]);
+int sha256SwMidstateGet(const sha256Sw_TypeDef *ctx,
+                        sha256SwMidstate_TypeDef *midstate);
+void sha256SwMidstateSet(sha256Sw_TypeDef *ctx,
+                         const sha256SwMidstate_TypeDef *midstate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHA256_SW_H
@@ -0,0 +1,210 @@
+/***************************************************************************//**
+ * @file sha256_sw_test.c
+ * @brief Host test of sha256_sw.c: FIPS 180-2 examples, all lengths up to
+ * 4 KiB against mbed TLS, streaming split points and midstates
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, with the mbed TLS of the
+// Gecko SDK built for the host (make -C <mbedtls> lib):
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc -I<mbedtls>/include
+//       test/sha256_sw_test.c src/sha256_sw.c
+//       -L<mbedtls>/library -lmbedcrypto -o sha256_sw_test
+//   ./sha256_sw_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "sha256_sw.h"
+#include "mbedtls/sha256.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define MAX_LEN         (4096)
+#define MILLION         (1000000)
+
+static int checks;
+static int failures;
+
+// Test data, one byte more than MAX_LEN for the unaligned start
+static uint8_t data[MAX_LEN + 1];
+
+// FIPS 180-2 appendix B: "abc", the 448-bit message and one million 'a'
+static const char *vectorMessage[2] = {
+  "abc",
+  "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+};
+
+static const uint8_t vectorDigest[3][SHA256_SW_DIGEST_SIZE] = {
+  {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde,
+    0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+    0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+  },
+  {
+    0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93,
+    0x0c, 0x3e, 0x60, 0x39, 0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+    0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+  },
+  {
+    0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2,
+    0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e,
+    0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+  },
+};
+
+/***************************************************************************//**
+ * @brief Check the FIPS 180-2 examples, the million 'a' message streamed in
+ * chunks of varying size
+ ******************************************************************************/
+static void testVectors(void)
+{
+  static uint8_t a[1000];
+  sha256Sw_TypeDef ctx;
+  uint8_t digest[SHA256_SW_DIGEST_SIZE];
+  size_t done = 0;
+  size_t step = 1;
+
+  for (int v = 0; v < 2; v++) {
+    sha256Sw((const uint8_t *)vectorMessage[v], strlen(vectorMessage[v]),
+             digest);
+    CHECK(memcmp(digest, vectorDigest[v], sizeof(digest)) == 0);
+  }
+
+  memset(a, 'a', sizeof(a));
+  sha256SwInit(&ctx);
+  while (done < MILLION) {
+    size_t n = step;
+
+    if (n > MILLION - done) {
+      n = MILLION - done;
+    }
+    sha256SwUpdate(&ctx, a, n);
+    done += n;
+    step = step * 7 % 997 + 1;
+  }
+  sha256SwFinish(&ctx, digest);
+  CHECK(memcmp(digest, vectorDigest[2], sizeof(digest)) == 0);
+}
+
+/***************************************************************************//**
+ * @brief Compare one-shot hashes with mbed TLS for every length up to
+ * MAX_LEN, from an aligned and from an unaligned start
+ ******************************************************************************/
+static void testLengths(void)
+{
+  uint8_t digest[SHA256_SW_DIGEST_SIZE];
+  uint8_t expected[SHA256_SW_DIGEST_SIZE];
+
+  for (size_t len = 0; len <= MAX_LEN; len++) {
+    for (size_t offset = 0; offset < 2; offset++) {
+      sha256Sw(data + offset, len, digest);
+      mbedtls_sha256_ret(data + offset, len, expected, 0);
+      CHECK(memcmp(digest, expected, sizeof(digest)) == 0);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Check that streamed hashes do not depend on where the data is split
+ ******************************************************************************/
+static void testStreaming(void)
+{
+  sha256Sw_TypeDef ctx;
+  uint8_t digest[SHA256_SW_DIGEST_SIZE];
+  uint8_t expected[SHA256_SW_DIGEST_SIZE];
+
+  for (size_t len = 0; len < 300; len++) {
+    mbedtls_sha256_ret(data + 3, len, expected, 0);
+    for (size_t split = 0; split <= len; split += 7) {
+      sha256SwInit(&ctx);
+      sha256SwUpdate(&ctx, data + 3, split);
+      sha256SwUpdate(&ctx, data + 3 + split, len - split);
+      sha256SwFinish(&ctx, digest);
+      CHECK(memcmp(digest, expected, sizeof(digest)) == 0);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Resume from a midstate after two blocks, and check that a midstate
+ * is refused off a block boundary
+ ******************************************************************************/
+static void testMidstate(void)
+{
+  sha256Sw_TypeDef ctx;
+  sha256Sw_TypeDef resumed;
+  sha256SwMidstate_TypeDef midstate;
+  uint8_t digest[SHA256_SW_DIGEST_SIZE];
+  uint8_t expected[SHA256_SW_DIGEST_SIZE];
+
+  sha256SwInit(&ctx);
+  sha256SwUpdate(&ctx, data, 2 * SHA256_SW_BLOCK_SIZE);
+  CHECK(sha256SwMidstateGet(&ctx, &midstate) == 0);
+  CHECK(midstate.blocks == 2);
+
+  for (size_t len = 0; len < 3 * SHA256_SW_BLOCK_SIZE; len++) {
+    sha256SwMidstateSet(&resumed, &midstate);
+    sha256SwUpdate(&resumed, data + 2 * SHA256_SW_BLOCK_SIZE, len);
+    sha256SwFinish(&resumed, digest);
+    mbedtls_sha256_ret(data, 2 * SHA256_SW_BLOCK_SIZE + len, expected, 0);
+    CHECK(memcmp(digest, expected, sizeof(digest)) == 0);
+  }
+
+  sha256SwUpdate(&ctx, data, 5);
+  CHECK(sha256SwMidstateGet(&ctx, &midstate) == SHA256_SW_ERR_NOT_ALIGNED);
+}
+
+int main(void)
+{
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 131 + 7);
+  }
+
+  testVectors();
+  testLengths();
+  testStreaming();
+  testMidstate();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
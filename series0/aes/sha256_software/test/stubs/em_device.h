@@ -0,0 +1,9 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+#define __REV(x)                        __builtin_bswap32(x)
+
+#endif // EM_DEVICE_H
@@ -0,0 +1,80 @@
+/***************************************************************************//**
+ * @file gpio_dispatch.h
+ * @brief Table-driven GPIO interrupt dispatcher with per-interrupt callbacks
+ * and debounce
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef GPIO_DISPATCH_H
+#define GPIO_DISPATCH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// External interrupts are numbered 0 to 15 on all series. The number is the
+// intNo argument of GPIO_ExtIntConfig(), which is the pin number on Series 0
+// and may be any pin of the same group of four on Series 1 and 2.
+#define GPIO_DISPATCH_MAX_INTS          (16)
+
+// Interrupt flags handled by GPIO_EVEN_IRQHandler and GPIO_ODD_IRQHandler
+#define GPIO_DISPATCH_EVEN_MASK         (0x5555UL)
+#define GPIO_DISPATCH_ODD_MASK          (0xAAAAUL)
+
+// Invalid interrupt number, or debounce without a timer
+#define GPIO_DISPATCH_ERR_PARAM         (-0x5480)
+
+typedef void (*gpioDispatchCallback_TypeDef)(uint32_t intNo);
+
+// Timer for debouncing. now() is a free running 32-bit time, and arm() must
+// make the timer interrupt handler call gpioDispatchTimeout() once now()
+// reaches tick, also if tick has already passed. The timer and the GPIO
+// interrupts must have the same NVIC priority.
+typedef struct {
+  uint32_t (*now)(void);
+  void (*arm)(uint32_t tick);
+  void (*disarm)(void);
+} gpioDispatchTimer_TypeDef;
+
+void gpioDispatchInit(const gpioDispatchTimer_TypeDef *timer);
+int gpioDispatchRegister(uint32_t intNo,
+                         gpioDispatchCallback_TypeDef callback,
+                         uint32_t debounce);
+void gpioDispatchTimeout(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPIO_DISPATCH_H
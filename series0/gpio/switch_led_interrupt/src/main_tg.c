@@ -2,7 +2,8 @@
  * @file main_tg.c
  * @brief This project demonstrates a using GPIOs to trigger external
  * interrupts. When PB0 or PB1 is pressed, LED0 or LED1 is toggled,
- * respectively. See readme.txt for details.
+ * respectively. The interrupts are dispatched by gpio_dispatch.c and
+ * debounced with the RTC. See readme.txt for details.
  *******************************************************************************
  * # License
  * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
@@ -40,20 +41,88 @@
 #include "em_cmu.h"
 #include "em_emu.h"
 #include "em_gpio.h"
+#include "em_rtc.h"
 #include "bsp.h"
+#include "gpio_dispatch.h"
+
+// RTC ticks per second, the RTC counts the ULFRCO, which runs in EM3
+#define TICKS_PER_SECOND  1000
+
+// The 24-bit RTC counter is shifted up to a 32-bit time for the dispatcher,
+// so that time differences wrap around correctly
+#define RTC_SHIFT         8
+
+// Time to ignore a push button after a press
+#define DEBOUNCE_TICKS    (TICKS_PER_SECOND / 20)
+
+/**************************************************************************//**
+ * @brief Debounce timer hooks for the RTC
+ *****************************************************************************/
+static uint32_t rtcNow(void)
+{
+  return RTC_CounterGet() << RTC_SHIFT;
+}
+
+static void rtcArm(uint32_t tick)
+{
+  RTC_CompareSet(0, tick >> RTC_SHIFT);
+  RTC_IntClear(RTC_IFC_COMP0);
+  RTC_IntEnable(RTC_IEN_COMP0);
+
+  // Set the flag if the match has already been missed
+  if ((int32_t)(tick - rtcNow()) <= 0)
+    RTC_IntSet(RTC_IFS_COMP0);
+}
+
+static void rtcDisarm(void)
+{
+  RTC_IntDisable(RTC_IEN_COMP0);
+  RTC_IntClear(RTC_IFC_COMP0);
+}
+
+static const gpioDispatchTimer_TypeDef debounceTimer = {
+  .now = rtcNow,
+  .arm = rtcArm,
+  .disarm = rtcDisarm,
+};
+
+void RTC_IRQHandler(void)
+{
+  RTC_IntClear(RTC_IFC_COMP0);
+  gpioDispatchTimeout();
+}
 
 /**************************************************************************//**
- * @brief GPIO Even IRQ for pushbuttons on even-numbered pins
+ * @brief Push button callback, called from the GPIO interrupt handlers
  *****************************************************************************/
-void GPIO_EVEN_IRQHandler(void) 
+static void pb0Pressed(uint32_t intNo)
 {
-  // Clear all even pin interrupt flags
-  GPIO_IntClear(0x5555);
+  (void)intNo;
 
-  // Toggle LED1
+  // Toggle LED0
   GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
 }
 
+/**************************************************************************//**
+ * @brief RTC initialization, free running counter on the ULFRCO
+ *****************************************************************************/
+void initRTC(void)
+{
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_ULFRCO);
+  CMU_ClockEnable(cmuClock_RTC, true);
+
+  // Count through the full 24-bit range instead of wrapping on COMP0
+  RTC_Init_TypeDef rtc = RTC_INIT_DEFAULT;
+  rtc.comp0Top = false;
+
+  RTC_IntClear(_RTC_IF_MASK);
+  NVIC_ClearPendingIRQ(RTC_IRQn);
+  NVIC_EnableIRQ(RTC_IRQn);
+
+  RTC_Init(&rtc);
+}
+
 /**************************************************************************//**
  * @brief GPIO initialization
  *****************************************************************************/
@@ -62,12 +131,16 @@ void initGPIO(void)
   // Enable GPIO clock
   CMU_ClockEnable(cmuClock_GPIO, true);
 
-  // Configure PB0 and PB1 as input with glitch filter enabled
+  // Configure PB0 as input with glitch filter enabled
   GPIO_PinModeSet(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, gpioModeInputPullFilter, 1);
 
-  // Configure LED0 and LED1 as output
+  // Configure LED0 as output
   GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, 0);
 
+  // Register the push button callback, the interrupt number is the pin
+  gpioDispatchInit(&debounceTimer);
+  gpioDispatchRegister(BSP_GPIO_PB0_PIN, pb0Pressed, DEBOUNCE_TICKS << RTC_SHIFT);
+
   // Enable IRQ for even numbered GPIO pins
   NVIC_EnableIRQ(GPIO_EVEN_IRQn);
 
@@ -84,6 +157,7 @@ int main(void)
   CHIP_Init();
 
   // Initializations
+  initRTC();
   initGPIO();
 
   while (1){
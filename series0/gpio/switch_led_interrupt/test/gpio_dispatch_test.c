@@ -0,0 +1,287 @@
+/***************************************************************************//**
+ * @file gpio_dispatch_test.c
+ * @brief Host test of gpio_dispatch.c: dispatch order and flag handling of both
+ * handlers, and debounce with a simulated timer
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, once as is and once
+// with -D__CORTEX_M=0 for the Cortex-M0+ code:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/gpio_dispatch_test.c
+//       src/gpio_dispatch.c -o gpio_dispatch_test
+//   ./gpio_dispatch_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "gpio_dispatch.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define RANDOM_IRQS     (100000)
+#define RANDOM_STEPS    (100000)
+
+// Interrupt without a callback in testDispatch()
+#define NO_CALLBACK     (3)
+
+void GPIO_EVEN_IRQHandler(void);
+void GPIO_ODD_IRQHandler(void);
+
+static int checks;
+static int failures;
+
+static uint32_t seed = 96;
+
+// GPIO interrupt flag and enable registers, see stubs/em_gpio.h
+uint32_t gpioIF;
+uint32_t gpioIEN;
+
+// Simulated timer, starting close to the wrap of the time
+static uint32_t simTime = 0xFFFFFF00UL;
+static uint32_t armedTick;
+static bool armed;
+
+// Callbacks in the order they were called
+static uint32_t calls[GPIO_DISPATCH_MAX_INTS];
+static int callCount;
+
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+static uint32_t simNow(void)
+{
+  return simTime;
+}
+
+static void simArm(uint32_t tick)
+{
+  armedTick = tick;
+  armed = true;
+}
+
+static void simDisarm(void)
+{
+  armed = false;
+}
+
+static const gpioDispatchTimer_TypeDef simTimer = {
+  simNow,
+  simArm,
+  simDisarm
+};
+
+static void callback(uint32_t intNo)
+{
+  calls[callCount++] = intNo;
+}
+
+/***************************************************************************//**
+ * @brief Random flags and enables: each handler clears and dispatches only
+ * its own enabled flags, highest interrupt first
+ ******************************************************************************/
+static void testDispatch(void)
+{
+  gpioDispatchInit(&simTimer);
+  CHECK(gpioDispatchRegister(GPIO_DISPATCH_MAX_INTS, callback, 0)
+        == GPIO_DISPATCH_ERR_PARAM);
+  for (uint32_t n = 0; n < GPIO_DISPATCH_MAX_INTS; n++) {
+    CHECK(gpioDispatchRegister(n, (n == NO_CALLBACK) ? NULL : callback, 0)
+          == 0);
+  }
+
+  for (int it = 0; it < RANDOM_IRQS; it++) {
+    uint32_t flags = random32() & 0xFFFF;
+    uint32_t high = random32() << 16;
+    bool odd = (random32() & 1) != 0;
+    uint32_t mask = odd ? GPIO_DISPATCH_ODD_MASK : GPIO_DISPATCH_EVEN_MASK;
+    uint32_t expect;
+    int k = 0;
+
+    gpioIF = flags | high;
+    gpioIEN = random32() & 0xFFFF;
+    expect = flags & gpioIEN & mask;
+    callCount = 0;
+    if (odd) {
+      GPIO_ODD_IRQHandler();
+    } else {
+      GPIO_EVEN_IRQHandler();
+    }
+    CHECK(gpioIF == ((flags | high) & ~expect));
+    for (int n = GPIO_DISPATCH_MAX_INTS - 1; n >= 0; n--) {
+      if ((expect & (1UL << n)) && n != NO_CALLBACK) {
+        CHECK(k < callCount && calls[k] == (uint32_t)n);
+        k++;
+      }
+    }
+    CHECK(k == callCount);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Debounce of two interrupts with different times, next to one
+ * without debounce
+ ******************************************************************************/
+static void testDebounce(void)
+{
+  gpioDispatchInit(NULL);
+  CHECK(gpioDispatchRegister(2, callback, 50) == GPIO_DISPATCH_ERR_PARAM);
+
+  gpioDispatchInit(&simTimer);
+  CHECK(gpioDispatchRegister(2, callback, 50) == 0);
+  CHECK(gpioDispatchRegister(5, callback, 100) == 0);
+  CHECK(gpioDispatchRegister(1, callback, 0) == 0);
+
+  // An edge on 2 calls back, disables 2 and arms the timer
+  gpioIEN = 0x26;
+  gpioIF = 0x4;
+  callCount = 0;
+  GPIO_EVEN_IRQHandler();
+  CHECK(callCount == 1 && calls[0] == 2);
+  CHECK(!(gpioIEN & 0x4));
+  CHECK(armed && armedTick == simTime + 50);
+
+  // A bounce on 2 is ignored, an edge on 5 calls back and the timer stays
+  // armed for 2, which ends first
+  simTime += 10;
+  gpioIF = 0x24;
+  GPIO_ODD_IRQHandler();
+  GPIO_EVEN_IRQHandler();
+  CHECK(callCount == 2 && calls[1] == 5);
+  CHECK(armedTick == simTime + 40);
+  CHECK(gpioIF == 0x4);
+
+  // 2 is enabled again once its time has passed, with the bounce cleared
+  simTime += 39;
+  gpioDispatchTimeout();
+  CHECK(!(gpioIEN & 0x4));
+  simTime += 1;
+  gpioDispatchTimeout();
+  CHECK((gpioIEN & 0x4) && gpioIF == 0);
+  CHECK(armed && armedTick == simTime + 60);
+
+  // 1 has no debounce and stays enabled
+  gpioIF = 0x2;
+  GPIO_ODD_IRQHandler();
+  CHECK(callCount == 3 && calls[2] == 1 && (gpioIEN & 0x2));
+
+  simTime += 60;
+  gpioDispatchTimeout();
+  CHECK((gpioIEN & 0x20) && !armed);
+}
+
+/***************************************************************************//**
+ * @brief Random edges on all interrupts with random debounce times, against
+ * a model of the debounce ends. The timer fires when it is due, as the
+ * timer interrupt handler would.
+ ******************************************************************************/
+static void testRandomDebounce(void)
+{
+  uint32_t debounce[GPIO_DISPATCH_MAX_INTS];
+  uint32_t end[GPIO_DISPATCH_MAX_INTS];
+  uint32_t busy = 0;
+
+  gpioDispatchInit(&simTimer);
+  armed = false;
+  for (uint32_t n = 0; n < GPIO_DISPATCH_MAX_INTS; n++) {
+    debounce[n] = random32() % 4 ? 1 + random32() % 200 : 0;
+    CHECK(gpioDispatchRegister(n, callback, debounce[n]) == 0);
+  }
+  gpioIEN = 0xFFFF;
+  gpioIF = 0;
+
+  for (int step = 0; step < RANDOM_STEPS; step++) {
+    uint32_t edges = random32() & random32() & 0xFFFF;
+    uint32_t expect;
+    uint32_t first = 0;
+    bool any = false;
+
+    simTime += random32() % 20;
+    if (armed && (int32_t)(armedTick - simTime) <= 0) {
+      gpioDispatchTimeout();
+      for (uint32_t n = 0; n < GPIO_DISPATCH_MAX_INTS; n++) {
+        if ((busy & (1UL << n)) && (int32_t)(end[n] - simTime) <= 0) {
+          busy &= ~(1UL << n);
+        }
+      }
+    }
+    CHECK(gpioIEN == (0xFFFF & ~busy));
+    CHECK((gpioIF & ~busy) == 0);
+
+    // Edges on interrupts in debounce only set their flags
+    expect = edges & ~busy;
+    gpioIF |= edges;
+    callCount = 0;
+    GPIO_EVEN_IRQHandler();
+    GPIO_ODD_IRQHandler();
+    CHECK(callCount == __builtin_popcount(expect));
+    for (uint32_t n = 0; n < GPIO_DISPATCH_MAX_INTS; n++) {
+      if ((expect & (1UL << n)) && debounce[n] != 0) {
+        end[n] = simTime + debounce[n];
+        busy |= 1UL << n;
+      }
+    }
+
+    for (uint32_t n = 0; n < GPIO_DISPATCH_MAX_INTS; n++) {
+      if ((busy & (1UL << n))
+          && (!any || (int32_t)(end[n] - first) < 0)) {
+        first = end[n];
+        any = true;
+      }
+    }
+    CHECK(armed == any);
+    CHECK(!any || armedTick == first);
+  }
+}
+
+int main(void)
+{
+  testDispatch();
+  testDebounce();
+  testRandomDebounce();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// Only the core type and the CMSIS CLZ function used by gpio_dispatch.c are
+// provided. Define __CORTEX_M to 0 to test the Cortex-M0+ code.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+#ifndef __CORTEX_M
+#define __CORTEX_M                      (4U)
+#endif
+
+static inline uint32_t __CLZ(uint32_t x)
+{
+  return (x != 0) ? (uint32_t)__builtin_clz(x) : 32;
+}
+
+#endif // EM_DEVICE_H
@@ -0,0 +1,31 @@
+// Host stand-in for em_gpio.h, used by the tests in the parent directory.
+// The interrupt flag and enable registers are variables of the test.
+#ifndef EM_GPIO_H
+#define EM_GPIO_H
+
+#include <stdint.h>
+
+extern uint32_t gpioIF;
+extern uint32_t gpioIEN;
+
+static inline uint32_t GPIO_IntGetEnabled(void)
+{
+  return gpioIF & gpioIEN;
+}
+
+static inline void GPIO_IntClear(uint32_t flags)
+{
+  gpioIF &= ~flags;
+}
+
+static inline void GPIO_IntDisable(uint32_t flags)
+{
+  gpioIEN &= ~flags;
+}
+
+static inline void GPIO_IntEnable(uint32_t flags)
+{
+  gpioIEN |= flags;
+}
+
+#endif // EM_GPIO_H
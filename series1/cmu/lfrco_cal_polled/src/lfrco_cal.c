@@ -0,0 +1,284 @@
+/***************************************************************************//**
+ * @file lfrco_cal.c
+ * @brief LFRCO calibration engine with binary search and a per-temperature
+ * tuning cache
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "lfrco_cal.h"
+#include <stddef.h>
+
+// Best tuning found for a temperature band
+typedef struct {
+  uint16_t tuning;
+  uint8_t error;                        // |up count - ideal| when found
+  uint8_t age;                          // Wakes since the last counter run
+  bool valid;
+} lfrcoCalEntry_TypeDef;
+
+// Best tuning value measured during one calibration
+typedef struct {
+  uint32_t tuning;
+  uint32_t error;
+} lfrcoCalBest_TypeDef;
+
+static lfrcoCalInit_TypeDef config;
+static lfrcoCalEntry_TypeDef cache[LFRCO_CAL_BANDS];
+static lfrcoCalStats_TypeDef stats;
+static int32_t lastBand = -1;
+
+/***************************************************************************//**
+ * @brief Map a temperature to a cache band
+ ******************************************************************************/
+static int32_t lfrcoCalBand(int32_t temperature)
+{
+  int32_t band;
+
+  if (temperature < LFRCO_CAL_TEMP_MIN) {
+    return 0;
+  }
+  band = (temperature - LFRCO_CAL_TEMP_MIN) / LFRCO_CAL_BAND_WIDTH;
+  return (band < LFRCO_CAL_BANDS) ? band : LFRCO_CAL_BANDS - 1;
+}
+
+/***************************************************************************//**
+ * @brief Run the counter at a tuning value and keep it if it is the best yet
+ *
+ * @return The up count.
+ ******************************************************************************/
+static uint32_t lfrcoCalMeasure(uint32_t tuning, lfrcoCalBest_TypeDef *best)
+{
+  uint32_t count = config.measure(tuning);
+  uint32_t error;
+
+  stats.counterRuns++;
+  stats.lastRuns++;
+
+  error = (count > config.idealCount) ? count - config.idealCount
+          : config.idealCount - count;
+  if (error < best->error) {
+    best->tuning = tuning;
+    best->error = error;
+  }
+  return count;
+}
+
+/***************************************************************************//**
+ * @brief Binary search between two tuning values
+ *
+ * @details The up count at lo is above the ideal count and the up count at hi
+ * is at or below it. lo may be -1 and hi may be tuningMax + 1, which stand for
+ * ends that are not measured. Each run halves the interval, so a search over
+ * the whole range takes log2(tuningMax + 1) runs.
+ ******************************************************************************/
+static void lfrcoCalBisect(int32_t lo, int32_t hi, lfrcoCalBest_TypeDef *best)
+{
+  int32_t mid;
+  uint32_t count;
+
+  while (hi - lo > 1 && best->error > 0) {
+    mid = lo + (hi - lo) / 2;
+    count = lfrcoCalMeasure((uint32_t)mid, best);
+    if (count > config.idealCount) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Search outwards from a tuning value with a known up count
+ *
+ * @details Steps of 1, 2, 4... are taken in the direction of the ideal count
+ * until it is passed, then the last step is bisected. A start that is off by
+ * n tuning steps costs about 2 * log2(n) runs.
+ ******************************************************************************/
+static void lfrcoCalGallop(uint32_t start, uint32_t count,
+                           lfrcoCalBest_TypeDef *best)
+{
+  int32_t lo;
+  int32_t hi;
+  int32_t step = 1;
+
+  if (count > config.idealCount) {
+    // Frequency too high, raise the tuning value
+    lo = (int32_t)start;
+    for (;; ) {
+      hi = lo + step;
+      if (hi > (int32_t)config.tuningMax) {
+        hi = (int32_t)config.tuningMax + 1;
+        break;
+      }
+      if (lfrcoCalMeasure((uint32_t)hi, best) <= config.idealCount) {
+        break;
+      }
+      lo = hi;
+      step <<= 1;
+    }
+  } else {
+    // Frequency too low, lower the tuning value
+    hi = (int32_t)start;
+    for (;; ) {
+      lo = hi - step;
+      if (lo < 0) {
+        lo = -1;
+        break;
+      }
+      if (lfrcoCalMeasure((uint32_t)lo, best) > config.idealCount) {
+        break;
+      }
+      hi = lo;
+      step <<= 1;
+    }
+  }
+
+  lfrcoCalBisect(lo, hi, best);
+}
+
+/***************************************************************************//**
+ * @brief Find the valid cache entry of the band closest to a band
+ ******************************************************************************/
+static const lfrcoCalEntry_TypeDef *lfrcoCalNearest(int32_t band)
+{
+  int32_t d;
+
+  for (d = 1; d < LFRCO_CAL_BANDS; d++) {
+    if (band - d >= 0 && cache[band - d].valid) {
+      return &cache[band - d];
+    }
+    if (band + d < LFRCO_CAL_BANDS && cache[band + d].valid) {
+      return &cache[band + d];
+    }
+  }
+  return NULL;
+}
+
+/***************************************************************************//**
+ * @brief Set up the calibration engine and clear the cache
+ ******************************************************************************/
+void lfrcoCalInit(const lfrcoCalInit_TypeDef *init)
+{
+  config = *init;
+  lfrcoCalInvalidate();
+  stats = (lfrcoCalStats_TypeDef){ 0 };
+}
+
+/***************************************************************************//**
+ * @brief Calibrate the LFRCO for the current temperature
+ *
+ * @details
+ *   - Same band as the last call and checked in the last
+ *     LFRCO_CAL_RECHECK_WAKES calls: the cached tuning is kept, no run.
+ *   - Band cached: one run at the cached tuning. If the up count is within
+ *     LFRCO_CAL_TOLERANCE of what it was when cached, it is kept.
+ *   - Otherwise the search starts from the cached tuning, or from the closest
+ *     cached band, or is a binary search over the whole range if the cache is
+ *     empty.
+ *
+ * @param temperature Die temperature in degrees C.
+ * @return The tuning value applied.
+ ******************************************************************************/
+uint32_t lfrcoCalRun(int32_t temperature)
+{
+  int32_t band = lfrcoCalBand(temperature);
+  lfrcoCalEntry_TypeDef *entry = &cache[band];
+  const lfrcoCalEntry_TypeDef *seed;
+  lfrcoCalBest_TypeDef best = { 0, UINT32_MAX };
+  uint32_t count;
+
+  stats.calibrations++;
+  stats.lastRuns = 0;
+
+  if (entry->valid && band == lastBand
+      && entry->age < LFRCO_CAL_RECHECK_WAKES) {
+    entry->age++;
+    stats.cacheHits++;
+    return entry->tuning;
+  }
+
+  if (entry->valid) {
+    count = lfrcoCalMeasure(entry->tuning, &best);
+    if (best.error <= (uint32_t)entry->error + LFRCO_CAL_TOLERANCE) {
+      stats.verifyHits++;
+    } else {
+      stats.searches++;
+      lfrcoCalGallop(entry->tuning, count, &best);
+    }
+  } else {
+    stats.searches++;
+    seed = lfrcoCalNearest(band);
+    if (seed != NULL) {
+      count = lfrcoCalMeasure(seed->tuning, &best);
+      lfrcoCalGallop(seed->tuning, count, &best);
+    } else {
+      lfrcoCalBisect(-1, (int32_t)config.tuningMax + 1, &best);
+    }
+  }
+
+  // A confirmed entry keeps the error found by the search, so that the
+  // tolerance does not add up over several confirmations
+  if (stats.lastRuns > 1 || !entry->valid) {
+    entry->tuning = (uint16_t)best.tuning;
+    entry->error = (best.error > UINT8_MAX) ? UINT8_MAX : (uint8_t)best.error;
+  }
+  entry->age = 0;
+  entry->valid = true;
+  lastBand = band;
+
+  // The last run may not have been at the best tuning value
+  config.apply(best.tuning);
+  stats.lastTuning = best.tuning;
+  stats.lastError = best.error;
+  return best.tuning;
+}
+
+/***************************************************************************//**
+ * @brief Forget all cached tuning values, e.g. after a supply change
+ ******************************************************************************/
+void lfrcoCalInvalidate(void)
+{
+  int32_t i;
+
+  for (i = 0; i < LFRCO_CAL_BANDS; i++) {
+    cache[i].valid = false;
+  }
+  lastBand = -1;
+}
+
+/***************************************************************************//**
+ * @brief Get the calibration statistics
+ ******************************************************************************/
+void lfrcoCalStatsGet(lfrcoCalStats_TypeDef *statsOut)
+{
+  *statsOut = stats;
+}
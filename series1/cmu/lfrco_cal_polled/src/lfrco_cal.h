@@ -0,0 +1,97 @@
+/***************************************************************************//**
+ * @file lfrco_cal.h
+ * @brief LFRCO calibration engine with binary search and a per-temperature
+ * tuning cache
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef LFRCO_CAL_H
+#define LFRCO_CAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lowest temperature of the cache, in degrees C
+#define LFRCO_CAL_TEMP_MIN              (-40)
+
+// Width of a temperature band, in degrees C
+#define LFRCO_CAL_BAND_WIDTH            (4)
+
+// Number of cached bands, -40 to +128 C
+#define LFRCO_CAL_BANDS                 (42)
+
+// Wakes in the same band that reuse the cached tuning without a counter run
+#define LFRCO_CAL_RECHECK_WAKES         (16)
+
+// Up counts a cached tuning may be off by before it is searched again
+#define LFRCO_CAL_TOLERANCE             (1)
+
+// Set the tuning value and return the up count of one calibration run. The
+// up count must not increase when the tuning value increases, as is the case
+// for the LFRCO (a higher tuning value gives a lower frequency).
+typedef uint32_t (*lfrcoCalMeasure_TypeDef)(uint32_t tuning);
+
+// Set the tuning value without a calibration run
+typedef void (*lfrcoCalApply_TypeDef)(uint32_t tuning);
+
+typedef struct {
+  uint32_t idealCount;                  // Up count at the target frequency
+  uint32_t tuningMax;                   // Largest tuning value
+  lfrcoCalMeasure_TypeDef measure;
+  lfrcoCalApply_TypeDef apply;
+} lfrcoCalInit_TypeDef;
+
+typedef struct {
+  uint32_t calibrations;                // Calls to lfrcoCalRun()
+  uint32_t counterRuns;                 // Calibration runs in total
+  uint32_t cacheHits;                   // Calibrations with no counter run
+  uint32_t verifyHits;                  // Cached tuning confirmed by one run
+  uint32_t searches;                    // Calibrations that had to search
+  uint32_t lastRuns;                    // Counter runs of the last calibration
+  uint32_t lastTuning;                  // Tuning value applied last
+  uint32_t lastError;                   // |up count - ideal| of lastTuning
+} lfrcoCalStats_TypeDef;
+
+void lfrcoCalInit(const lfrcoCalInit_TypeDef *init);
+uint32_t lfrcoCalRun(int32_t temperature);
+void lfrcoCalInvalidate(void);
+void lfrcoCalStatsGet(lfrcoCalStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LFRCO_CAL_H
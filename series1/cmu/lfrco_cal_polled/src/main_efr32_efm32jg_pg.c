@@ -40,6 +40,8 @@
 #include "em_emu.h"
 #include "em_gpio.h"
 
+#include "lfrco_cal.h"
+
 #include "bsp.h"
 
 /*
@@ -124,172 +126,71 @@ void CRYOTIMER_IRQHandler(void)
   __DSB();
 }
 
+// Calibration statistics, for viewing in the debugger
+lfrcoCalStats_TypeDef calStats;
+
 /*
- * Before calling this function make sure that HFXO and LFRCO are
- * already running.
- *
- * Calibration is an iterative process because the CMU hardware simply
- * returns a count.  It doesn't determine whether or not a specific
- * tuningVal is correct.  To keep things simple, this function implements
- * the search algorithm and not any of the setup that might differ from
- * system to system.
+ * Set the LFRCO tuning value, run the CMU up/down counters once and
+ * return the up count.  Before calling this function make sure that
+ * HFXO and LFRCO are already running.
  */
-void calLFRCO(uint32_t freq)
+static uint32_t measureLFRCO(uint32_t tuning)
 {
-  bool tuned, lastUpGT, lastUpLT;
+  CMU_OscillatorTuningSet(cmuOsc_LFRCO, tuning);
 
-  uint32_t idealCount, upCount, prevUp, tuningVal, prevTuning;
+  // Setup the calibration circuit
+  CMU_CalibrateConfig(DOWNCOUNT, cmuOsc_HFXO, cmuOsc_LFRCO);
 
-  // Get current tuningVal value
-  tuningVal = CMU_OscillatorTuningGet(cmuOsc_LFRCO);
+  // Start the up counter
+  CMU_CalibrateStart();
 
-  /*
-   * Determine the ideal up counter value based on the desired
-   * frequency.  Note that this is done to maintain accuracy throughout
-   * the calculation.
-   *
-   * In most applications, it is probably better to calculate the ideal
-   * up counter value(s) in advance.  For example, the ideal counter
-   * value at the default LFRCO frequency is (when calibrating against
-   * the HFXO and using the maximum down counter value of 0xFFFFF):
-   *
-   * 32768 x 1048576
-   * --------------- = 895 (rounded up from 894.8)
-   *    38400000
-   */
-  idealCount = (uint32_t)(((float)SystemLFRCOClockGet() / (float)SystemHFXOClockGet()) * (float)(DOWNCOUNT + 1));
+  // Wait for down counter to finish
+  while ((CMU->STATUS & CMU_STATUS_CALRDY) == 0);
 
-  /*
-   * Haven't run a calibration cycle yet so not tuned, and the last up
-   * count greater than and less than flags are ALSO false.
-   */
-  tuned = false;
-  lastUpGT = false;
-  lastUpLT = false;
+  // Get the up counter value
+  return CMU_CalibrateCountGet();
+}
 
-  while (!tuned)
-  {
-    // Setup the calibration circuit
-    CMU_CalibrateConfig(DOWNCOUNT, cmuOsc_HFXO, cmuOsc_LFRCO);
-
-    // Start the up counter
-    CMU_CalibrateStart();
-
-    // Wait for down counter to finish
-    while ((CMU->STATUS & CMU_STATUS_CALRDY) == 0);
-
-    // Get the up counter value
-    upCount = CMU_CalibrateCountGet();
-
-    /*
-     * If the up counter result is less than the tuned value, the LFRCO
-     * is running at a higher frequency, so the tuning value has to be
-     * incremented.
-     */
-    if (upCount < idealCount)
-    {
-      // Was the up counter greater than the tuned value on the last run?
-      if (lastUpGT)
-      {
-        /*
-         * If the difference between the ideal count and the up count
-         * from this run is greater than it was on the last run, then
-         * the last run produced a more accurate tuning, so revert to
-         * the previous tuning value.  If not, the current value gets
-         * the most accurate tuning.
-         */
-        if ((idealCount - upCount) > (prevUp - idealCount))
-          tuningVal = prevTuning;
-
-        // done tuning
-        tuned = true;
-      }
-      // Up counter for the last run not greater than the tuned value
-      else
-      {
-        /*
-         * If the difference is 1, decrementing the tuning value again
-         * will only increase the frequency further away from the
-         * intended target, so tuning is now complete.
-         */
-        if ((idealCount - upCount) == 1)
-          tuned = true;
-        /*
-         * The difference between the ideal count for the desired
-         * frequency and the result from this run is > 1, so decrease
-         * the tuning value to increase the LFRCO frequency.  Next
-         * time, the up counter value will increase.  Save the tuning
-         * value from this run; if close, it might be more accurate
-         * than the result of the next run.
-         */
-        else
-        {
-          prevTuning = tuningVal;
-          tuningVal--;
-          lastUpLT = true;  // Remember that the up counter was less than the ideal this run
-          prevUp = upCount;
-        }
-      }
-    }
-
-    /*
-     * If the up counter result is greater than the tuned value, the
-     * LFRCO is running at a lower frequency, so the tuning value has
-     * to be decremented.
-     */
-    if (upCount > idealCount)
-    {
-      // Was the up counter less than the tuned value on the last run?
-      if (lastUpLT)
-      {
-        /*
-         * If the difference between the up count and the ideal count
-         * from this run is greater than it was on the last run, then
-         * the last run produced a more accurate tuning, so revert to
-         * the previous tuning value.  If not, the current value gets
-         * the most accurate tuning.
-         */
-        if ((upCount - idealCount) > (idealCount - prevUp))
-          tuningVal = prevTuning;
-
-        // Done tuning
-        tuned = true;
-      }
-      // Up counter for the last run not less than the tuned value
-      else
-      {
-        /*
-         * If the difference is 1, incrementing the tuning value again
-         * will only decrease the frequency further away from the
-         * intended target, so tuning is now complete.
-         */
-        if ((upCount - idealCount) == 1)
-          tuned = true;
-        /*
-         * The difference between the ideal count for the desired
-         * frequency and the result from this run is > 1, so increase
-         * the tuning value to decrease the LFRCO frequency.  Next
-         * time, the up counter value will decrease.  Save the tuning
-         * value from this run; if close, it might be more accurate
-         * than the result of the next run.
-         */
-        else
-        {
-          prevTuning = tuningVal;
-          tuningVal++;
-          lastUpGT = true;  // Remember that the up counter was less than the ideal this run
-          prevUp = upCount;
-        }
-      }
-    }
-
-    // Up counter result is equal to the desired value, end of calibration
-    if (upCount == idealCount)
-      tuned = true;
-    // Otherwise set new tuning value
-    else
-      CMU_OscillatorTuningSet(cmuOsc_LFRCO, tuningVal);
-  }
+static void applyLFRCO(uint32_t tuning)
+{
+  CMU_OscillatorTuningSet(cmuOsc_LFRCO, tuning);
+}
+
+/*
+ * Setup the calibration engine in lfrco_cal.c for the desired LFRCO
+ * frequency.  The ideal up counter value is calculated once here
+ * instead of on every calibration.
+ */
+void startCalibration(uint32_t freq)
+{
+  lfrcoCalInit_TypeDef calInit;
+  uint32_t hfxoFreq = SystemHFXOClockGet();
+
+  calInit.idealCount = (uint32_t)(((uint64_t)freq * (DOWNCOUNT + 1)
+                                   + hfxoFreq / 2) / hfxoFreq);
+  calInit.tuningMax = _CMU_LFRCOCTRL_TUNING_MASK >> _CMU_LFRCOCTRL_TUNING_SHIFT;
+  calInit.measure = measureLFRCO;
+  calInit.apply = applyLFRCO;
+  lfrcoCalInit(&calInit);
+}
+
+/*
+ * Calibration is an iterative process because the CMU hardware simply
+ * returns a count.  It doesn't determine whether or not a specific
+ * tuning value is correct.  The engine in lfrco_cal.c binary searches
+ * the tuning value and remembers the best value for each temperature
+ * band, so most wakes need no counter run or only one.
+ */
+void calLFRCO(void)
+{
+  int32_t temperature = 25;
+
+#if defined(_EMU_TEMP_TEMP_MASK)
+  temperature = (int32_t)EMU_TemperatureGet();
+#endif
+
+  lfrcoCalRun(temperature);
+  lfrcoCalStatsGet(&calStats);
 }
 
 int main(void)
@@ -318,6 +219,9 @@ int main(void)
   CMU->CTRL |= CMU_CTRL_CLKOUTSEL0_LFRCOQ;
   CMU->ROUTEPEN = CMU_ROUTEPEN_CLKOUT0PEN;
 
+  // Calibrate the LFRCO to 32768 Hz
+  startCalibration(32768);
+
   // Start the 16-second CRYOTIMER interrupts
   startCryo();
 
@@ -327,6 +231,6 @@ int main(void)
     EMU_EnterEM2(true);
 
     // Run calibration
-    calLFRCO(32768);
+    calLFRCO();
   }
 }
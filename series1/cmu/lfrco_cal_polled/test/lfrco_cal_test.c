@@ -0,0 +1,273 @@
+/***************************************************************************//**
+ * @file lfrco_cal_test.c
+ * @brief Host test of lfrco_cal.c against a simulated LFRCO with tuning and
+ * temperature dependence
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Isrc test/lfrco_cal_test.c src/lfrco_cal.c -lm
+//       -o lfrco_cal_test
+//   ./lfrco_cal_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "lfrco_cal.h"
+#include <math.h>
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+// 9-bit tuning field, and the up count of the main_*.c examples
+#define TUNING_MAX      (511)
+#define IDEAL_COUNT     (895)
+#define WAKES           (20000)
+
+static int checks;
+static int failures;
+
+// Simulated oscillator: temperature, up count noise of +-1 if set, the tuning
+// value last set and the number of counter runs
+static double temperature;
+static bool noisy;
+static uint32_t idealCount;
+static uint32_t hwTuning;
+static uint32_t runs;
+static bool outOfRange;
+
+static uint32_t seed = 1;
+
+/***************************************************************************//**
+ * @brief Small LCG, so that the test does not depend on the C library rand()
+ ******************************************************************************/
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+/***************************************************************************//**
+ * @brief Up count of the simulated LFRCO, falling with the tuning value and
+ * slightly with the temperature
+ ******************************************************************************/
+static uint32_t modelCount(uint32_t tuning, bool withNoise)
+{
+  double x = tuning / (double)TUNING_MAX;
+  double f = (1.40 - 0.75 * x + 0.08 * x * x)
+             * (1.0 - 0.00025 * (temperature - 25.0));
+  double count = IDEAL_COUNT * f;
+
+  if (withNoise) {
+    count += (double)(random32() % 3) - 1.0;
+  }
+  return (uint32_t)floor(count + 0.5);
+}
+
+/***************************************************************************//**
+ * @brief Measure callback: set the tuning and do one counter run
+ ******************************************************************************/
+static uint32_t measure(uint32_t tuning)
+{
+  if (tuning > TUNING_MAX) {
+    outOfRange = true;
+    tuning = TUNING_MAX;
+  }
+  hwTuning = tuning;
+  runs++;
+  return modelCount(tuning, noisy);
+}
+
+/***************************************************************************//**
+ * @brief Apply callback: set the tuning without a counter run
+ ******************************************************************************/
+static void apply(uint32_t tuning)
+{
+  hwTuning = tuning;
+}
+
+/***************************************************************************//**
+ * @brief Noise free distance of the up count from the ideal count
+ ******************************************************************************/
+static uint32_t errorAt(uint32_t tuning)
+{
+  uint32_t count = modelCount(tuning, false);
+
+  return (count > idealCount) ? count - idealCount : idealCount - count;
+}
+
+/***************************************************************************//**
+ * @brief Smallest error of any tuning value at the current temperature
+ ******************************************************************************/
+static uint32_t optimalError(void)
+{
+  uint32_t best = UINT32_MAX;
+
+  for (uint32_t t = 0; t <= TUNING_MAX; t++) {
+    if (errorAt(t) < best) {
+      best = errorAt(t);
+    }
+  }
+  return best;
+}
+
+/***************************************************************************//**
+ * @brief Initialize the engine for an ideal count
+ ******************************************************************************/
+static void calInit(uint32_t ideal)
+{
+  lfrcoCalInit_TypeDef init = { ideal, TUNING_MAX, measure, apply };
+
+  idealCount = ideal;
+  lfrcoCalInit(&init);
+  runs = 0;
+}
+
+/***************************************************************************//**
+ * @brief A cold calibration is a binary search that finds the best tuning
+ * value in at most log2 of the range plus one runs
+ ******************************************************************************/
+static void testCold(void)
+{
+  uint32_t tuning;
+
+  noisy = false;
+  for (int t = -40; t <= 125; t += 5) {
+    temperature = t;
+    calInit(IDEAL_COUNT);
+    tuning = lfrcoCalRun(t);
+    CHECK(runs <= 10);
+    CHECK(errorAt(tuning) == optimalError());
+    CHECK(hwTuning == tuning);
+  }
+
+  // Targets outside the range clamp to its ends
+  temperature = 25;
+  calInit(2000);
+  CHECK(lfrcoCalRun(25) == 0);
+  calInit(400);
+  CHECK(lfrcoCalRun(25) == TUNING_MAX);
+}
+
+/***************************************************************************//**
+ * @brief Cache hits, rechecks and invalidation
+ ******************************************************************************/
+static void testCache(void)
+{
+  lfrcoCalStats_TypeDef stats;
+  uint32_t tuning;
+
+  noisy = false;
+  temperature = 25;
+  calInit(IDEAL_COUNT);
+  tuning = lfrcoCalRun(25);
+
+  // The same band reuses the tuning without a run until the recheck
+  runs = 0;
+  for (int i = 0; i < LFRCO_CAL_RECHECK_WAKES; i++) {
+    CHECK(lfrcoCalRun(26) == tuning);
+  }
+  CHECK(runs == 0);
+  CHECK(lfrcoCalRun(25) == tuning);
+  CHECK(runs == 1);
+
+  // Going back to a cached band costs one verification run
+  temperature = 60;
+  lfrcoCalRun(60);
+  runs = 0;
+  temperature = 25;
+  CHECK(lfrcoCalRun(25) == tuning);
+  CHECK(runs == 1);
+  lfrcoCalStatsGet(&stats);
+  CHECK(stats.verifyHits == 2);
+  CHECK(stats.cacheHits == LFRCO_CAL_RECHECK_WAKES);
+  CHECK(stats.lastTuning == tuning);
+  CHECK(stats.lastError == errorAt(tuning));
+
+  // After lfrcoCalInvalidate() the next calibration searches again
+  lfrcoCalInvalidate();
+  runs = 0;
+  CHECK(lfrcoCalRun(25) == tuning);
+  CHECK(runs > 1);
+}
+
+/***************************************************************************//**
+ * @brief Slow temperature drift over many wakes, with and without noise: the
+ * tuning stays close to the optimum with less than 0.1 runs per wake
+ ******************************************************************************/
+static void testDrift(void)
+{
+  lfrcoCalStats_TypeDef stats;
+  uint32_t tuning;
+  uint32_t optimal;
+
+  for (int n = 0; n < 2; n++) {
+    noisy = (n == 1);
+    seed = 1;
+    temperature = 25;
+    calInit(IDEAL_COUNT);
+
+    for (int w = 0; w < WAKES; w++) {
+      temperature += (double)((int)(random32() % 201) - 100) / 400.0
+                     + 0.3 * sin(w / 800.0);
+      temperature = fmax(-30.0, fmin(90.0, temperature));
+      tuning = lfrcoCalRun((int32_t)floor(temperature));
+      optimal = optimalError();
+      CHECK(errorAt(tuning) <= optimal + (noisy ? 4 : 2));
+      CHECK(hwTuning == tuning);
+    }
+
+    lfrcoCalStatsGet(&stats);
+    CHECK(stats.calibrations == WAKES);
+    CHECK(stats.counterRuns == runs);
+    CHECK(runs < WAKES / 10);
+  }
+  CHECK(!outOfRange);
+}
+
+int main(void)
+{
+  testCold();
+  testCache();
+  testDrift();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,270 @@
+/***************************************************************************//**
+ * @file boot_seq.c
+ * @brief Boot sequencer that runs initialization steps in dependency order
+ * and overlaps them with oscillator startup
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "boot_seq.h"
+#include <stddef.h>
+
+// A step is started once all steps in its after mask are done. A step with
+// a ready() function, such as an oscillator startup, keeps going in the
+// background after start() returns, and the sequencer starts other steps
+// until something needs it. Steps that such background steps depend on, and
+// the background steps themselves, are started before any other step, so
+// that the slow startups begin as early as possible. Otherwise steps are
+// started in table order.
+
+static bootSeqInit_TypeDef config;
+static uint32_t after[BOOT_SEQ_MAX_STEPS];
+static uint32_t allSteps;
+static uint32_t started;
+static uint32_t urgent;                 // Steps to start before all others
+static bootSeqProfile_TypeDef profile;
+
+// Index of the lowest set bit, x must not be 0
+static inline uint32_t lowestBit(uint32_t x)
+{
+  return __CLZ(__RBIT(x));
+}
+
+/***************************************************************************//**
+ * @brief Add all steps that the given steps depend on, directly or through
+ * other steps
+ ******************************************************************************/
+static uint32_t closure(uint32_t steps)
+{
+  uint32_t prev;
+  uint32_t rest;
+  uint32_t i;
+
+  do {
+    prev = steps;
+    for (rest = steps; rest != 0; rest &= rest - 1) {
+      i = lowestBit(rest);
+      steps |= after[i];
+    }
+  } while (steps != prev);
+
+  return steps;
+}
+
+/***************************************************************************//**
+ * @brief Steps that are not started and whose dependencies are done
+ ******************************************************************************/
+static uint32_t runnableGet(uint32_t allowed)
+{
+  uint32_t runnable = 0;
+  uint32_t rest;
+  uint32_t i;
+
+  for (rest = allowed & ~started; rest != 0; rest &= rest - 1) {
+    i = lowestBit(rest);
+    if ((after[i] & ~profile.done) == 0) {
+      runnable |= BOOT_SEQ_STEP(i);
+    }
+  }
+  return runnable;
+}
+
+/***************************************************************************//**
+ * @brief Check the started steps for completion and start one step
+ *
+ * @param allowed Steps that may be started.
+ * @return true if a step was started or has completed.
+ ******************************************************************************/
+static bool advance(uint32_t allowed)
+{
+  bool progress = false;
+  uint32_t pending = started & ~profile.done & ~profile.failed;
+  uint32_t runnable;
+  uint32_t rest;
+  uint32_t i;
+
+  for (rest = pending; rest != 0; rest &= rest - 1) {
+    i = lowestBit(rest);
+    if (config.steps[i].ready()) {
+      profile.time[i].done = config.now();
+      profile.done |= BOOT_SEQ_STEP(i);
+      progress = true;
+    } else if (config.timeout != 0
+               && config.now() - profile.time[i].start > config.timeout) {
+      profile.failed |= BOOT_SEQ_STEP(i);
+    }
+  }
+
+  // In serial mode, nothing starts while a step is pending
+  if (config.serial && (started & ~profile.done) != 0) {
+    return progress;
+  }
+
+  runnable = runnableGet(allowed);
+  if (runnable == 0) {
+    return progress;
+  }
+  i = lowestBit((runnable & urgent) != 0 ? runnable & urgent : runnable);
+
+  started |= BOOT_SEQ_STEP(i);
+  profile.time[i].start = config.now();
+  config.steps[i].start();
+  if (config.steps[i].ready == NULL) {
+    profile.time[i].done = config.now();
+    profile.done |= BOOT_SEQ_STEP(i);
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief Initialize the sequencer with a table of steps
+ *
+ * @details No step is started. The table must stay valid until all steps are
+ * done. In serial mode, each step also depends on all steps before it in the
+ * table, so the table has to be in dependency order, and each step is waited
+ * for before the next is started. This gives the time of a conventional
+ * boot for comparison.
+ *
+ * @return 0, or BOOT_SEQ_ERR_DEPENDENCY if a step depends on itself, on a
+ * step that is not in the table, or on a step that depends on it.
+ ******************************************************************************/
+int bootSeqInit(const bootSeqInit_TypeDef *init)
+{
+  uint32_t background = 0;
+  uint32_t done;
+  uint32_t prev;
+  uint32_t i;
+
+  if (init->count == 0 || init->count > BOOT_SEQ_MAX_STEPS
+      || init->now == NULL) {
+    return BOOT_SEQ_ERR_DEPENDENCY;
+  }
+
+  config = *init;
+  allSteps = (init->count == 32) ? 0xFFFFFFFFUL
+             : BOOT_SEQ_STEP(init->count) - 1;
+  started = 0;
+  profile = (bootSeqProfile_TypeDef){ 0 };
+
+  for (i = 0; i < init->count; i++) {
+    after[i] = init->steps[i].after;
+    if (init->serial) {
+      after[i] |= BOOT_SEQ_STEP(i) - 1;
+    }
+    if ((after[i] & ~allSteps) != 0 || (after[i] & BOOT_SEQ_STEP(i)) != 0
+        || init->steps[i].start == NULL) {
+      return BOOT_SEQ_ERR_DEPENDENCY;
+    }
+    if (init->steps[i].ready != NULL) {
+      background |= BOOT_SEQ_STEP(i);
+    }
+  }
+
+  // Check that all steps can be done, which fails if there is a cycle
+  done = 0;
+  do {
+    prev = done;
+    for (i = 0; i < init->count; i++) {
+      if ((after[i] & ~done) == 0) {
+        done |= BOOT_SEQ_STEP(i);
+      }
+    }
+  } while (done != prev);
+  if (done != allSteps) {
+    return BOOT_SEQ_ERR_DEPENDENCY;
+  }
+
+  urgent = closure(background);
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Run steps until the given steps are done
+ *
+ * @details This is a join point: the given steps and the steps they depend
+ * on are run, and background steps and the steps they depend on are started
+ * as soon as they can be, but other steps are left for later, so that the caller can continue as early
+ * as possible. While only background steps are pending, this waits for them.
+ *
+ * @param steps Steps to wait for.
+ * @return 0, or BOOT_SEQ_ERR_TIMEOUT if one of the steps, or a step that it
+ * depends on, was not ready within the timeout.
+ ******************************************************************************/
+int bootSeqRun(uint32_t steps)
+{
+  uint32_t need = closure(steps & allSteps);
+  uint32_t allowed = need | urgent;
+  uint32_t waitStart;
+
+  while ((profile.done & need) != need) {
+    waitStart = config.now();
+    if (!advance(allowed)) {
+      if ((profile.failed & need) != 0) {
+        return BOOT_SEQ_ERR_TIMEOUT;
+      }
+      profile.waitTime += config.now() - waitStart;
+    }
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Complete and start as many steps as possible without waiting
+ *
+ * @details Call this from the main loop, e.g. after each wakeup, until
+ * bootSeqDoneGet() returns all steps.
+ *
+ * @return 0, or BOOT_SEQ_ERR_TIMEOUT if a step was not ready within the
+ * timeout. The steps that depend on it are never started.
+ ******************************************************************************/
+int bootSeqPoll(void)
+{
+  while (advance(allSteps)) {
+  }
+  return (profile.failed != 0) ? BOOT_SEQ_ERR_TIMEOUT : 0;
+}
+
+/***************************************************************************//**
+ * @brief Get the steps that are done
+ ******************************************************************************/
+uint32_t bootSeqDoneGet(void)
+{
+  return profile.done;
+}
+
+/***************************************************************************//**
+ * @brief Get the time stamps of the steps and the time spent waiting
+ ******************************************************************************/
+void bootSeqProfileGet(bootSeqProfile_TypeDef *result)
+{
+  *result = profile;
+}
@@ -0,0 +1,93 @@
+/***************************************************************************//**
+ * @file boot_seq.h
+ * @brief Boot sequencer that runs initialization steps in dependency order
+ * and overlaps them with oscillator startup
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef BOOT_SEQ_H
+#define BOOT_SEQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Steps are identified by their index in the step table, and dependencies
+// are masks of step bits
+#define BOOT_SEQ_MAX_STEPS              (32)
+#define BOOT_SEQ_STEP(n)                (1UL << (n))
+
+// The step table is invalid or has a dependency cycle
+#define BOOT_SEQ_ERR_DEPENDENCY         (-0x5800)
+// A step was not ready within the timeout
+#define BOOT_SEQ_ERR_TIMEOUT            (-0x5780)
+
+typedef struct {
+  void (*start)(void);                  // Starts, or does, the step
+  bool (*ready)(void);                  // NULL if done when start() returns
+  uint32_t after;                       // Steps that must be done first
+} bootSeqStep_TypeDef;
+
+typedef struct {
+  const bootSeqStep_TypeDef *steps;
+  uint32_t count;
+  uint32_t (*now)(void);                // Time stamp, in any unit
+  uint32_t timeout;                     // Longest time to ready, 0 for none
+  bool serial;                          // One step at a time, in table order
+} bootSeqInit_TypeDef;
+
+typedef struct {
+  uint32_t start;                       // now() when start() was called
+  uint32_t done;                        // now() when the step was seen done
+} bootSeqTime_TypeDef;
+
+typedef struct {
+  uint32_t done;                        // Steps that are done
+  uint32_t failed;                      // Steps that timed out
+  uint32_t waitTime;                    // Time spent with nothing to start
+  bootSeqTime_TypeDef time[BOOT_SEQ_MAX_STEPS];
+} bootSeqProfile_TypeDef;
+
+int bootSeqInit(const bootSeqInit_TypeDef *init);
+int bootSeqRun(uint32_t steps);
+int bootSeqPoll(void);
+uint32_t bootSeqDoneGet(void);
+void bootSeqProfileGet(bootSeqProfile_TypeDef *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_SEQ_H
@@ -0,0 +1,416 @@
+/***************************************************************************//**
+ * @file gg1x_main_parallel_boot.c
+ * @brief This project demonstrates a boot sequence that starts the LFXO and
+ * HFXO first and initializes the rest of the device while they start up,
+ * with a time stamp for each step.
+ *
+ * LED1 blinks from TIMER0, which runs from the HFXO, as soon as the main
+ * loop is entered.  LED0 blinks from the RTCC once the LFXO has started.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_cryotimer.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_rtcc.h"
+#include "em_timer.h"
+
+#include "bsp.h"
+#include "boot_seq.h"
+
+// Level that turns an LED on, the GG11/GG12 kit RGB LEDs are active low
+#define LED_ON      0
+
+/*
+ * Set to 1 to run the same steps one after the other, waiting for each
+ * oscillator where it is started, as a conventional boot would.
+ */
+#define SERIAL_BOOT 0
+
+// A crystal that has not started within this time (us) is taken as missing
+#define OSC_TIMEOUT_US    2000000
+
+// Flash checked by the image check step, from the start of the flash
+#define IMAGE_CHECK_BYTES 16384
+
+// LED1 toggle rate from TIMER0, and LED0 toggle period in RTCC ticks
+#define TIMER_TOGGLE_HZ   5
+#define RTCC_TOGGLE_TICKS 16384
+
+// Boot steps, in the order a serial boot would do them
+enum {
+  STEP_DCDC,
+  STEP_HFXO,
+  STEP_LFXO,
+  STEP_GPIO,
+  STEP_IMAGE,
+  STEP_HFCLK,
+  STEP_TIMER,
+  STEP_RTCC,
+  STEP_COUNT
+};
+
+// Steps that the main loop needs, the RTCC is finished from the main loop
+#define MAIN_LOOP_STEPS   (BOOT_SEQ_STEP(STEP_GPIO) | BOOT_SEQ_STEP(STEP_IMAGE) \
+                           | BOOT_SEQ_STEP(STEP_TIMER))
+#define ALL_STEPS         (BOOT_SEQ_STEP(STEP_COUNT) - 1)
+
+// Boot profile in us from the start of main(), for viewing in the debugger
+bootSeqProfile_TypeDef bootProfile;
+uint32_t mainLoopUs;
+uint32_t bootDoneUs;
+int bootStatus;
+
+// CRC-32 of the checked flash
+uint32_t imageCrc;
+
+// HFCLK cycles are counted with the DWT cycle counter.  Cortex-M0+ parts
+// such as the EFM32TG11 have no DWT, and use the 24-bit SysTick instead,
+// so there timeNow() must be called at least every 2^24 cycles.
+#if defined(DWT)
+#define CYCLE_MASK  0xFFFFFFFFUL
+#else
+#define CYCLE_MASK  SysTick_LOAD_RELOAD_Msk
+#endif
+
+static uint32_t lastCycles;
+static uint64_t cycleFraction;
+static uint64_t tickFraction;
+static uint32_t timeUs;
+
+/**************************************************************************//**
+ * @brief
+ *    HFCLK cycles counted since timeInit(), modulo CYCLE_MASK + 1.
+ *****************************************************************************/
+static uint32_t cycleCounterGet(void)
+{
+#if defined(DWT)
+  return DWT->CYCCNT;
+#else
+  // SysTick counts down
+  return (CYCLE_MASK - SysTick->VAL) & CYCLE_MASK;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Time in us since the start of main().
+ *
+ * @details
+ *    The cycle counter counts HFCLK cycles, and HFCLK changes during the
+ *    boot, so the cycles are converted at the clock they were counted at.
+ *    This is called just before HFCLK is switched to keep the time exact.
+ *    The cycles slept in EM1 are left out, and sleepEM1() adds the time
+ *    slept instead.
+ *****************************************************************************/
+static uint32_t timeNow(void)
+{
+  uint32_t cycles = cycleCounterGet();
+
+  cycleFraction += (uint64_t)((cycles - lastCycles) & CYCLE_MASK) * 1000000;
+  lastCycles = cycles;
+  timeUs += (uint32_t)(cycleFraction / SystemCoreClock);
+  cycleFraction %= SystemCoreClock;
+  return timeUs;
+}
+
+static void timeInit(void)
+{
+#if defined(DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#else
+  SysTick->LOAD = CYCLE_MASK;
+  SysTick->VAL = 0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+#endif
+  lastCycles = cycleCounterGet();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Count the time spent in EM1 with the CRYOTIMER.
+ *
+ * @details
+ *    The DWT cycle counter stops while the core sleeps, and SysTick does
+ *    not count reliably in EM1, so the CRYOTIMER counts LFRCO cycles across
+ *    each sleep.  The LFRCO is not waited for.
+ *    It normally runs before the HFXO is ready and the main loop first
+ *    sleeps.  A sleep before that is undercounted by the rest of its
+ *    start-up time.
+ *****************************************************************************/
+static void sleepTimeInit(void)
+{
+  CRYOTIMER_Init_TypeDef cryoInit = CRYOTIMER_INIT_DEFAULT;
+
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, false);
+  CMU_ClockEnable(cmuClock_CRYOTIMER, true);
+
+  cryoInit.osc = cryotimerOscLFRCO;
+  cryoInit.presc = cryotimerPresc_1;
+  cryoInit.enable = true;
+  CRYOTIMER_Init(&cryoInit);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Sleep in EM1 and add the time slept to the time in us.
+ *
+ * @details
+ *    Called with interrupts disabled, so that the CRYOTIMER is read right
+ *    before and after the sleep.  Each sleep is counted in whole LFRCO
+ *    cycles of about 30 us.  The cycle counter is read before the sleep and
+ *    counted again from after it, so that cycles it counts in EM1, if any,
+ *    are not counted twice.
+ *****************************************************************************/
+static void sleepEM1(void)
+{
+  uint32_t ticks = CRYOTIMER_CounterGet();
+
+  timeNow();
+  EMU_EnterEM1();
+  lastCycles = cycleCounterGet();
+  tickFraction += (uint64_t)(CRYOTIMER_CounterGet() - ticks) * 1000000;
+  timeUs += (uint32_t)(tickFraction / SystemLFRCOClockGet());
+  tickFraction %= SystemLFRCOClockGet();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Boot steps.  The oscillator steps only start the oscillator, and the
+ *    sequencer polls their ready functions.
+ *****************************************************************************/
+static void dcdcInit(void)
+{
+  // Initialize DCDC with kit specific parameters
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+}
+
+static void hfxoStart(void)
+{
+  CMU_HFXOInit_TypeDef hfxoInit = CMU_HFXOINIT_DEFAULT;
+  CMU_HFXOInit(&hfxoInit);
+  CMU_OscillatorEnable(cmuOsc_HFXO, true, false);
+}
+
+static bool hfxoReady(void)
+{
+  return (CMU->STATUS & CMU_STATUS_HFXORDY) != 0;
+}
+
+static void lfxoStart(void)
+{
+  CMU_LFXOInit_TypeDef lfxoInit = CMU_LFXOINIT_DEFAULT;
+  CMU_LFXOInit(&lfxoInit);
+  CMU_OscillatorEnable(cmuOsc_LFXO, true, false);
+
+  // Wake the main loop when the LFXO is ready
+  CMU_IntClear(CMU_IF_LFXORDY);
+  CMU_IntEnable(CMU_IEN_LFXORDY);
+  NVIC_ClearPendingIRQ(CMU_IRQn);
+  NVIC_EnableIRQ(CMU_IRQn);
+}
+
+static bool lfxoReady(void)
+{
+  return (CMU->STATUS & CMU_STATUS_LFXORDY) != 0;
+}
+
+static void gpioInit(void)
+{
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, !LED_ON);
+  GPIO_PinModeSet(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN, gpioModePushPull, !LED_ON);
+}
+
+// Stands in for an application integrity check, which needs no clocks
+static void imageCheck(void)
+{
+  const uint8_t *p = (const uint8_t *)FLASH_BASE;
+  uint32_t crc = 0xFFFFFFFF;
+  uint32_t i;
+  int bit;
+
+  for (i = 0; i < IMAGE_CHECK_BYTES; i++)
+  {
+    crc ^= p[i];
+    for (bit = 0; bit < 8; bit++)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  imageCrc = ~crc;
+}
+
+static void hfclkSelect(void)
+{
+  timeNow();
+  CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFXO);
+}
+
+// TIMER0 overflows TIMER_TOGGLE_HZ times per second at the HFXO frequency
+static void timerInit(void)
+{
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+  timerInit.enable = false;
+  timerInit.prescale = timerPrescale1024;
+  TIMER_Init(TIMER0, &timerInit);
+  TIMER_TopSet(TIMER0, CMU_ClockFreqGet(cmuClock_TIMER0) / 1024 / TIMER_TOGGLE_HZ - 1);
+
+  TIMER_IntClear(TIMER0, TIMER_IF_OF);
+  TIMER_IntEnable(TIMER0, TIMER_IEN_OF);
+  NVIC_ClearPendingIRQ(TIMER0_IRQn);
+  NVIC_EnableIRQ(TIMER0_IRQn);
+  TIMER_Enable(TIMER0, true);
+}
+
+// The LFXO is ready, so selecting it does not wait
+static void rtccInit(void)
+{
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_LFXO);
+  CMU_ClockEnable(cmuClock_RTCC, true);
+
+  RTCC_Init_TypeDef rtcc = RTCC_INIT_DEFAULT;
+  rtcc.enable   = false;
+  rtcc.presc    = rtccCntPresc_1;
+  RTCC_Init(&rtcc);
+
+  RTCC_CCChConf_TypeDef compCfg = RTCC_CH_INIT_COMPARE_DEFAULT;
+  RTCC_ChannelInit(1, &compCfg);
+  RTCC_ChannelCCVSet(1, RTCC_TOGGLE_TICKS);
+
+  RTCC_IntClear(_RTCC_IF_MASK);
+  RTCC_IntEnable(RTCC_IEN_CC1);
+  NVIC_ClearPendingIRQ(RTCC_IRQn);
+  NVIC_EnableIRQ(RTCC_IRQn);
+
+  RTCC_Enable(true);
+}
+
+static const bootSeqStep_TypeDef bootSteps[STEP_COUNT] = {
+  [STEP_DCDC]  = { dcdcInit, NULL, 0 },
+  // The crystals start once the supply is set up
+  [STEP_HFXO]  = { hfxoStart, hfxoReady, BOOT_SEQ_STEP(STEP_DCDC) },
+  [STEP_LFXO]  = { lfxoStart, lfxoReady, BOOT_SEQ_STEP(STEP_DCDC) },
+  [STEP_GPIO]  = { gpioInit, NULL, 0 },
+  [STEP_IMAGE] = { imageCheck, NULL, 0 },
+  [STEP_HFCLK] = { hfclkSelect, NULL, BOOT_SEQ_STEP(STEP_HFXO) },
+  [STEP_TIMER] = { timerInit, NULL, BOOT_SEQ_STEP(STEP_HFCLK) | BOOT_SEQ_STEP(STEP_GPIO) },
+  [STEP_RTCC]  = { rtccInit, NULL, BOOT_SEQ_STEP(STEP_LFXO) | BOOT_SEQ_STEP(STEP_GPIO) },
+};
+
+/**************************************************************************//**
+ * @brief
+ *    Interrupt handlers.
+ *****************************************************************************/
+void CMU_IRQHandler(void)
+{
+  // The main loop finishes the RTCC step after wake-up
+  CMU_IntDisable(CMU_IEN_LFXORDY);
+  CMU_IntClear(CMU_IF_LFXORDY);
+}
+
+void TIMER0_IRQHandler(void)
+{
+  TIMER_IntClear(TIMER0, TIMER_IF_OF);
+  GPIO_PinOutToggle(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN);
+}
+
+void RTCC_IRQHandler(void)
+{
+  RTCC_IntClear(RTCC_IF_CC1);
+  RTCC_ChannelCCVSet(1, RTCC_ChannelCCVGet(1) + RTCC_TOGGLE_TICKS);
+  GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Main function
+ *****************************************************************************/
+int main(void)
+{
+  bootSeqInit_TypeDef bootInit = {
+    .steps = bootSteps,
+    .count = STEP_COUNT,
+    .now = timeNow,
+    .timeout = OSC_TIMEOUT_US,
+    .serial = SERIAL_BOOT,
+  };
+  bool booting = true;
+  CORE_DECLARE_IRQ_STATE;
+
+  timeInit();
+  CHIP_Init();
+  sleepTimeInit();
+
+  bootStatus = bootSeqInit(&bootInit);
+  if (bootStatus == 0)
+    bootStatus = bootSeqRun(SERIAL_BOOT ? ALL_STEPS : MAIN_LOOP_STEPS);
+
+  // Without the HFXO, stop here and leave the profile to be inspected
+  if (bootStatus != 0)
+  {
+    bootSeqProfileGet(&bootProfile);
+    while (1);
+  }
+
+  mainLoopUs = timeNow();
+  bootSeqProfileGet(&bootProfile);
+
+  while (1)
+  {
+    // Finish the boot steps that were left for later
+    if (booting)
+    {
+      bootStatus = bootSeqPoll();
+      if (bootSeqDoneGet() == ALL_STEPS || bootStatus != 0)
+      {
+        booting = false;
+        bootDoneUs = timeNow();
+        bootSeqProfileGet(&bootProfile);
+      }
+    }
+
+    // Do not sleep if the LFXO became ready after it was polled
+    CORE_ENTER_CRITICAL();
+    if (!booting || !lfxoReady())
+      sleepEM1();
+    CORE_EXIT_CRITICAL();
+  }
+}
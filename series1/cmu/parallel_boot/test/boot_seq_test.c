@@ -0,0 +1,428 @@
+/***************************************************************************//**
+ * @file boot_seq_test.c
+ * @brief Host test of boot_seq.c: random dependency tables, table checks, the
+ * example boot of main and oscillator timeouts
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/boot_seq_test.c src/boot_seq.c
+//       -o boot_seq_test
+//   ./boot_seq_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "boot_seq.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define STEPS           (12)
+#define NOT_DONE        (0xFFFFFFFFUL)
+
+static int checks;
+static int failures;
+
+// Simulated time, advanced by one on every now() call and by the duration
+// of each step that runs to completion in start()
+static uint32_t simTime;
+
+// Step setup: dependencies, duration, and whether the step keeps going after
+// start() returns and has a ready() function
+static uint32_t stepAfter[STEPS];
+static uint32_t stepDuration[STEPS];
+static bool stepAsync[STEPS];
+
+// Step results: start() calls, and the time at which the step is done
+static int startCount[STEPS];
+static uint32_t doneTime[STEPS];
+static bool startedTooEarly;
+
+static bootSeqStep_TypeDef steps[STEPS];
+
+static uint32_t seed = 91;
+
+/***************************************************************************//**
+ * @brief Small LCG, so that the test does not depend on the C library rand()
+ ******************************************************************************/
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+static uint32_t simNow(void)
+{
+  return simTime++;
+}
+
+/***************************************************************************//**
+ * @brief Start a step, checking that the steps it depends on are done
+ ******************************************************************************/
+static void stepStart(int i)
+{
+  startCount[i]++;
+  for (int j = 0; j < STEPS; j++) {
+    if ((stepAfter[i] & BOOT_SEQ_STEP(j))
+        && (startCount[j] != 1 || doneTime[j] > simTime)) {
+      startedTooEarly = true;
+    }
+  }
+  if (stepAsync[i]) {
+    doneTime[i] = simTime + stepDuration[i];
+  } else {
+    simTime += stepDuration[i];
+    doneTime[i] = simTime;
+  }
+}
+
+static bool stepReady(int i)
+{
+  return simTime >= doneTime[i];
+}
+
+#define STEP_FUNCTIONS(n)                                      \
+  static void start##n(void) { stepStart(n); }                 \
+  static bool ready##n(void) { return stepReady(n); }
+
+STEP_FUNCTIONS(0)
+STEP_FUNCTIONS(1)
+STEP_FUNCTIONS(2)
+STEP_FUNCTIONS(3)
+STEP_FUNCTIONS(4)
+STEP_FUNCTIONS(5)
+STEP_FUNCTIONS(6)
+STEP_FUNCTIONS(7)
+STEP_FUNCTIONS(8)
+STEP_FUNCTIONS(9)
+STEP_FUNCTIONS(10)
+STEP_FUNCTIONS(11)
+
+static void (*const startFn[STEPS])(void) = {
+  start0, start1, start2, start3, start4, start5,
+  start6, start7, start8, start9, start10, start11
+};
+
+static bool (*const readyFn[STEPS])(void) = {
+  ready0, ready1, ready2, ready3, ready4, ready5,
+  ready6, ready7, ready8, ready9, ready10, ready11
+};
+
+/***************************************************************************//**
+ * @brief Fill the step table from the step setup and reset the results
+ ******************************************************************************/
+static void tableBuild(int count)
+{
+  for (int i = 0; i < count; i++) {
+    steps[i].start = startFn[i];
+    steps[i].ready = stepAsync[i] ? readyFn[i] : NULL;
+    steps[i].after = stepAfter[i];
+  }
+  simTime = 1;
+  memset(startCount, 0, sizeof(startCount));
+  for (int i = 0; i < STEPS; i++) {
+    doneTime[i] = NOT_DONE;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Steps in mask and all the steps they depend on
+ ******************************************************************************/
+static uint32_t closure(uint32_t mask, int count)
+{
+  uint32_t prev;
+
+  do {
+    prev = mask;
+    for (int i = 0; i < count; i++) {
+      if (mask & BOOT_SEQ_STEP(i)) {
+        mask |= stepAfter[i];
+      }
+    }
+  } while (mask != prev);
+  return mask;
+}
+
+/***************************************************************************//**
+ * @brief Random dependency tables: bootSeqRun() finishes the steps asked for
+ * and starts no unrelated step that runs to completion, bootSeqPoll() then
+ * finishes the rest, and each step is started once after its dependencies
+ ******************************************************************************/
+static void testRandomTables(void)
+{
+  bootSeqInit_TypeDef init;
+  bootSeqProfile_TypeDef profile;
+  int order[STEPS];
+  uint32_t all;
+  uint32_t run;
+  uint32_t async;
+  int count;
+  int err;
+  int polls;
+  int tmp;
+  bool inOrder;
+
+  for (int it = 0; it < 3000; it++) {
+    // Dependencies only on steps earlier in a random order, so no cycles
+    count = 1 + (int)(random32() % STEPS);
+    for (int i = 0; i < count; i++) {
+      order[i] = i;
+    }
+    for (int i = count - 1; i > 0; i--) {
+      int j = (int)(random32() % (uint32_t)(i + 1));
+
+      tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+    async = 0;
+    for (int k = 0; k < count; k++) {
+      int i = order[k];
+
+      stepAfter[i] = 0;
+      for (int m = 0; m < k; m++) {
+        if (random32() % 4 == 0) {
+          stepAfter[i] |= BOOT_SEQ_STEP(order[m]);
+        }
+      }
+      stepAsync[i] = (random32() % 3 == 0);
+      stepDuration[i] = 1 + random32() % (stepAsync[i] ? 500 : 50);
+      if (stepAsync[i]) {
+        async |= BOOT_SEQ_STEP(i);
+      }
+    }
+    tableBuild(count);
+    startedTooEarly = false;
+
+    // A serial boot needs the table in dependency order
+    init = (bootSeqInit_TypeDef){ steps, (uint32_t)count, simNow, 0,
+                                  (it & 1) != 0 };
+    inOrder = true;
+    for (int i = 0; i < count; i++) {
+      if (stepAfter[i] >> i) {
+        inOrder = false;
+      }
+    }
+    err = bootSeqInit(&init);
+    if (init.serial && !inOrder) {
+      CHECK(err == BOOT_SEQ_ERR_DEPENDENCY);
+      continue;
+    }
+    CHECK(err == 0);
+
+    all = BOOT_SEQ_STEP(count) - 1;
+    run = closure(random32() & all, count);
+    CHECK(bootSeqRun(run) == 0);
+    CHECK((bootSeqDoneGet() & run) == run);
+
+    // Steps with a ready() function and their dependencies start early
+    if (!init.serial) {
+      for (int i = 0; i < count; i++) {
+        if (startCount[i] != 0) {
+          CHECK((run | closure(async, count)) & BOOT_SEQ_STEP(i));
+        }
+      }
+    }
+
+    polls = 0;
+    while (bootSeqDoneGet() != all && polls++ < 100000) {
+      CHECK(bootSeqPoll() == 0);
+      simTime += 3;
+    }
+    CHECK(bootSeqDoneGet() == all);
+    CHECK(!startedTooEarly);
+
+    bootSeqProfileGet(&profile);
+    for (int i = 0; i < count; i++) {
+      CHECK(startCount[i] == 1);
+      CHECK(profile.time[i].done >= profile.time[i].start);
+      CHECK(profile.time[i].done >= doneTime[i]);
+      if (init.serial && i > 0) {
+        CHECK(profile.time[i].start >= profile.time[i - 1].done);
+      }
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Tables with cycles or dependencies on missing steps are refused
+ ******************************************************************************/
+static void testInvalidTables(void)
+{
+  bootSeqInit_TypeDef init = { steps, 3, simNow, 0, false };
+
+  for (int i = 0; i < 3; i++) {
+    stepAsync[i] = false;
+    stepDuration[i] = 1;
+  }
+
+  // Step 0 after itself, steps 0 and 1 after each other, step 2 after a
+  // step that does not exist
+  stepAfter[0] = BOOT_SEQ_STEP(0);
+  stepAfter[1] = 0;
+  stepAfter[2] = 0;
+  tableBuild(3);
+  CHECK(bootSeqInit(&init) == BOOT_SEQ_ERR_DEPENDENCY);
+  stepAfter[0] = BOOT_SEQ_STEP(1);
+  stepAfter[1] = BOOT_SEQ_STEP(0);
+  tableBuild(3);
+  CHECK(bootSeqInit(&init) == BOOT_SEQ_ERR_DEPENDENCY);
+  stepAfter[0] = 0;
+  stepAfter[1] = 0;
+  stepAfter[2] = BOOT_SEQ_STEP(3);
+  tableBuild(3);
+  CHECK(bootSeqInit(&init) == BOOT_SEQ_ERR_DEPENDENCY);
+
+  // Step 0 after step 1 is fine in parallel, but not in table order
+  stepAfter[0] = BOOT_SEQ_STEP(1);
+  stepAfter[2] = 0;
+  tableBuild(3);
+  CHECK(bootSeqInit(&init) == 0);
+  init.serial = true;
+  CHECK(bootSeqInit(&init) == BOOT_SEQ_ERR_DEPENDENCY);
+}
+
+// The boot of main, with durations in us
+enum {
+  STEP_DCDC,
+  STEP_HFXO,
+  STEP_LFXO,
+  STEP_GPIO,
+  STEP_IMAGE,
+  STEP_HFCLK,
+  STEP_TIMER,
+  STEP_RTCC,
+  STEP_COUNT
+};
+
+#define MAIN_LOOP_STEPS   (BOOT_SEQ_STEP(STEP_GPIO) | BOOT_SEQ_STEP(STEP_IMAGE) \
+                           | BOOT_SEQ_STEP(STEP_TIMER))
+#define ALL_STEPS         (BOOT_SEQ_STEP(STEP_COUNT) - 1)
+#define OSC_TIMEOUT_US    (2000000)
+
+static void exampleBuild(void)
+{
+  static const uint32_t duration[STEP_COUNT] = {
+    50, 600, 300000, 20, 30000, 100, 40, 60
+  };
+
+  memset(stepAfter, 0, sizeof(stepAfter));
+  memset(stepAsync, 0, sizeof(stepAsync));
+  memcpy(stepDuration, duration, sizeof(duration));
+  stepAfter[STEP_HFXO] = BOOT_SEQ_STEP(STEP_DCDC);
+  stepAfter[STEP_LFXO] = BOOT_SEQ_STEP(STEP_DCDC);
+  stepAfter[STEP_HFCLK] = BOOT_SEQ_STEP(STEP_HFXO);
+  stepAfter[STEP_TIMER] = BOOT_SEQ_STEP(STEP_HFCLK) | BOOT_SEQ_STEP(STEP_GPIO);
+  stepAfter[STEP_RTCC] = BOOT_SEQ_STEP(STEP_LFXO) | BOOT_SEQ_STEP(STEP_GPIO);
+  stepAsync[STEP_HFXO] = true;
+  stepAsync[STEP_LFXO] = true;
+  tableBuild(STEP_COUNT);
+}
+
+/***************************************************************************//**
+ * @brief The boot of main: in parallel, the main loop is entered once the
+ * HFXO and the image check are done, serially only after the LFXO
+ ******************************************************************************/
+static void testExampleBoot(void)
+{
+  bootSeqInit_TypeDef init = { steps, STEP_COUNT, simNow, OSC_TIMEOUT_US,
+                               false };
+  bootSeqProfile_TypeDef profile;
+  uint32_t mainLoop[2];
+
+  for (int serial = 0; serial < 2; serial++) {
+    exampleBuild();
+    startedTooEarly = false;
+    init.serial = (serial != 0);
+    CHECK(bootSeqInit(&init) == 0);
+    CHECK(bootSeqRun(serial ? ALL_STEPS : MAIN_LOOP_STEPS) == 0);
+    mainLoop[serial] = simTime;
+    while (bootSeqDoneGet() != ALL_STEPS) {
+      CHECK(bootSeqPoll() == 0);
+      simTime += 1000;
+    }
+    CHECK(!startedTooEarly);
+
+    // Both crystals are started before the image check
+    bootSeqProfileGet(&profile);
+    if (!serial) {
+      CHECK(profile.time[STEP_HFXO].start < profile.time[STEP_IMAGE].start);
+      CHECK(profile.time[STEP_LFXO].start < profile.time[STEP_IMAGE].start);
+    }
+  }
+  CHECK(mainLoop[0] < 32000);
+  CHECK(mainLoop[1] > 300000);
+}
+
+/***************************************************************************//**
+ * @brief A crystal that does not start fails its step, the steps after it
+ * are not started, and unrelated steps still run
+ ******************************************************************************/
+static void testTimeout(void)
+{
+  bootSeqInit_TypeDef init = { steps, STEP_COUNT, simNow, OSC_TIMEOUT_US,
+                               false };
+  bootSeqProfile_TypeDef profile;
+
+  exampleBuild();
+  stepDuration[STEP_HFXO] = 5000000;
+  CHECK(bootSeqInit(&init) == 0);
+  CHECK(bootSeqRun(MAIN_LOOP_STEPS) == BOOT_SEQ_ERR_TIMEOUT);
+  CHECK(startCount[STEP_HFCLK] == 0);
+  CHECK(startCount[STEP_TIMER] == 0);
+  CHECK(bootSeqRun(BOOT_SEQ_STEP(STEP_GPIO)) == 0);
+
+  bootSeqProfileGet(&profile);
+  CHECK(profile.failed & BOOT_SEQ_STEP(STEP_HFXO));
+  CHECK(!(profile.done & BOOT_SEQ_STEP(STEP_HFXO)));
+}
+
+int main(void)
+{
+  testRandomTables();
+  testInvalidTables();
+  testExampleBoot();
+  testTimeout();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
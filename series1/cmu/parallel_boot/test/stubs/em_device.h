@@ -0,0 +1,24 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// Only the CMSIS bit instructions used by boot_seq.c are provided.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+static inline uint32_t __CLZ(uint32_t x)
+{
+  return (x != 0) ? (uint32_t)__builtin_clz(x) : 32;
+}
+
+static inline uint32_t __RBIT(uint32_t x)
+{
+  uint32_t r = 0;
+
+  for (int i = 0; i < 32; i++) {
+    r = (r << 1) | (x & 1);
+    x >>= 1;
+  }
+  return r;
+}
+
+#endif // EM_DEVICE_H
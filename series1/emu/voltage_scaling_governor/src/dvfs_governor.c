@@ -0,0 +1,307 @@
+/***************************************************************************//**
+ * @file dvfs_governor.c
+ * @brief Voltage and frequency governor for EM0/EM1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "dvfs_governor.h"
+#include <stddef.h>
+
+// The load is the part of each window in which the core was not in EM1. It
+// is counted in core cycles from each wake-up to the next dvfsSleep(), and
+// compared with the number of HFCLK cycles in a window. The HFCLK only
+// changes at the end of a window, so each window is counted at one HFCLK.
+//
+// The DWT cycle counter is used where there is one. Cortex-M0+ parts such
+// as the EFM32TG11 have no DWT, so SysTick counts the cycles instead. It
+// has 24 bits, so there a window must be shorter than 2^24 cycles at the
+// highest level, 440 ms at 38 MHz.
+//
+// A missed deadline moves to the highest level at once, since a saturated
+// core does not tell how much more is needed. A load above upPercent moves
+// to the lowest level that gives targetPercent, and a load below
+// downPercent does so only after downWindows windows in a row, so that
+// short idle periods do not cause a switch back and forth.
+
+static dvfsInit_TypeDef cfg;
+static uint32_t current;
+static uint32_t lowWindows;
+static uint32_t busyCycles;
+static uint32_t busyStart;
+static dvfsStats_TypeDef stats;
+
+#if defined(DWT)
+#define CYCLE_MASK      (0xFFFFFFFFUL)
+#else
+#define CYCLE_MASK      (SysTick_LOAD_RELOAD_Msk)
+#endif
+
+/***************************************************************************//**
+ * @brief Start the core cycle counter
+ ******************************************************************************/
+static void cycleCounterStart(void)
+{
+#if defined(DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#else
+  SysTick->LOAD = CYCLE_MASK;
+  SysTick->VAL = 0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief Core cycles counted since the start, modulo CYCLE_MASK + 1
+ ******************************************************************************/
+static inline uint32_t cycleCounterGet(void)
+{
+#if defined(DWT)
+  return DWT->CYCCNT;
+#else
+  // SysTick counts down
+  return (CYCLE_MASK - SysTick->VAL) & CYCLE_MASK;
+#endif
+}
+
+static inline uint32_t levelHz(uint32_t level)
+{
+  return (uint32_t)cfg.levels[level].band;
+}
+
+/***************************************************************************//**
+ * @brief Find the lowest level with at least hz
+ ******************************************************************************/
+static uint32_t levelFor(uint64_t hz)
+{
+  uint32_t level;
+
+  for (level = 0; level < cfg.levelCount - 1; level++) {
+    if (levelHz(level) >= hz) {
+      break;
+    }
+  }
+  return level;
+}
+
+/***************************************************************************//**
+ * @brief Set the EM0/EM1 voltage, which also adjusts the flash wait states
+ ******************************************************************************/
+static void voltageSet(bool lowPower)
+{
+  EMU_EM01Init_TypeDef vsInit;
+
+  vsInit.vScaleEM01LowPowerVoltageEnable = lowPower;
+  EMU_EM01Init(&vsInit);
+}
+
+/***************************************************************************//**
+ * @brief Set up the governor and switch to a level
+ *
+ * @param init Configuration, levels must stay valid.
+ * @param level Level to start at.
+ ******************************************************************************/
+void dvfsInit(const dvfsInit_TypeDef *init, uint32_t level)
+{
+  const dvfsLevel_TypeDef *to = &init->levels[level];
+
+  cfg = *init;
+  lowWindows = 0;
+  stats = (dvfsStats_TypeDef){ 0 };
+
+  // Start in a known state, voltage up before the clock and down after it
+  if (!to->lowPowerVoltage) {
+    voltageSet(false);
+  }
+  CMU_ClockDivSet(cmuClock_HFPER, to->hfperDiv);
+  CMU_HFRCOBandSet(to->band);
+  if (to->lowPowerVoltage) {
+    voltageSet(true);
+  }
+  current = level;
+  if (cfg.changed != NULL) {
+    cfg.changed(levelHz(level));
+  }
+
+  cycleCounterStart();
+  busyCycles = 0;
+  busyStart = cycleCounterGet();
+}
+
+/***************************************************************************//**
+ * @brief Sleep in EM1 until an interrupt, use this instead of
+ * EMU_EnterEM1() so that the idle time is seen by the governor
+ ******************************************************************************/
+void dvfsSleep(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  // The interrupt that wakes the core runs after the count is restarted
+  CORE_ENTER_CRITICAL();
+  busyCycles += (cycleCounterGet() - busyStart) & CYCLE_MASK;
+  EMU_EnterEM1();
+  busyStart = cycleCounterGet();
+  CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief Choose the level for the next window
+ *
+ * @param level Current level.
+ * @param loadPercent Load in the last window.
+ * @param missed true if a deadline was missed in the last window.
+ * @return The new level.
+ ******************************************************************************/
+uint32_t dvfsLevelChoose(uint32_t level, uint32_t loadPercent, bool missed)
+{
+  uint64_t needHz = (uint64_t)levelHz(level) * loadPercent / cfg.targetPercent;
+  uint32_t next = level;
+
+  if (missed) {
+    lowWindows = 0;
+    next = cfg.levelCount - 1;
+  } else if (loadPercent > cfg.upPercent) {
+    lowWindows = 0;
+    next = levelFor(needHz);
+    if (next <= level && level < cfg.levelCount - 1) {
+      next = level + 1;
+    }
+  } else if (loadPercent < cfg.downPercent) {
+    if (++lowWindows >= cfg.downWindows) {
+      lowWindows = 0;
+      next = levelFor(needHz);
+      if (next > level) {
+        next = level;
+      }
+    }
+  } else {
+    lowWindows = 0;
+  }
+  return next;
+}
+
+/***************************************************************************//**
+ * @brief Switch to a level
+ *
+ * @details The voltage is raised before HFCLK and lowered after it, since
+ * VSCALE0 only allows HFCLK up to 20 MHz. CMU_HFRCOBandSet() sets the flash
+ * wait states before a higher HFCLK and after a lower one, and EMU_EM01Init()
+ * does the same for the voltage. The HFPERCLK prescaler is increased before
+ * HFCLK and decreased after it, so that HFPERCLK never goes above the
+ * frequencies of both levels. The changed() callback is then called to
+ * update baud rates and timer settings.
+ ******************************************************************************/
+void dvfsLevelSet(uint32_t level)
+{
+  const dvfsLevel_TypeDef *from = &cfg.levels[current];
+  const dvfsLevel_TypeDef *to = &cfg.levels[level];
+  uint32_t start;
+  uint32_t cycles;
+
+  if (level == current) {
+    return;
+  }
+
+  start = cycleCounterGet();
+  if (from->lowPowerVoltage && !to->lowPowerVoltage) {
+    voltageSet(false);
+  }
+  if (to->hfperDiv > from->hfperDiv) {
+    CMU_ClockDivSet(cmuClock_HFPER, to->hfperDiv);
+  }
+  CMU_HFRCOBandSet(to->band);
+  if (to->hfperDiv < from->hfperDiv) {
+    CMU_ClockDivSet(cmuClock_HFPER, to->hfperDiv);
+  }
+  if (!from->lowPowerVoltage && to->lowPowerVoltage) {
+    voltageSet(true);
+  }
+  current = level;
+  if (cfg.changed != NULL) {
+    cfg.changed(levelHz(level));
+  }
+  cycles = (cycleCounterGet() - start) & CYCLE_MASK;
+
+  stats.switches++;
+  stats.switchCyclesLast = cycles;
+  if (cycles > stats.switchCyclesMax) {
+    stats.switchCyclesMax = cycles;
+  }
+}
+
+/***************************************************************************//**
+ * @brief End a window, call this every windowMs
+ *
+ * @param missed true if a deadline was missed in the window.
+ * @return The level for the next window.
+ ******************************************************************************/
+uint32_t dvfsUpdate(bool missed)
+{
+  uint32_t windowCycles = levelHz(current) / 1000 * cfg.windowMs;
+  uint32_t now = cycleCounterGet();
+  uint32_t load;
+
+  busyCycles += (now - busyStart) & CYCLE_MASK;
+  load = (busyCycles >= windowCycles) ? 100
+         : (uint32_t)((uint64_t)busyCycles * 100 / windowCycles);
+
+  stats.windows[current]++;
+  if (missed) {
+    stats.missedWindows++;
+  }
+
+  dvfsLevelSet(dvfsLevelChoose(current, load, missed));
+
+  // The switch itself is not part of the next window's load
+  busyCycles = 0;
+  busyStart = cycleCounterGet();
+  return current;
+}
+
+/***************************************************************************//**
+ * @brief Get the current level
+ ******************************************************************************/
+uint32_t dvfsLevelGet(void)
+{
+  return current;
+}
+
+/***************************************************************************//**
+ * @brief Get the governor statistics
+ ******************************************************************************/
+void dvfsStatsGet(dvfsStats_TypeDef *statsOut)
+{
+  *statsOut = stats;
+}
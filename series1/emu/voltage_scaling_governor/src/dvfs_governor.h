@@ -0,0 +1,88 @@
+/***************************************************************************//**
+ * @file dvfs_governor.h
+ * @brief Voltage and frequency governor for EM0/EM1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef DVFS_GOVERNOR_H
+#define DVFS_GOVERNOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "em_cmu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of operating points
+#define DVFS_MAX_LEVELS                 (8)
+
+// Operating point, HFCLK is the HFRCO
+typedef struct {
+  CMU_HFRCOFreq_TypeDef band;           // HFRCO band, the value is in Hz
+  bool lowPowerVoltage;                 // VSCALE0, HFCLK must be <= 20 MHz
+  uint16_t hfperDiv;                    // HFPERCLK prescaler, 1 to 512
+} dvfsLevel_TypeDef;
+
+typedef struct {
+  const dvfsLevel_TypeDef *levels;      // Operating points, lowest HFCLK first
+  uint32_t levelCount;
+  uint32_t windowMs;                    // Time between dvfsUpdate() calls
+  uint8_t upPercent;                    // Raise HFCLK above this load
+  uint8_t downPercent;                  // Lower HFCLK below this load
+  uint8_t targetPercent;                // Load to aim for when switching
+  uint8_t downWindows;                  // Windows below downPercent first
+  void (*changed)(uint32_t hfclkHz);    // Reconfigure HFCLK based settings
+} dvfsInit_TypeDef;
+
+typedef struct {
+  uint32_t switches;
+  uint32_t switchCyclesLast;            // Core cycles spent in the last switch
+  uint32_t switchCyclesMax;
+  uint32_t missedWindows;               // Windows with a missed deadline
+  uint32_t windows[DVFS_MAX_LEVELS];    // Windows spent at each level
+} dvfsStats_TypeDef;
+
+void dvfsInit(const dvfsInit_TypeDef *init, uint32_t level);
+void dvfsSleep(void);
+uint32_t dvfsUpdate(bool missed);
+uint32_t dvfsLevelChoose(uint32_t level, uint32_t loadPercent, bool missed);
+void dvfsLevelSet(uint32_t level);
+uint32_t dvfsLevelGet(void);
+void dvfsStatsGet(dvfsStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DVFS_GOVERNOR_H
@@ -0,0 +1,257 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief Example of a governor that scales HFCLK and the EM0/EM1 voltage
+ * with the workload of a periodic job
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_letimer.h"
+#include "bsp.h"
+
+#include "dvfs_governor.h"
+
+// Job period in LFRCO ticks, about 10 ms
+#define JOB_PERIOD_TICKS    328
+
+// Jobs per governor window, and the window length in ms
+#define WINDOW_JOBS         10
+#define WINDOW_MS           (WINDOW_JOBS * JOB_PERIOD_TICKS * 1000 / 32768)
+
+// Governor thresholds in percent of the window
+#define UP_PERCENT          80
+#define DOWN_PERCENT        40
+#define TARGET_PERCENT      60
+#define DOWN_WINDOWS        3
+
+/*
+ * Operating points from 4 MHz at 1.0 V (VSCALE0) to 38 MHz at 1.2 V
+ * (VSCALE2).  The HFPERCLK prescaler keeps HFPERCLK between 3.25 and
+ * 4.75 MHz at every point.
+ */
+static const dvfsLevel_TypeDef levels[] = {
+  { cmuHFRCOFreq_4M0Hz,  true,  1 },
+  { cmuHFRCOFreq_7M0Hz,  true,  2 },
+  { cmuHFRCOFreq_13M0Hz, true,  4 },
+  { cmuHFRCOFreq_19M0Hz, true,  4 },
+  { cmuHFRCOFreq_26M0Hz, false, 8 },
+  { cmuHFRCOFreq_38M0Hz, false, 8 },
+};
+
+// Loop iterations per job for the light, medium and heavy workloads
+static const uint32_t work[] = { 2000, 10000, 30000 };
+
+// Current workload, HFCLK and statistics, for viewing in the debugger
+volatile uint32_t workload;
+volatile uint32_t hfclkHz;
+volatile uint32_t missedDeadlines;
+dvfsStats_TypeDef dvfsStats;
+
+static volatile uint32_t jobsReleased;
+
+/**************************************************************************//**
+ * @brief GPIO initialization
+ *****************************************************************************/
+void initGpio(void)
+{
+  // Enable GPIO clock
+  CMU_ClockEnable(cmuClock_GPIO, true);
+
+  // Configure PB0 as input
+  GPIO_PinModeSet(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, gpioModeInputPullFilter, 1);
+
+  // Enable falling-edge interrupts for PB pins
+  GPIO_IntConfig(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, 1, 0, true);
+
+  // Enable IRQ for even numbered GPIO pins
+  NVIC_ClearPendingIRQ(GPIO_EVEN_IRQn);
+  NVIC_EnableIRQ(GPIO_EVEN_IRQn);
+
+  // Enable IRQ for even numbered GPIO pins
+  NVIC_ClearPendingIRQ(GPIO_ODD_IRQn);
+  NVIC_EnableIRQ(GPIO_ODD_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization, releases a job every JOB_PERIOD_TICKS
+ *
+ * @details The LETIMER runs from the LFRCO, so the job period does not
+ * change when the governor changes HFCLK.
+ *****************************************************************************/
+void initLetimer(void)
+{
+  LETIMER_Init_TypeDef init = LETIMER_INIT_DEFAULT;
+
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  init.comp0Top = true;
+  init.enable = false;
+  LETIMER_Init(LETIMER0, &init);
+  LETIMER_CompareSet(LETIMER0, 0, JOB_PERIOD_TICKS - 1);
+
+  LETIMER_IntClear(LETIMER0, LETIMER_IF_UF);
+  LETIMER_IntEnable(LETIMER0, LETIMER_IEN_UF);
+  NVIC_ClearPendingIRQ(LETIMER0_IRQn);
+  NVIC_EnableIRQ(LETIMER0_IRQn);
+
+  LETIMER_Enable(LETIMER0, true);
+}
+
+/**************************************************************************//**
+ * @brief LETIMER handler, releases the next job
+ *****************************************************************************/
+void LETIMER0_IRQHandler(void)
+{
+  LETIMER_IntClear(LETIMER0, LETIMER_IF_UF);
+  jobsReleased++;
+}
+
+/**************************************************************************//**
+ * @brief Push Button handler, selects the next workload
+ *****************************************************************************/
+void GPIO_Handler(void)
+{
+  workload = (workload + 1) % (sizeof(work) / sizeof(work[0]));
+
+  // Clear all even pin interrupt flags
+  GPIO_IntClear(1 << BSP_GPIO_PB0_PIN);
+}
+
+/**************************************************************************//**
+ * @brief GPIO Odd IRQ redirects to generic handler
+ *****************************************************************************/
+void GPIO_ODD_IRQHandler(void)
+{
+  GPIO_Handler();
+}
+
+/**************************************************************************//**
+ * @brief GPIO Even IRQ redirects to generic handler
+ *****************************************************************************/
+void GPIO_EVEN_IRQHandler(void)
+{
+  GPIO_Handler();
+}
+
+/**************************************************************************//**
+ * @brief Called by the governor after each switch
+ *
+ * @details Settings derived from HFCLK or HFPERCLK, e.g. USART baud rates
+ * or TIMER top values, would be updated here.
+ *****************************************************************************/
+void hfclkChanged(uint32_t hz)
+{
+  hfclkHz = hz;
+}
+
+/**************************************************************************//**
+ * @brief  Runs the processor for a number of loop iterations
+ *****************************************************************************/
+void runJob(uint32_t iterations)
+{
+  for (volatile uint32_t i = 0; i < iterations; i++)
+  {
+  }
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  dvfsInit_TypeDef dvfsInit = {
+    .levels = levels,
+    .levelCount = sizeof(levels) / sizeof(levels[0]),
+    .windowMs = WINDOW_MS,
+    .upPercent = UP_PERCENT,
+    .downPercent = DOWN_PERCENT,
+    .targetPercent = TARGET_PERCENT,
+    .downWindows = DOWN_WINDOWS,
+    .changed = hfclkChanged,
+  };
+  uint32_t jobsDone = 0;
+  uint32_t windowStart = 0;
+  bool missed = false;
+  CORE_DECLARE_IRQ_STATE;
+
+  CHIP_Init();
+
+  // Start at the highest operating point
+  dvfsInit(&dvfsInit, dvfsInit.levelCount - 1);
+
+  // Configure PB0 and the job timer
+  initGpio();
+  initLetimer();
+
+  while (1)
+  {
+    // End of a governor window
+    if (jobsReleased - windowStart >= WINDOW_JOBS)
+    {
+      windowStart += WINDOW_JOBS;
+      dvfsUpdate(missed);
+      dvfsStatsGet(&dvfsStats);
+      missed = false;
+    }
+
+    if (jobsDone != jobsReleased)
+    {
+      runJob(work[workload]);
+      jobsDone++;
+
+      // The next job was released before this one was done
+      if (jobsDone != jobsReleased)
+      {
+        missed = true;
+        missedDeadlines++;
+        jobsDone = jobsReleased;
+      }
+    }
+    else
+    {
+      // Check again with interrupts disabled, so that a job released now
+      // still ends the sleep
+      CORE_ENTER_CRITICAL();
+      if (jobsDone == jobsReleased)
+        dvfsSleep();
+      CORE_EXIT_CRITICAL();
+    }
+  }
+}
@@ -0,0 +1,328 @@
+/***************************************************************************//**
+ * @file dvfs_governor_test.c
+ * @brief Host test of dvfs_governor.c: level choice, switch sequencing and
+ * periodic workloads on a simulated core
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/dvfs_governor_test.c
+//       src/dvfs_governor.c -o dvfs_governor_test
+//   ./dvfs_governor_test
+//
+// Add -DHOST_NO_DWT to test the SysTick cycle counter of Cortex-M0+ parts.
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "dvfs_governor.h"
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+// Settings of main.c
+#define WINDOW_MS       (100)
+#define JOBS_PER_WINDOW (10)
+#define LEVELS          (6)
+
+// VSCALE0 limit, and the highest HFPERCLK of the levels below
+#define VSCALE0_MAX_HZ  (20000000UL)
+#define HFPER_MAX_HZ    (4750000UL)
+
+static int checks;
+static int failures;
+
+SysTick_Type hostSysTick;
+#if defined(DWT)
+DWT_Type hostDwt;
+CoreDebug_Type hostCoreDebug;
+#endif
+
+// Simulated clock and voltage state, and any limit exceeded on the way
+static uint32_t hfclkHz;
+static uint32_t hfperDiv = 1;
+static bool lowPowerVoltage;
+static bool vscale0Overclocked;
+static bool hfperOvershoot;
+static uint32_t changedHz;
+
+static const dvfsLevel_TypeDef levels[LEVELS] = {
+  { cmuHFRCOFreq_4M0Hz,  true,  1 },
+  { cmuHFRCOFreq_7M0Hz,  true,  2 },
+  { cmuHFRCOFreq_13M0Hz, true,  4 },
+  { cmuHFRCOFreq_19M0Hz, true,  4 },
+  { cmuHFRCOFreq_26M0Hz, false, 8 },
+  { cmuHFRCOFreq_38M0Hz, false, 8 },
+};
+
+static uint32_t seed = 90;
+
+/***************************************************************************//**
+ * @brief Advance the core cycle counter
+ ******************************************************************************/
+static void cyclesRun(uint32_t cycles)
+{
+#if defined(DWT)
+  hostDwt.CYCCNT += cycles;
+#else
+  hostSysTick.VAL = (hostSysTick.VAL - cycles) & SysTick_LOAD_RELOAD_Msk;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief Check the clock limits after each step of a switch
+ ******************************************************************************/
+static void checkLimits(void)
+{
+  if (lowPowerVoltage && hfclkHz > VSCALE0_MAX_HZ) {
+    vscale0Overclocked = true;
+  }
+  if (hfclkHz / hfperDiv > HFPER_MAX_HZ) {
+    hfperOvershoot = true;
+  }
+}
+
+void CMU_ClockDivSet(CMU_Clock_TypeDef clock, uint32_t div)
+{
+  (void)clock;
+  hfperDiv = div;
+  checkLimits();
+}
+
+void CMU_HFRCOBandSet(CMU_HFRCOFreq_TypeDef setFreq)
+{
+  hfclkHz = (uint32_t)setFreq;
+  cyclesRun(200);
+  checkLimits();
+}
+
+void EMU_EM01Init(const EMU_EM01Init_TypeDef *em01Init)
+{
+  lowPowerVoltage = em01Init->vScaleEM01LowPowerVoltageEnable;
+  cyclesRun(1000);
+  checkLimits();
+}
+
+void EMU_EnterEM1(void)
+{
+}
+
+static void changed(uint32_t hz)
+{
+  changedHz = hz;
+}
+
+static const dvfsInit_TypeDef governorInit = {
+  levels, LEVELS, WINDOW_MS, 80, 40, 60, 3, changed
+};
+
+/***************************************************************************//**
+ * @brief Start the governor from the clocks after reset, 19 MHz HFRCO with
+ * HFPERCLK undivided at VSCALE2. HFPERCLK is above the limit of the levels
+ * until dvfsInit() has switched, so that limit is only checked after it.
+ ******************************************************************************/
+static void governorStart(uint32_t level)
+{
+  hfclkHz = (uint32_t)cmuHFRCOFreq_19M0Hz;
+  hfperDiv = 1;
+  lowPowerVoltage = false;
+  dvfsInit(&governorInit, level);
+  hfperOvershoot = false;
+}
+
+/***************************************************************************//**
+ * @brief Small LCG, so that the test does not depend on the C library rand()
+ ******************************************************************************/
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+/***************************************************************************//**
+ * @brief Run one window of jobs, each taking about the given number of core
+ * cycles (+-10%) at any HFCLK
+ * @return true if a job was not done before the next one was released
+ ******************************************************************************/
+static bool runWindow(uint32_t jobCycles)
+{
+  uint32_t period = hfclkHz / 1000 * WINDOW_MS / JOBS_PER_WINDOW;
+  uint32_t cycles;
+  bool missed = false;
+
+  for (int j = 0; j < JOBS_PER_WINDOW; j++) {
+    cycles = jobCycles - jobCycles / 10 + random32() % (jobCycles / 5 + 1);
+    if (cycles > period) {
+      missed = true;
+      cycles = period;
+    }
+    cyclesRun(cycles);
+    dvfsSleep();
+  }
+  dvfsUpdate(missed);
+  return missed;
+}
+
+/***************************************************************************//**
+ * @brief Lowest level at which a job load stays at or below 80%
+ ******************************************************************************/
+static uint32_t lowestFeasible(uint32_t jobCycles)
+{
+  for (uint32_t l = 0; l < LEVELS; l++) {
+    uint64_t period = (uint64_t)levels[l].band / 1000 * WINDOW_MS
+                      / JOBS_PER_WINDOW;
+
+    if ((uint64_t)jobCycles * 100 <= period * 80) {
+      return l;
+    }
+  }
+  return LEVELS - 1;
+}
+
+/***************************************************************************//**
+ * @brief The policy of dvfsLevelChoose() on its own
+ ******************************************************************************/
+static void testChoose(void)
+{
+  governorStart(2);
+
+  // A missed deadline goes to the top
+  CHECK(dvfsLevelChoose(0, 10, true) == LEVELS - 1);
+
+  // A high load goes to the level that gives 60%, at least one level up:
+  // 13 MHz at 95% needs 20.6 MHz, 4 MHz at 81% needs 5.4 MHz
+  CHECK(dvfsLevelChoose(2, 95, false) == 4);
+  CHECK(dvfsLevelChoose(0, 81, false) == 1);
+  CHECK(dvfsLevelChoose(5, 100, false) == 5);
+
+  // Between the thresholds nothing changes
+  CHECK(dvfsLevelChoose(3, 60, false) == 3);
+  CHECK(dvfsLevelChoose(3, 40, false) == 3);
+
+  // A low load only goes down after three windows in a row, and a window in
+  // between starts the count again. 38 MHz at 10% needs 6.3 MHz.
+  CHECK(dvfsLevelChoose(5, 10, false) == 5);
+  CHECK(dvfsLevelChoose(5, 10, false) == 5);
+  CHECK(dvfsLevelChoose(5, 50, false) == 5);
+  CHECK(dvfsLevelChoose(5, 10, false) == 5);
+  CHECK(dvfsLevelChoose(5, 10, false) == 5);
+  CHECK(dvfsLevelChoose(5, 10, false) == 1);
+
+  // Never up from a low load
+  CHECK(dvfsLevelChoose(0, 39, false) == 0);
+  CHECK(dvfsLevelChoose(0, 39, false) == 0);
+  CHECK(dvfsLevelChoose(0, 39, false) == 0);
+}
+
+/***************************************************************************//**
+ * @brief Every switch between two levels keeps the voltage and HFPERCLK
+ * limits, and reports the new HFCLK
+ ******************************************************************************/
+static void testSwitches(void)
+{
+  for (uint32_t from = 0; from < LEVELS; from++) {
+    for (uint32_t to = 0; to < LEVELS; to++) {
+      governorStart(from);
+      CHECK(hfclkHz == (uint32_t)levels[from].band);
+      CHECK(lowPowerVoltage == levels[from].lowPowerVoltage);
+      CHECK(hfperDiv == levels[from].hfperDiv);
+      dvfsLevelSet(to);
+      CHECK(dvfsLevelGet() == to);
+      CHECK(hfclkHz == (uint32_t)levels[to].band);
+      CHECK(lowPowerVoltage == levels[to].lowPowerVoltage);
+      CHECK(hfperDiv == levels[to].hfperDiv);
+      CHECK(changedHz == hfclkHz);
+    }
+  }
+  CHECK(!vscale0Overclocked);
+  CHECK(!hfperOvershoot);
+}
+
+/***************************************************************************//**
+ * @brief Workload phases with noise: each settles within one level of the
+ * lowest feasible level, with at most two missed windows per phase and no
+ * misses once settled
+ ******************************************************************************/
+static void testWorkloads(void)
+{
+  static const uint32_t work[] = {
+    15000, 80000, 250000, 40000, 150000, 5000, 300000, 20000
+  };
+  dvfsStats_TypeDef stats;
+  uint32_t target;
+  uint32_t level;
+  int missed;
+
+  governorStart(LEVELS - 1);
+  for (size_t p = 0; p < sizeof(work) / sizeof(work[0]); p++) {
+    target = lowestFeasible(work[p]);
+    missed = 0;
+    for (int w = 0; w < 60; w++) {
+      if (runWindow(work[p])) {
+        missed++;
+        CHECK(w < 20);
+      }
+      if (w >= 20) {
+        level = dvfsLevelGet();
+        CHECK(level + 1 >= target);
+        CHECK(level <= target + 1);
+      }
+    }
+    CHECK(missed <= 2);
+  }
+
+  dvfsStatsGet(&stats);
+  CHECK(stats.switches < 60);
+  CHECK(stats.switchCyclesMax >= 200);
+  CHECK(!vscale0Overclocked);
+  CHECK(!hfperOvershoot);
+}
+
+int main(void)
+{
+  testChoose();
+  testSwitches();
+  testWorkloads();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+// Host stand-in for em_cmu.h, used by the tests in the parent directory.
+// The functions are implemented by the test.
+#ifndef EM_CMU_H
+#define EM_CMU_H
+
+#include <stdint.h>
+
+typedef enum {
+  cmuHFRCOFreq_4M0Hz  = 4000000U,
+  cmuHFRCOFreq_7M0Hz  = 7000000U,
+  cmuHFRCOFreq_13M0Hz = 13000000U,
+  cmuHFRCOFreq_19M0Hz = 19000000U,
+  cmuHFRCOFreq_26M0Hz = 26000000U,
+  cmuHFRCOFreq_38M0Hz = 38000000U,
+} CMU_HFRCOFreq_TypeDef;
+
+typedef enum {
+  cmuClock_HFPER,
+} CMU_Clock_TypeDef;
+
+void CMU_ClockDivSet(CMU_Clock_TypeDef clock, uint32_t div);
+void CMU_HFRCOBandSet(CMU_HFRCOFreq_TypeDef setFreq);
+
+#endif // EM_CMU_H
@@ -0,0 +1,41 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// The test advances the simulated cycle counter. Define HOST_NO_DWT to leave
+// out the DWT, as on a Cortex-M0+, so that SysTick is used instead.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t LOAD;
+  volatile uint32_t VAL;
+} SysTick_Type;
+
+extern SysTick_Type hostSysTick;
+
+#define SysTick                         (&hostSysTick)
+#define SysTick_CTRL_CLKSOURCE_Msk      (0x1UL << 2)
+#define SysTick_CTRL_ENABLE_Msk         (0x1UL << 0)
+#define SysTick_LOAD_RELOAD_Msk         (0xFFFFFFUL)
+
+#if !defined(HOST_NO_DWT)
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type hostDwt;
+extern CoreDebug_Type hostCoreDebug;
+
+#define DWT                             (&hostDwt)
+#define CoreDebug                       (&hostCoreDebug)
+#define DWT_CTRL_CYCCNTENA_Msk          (0x1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk      (0x1UL << 24)
+#endif
+
+#endif // EM_DEVICE_H
@@ -0,0 +1,15 @@
+// Host stand-in for em_emu.h, used by the tests in the parent directory.
+// The functions are implemented by the test.
+#ifndef EM_EMU_H
+#define EM_EMU_H
+
+#include <stdbool.h>
+
+typedef struct {
+  bool vScaleEM01LowPowerVoltageEnable;
+} EMU_EM01Init_TypeDef;
+
+void EMU_EM01Init(const EMU_EM01Init_TypeDef *em01Init);
+void EMU_EnterEM1(void);
+
+#endif // EM_EMU_H
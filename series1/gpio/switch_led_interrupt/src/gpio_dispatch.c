@@ -0,0 +1,246 @@
+/***************************************************************************//**
+ * @file gpio_dispatch.c
+ * @brief Table-driven GPIO interrupt dispatcher with per-interrupt callbacks
+ * and debounce
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_core.h"
+#include "em_gpio.h"
+#include "gpio_dispatch.h"
+#include <stddef.h>
+
+// The even and odd interrupt handlers take the pending and enabled flags of
+// their half, clear them and call the callback of each set flag, highest
+// interrupt number first. The set flags are found with CLZ, so the cost is
+// per pending interrupt and not per table entry.
+//
+// An interrupt with a debounce time calls its callback on the first edge and
+// is then disabled until the debounce time has passed, so contact bounce
+// neither calls the callback again nor wakes the core. One timer compare is
+// used for all interrupts, armed for the earliest end of debounce. The GPIO
+// glitch filter (gpioModeInputPullFilter) removes the short spikes.
+
+static gpioDispatchCallback_TypeDef callbacks[GPIO_DISPATCH_MAX_INTS];
+static uint32_t debounceTime[GPIO_DISPATCH_MAX_INTS];
+static uint32_t debounceEnd[GPIO_DISPATCH_MAX_INTS];
+static uint32_t debouncing;
+static const gpioDispatchTimer_TypeDef *hal;
+
+/***************************************************************************//**
+ * @brief Number of the highest set bit, x must not be zero
+ ******************************************************************************/
+static inline uint32_t highestBit(uint32_t x)
+{
+#if (__CORTEX_M >= 3)
+  return 31 - __CLZ(x);
+#else
+  // Cortex-M0+ has no CLZ instruction, and only 16 bits are used
+  uint32_t n = 0;
+
+  if (x & 0xFF00) {
+    n += 8;
+    x >>= 8;
+  }
+  if (x & 0xF0) {
+    n += 4;
+    x >>= 4;
+  }
+  if (x & 0xC) {
+    n += 2;
+    x >>= 2;
+  }
+  return n + (x >> 1);
+#endif
+}
+
+/***************************************************************************//**
+ * @brief Arm the timer for the earliest end of debounce, or disarm it
+ ******************************************************************************/
+static void timerUpdate(void)
+{
+  uint32_t pending = debouncing;
+  uint32_t first;
+  uint32_t n;
+
+  if (pending == 0) {
+    hal->disarm();
+    return;
+  }
+
+  n = highestBit(pending);
+  first = debounceEnd[n];
+  pending &= ~(1UL << n);
+  while (pending != 0) {
+    n = highestBit(pending);
+    pending &= ~(1UL << n);
+    if ((int32_t)(debounceEnd[n] - first) < 0) {
+      first = debounceEnd[n];
+    }
+  }
+  hal->arm(first);
+}
+
+/***************************************************************************//**
+ * @brief Call the callbacks of the pending interrupts in mask
+ ******************************************************************************/
+static void dispatch(uint32_t mask)
+{
+  uint32_t pending = GPIO_IntGetEnabled() & mask;
+  uint32_t debounced = 0;
+  uint32_t n;
+
+  GPIO_IntClear(pending);
+
+  while (pending != 0) {
+    n = highestBit(pending);
+    pending &= ~(1UL << n);
+
+    if (debounceTime[n] != 0) {
+      GPIO_IntDisable(1UL << n);
+      debounceEnd[n] = hal->now() + debounceTime[n];
+      debounced |= 1UL << n;
+    }
+    if (callbacks[n] != NULL) {
+      callbacks[n](n);
+    }
+  }
+
+  if (debounced != 0) {
+    debouncing |= debounced;
+    timerUpdate();
+  }
+}
+
+void GPIO_EVEN_IRQHandler(void)
+{
+  dispatch(GPIO_DISPATCH_EVEN_MASK);
+}
+
+void GPIO_ODD_IRQHandler(void)
+{
+  dispatch(GPIO_DISPATCH_ODD_MASK);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the dispatcher.
+ *
+ * @param[in] timer
+ *   Timer for debouncing, NULL if no interrupt is debounced. Must stay valid.
+ ******************************************************************************/
+void gpioDispatchInit(const gpioDispatchTimer_TypeDef *timer)
+{
+  uint32_t n;
+
+  for (n = 0; n < GPIO_DISPATCH_MAX_INTS; n++) {
+    callbacks[n] = NULL;
+    debounceTime[n] = 0;
+  }
+  debouncing = 0;
+  hal = timer;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the callback of an external interrupt.
+ *
+ * @details
+ *   The interrupt itself is configured with GPIO_ExtIntConfig(), and the
+ *   GPIO_EVEN_IRQn and GPIO_ODD_IRQn interrupts are enabled in the NVIC by
+ *   the application.
+ *
+ * @param[in] intNo
+ *   External interrupt number, 0 to 15.
+ *
+ * @param[in] callback
+ *   Called from the interrupt handler with intNo, NULL for none.
+ *
+ * @param[in] debounce
+ *   Time in now() units to ignore the interrupt after each call, 0 for none.
+ *
+ * @return
+ *   0 on success, GPIO_DISPATCH_ERR_PARAM on failure.
+ ******************************************************************************/
+int gpioDispatchRegister(uint32_t intNo,
+                         gpioDispatchCallback_TypeDef callback,
+                         uint32_t debounce)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  if (intNo >= GPIO_DISPATCH_MAX_INTS || (debounce != 0 && hal == NULL)) {
+    return GPIO_DISPATCH_ERR_PARAM;
+  }
+
+  CORE_ENTER_CRITICAL();
+  callbacks[intNo] = callback;
+  debounceTime[intNo] = debounce;
+  CORE_EXIT_CRITICAL();
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   End debounce of the interrupts whose debounce time has passed. Called
+ *   from the timer interrupt handler.
+ *
+ * @details
+ *   Edges seen during debounce are discarded, the interrupt is enabled again
+ *   with its flag cleared.
+ ******************************************************************************/
+void gpioDispatchTimeout(void)
+{
+  uint32_t pending;
+  uint32_t done = 0;
+  uint32_t now;
+  uint32_t n;
+
+  if (hal == NULL) {
+    return;
+  }
+
+  now = hal->now();
+  pending = debouncing;
+  while (pending != 0) {
+    n = highestBit(pending);
+    pending &= ~(1UL << n);
+    if ((int32_t)(debounceEnd[n] - now) <= 0) {
+      done |= 1UL << n;
+    }
+  }
+
+  debouncing &= ~done;
+  GPIO_IntClear(done);
+  GPIO_IntEnable(done);
+  timerUpdate();
+}
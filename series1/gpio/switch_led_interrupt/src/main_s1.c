@@ -2,7 +2,8 @@
  * @file main_s1.c
  * @brief This project demonstrates a using GPIOs to trigger external 
  * interrupts. When PB0 or PB1 is pressed, LED0 or LED1 is toggled, 
- * respectively. See readme.txt for details.
+ * respectively. The interrupts are dispatched by gpio_dispatch.c and
+ * debounced with the RTCC. See readme.txt for details.
  *******************************************************************************
  * # License
  * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
@@ -40,30 +41,97 @@
 #include "em_cmu.h"
 #include "em_emu.h"
 #include "em_gpio.h"
+#include "em_rtcc.h"
 #include "bsp.h"
+#include "gpio_dispatch.h"
+
+// RTCC ticks per second, the RTCC counts the ULFRCO, which runs in EM3
+#define TICKS_PER_SECOND  1000
+
+// Time to ignore a push button after a press
+#define DEBOUNCE_TICKS    (TICKS_PER_SECOND / 20)
+
+// RTCC channel used for debouncing
+#define DEBOUNCE_CC       1
 
 /**************************************************************************//**
- * @brief GPIO Even IRQ for pushbuttons on even-numbered pins
+ * @brief Debounce timer hooks for the RTCC
  *****************************************************************************/
-void GPIO_EVEN_IRQHandler(void) 
+static uint32_t rtccNow(void)
+{
+  return RTCC_CounterGet();
+}
+
+static void rtccArm(uint32_t tick)
 {
-  // Clear all even pin interrupt flags
-  GPIO_IntClear(0x5555);
+  RTCC_ChannelCCVSet(DEBOUNCE_CC, tick);
+  RTCC_IntClear(RTCC_IF_CC1);
+  RTCC_IntEnable(RTCC_IEN_CC1);
+
+  // Set the flag if the match has already been missed
+  if ((int32_t)(tick - RTCC_CounterGet()) <= 0)
+    RTCC_IntSet(RTCC_IF_CC1);
+}
+
+static void rtccDisarm(void)
+{
+  RTCC_IntDisable(RTCC_IEN_CC1);
+  RTCC_IntClear(RTCC_IF_CC1);
+}
+
+static const gpioDispatchTimer_TypeDef debounceTimer = {
+  .now = rtccNow,
+  .arm = rtccArm,
+  .disarm = rtccDisarm,
+};
+
+void RTCC_IRQHandler(void)
+{
+  RTCC_IntClear(RTCC_IF_CC1);
+  gpioDispatchTimeout();
+}
+
+/**************************************************************************//**
+ * @brief Push button callbacks, called from the GPIO interrupt handlers
+ *****************************************************************************/
+static void pb0Pressed(uint32_t intNo)
+{
+  (void)intNo;
 
   // Toggle LED0
   GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
 }
 
+static void pb1Pressed(uint32_t intNo)
+{
+  (void)intNo;
+
+  // Toggle LED1
+  GPIO_PinOutToggle(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN);
+}
+
 /**************************************************************************//**
- * @brief GPIO Odd IRQ for pushbuttons on odd-numbered pins
+ * @brief RTCC initialization, free running 32-bit counter on the ULFRCO
  *****************************************************************************/
-void GPIO_ODD_IRQHandler(void) 
+void initRTCC(void)
 {
-  // Clear all odd pin interrupt flags
-  GPIO_IntClear(0xAAAA);
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_ULFRCO);
+  CMU_ClockEnable(cmuClock_RTCC, true);
 
-  // Toggle LED01
-  GPIO_PinOutToggle(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN);
+  RTCC_Init_TypeDef rtcc = RTCC_INIT_DEFAULT;
+  rtcc.enable = false;
+  rtcc.presc = rtccCntPresc_1;
+  RTCC_Init(&rtcc);
+
+  RTCC_CCChConf_TypeDef compCfg = RTCC_CH_INIT_COMPARE_DEFAULT;
+  RTCC_ChannelInit(DEBOUNCE_CC, &compCfg);
+
+  RTCC_IntClear(_RTCC_IF_MASK);
+  NVIC_ClearPendingIRQ(RTCC_IRQn);
+  NVIC_EnableIRQ(RTCC_IRQn);
+
+  RTCC_Enable(true);
 }
 
 /**************************************************************************//**
@@ -82,6 +150,11 @@ void initGPIO(void)
   GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, 0);
   GPIO_PinModeSet(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN, gpioModePushPull, 0);
 
+  // Register the push button callbacks, the interrupt number is the pin
+  gpioDispatchInit(&debounceTimer);
+  gpioDispatchRegister(BSP_GPIO_PB0_PIN, pb0Pressed, DEBOUNCE_TICKS);
+  gpioDispatchRegister(BSP_GPIO_PB1_PIN, pb1Pressed, DEBOUNCE_TICKS);
+
   // Enable IRQ for even numbered GPIO pins
   NVIC_EnableIRQ(GPIO_EVEN_IRQn);
 
@@ -89,7 +162,7 @@ void initGPIO(void)
   NVIC_EnableIRQ(GPIO_ODD_IRQn);
 
   // Enable falling-edge interrupts for PB pins
-  GPIO_ExtIntConfig(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN,BSP_GPIO_PB0_PIN, 0, 1, true);
+  GPIO_ExtIntConfig(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, BSP_GPIO_PB0_PIN, 0, 1, true);
   GPIO_ExtIntConfig(BSP_GPIO_PB1_PORT, BSP_GPIO_PB1_PIN, BSP_GPIO_PB1_PIN, 0, 1, true);
 }
 
@@ -102,6 +175,7 @@ int main(void)
   CHIP_Init();
 
   // Initializations
+  initRTCC();
   initGPIO();
 
   while (1){
@@ -0,0 +1,242 @@
+/***************************************************************************//**
+ * @file keypad.c
+ * @brief Matrix keypad scanner using LESENSE in EM2, with debounce in the
+ * LESENSE decoder
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_acmp.h"
+#include "em_cmu.h"
+#include "em_lesense.h"
+#include "keypad.h"
+#include <stddef.h>
+
+// All row and column lines are LESENSE channel pins, with no pull-ups. Each
+// channel drives its line low while it is idle. When a channel is scanned,
+// it drives its line high for a few HF clock cycles, releases it and
+// samples it with the ACMP at VDD/2. A pressed key connects the line to a
+// line that is held low, so it is sampled low, and the inverted result is 1.
+// Between scans all lines are low and draw no current.
+//
+// One scan thus gives the active rows and the active columns. The decoder
+// sees the rows (channels 0-3) and only moves to the held state after a key
+// has been seen in two scans in a row, and back to idle after two scans
+// without. It interrupts the core on these two transitions only, so
+// contact bounce and short glitches never wake the core.
+
+// Decoder states, numbered by their first state descriptor
+#define STATE_IDLE      0               // No key
+#define STATE_PRESS     2               // Key seen in one scan
+#define STATE_HELD      5               // Key confirmed
+#define STATE_RELEASE   6               // No key seen in one scan
+
+#define ROWS_MASK       ((1 << KEYPAD_ROWS) - 1)
+
+// Transition when row n is active, the other rows are excluded
+#define ROW_ACTIVE(n, next, irq) \
+  { 1 << (n), ROWS_MASK & ~(1 << (n)), (next), lesenseTransActNone, (irq) }
+
+// Transition when no row is active
+#define NO_ROW(next, irq) \
+  { 0, 0, (next), lesenseTransActNone, (irq) }
+
+static const LESENSE_DecStDesc_TypeDef decoderStates[] = {
+  // STATE_IDLE
+  { true, ROW_ACTIVE(0, STATE_PRESS, false), ROW_ACTIVE(1, STATE_PRESS, false) },
+  { false, ROW_ACTIVE(2, STATE_PRESS, false), ROW_ACTIVE(3, STATE_PRESS, false) },
+  // STATE_PRESS
+  { true, NO_ROW(STATE_IDLE, false), ROW_ACTIVE(0, STATE_HELD, true) },
+  { true, ROW_ACTIVE(1, STATE_HELD, true), ROW_ACTIVE(2, STATE_HELD, true) },
+  { false, ROW_ACTIVE(3, STATE_HELD, true), ROW_ACTIVE(3, STATE_HELD, true) },
+  // STATE_HELD
+  { false, NO_ROW(STATE_RELEASE, false), NO_ROW(STATE_RELEASE, false) },
+  // STATE_RELEASE
+  { true, NO_ROW(STATE_IDLE, true), ROW_ACTIVE(0, STATE_HELD, false) },
+  { true, ROW_ACTIVE(1, STATE_HELD, false), ROW_ACTIVE(2, STATE_HELD, false) },
+  { false, ROW_ACTIVE(3, STATE_HELD, false), ROW_ACTIVE(3, STATE_HELD, false) },
+};
+
+static keypadCallback_TypeDef callback;
+static int pressedKey = KEYPAD_ERR_NONE;
+
+/***************************************************************************//**
+ * @brief Index of the only set bit, or -1 if zero or more than one bit is set
+ ******************************************************************************/
+static int singleBit(uint32_t x)
+{
+  if (x == 0 || (x & (x - 1)) != 0) {
+    return -1;
+  }
+  return 31 - __CLZ(x);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Find the pressed key from a LESENSE scan result.
+ *
+ * @param[in] scanRes
+ *   Channel results, bit n is channel n.
+ *
+ * @return
+ *   Key number, KEYPAD_ERR_NONE if no key is pressed or the row and column
+ *   results disagree, KEYPAD_ERR_MULTI if more than one key is pressed.
+ ******************************************************************************/
+int keypadDecode(uint32_t scanRes)
+{
+  uint32_t rows = scanRes & ROWS_MASK;
+  uint32_t cols = (scanRes >> KEYPAD_ROWS) & ((1 << KEYPAD_COLS) - 1);
+  int row = singleBit(rows);
+  int col = singleBit(cols);
+
+  // A pressed key always pulls both its row and its column low
+  if (rows == 0 || cols == 0) {
+    return KEYPAD_ERR_NONE;
+  }
+  if (row < 0 || col < 0) {
+    return KEYPAD_ERR_MULTI;
+  }
+  return row * KEYPAD_COLS + col;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   LESENSE interrupt, called only when the decoder confirms a press or a
+ *   release.
+ ******************************************************************************/
+void LESENSE_IRQHandler(void)
+{
+  uint32_t state;
+
+  LESENSE_IntClear(LESENSE_IFC_DEC);
+  state = LESENSE_DecoderStateGet();
+
+  if (state == STATE_HELD) {
+    pressedKey = keypadDecode(LESENSE_ScanResultGet());
+    if (callback != NULL) {
+      callback(keypadEventPress, pressedKey);
+    }
+  } else if (state == STATE_IDLE) {
+    if (callback != NULL) {
+      callback(keypadEventRelease, pressedKey);
+    }
+    pressedKey = KEYPAD_ERR_NONE;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set up the ACMP and LESENSE, and start scanning.
+ *
+ * @details
+ *   The LFA clock must run, and the channel pins must be set to
+ *   gpioModeDisabled. The LESENSE interrupt is enabled in the NVIC.
+ *
+ * @param[in] init
+ *   Configuration.
+ ******************************************************************************/
+void keypadInit(const keypadInit_TypeDef *init)
+{
+  ACMP_Init_TypeDef acmpInit = ACMP_INIT_DEFAULT;
+  ACMP_VAConfig_TypeDef vaInit = ACMP_VACONFIG_DEFAULT;
+  LESENSE_Init_TypeDef lesenseInit = LESENSE_INIT_DEFAULT;
+  LESENSE_ChDesc_TypeDef chInit = LESENSE_CH_CONF_DEFAULT;
+  uint32_t i;
+
+  callback = init->callback;
+  pressedKey = KEYPAD_ERR_NONE;
+
+  // Compare the channels with VDD/2, LESENSE selects the channel input
+  acmpInit.fullBias = true;
+  acmpInit.biasProg = 0x1F;
+  acmpInit.inputRange = acmpInputRangeFull;
+  acmpInit.accuracy = acmpAccuracyHigh;
+  acmpInit.powerSource = acmpPowerSourceAvdd;
+  acmpInit.vlpInput = acmpVLPInputVADIV;
+  vaInit.input = acmpVAInputVDD;
+  vaInit.div0 = 32;
+  vaInit.div1 = 32;
+
+  CMU_ClockEnable(init->acmp == ACMP0 ? cmuClock_ACMP0 : cmuClock_ACMP1, true);
+  ACMP_Init(init->acmp, &acmpInit);
+  ACMP_VASetup(init->acmp, &vaInit);
+  ACMP_ChannelSet(init->acmp, acmpInputVADIV, acmpInputAPORT0XCH0);
+  ACMP_ExternalInputSelect(init->acmp, acmpExternalInputAPORT0X);
+
+  // Periodic scans with the decoder on the row results
+  lesenseInit.coreCtrl.scanStart = lesenseScanStartPeriodic;
+  lesenseInit.coreCtrl.biasMode = lesenseBiasModeDutyCycle;
+  lesenseInit.perCtrl.acmp0Mode = (init->acmp == ACMP0) ? lesenseACMPModeMux
+                                                        : lesenseACMPModeDisable;
+  lesenseInit.perCtrl.acmp1Mode = (init->acmp == ACMP0) ? lesenseACMPModeDisable
+                                                        : lesenseACMPModeMux;
+  lesenseInit.perCtrl.warmupMode = lesenseWarmupModeNormal;
+  lesenseInit.decCtrl.decInput = lesenseDecInputSensorSt;
+  lesenseInit.decCtrl.initState = STATE_IDLE;
+
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockEnable(cmuClock_LESENSE, true);
+  LESENSE_Init(&lesenseInit, true);
+
+  // Precharge the line high, release it and sample it, keep it low when idle
+  chInit.enaScanCh = true;
+  chInit.enaPin = true;
+  chInit.enaInt = false;
+  chInit.chPinExMode = lesenseChPinExHigh;
+  chInit.chPinIdleMode = lesenseChPinIdleLow;
+  chInit.invRes = true;
+  chInit.exClk = lesenseClkHF;
+  chInit.sampleClk = lesenseClkHF;
+  chInit.exTime = 4;
+  chInit.sampleDelay = 6;
+  chInit.measDelay = 0;
+  chInit.sampleMode = lesenseSampleModeACMP;
+  chInit.intMode = lesenseSetIntNone;
+  for (i = 0; i < KEYPAD_ROWS + KEYPAD_COLS; i++) {
+    LESENSE_ChannelConfig(&chInit, i);
+  }
+
+  for (i = 0; i < sizeof(decoderStates) / sizeof(decoderStates[0]); i++) {
+    LESENSE_DecoderStateConfig(&decoderStates[i], i);
+  }
+
+  LESENSE_ScanFreqSet(0, init->scanHz);
+  LESENSE_ClkDivSet(lesenseClkHF, lesenseClkDiv_1);
+
+  LESENSE_IntClear(_LESENSE_IFC_MASK);
+  LESENSE_IntEnable(LESENSE_IEN_DEC);
+  NVIC_ClearPendingIRQ(LESENSE_IRQn);
+  NVIC_EnableIRQ(LESENSE_IRQn);
+
+  LESENSE_DecoderStart();
+  LESENSE_ScanStart();
+}
@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * @file keypad.h
+ * @brief Matrix keypad scanner using LESENSE in EM2, with debounce in the
+ * LESENSE decoder
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include <stdint.h>
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rows are on LESENSE channels 0-3, which are the decoder inputs, and
+// columns on channels 4-7. A channel result is 1 when its line is pulled low
+// by a pressed key. Keys are numbered row * KEYPAD_COLS + column.
+#define KEYPAD_ROWS                     (4)
+#define KEYPAD_COLS                     (4)
+#define KEYPAD_ROW_CH(row)              (row)
+#define KEYPAD_COL_CH(col)              (KEYPAD_ROWS + (col))
+#define KEYPAD_CH_MASK                  ((1UL << (KEYPAD_ROWS + KEYPAD_COLS)) - 1)
+
+// No key is pressed
+#define KEYPAD_ERR_NONE                 (-0x5280)
+// More than one key is pressed and the keys can not be told apart
+#define KEYPAD_ERR_MULTI                (-0x5200)
+
+typedef enum {
+  keypadEventPress,
+  keypadEventRelease,
+} keypadEvent_TypeDef;
+
+// Called from the LESENSE interrupt handler with the key, or with
+// KEYPAD_ERR_NONE or KEYPAD_ERR_MULTI if the key can not be found
+typedef void (*keypadCallback_TypeDef)(keypadEvent_TypeDef event, int key);
+
+typedef struct {
+  ACMP_TypeDef *acmp;                   // ACMP of the channel pins
+  uint32_t scanHz;                      // Scan rate, a press is confirmed
+                                        // after two scans
+  keypadCallback_TypeDef callback;
+} keypadInit_TypeDef;
+
+void keypadInit(const keypadInit_TypeDef *init);
+int keypadDecode(uint32_t scanRes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KEYPAD_H
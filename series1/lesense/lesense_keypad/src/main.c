@@ -0,0 +1,323 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief 4x4 matrix keypad scanned by LESENSE in EM2. LESENSE
+ * scans the keypad and debounces it in its decoder, so the core only wakes
+ * up once when a key is pressed and once when it is released. LED0 is on
+ * while a key is held.
+ * 
+ * Define KEYPAD_GPIO_SCAN to build a GPIO interrupt and RTCC polling scanner
+ * instead, for comparing the current of the two.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_rtcc.h"
+
+#include "bsp.h"
+#include "keypad.h"
+
+/***************************************************************************//**
+ * Macro definitions*/
+ /******************************************************************************/
+
+// Scan rate, a press is reported after two scans that see it
+#define SCAN_FREQ         50
+
+// Keypad lines, rows on LESENSE channels 0-3 and columns on channels 4-7
+#if defined(_SILICON_LABS_GECKO_INTERNAL_SDID_100)
+  #define KEYPAD_ACMP     ACMP0           // GG11: PC0-PC7
+  #define KEYPAD_PORT     gpioPortC
+  #define KEYPAD_PIN0     0
+#else
+  #define KEYPAD_ACMP     ACMP1           // TG11: PC8-PC15
+  #define KEYPAD_PORT     gpioPortC
+  #define KEYPAD_PIN0     8
+#endif
+
+#define ROW_PIN(row)      (KEYPAD_PIN0 + KEYPAD_ROW_CH(row))
+#define COL_PIN(col)      (KEYPAD_PIN0 + KEYPAD_COL_CH(col))
+#define COL_INT_MASK      (((1 << KEYPAD_COLS) - 1) << COL_PIN(0))
+
+// RTCC channel and ticks between polls of the GPIO scanner
+#define POLL_CC           1
+#define POLL_TICKS        (32768 / SCAN_FREQ)
+
+/***************************************************************************//**
+ * Global variables*/
+ /******************************************************************************/
+
+volatile int lastKey = KEYPAD_ERR_NONE;   // Last key pressed
+volatile uint32_t keyPresses;             // Presses reported
+volatile uint32_t wakeups;                // Keypad interrupts that woke the core
+
+/**************************************************************************//**
+ * @brief Key press and release, LED0 is on while a key is held
+ *****************************************************************************/
+static void keyEvent(keypadEvent_TypeDef event, int key)
+{
+  if (event == keypadEventPress)
+  {
+    lastKey = key;
+    keyPresses++;
+    BSP_LedSet(0);
+  }
+  else
+    BSP_LedClear(0);
+}
+
+#ifdef KEYPAD_GPIO_SCAN
+
+static bool polling;
+static bool pressed;
+static uint32_t prevRows;
+
+/**************************************************************************//**
+ * @brief
+ *    Drive one row low at a time and read the columns. The rows are open
+ *    drain, so two keys in one column can not short a high row to a low row.
+ *
+ * @return
+ *    Active rows and columns in the LESENSE scan result layout
+ *****************************************************************************/
+static uint32_t gpioScan(void)
+{
+  uint32_t res = 0;
+  uint32_t cols;
+  int row, col;
+
+  for (row = 0; row < KEYPAD_ROWS; row++)
+    GPIO_PinOutSet(KEYPAD_PORT, ROW_PIN(row));
+
+  for (row = 0; row < KEYPAD_ROWS; row++)
+  {
+    GPIO_PinOutClear(KEYPAD_PORT, ROW_PIN(row));
+    cols = 0;
+    for (col = 0; col < KEYPAD_COLS; col++)
+    {
+      if (!GPIO_PinInGet(KEYPAD_PORT, COL_PIN(col)))
+        cols |= 1 << KEYPAD_COL_CH(col);
+    }
+    if (cols)
+      res |= cols | (1 << KEYPAD_ROW_CH(row));
+    GPIO_PinOutSet(KEYPAD_PORT, ROW_PIN(row));
+  }
+
+  // Idle with all rows low, so that any key pulls its column low
+  for (row = 0; row < KEYPAD_ROWS; row++)
+    GPIO_PinOutClear(KEYPAD_PORT, ROW_PIN(row));
+
+  return res;
+}
+
+static void pollStart(void)
+{
+  polling = true;
+  RTCC_ChannelCCVSet(POLL_CC, RTCC_CounterGet() + POLL_TICKS);
+  RTCC_IntClear(RTCC_IF_CC1);
+  RTCC_IntEnable(RTCC_IEN_CC1);
+}
+
+static void pollStop(void)
+{
+  polling = false;
+  RTCC_IntDisable(RTCC_IEN_CC1);
+  RTCC_IntClear(RTCC_IF_CC1);
+
+  GPIO_IntClear(_GPIO_IF_MASK);
+  GPIO_IntEnable(COL_INT_MASK);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    A column went low. Stop the column interrupts and poll until the
+ *    keypad has been released.
+ *****************************************************************************/
+static void columnIrq(void)
+{
+  uint32_t flags = GPIO_IntGet();
+
+  GPIO_IntClear(flags);
+  wakeups++;
+
+  if (!polling)
+  {
+    GPIO_IntDisable(flags);
+    prevRows = 0;
+    pollStart();
+  }
+}
+
+void GPIO_EVEN_IRQHandler(void)
+{
+  columnIrq();
+}
+
+void GPIO_ODD_IRQHandler(void)
+{
+  columnIrq();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Poll the keypad with the same debounce as the LESENSE decoder, a key
+ *    must be seen or not seen in two polls in a row.
+ *****************************************************************************/
+void RTCC_IRQHandler(void)
+{
+  uint32_t res;
+  uint32_t rows;
+
+  RTCC_IntClear(RTCC_IF_CC1);
+  wakeups++;
+
+  res = gpioScan();
+  rows = res & ((1 << KEYPAD_ROWS) - 1);
+
+  if (!pressed && rows && prevRows)
+  {
+    pressed = true;
+    keyEvent(keypadEventPress, keypadDecode(res));
+  }
+  else if (!rows && !prevRows)
+  {
+    if (pressed)
+    {
+      pressed = false;
+      keyEvent(keypadEventRelease, lastKey);
+    }
+    pollStop();
+    return;
+  }
+
+  prevRows = rows;
+  RTCC_ChannelCCVSet(POLL_CC, RTCC_ChannelCCVGet(POLL_CC) + POLL_TICKS);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Rows are open drain outputs driven low and columns are inputs with
+ *    pull-ups that interrupt on the falling edge. The RTCC counts the LFXO.
+ *****************************************************************************/
+static void gpioScanInit(void)
+{
+  RTCC_Init_TypeDef rtcc = RTCC_INIT_DEFAULT;
+  RTCC_CCChConf_TypeDef compCfg = RTCC_CH_INIT_COMPARE_DEFAULT;
+  int i;
+
+  for (i = 0; i < KEYPAD_ROWS; i++)
+    GPIO_PinModeSet(KEYPAD_PORT, ROW_PIN(i), gpioModeWiredAnd, 0);
+
+  for (i = 0; i < KEYPAD_COLS; i++)
+  {
+    GPIO_PinModeSet(KEYPAD_PORT, COL_PIN(i), gpioModeInputPullFilter, 1);
+    GPIO_ExtIntConfig(KEYPAD_PORT, COL_PIN(i), COL_PIN(i), false, true, false);
+  }
+
+  CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_LFXO);
+  CMU_ClockEnable(cmuClock_RTCC, true);
+  rtcc.presc = rtccCntPresc_1;
+  RTCC_Init(&rtcc);
+  RTCC_ChannelInit(POLL_CC, &compCfg);
+
+  NVIC_ClearPendingIRQ(RTCC_IRQn);
+  NVIC_EnableIRQ(RTCC_IRQn);
+  NVIC_ClearPendingIRQ(GPIO_EVEN_IRQn);
+  NVIC_EnableIRQ(GPIO_EVEN_IRQn);
+  NVIC_ClearPendingIRQ(GPIO_ODD_IRQn);
+  NVIC_EnableIRQ(GPIO_ODD_IRQn);
+
+  pollStop();
+}
+
+#else
+
+/**************************************************************************//**
+ * @brief LESENSE event, counts the wake-ups and passes the event on
+ *****************************************************************************/
+static void lesenseEvent(keypadEvent_TypeDef event, int key)
+{
+  wakeups++;
+  keyEvent(event, key);
+}
+
+#endif
+
+/***************************************************************************//**
+ * @brief  Main function
+ ******************************************************************************/
+int main(void)
+{
+  /*Initialize DCDC for series 1 board*/
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_STK_DEFAULT;
+#ifndef KEYPAD_GPIO_SCAN
+  keypadInit_TypeDef keypad = {
+    .acmp = KEYPAD_ACMP,
+    .scanHz = SCAN_FREQ,
+    .callback = lesenseEvent,
+  };
+  int i;
+#endif
+
+  /* Chip errata */
+  CHIP_Init();
+
+  // Init DCDC regulator with kit specific parameters
+  EMU_DCDCInit(&dcdcInit);
+
+  /* Initialize LED Driver*/
+  BSP_LedsInit();
+
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+#ifdef KEYPAD_GPIO_SCAN
+  gpioScanInit();
+#else
+  // The channel pins are analog, LESENSE drives them and the ACMP samples them
+  for (i = 0; i < KEYPAD_ROWS + KEYPAD_COLS; i++)
+    GPIO_PinModeSet(KEYPAD_PORT, KEYPAD_PIN0 + i, gpioModeDisabled, 0);
+
+  // LFXO as LESENSE clock source
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFXO);
+  keypadInit(&keypad);
+#endif
+
+  while (1)
+    EMU_EnterEM2(false);
+}
@@ -0,0 +1,317 @@
+/***************************************************************************//**
+ * @file keypad_test.c
+ * @brief Host test of keypad.c: key decoding and the decoder debounce, with a
+ * simulation of the LESENSE decoder
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/keypad_test.c -o keypad_test
+//   ./keypad_test
+//
+// keypad.c is included rather than linked, so the test can check the decoder
+// state against STATE_IDLE and call LESENSE_IRQHandler() the way the decoder
+// interrupt would. The program prints one line per failed check and exits
+// with status 1 if any check failed.
+
+#include "keypad.c"
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define DECODER_STATES  (16)
+#define MAX_EVENTS      (8)
+#define RANDOM_SCANS    (20000)
+
+static int checks;
+static int failures;
+
+static uint32_t seed = 98;
+
+ACMP_TypeDef hostAcmp0;
+ACMP_TypeDef hostAcmp1;
+
+// Simulated decoder
+static LESENSE_DecStDesc_TypeDef decoder[DECODER_STATES];
+static uint32_t decoderState;
+static uint32_t scanResult;
+
+static int eventCount;
+static keypadEvent_TypeDef events[MAX_EVENTS];
+static int eventKeys[MAX_EVENTS];
+
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+void LESENSE_DecoderStateConfig(const LESENSE_DecStDesc_TypeDef *confDecSt,
+                                uint32_t decSt)
+{
+  if (decSt < DECODER_STATES) {
+    decoder[decSt] = *confDecSt;
+  }
+}
+
+uint32_t LESENSE_DecoderStateGet(void)
+{
+  return decoderState;
+}
+
+uint32_t LESENSE_ScanResultGet(void)
+{
+  return scanResult;
+}
+
+static void keyEvent(keypadEvent_TypeDef event, int key)
+{
+  if (eventCount < MAX_EVENTS) {
+    events[eventCount] = event;
+    eventKeys[eventCount] = key;
+  }
+  eventCount++;
+}
+
+static bool condMatch(const LESENSE_DecStCond_TypeDef *cond, uint32_t in)
+{
+  return ((in ^ cond->compVal) & ~cond->compMask & ROWS_MASK) == 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   One scan as the decoder sees it: the descriptors of the current state
+ *   are tried in order through the chain, confA before confB, and the first
+ *   match moves the decoder and may interrupt the core.
+ ******************************************************************************/
+static void scan(uint32_t res)
+{
+  uint32_t in = res & ROWS_MASK;
+  uint32_t desc = decoderState;
+  const LESENSE_DecStCond_TypeDef *cond;
+
+  scanResult = res;
+  for (;;) {
+    cond = NULL;
+    if (condMatch(&decoder[desc].confA, in)) {
+      cond = &decoder[desc].confA;
+    } else if (condMatch(&decoder[desc].confB, in)) {
+      cond = &decoder[desc].confB;
+    }
+    if (cond != NULL) {
+      decoderState = cond->nextState;
+      if (cond->setInt) {
+        LESENSE_IRQHandler();
+      }
+      return;
+    }
+    if (!decoder[desc].chainDesc || desc + 1 >= DECODER_STATES) {
+      return;
+    }
+    desc++;
+  }
+}
+
+static uint32_t keyResult(int key)
+{
+  return (1u << KEYPAD_ROW_CH(key / KEYPAD_COLS))
+         | (1u << KEYPAD_COL_CH(key % KEYPAD_COLS));
+}
+
+static void start(void)
+{
+  keypadInit_TypeDef init = { ACMP0, 50, keyEvent };
+
+  keypadInit(&init);
+  decoderState = STATE_IDLE;
+  eventCount = 0;
+}
+
+/***************************************************************************//**
+ * @brief Every scan result decodes to the key, no key or several keys
+ ******************************************************************************/
+static void testDecode(void)
+{
+  uint32_t res;
+  int rows, cols, key;
+
+  for (res = 0; res <= KEYPAD_CH_MASK; res++) {
+    rows = __builtin_popcount(res & ROWS_MASK);
+    cols = __builtin_popcount(res >> KEYPAD_ROWS);
+    key = keypadDecode(res);
+    if (rows == 0 || cols == 0) {
+      CHECK(key == KEYPAD_ERR_NONE);
+    } else if (rows > 1 || cols > 1) {
+      CHECK(key == KEYPAD_ERR_MULTI);
+    } else {
+      CHECK(key >= 0 && key < KEYPAD_ROWS * KEYPAD_COLS);
+      CHECK(keyResult(key) == res);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Each key, with a bounce on press, during the hold and on release
+ ******************************************************************************/
+static void testDebounce(void)
+{
+  int key;
+
+  start();
+  for (key = 0; key < KEYPAD_ROWS * KEYPAD_COLS; key++) {
+    eventCount = 0;
+
+    // Seen in one scan only
+    scan(keyResult(key));
+    scan(0);
+    CHECK(eventCount == 0);
+    CHECK(decoderState == STATE_IDLE);
+
+    scan(keyResult(key));
+    scan(keyResult(key));
+    CHECK(eventCount == 1);
+    CHECK(events[0] == keypadEventPress && eventKeys[0] == key);
+
+    // Released for one scan while held
+    scan(0);
+    scan(keyResult(key));
+    scan(keyResult(key));
+    CHECK(eventCount == 1);
+
+    scan(0);
+    scan(0);
+    CHECK(eventCount == 2);
+    CHECK(events[1] == keypadEventRelease && eventKeys[1] == key);
+    CHECK(decoderState == STATE_IDLE);
+
+    // Idle scans do not wake the core
+    scan(0);
+    scan(0);
+    CHECK(eventCount == 2);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Two keys at once are reported as KEYPAD_ERR_MULTI
+ ******************************************************************************/
+static void testMulti(void)
+{
+  uint32_t res[] = {
+    keyResult(0) | keyResult(15),       // Different rows and columns
+    keyResult(4) | keyResult(5),        // Same row
+    keyResult(2) | keyResult(14),       // Same column
+  };
+  unsigned i;
+
+  start();
+  for (i = 0; i < sizeof(res) / sizeof(res[0]); i++) {
+    eventCount = 0;
+    scan(res[i]);
+    scan(res[i]);
+    CHECK(eventCount == 1);
+    CHECK(events[0] == keypadEventPress && eventKeys[0] == KEYPAD_ERR_MULTI);
+    scan(0);
+    scan(0);
+    CHECK(eventCount == 2);
+    CHECK(events[1] == keypadEventRelease);
+    CHECK(eventKeys[1] == KEYPAD_ERR_MULTI);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Random scan results, mostly no key or one key, against a model of the
+ *   two-scan debounce.
+ ******************************************************************************/
+static void testRandom(void)
+{
+  int seen = 0;                         // Scans in a row with a row active
+  int idle = 0;                         // Scans in a row without
+  bool held = false;
+  int heldKey = KEYPAD_ERR_NONE;
+  uint32_t res;
+  int i, r;
+
+  start();
+  for (i = 0; i < RANDOM_SCANS; i++) {
+    r = random32() % 8;
+    if (r < 3) {
+      res = 0;
+    } else if (r < 7) {
+      res = keyResult(random32() % (KEYPAD_ROWS * KEYPAD_COLS));
+    } else {
+      res = random32() & KEYPAD_CH_MASK;
+    }
+
+    eventCount = 0;
+    scan(res);
+
+    if ((res & ROWS_MASK) != 0) {
+      seen++;
+      idle = 0;
+    } else {
+      idle++;
+      seen = 0;
+    }
+    if (!held && seen == 2) {
+      held = true;
+      heldKey = keypadDecode(res);
+      CHECK(eventCount == 1);
+      CHECK(events[0] == keypadEventPress && eventKeys[0] == heldKey);
+    } else if (held && idle == 2) {
+      held = false;
+      CHECK(eventCount == 1);
+      CHECK(events[0] == keypadEventRelease && eventKeys[0] == heldKey);
+    } else {
+      CHECK(eventCount == 0);
+    }
+  }
+}
+
+int main(void)
+{
+  testDecode();
+  testDebounce();
+  testMulti();
+  testRandom();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
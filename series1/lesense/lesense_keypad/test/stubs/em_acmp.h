@@ -0,0 +1,85 @@
+// Host stand-in for em_acmp.h, used by the tests in the parent directory.
+// Only the fields set by keypad.c are provided, and the functions do
+// nothing.
+#ifndef EM_ACMP_H
+#define EM_ACMP_H
+
+#include "em_device.h"
+
+typedef enum {
+  acmpInputRangeFull
+} ACMP_InputRange_TypeDef;
+
+typedef enum {
+  acmpAccuracyHigh
+} ACMP_Accuracy_TypeDef;
+
+typedef enum {
+  acmpPowerSourceAvdd
+} ACMP_PowerSource_TypeDef;
+
+typedef enum {
+  acmpVLPInputVADIV
+} ACMP_VLPInput_Typedef;
+
+typedef enum {
+  acmpVAInputVDD
+} ACMP_VAInput_TypeDef;
+
+typedef enum {
+  acmpInputVADIV,
+  acmpInputAPORT0XCH0
+} ACMP_Channel_TypeDef;
+
+typedef enum {
+  acmpExternalInputAPORT0X
+} ACMP_ExternalInput_Typedef;
+
+typedef struct {
+  bool fullBias;
+  uint32_t biasProg;
+  ACMP_InputRange_TypeDef inputRange;
+  ACMP_Accuracy_TypeDef accuracy;
+  ACMP_PowerSource_TypeDef powerSource;
+  ACMP_VLPInput_Typedef vlpInput;
+} ACMP_Init_TypeDef;
+
+typedef struct {
+  ACMP_VAInput_TypeDef input;
+  uint32_t div0;
+  uint32_t div1;
+} ACMP_VAConfig_TypeDef;
+
+#define ACMP_INIT_DEFAULT               { 0 }
+#define ACMP_VACONFIG_DEFAULT           { 0 }
+
+static inline void ACMP_Init(ACMP_TypeDef *acmp, const ACMP_Init_TypeDef *init)
+{
+  (void)acmp;
+  (void)init;
+}
+
+static inline void ACMP_VASetup(ACMP_TypeDef *acmp,
+                                const ACMP_VAConfig_TypeDef *config)
+{
+  (void)acmp;
+  (void)config;
+}
+
+static inline void ACMP_ChannelSet(ACMP_TypeDef *acmp,
+                                   ACMP_Channel_TypeDef negSel,
+                                   ACMP_Channel_TypeDef posSel)
+{
+  (void)acmp;
+  (void)negSel;
+  (void)posSel;
+}
+
+static inline void ACMP_ExternalInputSelect(ACMP_TypeDef *acmp,
+                                            ACMP_ExternalInput_Typedef aport)
+{
+  (void)acmp;
+  (void)aport;
+}
+
+#endif // EM_ACMP_H
@@ -0,0 +1,20 @@
+// Host stand-in for em_cmu.h, used by the tests in the parent directory.
+#ifndef EM_CMU_H
+#define EM_CMU_H
+
+#include "em_device.h"
+
+typedef enum {
+  cmuClock_ACMP0,
+  cmuClock_ACMP1,
+  cmuClock_HFLE,
+  cmuClock_LESENSE
+} CMU_Clock_TypeDef;
+
+static inline void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void)clock;
+  (void)enable;
+}
+
+#endif // EM_CMU_H
@@ -0,0 +1,39 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// Only the ACMP instances, the CMSIS CLZ function and the NVIC functions
+// used by keypad.c are provided.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint32_t unused;
+} ACMP_TypeDef;
+
+typedef enum {
+  LESENSE_IRQn
+} IRQn_Type;
+
+extern ACMP_TypeDef hostAcmp0;
+extern ACMP_TypeDef hostAcmp1;
+
+#define ACMP0                           (&hostAcmp0)
+#define ACMP1                           (&hostAcmp1)
+
+static inline uint32_t __CLZ(uint32_t x)
+{
+  return (x != 0) ? (uint32_t)__builtin_clz(x) : 32;
+}
+
+static inline void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+static inline void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+#endif // EM_DEVICE_H
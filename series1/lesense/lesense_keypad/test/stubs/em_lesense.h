@@ -0,0 +1,161 @@
+// Host stand-in for em_lesense.h, used by the tests in the parent directory.
+// Only the fields set by keypad.c are provided. The decoder and scan result
+// functions are implemented by the test, the others do nothing.
+#ifndef EM_LESENSE_H
+#define EM_LESENSE_H
+
+#include "em_device.h"
+
+#define LESENSE_IFC_DEC                 (0x1UL << 8)
+#define LESENSE_IEN_DEC                 (0x1UL << 8)
+#define _LESENSE_IFC_MASK               0x007FFFFFUL
+
+typedef enum {
+  lesenseTransActNone
+} LESENSE_StTransAct_TypeDef;
+
+typedef enum {
+  lesenseScanStartPeriodic
+} LESENSE_ScanMode_TypeDef;
+
+typedef enum {
+  lesenseBiasModeDutyCycle
+} LESENSE_BiasMode_TypeDef;
+
+typedef enum {
+  lesenseACMPModeDisable,
+  lesenseACMPModeMux
+} LESENSE_ControlACMP_TypeDef;
+
+typedef enum {
+  lesenseWarmupModeNormal
+} LESENSE_WarmupMode_TypeDef;
+
+typedef enum {
+  lesenseDecInputSensorSt
+} LESENSE_DecInput_TypeDef;
+
+typedef enum {
+  lesenseChPinExHigh
+} LESENSE_ChPinExMode_TypeDef;
+
+typedef enum {
+  lesenseChPinIdleLow
+} LESENSE_ChPinIdleMode_TypeDef;
+
+typedef enum {
+  lesenseClkHF
+} LESENSE_ChClk_TypeDef;
+
+typedef enum {
+  lesenseSampleModeACMP
+} LESENSE_ChSampleMode_TypeDef;
+
+typedef enum {
+  lesenseSetIntNone
+} LESENSE_ChIntMode_TypeDef;
+
+typedef enum {
+  lesenseClkDiv_1
+} LESENSE_ClkPresc_TypeDef;
+
+typedef struct {
+  uint8_t compVal;
+  uint8_t compMask;
+  uint8_t nextState;
+  LESENSE_StTransAct_TypeDef prsAct;
+  bool setInt;
+} LESENSE_DecStCond_TypeDef;
+
+typedef struct {
+  bool chainDesc;
+  LESENSE_DecStCond_TypeDef confA;
+  LESENSE_DecStCond_TypeDef confB;
+} LESENSE_DecStDesc_TypeDef;
+
+typedef struct {
+  struct {
+    LESENSE_ScanMode_TypeDef scanStart;
+    LESENSE_BiasMode_TypeDef biasMode;
+  } coreCtrl;
+  struct {
+    LESENSE_ControlACMP_TypeDef acmp0Mode;
+    LESENSE_ControlACMP_TypeDef acmp1Mode;
+    LESENSE_WarmupMode_TypeDef warmupMode;
+  } perCtrl;
+  struct {
+    LESENSE_DecInput_TypeDef decInput;
+    uint32_t initState;
+  } decCtrl;
+} LESENSE_Init_TypeDef;
+
+typedef struct {
+  bool enaScanCh;
+  bool enaPin;
+  bool enaInt;
+  LESENSE_ChPinExMode_TypeDef chPinExMode;
+  LESENSE_ChPinIdleMode_TypeDef chPinIdleMode;
+  bool invRes;
+  LESENSE_ChClk_TypeDef exClk;
+  LESENSE_ChClk_TypeDef sampleClk;
+  uint8_t exTime;
+  uint8_t sampleDelay;
+  uint8_t measDelay;
+  LESENSE_ChSampleMode_TypeDef sampleMode;
+  LESENSE_ChIntMode_TypeDef intMode;
+} LESENSE_ChDesc_TypeDef;
+
+#define LESENSE_INIT_DEFAULT            { { 0 }, { 0 }, { 0 } }
+#define LESENSE_CH_CONF_DEFAULT         { 0 }
+
+void LESENSE_DecoderStateConfig(const LESENSE_DecStDesc_TypeDef *confDecSt,
+                                uint32_t decSt);
+uint32_t LESENSE_DecoderStateGet(void);
+uint32_t LESENSE_ScanResultGet(void);
+
+static inline void LESENSE_Init(const LESENSE_Init_TypeDef *init,
+                                bool reqReset)
+{
+  (void)init;
+  (void)reqReset;
+}
+
+static inline void LESENSE_ChannelConfig(const LESENSE_ChDesc_TypeDef *confCh,
+                                         uint32_t chIdx)
+{
+  (void)confCh;
+  (void)chIdx;
+}
+
+static inline uint32_t LESENSE_ScanFreqSet(uint32_t refFreq, uint32_t scanFreq)
+{
+  (void)refFreq;
+  return scanFreq;
+}
+
+static inline void LESENSE_ClkDivSet(LESENSE_ChClk_TypeDef clk,
+                                     LESENSE_ClkPresc_TypeDef clkDiv)
+{
+  (void)clk;
+  (void)clkDiv;
+}
+
+static inline void LESENSE_IntClear(uint32_t flags)
+{
+  (void)flags;
+}
+
+static inline void LESENSE_IntEnable(uint32_t flags)
+{
+  (void)flags;
+}
+
+static inline void LESENSE_DecoderStart(void)
+{
+}
+
+static inline void LESENSE_ScanStart(void)
+{
+}
+
+#endif // EM_LESENSE_H
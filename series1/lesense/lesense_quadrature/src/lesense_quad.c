@@ -0,0 +1,376 @@
+/***************************************************************************//**
+ * @file lesense_quad.c
+ * @brief Quadrature counting with the LESENSE decoder and the PCNT in EM2
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_lesense.h"
+#include "em_pcnt.h"
+#include "em_prs.h"
+#include "lesense_quad.h"
+#include <stddef.h>
+
+// Two sensors A and B step through a Gray code cycle of four positions,
+// forward when A leads B. The decoder has one state per position, and its
+// inputs are the sensor states of LESENSE channels 0-3. Each state has a
+// transition to the next position that counts up, one to the previous
+// position that counts down, and one to the opposite position for a step
+// that was missed, which does not count. Each state is two chained
+// descriptors.
+//
+// With PRS count mode, the decoder pulses PRS output 0 on each count and
+// drives PRS output 1 with the direction. The PCNT counts the pulses in
+// single input oversampling mode, with S1 as the direction, so rotations
+// are counted in EM2 without the core. Its top value is threshold - 1, so
+// it overflows or underflows every threshold counts, and it interrupts on
+// a direction change.
+//
+// At X1 and X2 resolution, only some edges count. A step over a counted
+// edge counts up forward and down backward, so jitter on that edge counts
+// +1 -1 and not +1 +1.
+
+// Decoder state of a position
+#define STATE(pos)      (2 * (pos))
+
+// Sensor states in forward order, bit 0 is A and bit 1 is B
+static const uint8_t cycle[4] = { 0x0, 0x1, 0x3, 0x2 };
+
+static lesenseQuadInit_TypeDef config;
+static volatile int32_t wraps;
+static volatile uint32_t errors;
+
+/***************************************************************************//**
+ * @brief Decoder input bits of a position
+ ******************************************************************************/
+static uint32_t inputsOf(const lesenseQuadTable_TypeDef *table, uint32_t pos)
+{
+  uint32_t ab = cycle[pos & 3];
+
+  return ((ab & 1) << table->inputA) | ((ab >> 1) << table->inputB);
+}
+
+/***************************************************************************//**
+ * @brief True if the edge from pos to pos + 1 counts
+ ******************************************************************************/
+static bool edgeCounts(lesenseQuadRes_TypeDef resolution, uint32_t pos)
+{
+  switch (resolution) {
+    case lesenseQuadX4:
+      return true;
+    case lesenseQuadX2:
+      return pos == 1 || pos == 3;
+    default:
+      return pos == 3;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Transition to a position
+ ******************************************************************************/
+static LESENSE_DecStCond_TypeDef transition(const lesenseQuadTable_TypeDef *table,
+                                            uint32_t pos,
+                                            LESENSE_StTransAct_TypeDef action,
+                                            bool irq)
+{
+  LESENSE_DecStCond_TypeDef cond;
+
+  cond.compVal = inputsOf(table, pos);
+  cond.compMask = 0xF & ~((1 << table->inputA) | (1 << table->inputB));
+  cond.nextState = STATE(pos);
+  cond.prsAct = action;
+  cond.setInt = irq;
+  return cond;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Build the decoder state table.
+ *
+ * @param[in] config
+ *   Sensor inputs and counting.
+ *
+ * @param[out] table
+ *   Decoder state descriptors, descriptor n is for LESENSE_DecoderStateConfig()
+ *   with decSt n.
+ *
+ * @param[in] size
+ *   Number of descriptors in table.
+ *
+ * @return
+ *   Number of descriptors written, LESENSE_QUAD_STATES, or
+ *   LESENSE_QUAD_ERR_PARAM.
+ ******************************************************************************/
+int lesenseQuadTableBuild(const lesenseQuadTable_TypeDef *config,
+                          LESENSE_DecStDesc_TypeDef *table,
+                          uint32_t size)
+{
+  LESENSE_StTransAct_TypeDef up;
+  LESENSE_StTransAct_TypeDef down;
+  uint32_t pos;
+  uint32_t next;
+  uint32_t prev;
+
+  if (size < LESENSE_QUAD_STATES
+      || config->inputA > 3 || config->inputB > 3
+      || config->inputA == config->inputB
+      || (config->resolution != lesenseQuadX1
+          && config->resolution != lesenseQuadX2
+          && config->resolution != lesenseQuadX4)) {
+    return LESENSE_QUAD_ERR_PARAM;
+  }
+
+  up = config->reverse ? lesenseTransActDown : lesenseTransActUp;
+  down = config->reverse ? lesenseTransActUp : lesenseTransActDown;
+
+  for (pos = 0; pos < 4; pos++) {
+    next = (pos + 1) & 3;
+    prev = (pos + 3) & 3;
+
+    table[STATE(pos)].chainDesc = true;
+    table[STATE(pos)].confA = transition(config, next,
+                                         edgeCounts(config->resolution, pos)
+                                         ? up : lesenseTransActNone,
+                                         false);
+    table[STATE(pos)].confB = transition(config, prev,
+                                         edgeCounts(config->resolution, prev)
+                                         ? down : lesenseTransActNone,
+                                         false);
+
+    table[STATE(pos) + 1].chainDesc = false;
+    table[STATE(pos) + 1].confA = transition(config, (pos + 2) & 3,
+                                             lesenseTransActNone,
+                                             config->errorInt);
+    table[STATE(pos) + 1].confB = table[STATE(pos) + 1].confA;
+  }
+
+  return LESENSE_QUAD_STATES;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decoder state of the position given by the sensor states.
+ *
+ * @param[in] config
+ *   Sensor inputs.
+ *
+ * @param[in] sensorState
+ *   Sensor states, bit n is decoder input n.
+ ******************************************************************************/
+uint32_t lesenseQuadStateFind(const lesenseQuadTable_TypeDef *config,
+                              uint32_t sensorState)
+{
+  uint32_t mask = (1 << config->inputA) | (1 << config->inputB);
+  uint32_t pos;
+
+  for (pos = 0; pos < 3; pos++) {
+    if (((sensorState ^ inputsOf(config, pos)) & mask) == 0) {
+      break;
+    }
+  }
+  return STATE(pos);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Count overflow or underflow, and direction change.
+ ******************************************************************************/
+void PCNT0_IRQHandler(void)
+{
+  uint32_t flags = PCNT_IntGet(PCNT0);
+
+  PCNT_IntClear(PCNT0, flags);
+
+  if (flags & PCNT_IF_OF) {
+    wraps++;
+  }
+  if (flags & PCNT_IF_UF) {
+    wraps--;
+  }
+
+  if (config.callback != NULL) {
+    if (flags & (PCNT_IF_OF | PCNT_IF_UF)) {
+      config.callback(lesenseQuadEventThreshold, lesenseQuadCountGet());
+    }
+    if (flags & PCNT_IF_DIRCNG) {
+      config.callback(lesenseQuadEventDirection, lesenseQuadCountGet());
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A step was missed, the decoder has moved to the opposite position
+ *   without counting.
+ ******************************************************************************/
+void LESENSE_IRQHandler(void)
+{
+  LESENSE_IntClear(LESENSE_IFC_DEC);
+  errors++;
+
+  if (config.callback != NULL) {
+    config.callback(lesenseQuadEventError, lesenseQuadCountGet());
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Program the decoder and the PCNT, and start scanning and counting.
+ *
+ * @details
+ *   LESENSE must be initialized with periodic scans, the sensor states as
+ *   decoder input and PRS count mode (decCtrl.prsCount), and the sensor
+ *   channels configured, but not started. The first scan is waited for, so
+ *   that the decoder starts in the position of the sensors.
+ *
+ * @param[in] init
+ *   Configuration.
+ *
+ * @return
+ *   0, or LESENSE_QUAD_ERR_PARAM.
+ ******************************************************************************/
+int lesenseQuadInit(const lesenseQuadInit_TypeDef *init)
+{
+  LESENSE_DecStDesc_TypeDef table[LESENSE_QUAD_STATES];
+  PCNT_Init_TypeDef pcntInit = PCNT_INIT_DEFAULT;
+  int count;
+  int i;
+
+  count = lesenseQuadTableBuild(&init->table, table, LESENSE_QUAD_STATES);
+  if (count < 0) {
+    return count;
+  }
+  if (init->threshold == 0 || init->threshold > 0x10000
+      || init->prsCount == init->prsDir) {
+    return LESENSE_QUAD_ERR_PARAM;
+  }
+
+  config = *init;
+  wraps = 0;
+  errors = 0;
+
+  for (i = 0; i < count; i++) {
+    LESENSE_DecoderStateConfig(&table[i], i);
+  }
+
+  // Count pulses and direction to the PCNT
+  CMU_ClockEnable(cmuClock_PRS, true);
+  PRS_SourceSignalSet(init->prsCount, PRS_CH_CTRL_SOURCESEL_LESENSED,
+                      PRS_CH_CTRL_SIGSEL_LESENSEDEC0, prsEdgeOff);
+  PRS_SourceSignalSet(init->prsDir, PRS_CH_CTRL_SOURCESEL_LESENSED,
+                      PRS_CH_CTRL_SIGSEL_LESENSEDEC1, prsEdgeOff);
+
+  CMU_ClockEnable(cmuClock_PCNT0, true);
+  pcntInit.mode = pcntModeOvsSingle;
+  pcntInit.counter = 0;
+  pcntInit.top = init->threshold - 1;
+  pcntInit.s1CntDir = true;
+  pcntInit.s0PRS = (PCNT_PRSSel_TypeDef)init->prsCount;
+  pcntInit.s1PRS = (PCNT_PRSSel_TypeDef)init->prsDir;
+  PCNT_Init(PCNT0, &pcntInit);
+  PCNT_PRSInputEnable(PCNT0, pcntPRSInputS0, true);
+  PCNT_PRSInputEnable(PCNT0, pcntPRSInputS1, true);
+
+  PCNT_IntClear(PCNT0, _PCNT_IFC_MASK);
+  PCNT_IntEnable(PCNT0, PCNT_IEN_OF | PCNT_IEN_UF | PCNT_IEN_DIRCNG);
+  NVIC_ClearPendingIRQ(PCNT0_IRQn);
+  NVIC_EnableIRQ(PCNT0_IRQn);
+
+  // Start in the position of the sensors, so that nothing is counted
+  LESENSE_IntClear(LESENSE_IFC_SCANCOMPLETE | LESENSE_IFC_DEC);
+  LESENSE_ScanStart();
+  while (!(LESENSE_IntGet() & LESENSE_IF_SCANCOMPLETE)) {
+  }
+  LESENSE->DECSTATE = lesenseQuadStateFind(&init->table,
+                                           LESENSE_SensorStateGet());
+
+  if (init->table.errorInt) {
+    LESENSE_IntEnable(LESENSE_IEN_DEC);
+    NVIC_ClearPendingIRQ(LESENSE_IRQn);
+    NVIC_EnableIRQ(LESENSE_IRQn);
+  }
+  LESENSE_DecoderStart();
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Counts since lesenseQuadInit(), positive forward.
+ ******************************************************************************/
+int32_t lesenseQuadCountGet(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  uint32_t flags;
+  uint32_t counter;
+  int32_t count;
+
+  CORE_ENTER_ATOMIC();
+
+  // A wrap that is not yet handled is in the interrupt flags. Read the
+  // counter again if it wrapped while it was read.
+  flags = PCNT_IntGet(PCNT0);
+  counter = PCNT_CounterGet(PCNT0);
+  if (PCNT_IntGet(PCNT0) != flags) {
+    flags = PCNT_IntGet(PCNT0);
+    counter = PCNT_CounterGet(PCNT0);
+  }
+
+  count = wraps;
+  if (flags & PCNT_IF_OF) {
+    count++;
+  }
+  if (flags & PCNT_IF_UF) {
+    count--;
+  }
+  count = count * (int32_t)config.threshold + (int32_t)counter;
+
+  CORE_EXIT_ATOMIC();
+  return count;
+}
+
+/***************************************************************************//**
+ * @brief True if the last count was down
+ ******************************************************************************/
+bool lesenseQuadDownGet(void)
+{
+  return (PCNT0->STATUS & PCNT_STATUS_DIR) != 0;
+}
+
+/***************************************************************************//**
+ * @brief Missed steps since lesenseQuadInit()
+ ******************************************************************************/
+uint32_t lesenseQuadErrorsGet(void)
+{
+  return errors;
+}
@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * @file lesense_quad.h
+ * @brief Quadrature counting with the LESENSE decoder and the PCNT in EM2
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef LESENSE_QUAD_H
+#define LESENSE_QUAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "em_lesense.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Decoder states used, two chained descriptors for each of the four
+// quadrature positions
+#define LESENSE_QUAD_STATES             (8)
+
+// Invalid configuration
+#define LESENSE_QUAD_ERR_PARAM          (-0x5080)
+
+typedef enum {
+  lesenseQuadX1 = 1,                    // One count per cycle
+  lesenseQuadX2 = 2,                    // Two counts per cycle
+  lesenseQuadX4 = 4,                    // A count on every edge
+} lesenseQuadRes_TypeDef;
+
+typedef struct {
+  uint8_t inputA;                       // Decoder input of sensor A, 0-3
+  uint8_t inputB;                       // Decoder input of sensor B, 0-3
+  lesenseQuadRes_TypeDef resolution;
+  bool reverse;                         // Count down when A leads B
+  bool errorInt;                        // Interrupt when a step is missed
+} lesenseQuadTable_TypeDef;
+
+typedef enum {
+  lesenseQuadEventThreshold,            // Counted threshold counts further
+  lesenseQuadEventDirection,            // Count direction changed
+  lesenseQuadEventError,                // Both sensors changed in one scan
+} lesenseQuadEvent_TypeDef;
+
+// Called from the PCNT0 and LESENSE interrupt handlers
+typedef void (*lesenseQuadCallback_TypeDef)(lesenseQuadEvent_TypeDef event,
+                                            int32_t count);
+
+typedef struct {
+  lesenseQuadTable_TypeDef table;
+  uint32_t threshold;                   // Counts between wake-ups, 1-65536
+  unsigned int prsCount;                // PRS channel for the count pulses
+  unsigned int prsDir;                  // PRS channel for the direction
+  lesenseQuadCallback_TypeDef callback;
+} lesenseQuadInit_TypeDef;
+
+int lesenseQuadTableBuild(const lesenseQuadTable_TypeDef *config,
+                          LESENSE_DecStDesc_TypeDef *table,
+                          uint32_t size);
+uint32_t lesenseQuadStateFind(const lesenseQuadTable_TypeDef *config,
+                              uint32_t sensorState);
+int lesenseQuadInit(const lesenseQuadInit_TypeDef *init);
+int32_t lesenseQuadCountGet(void);
+bool lesenseQuadDownGet(void);
+uint32_t lesenseQuadErrorsGet(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LESENSE_QUAD_H
@@ -0,0 +1,273 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief LESENSE quadrature counting demo. Two sensors on LESENSE channels 0
+ * and 1 are decoded by the LESENSE decoder and counted by the PCNT in EM2.
+ * The core wakes up every COUNT_THRESHOLD counts and when the direction
+ * changes. LED0 toggles every COUNT_THRESHOLD counts, and LED1 is on while
+ * the count goes down.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "em_device.h"
+#include "em_acmp.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_lesense.h"
+
+#include "bsp.h"
+#include "lesense_quad.h"
+
+/***************************************************************************//**
+ * Macro definitions*/
+ /******************************************************************************/
+
+// Sensor A on LESENSE channel 0 and sensor B on channel 1
+#if defined(_SILICON_LABS_GECKO_INTERNAL_SDID_100)
+  #define SENSOR_ACMP     ACMP0           // GG11: PC0 and PC1
+  #define SENSOR_PORT     gpioPortC
+  #define SENSOR_PIN0     0
+#else
+  #define SENSOR_ACMP     ACMP1           // TG11: PC8 and PC9
+  #define SENSOR_PORT     gpioPortC
+  #define SENSOR_PIN0     8
+#endif
+
+// The sensors may change at most once per scan, so this limits the speed
+// to LESENSE_SCAN_FREQ / 4 cycles per second
+#define LESENSE_SCAN_FREQ 500
+
+// Counts between wake-ups
+#define COUNT_THRESHOLD   100
+
+// PRS channels for the decoder count and direction
+#define PRS_CH_COUNT      0
+#define PRS_CH_DIR        1
+
+/***************************************************************************//**
+ * Global variables*/
+ /******************************************************************************/
+
+volatile int32_t count;                   // Count at the last wake-up
+volatile bool countDown;                  // Last direction
+volatile uint32_t missedSteps;            // Both sensors changed in one scan
+volatile uint32_t wakeups;                // Interrupts that woke the core
+
+/**************************************************************************//**
+ * @brief Quadrature events
+ *****************************************************************************/
+static void quadEvent(lesenseQuadEvent_TypeDef event, int32_t newCount)
+{
+  wakeups++;
+
+  if (event == lesenseQuadEventThreshold)
+    BSP_LedToggle(0);
+  else if (event == lesenseQuadEventDirection)
+  {
+    countDown = lesenseQuadDownGet();
+    if (countDown)
+      BSP_LedSet(1);
+    else
+      BSP_LedClear(1);
+  }
+  else
+    missedSteps = lesenseQuadErrorsGet();
+
+  count = newCount;
+}
+
+/**************************************************************************//**
+ * @brief  Sets up the ACMP to compare the sensor pins with VDD/2
+ *****************************************************************************/
+static void setupACMP(void)
+{
+  // ACMP configuration constant table.
+  static const ACMP_Init_TypeDef initACMP =
+  {
+    .fullBias                 = true,                  // fullBias
+    .biasProg                 = 0x1F,                  // biasProg
+    .interruptOnFallingEdge   = false,                 // interrupt on rising edge
+    .interruptOnRisingEdge    = false,                 // interrupt on falling edge
+    .inputRange               = acmpInputRangeFull,    // Full ACMP rang
+    .accuracy                 = acmpAccuracyHigh,      // high accuracy
+    .powerSource              = acmpPowerSourceAvdd,   // Use AVDD as power source, default to 3.3V
+    .hysteresisLevel_0        = acmpHysteresisLevel0,  // hysteresis level 0
+    .hysteresisLevel_1        = acmpHysteresisLevel0,  // hysteresis level 1
+    .vlpInput                 = acmpVLPInputVADIV,     // Use VADIV as the VLP input source.
+    .inactiveValue            = false,                 // no inactive value
+    .enable                   = true                   // Enable after init
+  };
+
+  static const ACMP_VAConfig_TypeDef initVa =
+  {
+    acmpVAInputVDD,                                    // Use VDD as input for VA
+    32,                                                // VA divider when ACMP output is 0, VDD/2
+    32                                                 // VA divider when ACMP output is 1, VDD/2
+  };
+
+  CMU_ClockEnable(SENSOR_ACMP == ACMP0 ? cmuClock_ACMP0 : cmuClock_ACMP1, true);
+
+  //Initialize ACMP
+  ACMP_Init(SENSOR_ACMP, &initACMP);
+
+  //Setup VADIV
+  ACMP_VASetup(SENSOR_ACMP, &initVa);
+
+  //Set ACMP CH0
+  ACMP_ChannelSet(SENSOR_ACMP, acmpInputVADIV, acmpInputAPORT0XCH0);
+
+  //Enable LESENSE control of ACMP
+  ACMP_ExternalInputSelect(SENSOR_ACMP, acmpExternalInputAPORT0X);
+}
+
+/**************************************************************************//**
+ * @brief GPIO initialization
+ *****************************************************************************/
+void initGPIO(void)
+{
+  // Enable GPIO clock
+  CMU_ClockEnable(cmuClock_GPIO, true);
+
+  // Configure the sensor pins as input with filter enabled
+  GPIO_PinModeSet(SENSOR_PORT, SENSOR_PIN0, gpioModeInputPullFilter, 0);
+  GPIO_PinModeSet(SENSOR_PORT, SENSOR_PIN0 + 1, gpioModeInputPullFilter, 0);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Sets up LESENSE to sample the two sensor channels, with the sensor
+ *    states as decoder input. The decoder and the scans are started by
+ *    lesenseQuadInit().
+ *****************************************************************************/
+static void setupLESENSE(void)
+{
+  LESENSE_Init_TypeDef initLesense = LESENSE_INIT_DEFAULT;
+
+  // Channel configuration
+  static const LESENSE_ChDesc_TypeDef initLesenseCh =
+  {
+    .enaScanCh     = true,
+    .enaPin        = true,
+    .enaInt        = false,
+    .chPinExMode   = lesenseChPinExDis,       //Disable excitation
+    .chPinIdleMode = lesenseChPinIdleDis,     //Disable idle
+    .useAltEx      = false,
+    .shiftRes      = false,
+    .invRes        = false,
+    .storeCntRes   = false,
+    .exClk         = lesenseClkHF,
+    .sampleClk     = lesenseClkLF,
+    .exTime        = 0x07,
+    .sampleDelay   = 0x02,
+    .measDelay     = 0x00,
+    .acmpThres     = 0x00,
+    .sampleMode    = lesenseSampleModeACMP,   //Sample directly from ACMP
+    .intMode       = lesenseSetIntNone,       //The decoder interrupts
+    .cntThres      = 0x0000,
+    .compMode      = lesenseCompModeLess,
+  };
+
+  initLesense.coreCtrl.scanStart = lesenseScanStartPeriodic;
+  initLesense.coreCtrl.biasMode = lesenseBiasModeDutyCycle;
+  initLesense.perCtrl.acmp0Mode = (SENSOR_ACMP == ACMP0) ? lesenseACMPModeMux : lesenseACMPModeDisable;
+  initLesense.perCtrl.acmp1Mode = (SENSOR_ACMP == ACMP0) ? lesenseACMPModeDisable : lesenseACMPModeMux;
+  initLesense.perCtrl.warmupMode = lesenseWarmupModeNormal;
+  initLesense.decCtrl.decInput = lesenseDecInputSensorSt;
+  initLesense.decCtrl.prsCount = true;
+
+  // Use LFXO as LESENSE clock source
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFXO);
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockEnable(cmuClock_LESENSE, true);
+
+  //Initialize LESENSE interface _with_ RESET
+  LESENSE_Init(&initLesense, true);
+
+  // Configure channel 0 and 1
+  LESENSE_ChannelConfig(&initLesenseCh, 0);
+  LESENSE_ChannelConfig(&initLesenseCh, 1);
+
+  LESENSE_ScanFreqSet(0, LESENSE_SCAN_FREQ);
+
+  // Set clock divisor for LF clock
+  LESENSE_ClkDivSet(lesenseClkLF, lesenseClkDiv_1);
+  // Set clock divisor for HF clock
+  LESENSE_ClkDivSet(lesenseClkHF, lesenseClkDiv_1);
+}
+
+/***************************************************************************//**
+ * @brief  Main function
+ ******************************************************************************/
+int main(void)
+{
+  /*Initialize DCDC for series 1 board*/
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_STK_DEFAULT;
+  lesenseQuadInit_TypeDef quadInit = {
+    .table = {
+      .inputA = 0,
+      .inputB = 1,
+      .resolution = lesenseQuadX4,
+      .reverse = false,
+      .errorInt = true,
+    },
+    .threshold = COUNT_THRESHOLD,
+    .prsCount = PRS_CH_COUNT,
+    .prsDir = PRS_CH_DIR,
+    .callback = quadEvent,
+  };
+
+  /* Chip errata */
+  CHIP_Init();
+
+  // Init DCDC regulator with kit specific parameters
+  EMU_DCDCInit(&dcdcInit);
+
+  /* Initialize LED Driver*/
+  BSP_LedsInit();
+
+  /* Initialize GPIO */
+  initGPIO();
+  /* Initialize ACMP */
+  setupACMP();
+  /*Initialize LESENSE*/
+  setupLESENSE();
+  /* Program the decoder and the PCNT, and start scanning */
+  lesenseQuadInit(&quadInit);
+
+  while(1) {
+    EMU_EnterEM2(false);        //put system into EM2 mode
+  }
+}
@@ -0,0 +1,417 @@
+/***************************************************************************//**
+ * @file lesense_quad_test.c
+ * @brief Host test of lesense_quad.c: the decoder state table for every
+ * input pair, resolution and direction, and the count from the PCNT wraps
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/lesense_quad_test.c
+//       src/lesense_quad.c -o lesense_quad_test
+//   ./lesense_quad_test
+//
+// The test runs the decoder state table through a simulation of the LESENSE
+// decoder, and feeds its count pulses to a simulation of the PCNT. The
+// program prints one line per failed check and exits with status 1 if any
+// check failed.
+
+#include "lesense_quad.h"
+#include "em_pcnt.h"
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define TABLE_SIZE      (32)
+#define RANDOM_STEPS    (20000)
+#define THRESHOLD       (100)
+
+static int checks;
+static int failures;
+
+static uint32_t seed = 100;
+
+LESENSE_TypeDef hostLesense;
+PCNT_TypeDef hostPcnt0;
+
+void PCNT0_IRQHandler(void);
+void LESENSE_IRQHandler(void);
+
+// Simulated decoder, counts and interrupts since the last reset
+static LESENSE_DecStDesc_TypeDef decoder[TABLE_SIZE];
+static uint32_t sensorState;
+static int32_t decoderCount;
+static int decoderIrqs;
+
+// Simulated PCNT, counting the decoder pulses when enabled
+static bool pcntEnabled;
+static uint32_t pcntCounter;
+static uint32_t pcntFlags;
+
+static int thresholdEvents;
+static int errorEvents;
+
+// Sensor states in forward order, bit 0 is A and bit 1 is B
+static const uint8_t gray[4] = { 0x0, 0x1, 0x3, 0x2 };
+
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+void LESENSE_DecoderStateConfig(const LESENSE_DecStDesc_TypeDef *confDecSt,
+                                uint32_t decSt)
+{
+  if (decSt < TABLE_SIZE) {
+    decoder[decSt] = *confDecSt;
+  }
+}
+
+uint32_t LESENSE_IntGet(void)
+{
+  return LESENSE_IF_SCANCOMPLETE;
+}
+
+uint32_t LESENSE_SensorStateGet(void)
+{
+  return sensorState;
+}
+
+uint32_t PCNT_IntGet(PCNT_TypeDef *pcnt)
+{
+  (void)pcnt;
+  return pcntFlags;
+}
+
+void PCNT_IntClear(PCNT_TypeDef *pcnt, uint32_t flags)
+{
+  (void)pcnt;
+  pcntFlags &= ~flags;
+}
+
+uint32_t PCNT_CounterGet(PCNT_TypeDef *pcnt)
+{
+  (void)pcnt;
+  return pcntCounter;
+}
+
+static void quadEvent(lesenseQuadEvent_TypeDef event, int32_t count)
+{
+  (void)count;
+  if (event == lesenseQuadEventThreshold) {
+    thresholdEvents++;
+  } else if (event == lesenseQuadEventError) {
+    errorEvents++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief One count pulse into the PCNT, with the direction on S1
+ ******************************************************************************/
+static void pcntPulse(bool down)
+{
+  if (down != ((PCNT0->STATUS & PCNT_STATUS_DIR) != 0)) {
+    PCNT0->STATUS ^= PCNT_STATUS_DIR;
+    pcntFlags |= PCNT_IF_DIRCNG;
+  }
+  if (!down) {
+    if (pcntCounter == THRESHOLD - 1) {
+      pcntCounter = 0;
+      pcntFlags |= PCNT_IF_OF;
+    } else {
+      pcntCounter++;
+    }
+  } else {
+    if (pcntCounter == 0) {
+      pcntCounter = THRESHOLD - 1;
+      pcntFlags |= PCNT_IF_UF;
+    } else {
+      pcntCounter--;
+    }
+  }
+}
+
+static bool condMatch(const LESENSE_DecStCond_TypeDef *cond, uint32_t in)
+{
+  return ((in ^ cond->compVal) & ~cond->compMask & 0xF) == 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   One scan as the decoder sees it: the descriptors of the current state
+ *   are tried in order through the chain, confA before confB, and the first
+ *   match moves the decoder. A match of the current state is no transition.
+ ******************************************************************************/
+static void scan(uint32_t in)
+{
+  uint32_t desc = LESENSE->DECSTATE;
+  const LESENSE_DecStCond_TypeDef *cond;
+
+  sensorState = in;
+  for (;;) {
+    cond = NULL;
+    if (condMatch(&decoder[desc].confA, in)) {
+      cond = &decoder[desc].confA;
+    } else if (condMatch(&decoder[desc].confB, in)) {
+      cond = &decoder[desc].confB;
+    }
+    if (cond != NULL) {
+      if (cond->nextState == LESENSE->DECSTATE) {
+        return;
+      }
+      LESENSE->DECSTATE = cond->nextState;
+      if (cond->prsAct == lesenseTransActUp) {
+        decoderCount++;
+      } else if (cond->prsAct == lesenseTransActDown) {
+        decoderCount--;
+      }
+      if (pcntEnabled && cond->prsAct != lesenseTransActNone) {
+        pcntPulse(cond->prsAct == lesenseTransActDown);
+      }
+      if (cond->setInt) {
+        decoderIrqs++;
+      }
+      return;
+    }
+    if (!decoder[desc].chainDesc || desc + 1 >= TABLE_SIZE) {
+      return;
+    }
+    desc++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Decoder inputs at a position, with noise on the other inputs
+ ******************************************************************************/
+static uint32_t inputsAt(const lesenseQuadTable_TypeDef *table, int32_t pos,
+                         uint32_t noise)
+{
+  uint32_t ab = gray[pos & 3];
+  uint32_t others = noise & 0xF
+                    & ~((1UL << table->inputA) | (1UL << table->inputB));
+
+  return others | ((ab & 1) << table->inputA) | ((ab >> 1) << table->inputB);
+}
+
+/***************************************************************************//**
+ * @brief Counted edges between position 0 and pos, rounded down
+ ******************************************************************************/
+static int32_t edgesTo(int32_t pos, lesenseQuadRes_TypeDef resolution)
+{
+  int32_t period = 4 / resolution;
+
+  return (pos >= 0) ? pos / period : -((period - 1 - pos) / period);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Every input pair, resolution and direction: a random walk with pauses
+ *   and noise on the other inputs counts the edges it crosses, and a missed
+ *   step interrupts without counting and without losing sync.
+ ******************************************************************************/
+static void testTable(void)
+{
+  static const lesenseQuadRes_TypeDef res[] = {
+    lesenseQuadX1, lesenseQuadX2, lesenseQuadX4
+  };
+  lesenseQuadTable_TypeDef table;
+  int32_t start, pos, expect, before;
+  uint32_t a, b, r, rev;
+  int step, ok;
+
+  pcntEnabled = false;
+  for (a = 0; a < 4; a++) {
+    for (b = 0; b < 4; b++) {
+      for (r = 0; r < 3; r++) {
+        for (rev = 0; rev < 2; rev++) {
+          table.inputA = a;
+          table.inputB = b;
+          table.resolution = res[r];
+          table.reverse = rev;
+          table.errorInt = true;
+          if (a == b) {
+            CHECK(lesenseQuadTableBuild(&table, decoder, TABLE_SIZE)
+                  == LESENSE_QUAD_ERR_PARAM);
+            continue;
+          }
+          CHECK(lesenseQuadTableBuild(&table, decoder, TABLE_SIZE)
+                == LESENSE_QUAD_STATES);
+
+          for (start = 0; start < 4; start++) {
+            pos = start;
+            LESENSE->DECSTATE =
+              lesenseQuadStateFind(&table, inputsAt(&table, pos, random32()));
+            decoderCount = 0;
+            decoderIrqs = 0;
+            ok = 1;
+            for (step = 0; step < RANDOM_STEPS; step++) {
+              pos += (int32_t)(random32() % 3) - 1;
+              scan(inputsAt(&table, pos, random32()));
+              expect = edgesTo(pos, res[r]) - edgesTo(start, res[r]);
+              ok &= decoderCount == (rev ? -expect : expect);
+            }
+            CHECK(ok);
+            CHECK(decoderIrqs == 0);
+
+            before = decoderCount;
+            pos += 2;
+            scan(inputsAt(&table, pos, random32()));
+            CHECK(decoderIrqs == 1);
+            CHECK(decoderCount == before);
+
+            start = pos;
+            for (step = 0; step < 400; step++) {
+              pos++;
+              scan(inputsAt(&table, pos, 0));
+            }
+            expect = edgesTo(pos, res[r]) - edgesTo(start, res[r]);
+            CHECK(decoderCount - before == (rev ? -expect : expect));
+            start = pos & 3;
+          }
+        }
+      }
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Invalid tables and configurations
+ ******************************************************************************/
+static void testInvalid(void)
+{
+  lesenseQuadTable_TypeDef table = { 0, 4, lesenseQuadX4, false, false };
+  lesenseQuadInit_TypeDef init = {
+    { 0, 1, lesenseQuadX4, false, true }, THRESHOLD, 0, 1, NULL
+  };
+
+  CHECK(lesenseQuadTableBuild(&table, decoder, TABLE_SIZE)
+        == LESENSE_QUAD_ERR_PARAM);
+  table.inputB = 1;
+  table.resolution = (lesenseQuadRes_TypeDef)3;
+  CHECK(lesenseQuadTableBuild(&table, decoder, TABLE_SIZE)
+        == LESENSE_QUAD_ERR_PARAM);
+  table.resolution = lesenseQuadX1;
+  CHECK(lesenseQuadTableBuild(&table, decoder, LESENSE_QUAD_STATES - 1)
+        == LESENSE_QUAD_ERR_PARAM);
+
+  init.threshold = 0;
+  CHECK(lesenseQuadInit(&init) == LESENSE_QUAD_ERR_PARAM);
+  init.threshold = 0x10001;
+  CHECK(lesenseQuadInit(&init) == LESENSE_QUAD_ERR_PARAM);
+  init.threshold = THRESHOLD;
+  init.prsDir = init.prsCount;
+  CHECK(lesenseQuadInit(&init) == LESENSE_QUAD_ERR_PARAM);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   lesenseQuadInit() starts the decoder in the position of the sensors, and
+ *   lesenseQuadCountGet() gives the decoder count from the PCNT counter and
+ *   wraps, also while a wrap interrupt is pending.
+ ******************************************************************************/
+static void testCount(void)
+{
+  lesenseQuadInit_TypeDef init = {
+    { 0, 1, lesenseQuadX4, false, true }, THRESHOLD, 0, 1, quadEvent
+  };
+  int32_t pos = 2;
+  int32_t wraps = 0;
+  bool down;
+  int step, ok = 1;
+
+  sensorState = gray[pos];
+  pcntEnabled = true;
+  pcntCounter = 0;
+  pcntFlags = 0;
+  PCNT0->STATUS = 0;
+  CHECK(lesenseQuadInit(&init) == 0);
+  CHECK(LESENSE->DECSTATE == lesenseQuadStateFind(&init.table, gray[pos]));
+  CHECK(lesenseQuadCountGet() == 0);
+
+  decoderCount = 0;
+  decoderIrqs = 0;
+  thresholdEvents = 0;
+  errorEvents = 0;
+  for (step = 0; step < RANDOM_STEPS; step++) {
+    // Long runs in one direction, so that the count wraps both ways, with
+    // an occasional step back
+    down = (step / 1000) % 2 != 0;
+    if (random32() % 64 == 0) {
+      down = !down;
+    }
+    pos += down ? -1 : 1;
+    scan(inputsAt(&init.table, pos, 0));
+
+    ok &= lesenseQuadCountGet() == decoderCount;
+    ok &= lesenseQuadDownGet() == down;
+    if ((pcntFlags & (PCNT_IF_OF | PCNT_IF_UF)) != 0) {
+      wraps++;
+    }
+    if (pcntFlags != 0 && random32() % 2 == 0) {
+      PCNT0_IRQHandler();
+      ok &= pcntFlags == 0;
+    }
+    ok &= lesenseQuadCountGet() == decoderCount;
+  }
+  CHECK(ok);
+  CHECK(wraps > 0);
+  CHECK(decoderIrqs == 0);
+
+  // A missed step is counted by the LESENSE interrupt handler
+  PCNT0_IRQHandler();
+  pos += 2;
+  scan(inputsAt(&init.table, pos, 0));
+  CHECK(decoderIrqs == 1);
+  LESENSE_IRQHandler();
+  CHECK(lesenseQuadErrorsGet() == 1);
+  CHECK(errorEvents == 1);
+  CHECK(thresholdEvents > 0);
+  CHECK(lesenseQuadCountGet() == decoderCount);
+}
+
+int main(void)
+{
+  testTable();
+  testInvalid();
+  testCount();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
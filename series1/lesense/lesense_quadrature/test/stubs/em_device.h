@@ -0,0 +1,41 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// Only the LESENSE and PCNT registers and the NVIC functions used by
+// lesense_quad.c are provided.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint32_t DECSTATE;
+} LESENSE_TypeDef;
+
+typedef struct {
+  uint32_t STATUS;
+} PCNT_TypeDef;
+
+typedef enum {
+  LESENSE_IRQn,
+  PCNT0_IRQn
+} IRQn_Type;
+
+extern LESENSE_TypeDef hostLesense;
+extern PCNT_TypeDef hostPcnt0;
+
+#define LESENSE                         (&hostLesense)
+#define PCNT0                           (&hostPcnt0)
+
+#define PCNT_STATUS_DIR                 (0x1UL << 0)
+
+static inline void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+static inline void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+#endif // EM_DEVICE_H
@@ -0,0 +1,57 @@
+// Host stand-in for em_lesense.h, used by the tests in the parent directory.
+// The decoder, interrupt flag and sensor state functions are implemented by
+// the test, the others do nothing.
+#ifndef EM_LESENSE_H
+#define EM_LESENSE_H
+
+#include "em_device.h"
+
+#define LESENSE_IF_SCANCOMPLETE         (0x1UL << 0)
+#define LESENSE_IFC_SCANCOMPLETE        (0x1UL << 0)
+#define LESENSE_IFC_DEC                 (0x1UL << 8)
+#define LESENSE_IEN_DEC                 (0x1UL << 8)
+
+typedef enum {
+  lesenseTransActNone,
+  lesenseTransActUp,
+  lesenseTransActDown
+} LESENSE_StTransAct_TypeDef;
+
+typedef struct {
+  uint8_t compVal;
+  uint8_t compMask;
+  uint8_t nextState;
+  LESENSE_StTransAct_TypeDef prsAct;
+  bool setInt;
+} LESENSE_DecStCond_TypeDef;
+
+typedef struct {
+  bool chainDesc;
+  LESENSE_DecStCond_TypeDef confA;
+  LESENSE_DecStCond_TypeDef confB;
+} LESENSE_DecStDesc_TypeDef;
+
+void LESENSE_DecoderStateConfig(const LESENSE_DecStDesc_TypeDef *confDecSt,
+                                uint32_t decSt);
+uint32_t LESENSE_IntGet(void);
+uint32_t LESENSE_SensorStateGet(void);
+
+static inline void LESENSE_IntClear(uint32_t flags)
+{
+  (void)flags;
+}
+
+static inline void LESENSE_IntEnable(uint32_t flags)
+{
+  (void)flags;
+}
+
+static inline void LESENSE_ScanStart(void)
+{
+}
+
+static inline void LESENSE_DecoderStart(void)
+{
+}
+
+#endif // EM_LESENSE_H
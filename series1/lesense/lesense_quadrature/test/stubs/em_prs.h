@@ -0,0 +1,24 @@
+// Host stand-in for em_prs.h, used by the tests in the parent directory.
+#ifndef EM_PRS_H
+#define EM_PRS_H
+
+#include "em_device.h"
+
+#define PRS_CH_CTRL_SOURCESEL_LESENSED  (0x3AUL << 16)
+#define PRS_CH_CTRL_SIGSEL_LESENSEDEC0  (0x0UL << 0)
+#define PRS_CH_CTRL_SIGSEL_LESENSEDEC1  (0x1UL << 0)
+
+typedef enum {
+  prsEdgeOff
+} PRS_Edge_TypeDef;
+
+static inline void PRS_SourceSignalSet(unsigned int ch, uint32_t source,
+                                       uint32_t signal, PRS_Edge_TypeDef edge)
+{
+  (void)ch;
+  (void)source;
+  (void)signal;
+  (void)edge;
+}
+
+#endif // EM_PRS_H
@@ -0,0 +1,301 @@
+/***************************************************************************//**
+ * @file captouch.c
+ * @brief Capacitive touch engine with baseline tracking, adaptive thresholds,
+ * multi-touch and slider position
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include <string.h>
+#include "captouch.h"
+
+// Each channel has a count that drops when the electrode is touched, as
+// the added capacitance slows down the oscillator. The baseline is an IIR
+// low-pass of the count while the channel is not touched, so it follows
+// temperature and humidity drift. It follows a count that rises above it
+// faster, so that a finger present at start-up does not leave the baseline
+// too low. The delta is baseline - count.
+//
+// The noise level is the mean absolute delta while the channel is clearly
+// not touched, and the touch threshold is noiseFactor times the noise, but
+// at least minThreshold. A touch starts after the delta has been at or above
+// the threshold for debounce samples, and ends after it has been below half
+// the threshold for debounce samples. The baseline is frozen while a touch
+// starts and while it lasts, and follows a delta above half the threshold
+// only very slowly, so that a slowly approaching finger is not taken as
+// drift.
+//
+// Baseline and noise are kept with FRAC_BITS fraction bits, so that slow
+// time constants do not lose small changes.
+
+#define FRAC_BITS       8
+#define NOISE_SHIFT     4               // Noise time constant, 16 samples
+#define RISE_SPEEDUP    2               // Rising counts followed 4x faster
+#define NEAR_SLOWDOWN   4               // Near touch followed 16x slower
+
+typedef struct {
+  int32_t baseline;                     // Baseline, FRAC_BITS fraction bits
+  int32_t noise;                        // Noise, FRAC_BITS fraction bits
+  int32_t delta;                        // Last baseline - count
+  uint32_t threshold;
+  uint32_t touchTime;                   // Samples since the touch started
+  uint8_t debounce;                     // Samples seen towards a change
+  bool touched;
+  bool valid;                           // Baseline has been set
+} channel_TypeDef;
+
+static captouchInit_TypeDef config;
+static channel_TypeDef channels[CAPTOUCH_MAX_CHANNELS];
+static uint32_t touchMask;
+
+/***************************************************************************//**
+ * @brief Touch threshold from the noise level
+ ******************************************************************************/
+static uint32_t thresholdCalc(const channel_TypeDef *c)
+{
+  uint32_t threshold = ((uint32_t)c->noise * config.noiseFactor) >> FRAC_BITS;
+
+  return (threshold > config.minThreshold) ? threshold : config.minThreshold;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the configuration and forget all baselines.
+ *
+ * @param[in] init
+ *   Configuration.
+ *
+ * @return
+ *   0 on success, CAPTOUCH_ERR_PARAM if the configuration is invalid.
+ ******************************************************************************/
+int captouchInit(const captouchInit_TypeDef *init)
+{
+  if (init->channels == 0 || init->channels > CAPTOUCH_MAX_CHANNELS
+      || init->minThreshold == 0 || init->debounce == 0
+      || init->baselineShift > 16) {
+    return CAPTOUCH_ERR_PARAM;
+  }
+
+  config = *init;
+  memset(channels, 0, sizeof(channels));
+  touchMask = 0;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add one count sample of a channel. The first sample of a channel sets
+ *   its baseline.
+ *
+ * @param[in] ch
+ *   Channel, samples of other channels are ignored.
+ *
+ * @param[in] count
+ *   Count, at most 16 bits.
+ ******************************************************************************/
+void captouchUpdate(uint32_t ch, uint32_t count)
+{
+  channel_TypeDef *c;
+  int32_t sample;
+  int32_t diff;
+  int32_t mag;
+  uint32_t shift;
+  bool near;
+
+  if (ch >= config.channels) {
+    return;
+  }
+  c = &channels[ch];
+  sample = (int32_t)((count & 0xFFFF) << FRAC_BITS);
+
+  if (!c->valid) {
+    c->baseline = sample;
+    c->threshold = config.minThreshold;
+    c->valid = true;
+  }
+
+  diff = c->baseline - sample;
+  c->delta = diff >> FRAC_BITS;
+
+  if (c->touched) {
+    c->touchTime++;
+    if (config.maxTouchSamples != 0 && c->touchTime > config.maxTouchSamples) {
+      // Too long for a finger, take the new count as the baseline
+      c->baseline = sample;
+      c->delta = 0;
+    } else if (c->delta >= (int32_t)(c->threshold / 2)) {
+      c->debounce = 0;
+      return;
+    } else if (++c->debounce < config.debounce) {
+      return;
+    }
+    c->touched = false;
+    c->debounce = 0;
+    touchMask &= ~(1UL << ch);
+    return;
+  }
+
+  if (c->delta >= (int32_t)c->threshold) {
+    if (++c->debounce >= config.debounce) {
+      c->touched = true;
+      c->debounce = 0;
+      c->touchTime = 0;
+      touchMask |= 1UL << ch;
+    }
+    return;
+  }
+  c->debounce = 0;
+
+  // Noise only from samples that are clearly not a touch
+  mag = (diff < 0) ? -diff : diff;
+  near = (mag >> FRAC_BITS) >= (int32_t)(c->threshold / 2);
+  if (!near) {
+    c->noise += (mag - c->noise) >> NOISE_SHIFT;
+  }
+
+  shift = config.baselineShift;
+  if (diff < 0) {
+    shift = (shift > RISE_SPEEDUP) ? shift - RISE_SPEEDUP : 0;
+  } else if (near) {
+    shift += NEAR_SLOWDOWN;
+  }
+  c->baseline -= diff >> shift;
+  c->threshold = thresholdCalc(c);
+}
+
+/***************************************************************************//**
+ * @brief Touched channels, bit n is channel n
+ ******************************************************************************/
+uint32_t captouchTouchedGet(void)
+{
+  return touchMask;
+}
+
+/***************************************************************************//**
+ * @brief Last baseline - count of a channel, positive when touched
+ ******************************************************************************/
+int32_t captouchDeltaGet(uint32_t ch)
+{
+  return (ch < config.channels) ? channels[ch].delta : 0;
+}
+
+/***************************************************************************//**
+ * @brief Baseline of a channel, in counts
+ ******************************************************************************/
+uint32_t captouchBaselineGet(uint32_t ch)
+{
+  return (ch < config.channels) ? (uint32_t)channels[ch].baseline >> FRAC_BITS
+                                : 0;
+}
+
+/***************************************************************************//**
+ * @brief Touch threshold of a channel, in counts
+ ******************************************************************************/
+uint32_t captouchThresholdGet(uint32_t ch)
+{
+  return (ch < config.channels) ? channels[ch].threshold : 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Count below which a channel may be touched, for a hardware comparator
+ *   that wakes the core.
+ ******************************************************************************/
+uint32_t captouchWakeLevelGet(uint32_t ch)
+{
+  uint32_t baseline = captouchBaselineGet(ch);
+  uint32_t threshold = captouchThresholdGet(ch);
+
+  return (baseline > threshold) ? baseline - threshold : 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Finger position on a slider made of adjacent channels.
+ *
+ * @details
+ *   The position is the centroid of the deltas of the channel with the
+ *   largest delta and its two neighbours, so that it moves smoothly
+ *   between the electrodes.
+ *
+ * @param[in] first
+ *   First channel of the slider.
+ *
+ * @param[in] count
+ *   Number of channels in the slider.
+ *
+ * @return
+ *   Position from 0 at the first channel to CAPTOUCH_SLIDER_MAX at the
+ *   last, CAPTOUCH_ERR_NO_TOUCH if no slider channel is touched, or
+ *   CAPTOUCH_ERR_PARAM.
+ ******************************************************************************/
+int captouchSliderGet(uint32_t first, uint32_t count)
+{
+  uint32_t mask;
+  uint32_t i;
+  uint32_t max = 0;
+  uint32_t sum = 0;
+  uint32_t weighted = 0;
+  int32_t delta;
+
+  if (count == 0 || first >= config.channels
+      || count > config.channels - first) {
+    return CAPTOUCH_ERR_PARAM;
+  }
+
+  mask = ((count < 32) ? (1UL << count) - 1 : 0xFFFFFFFFUL) << first;
+  if ((touchMask & mask) == 0) {
+    return CAPTOUCH_ERR_NO_TOUCH;
+  }
+
+  for (i = 1; i < count; i++) {
+    if (channels[first + i].delta > channels[first + max].delta) {
+      max = i;
+    }
+  }
+
+  for (i = (max > 0) ? max - 1 : 0; i <= max + 1 && i < count; i++) {
+    delta = channels[first + i].delta;
+    if (delta > 0) {
+      sum += delta;
+      weighted += delta * i;
+    }
+  }
+
+  if (sum == 0) {
+    return CAPTOUCH_ERR_NO_TOUCH;
+  }
+  if (count == 1) {
+    return 0;
+  }
+  return (weighted * CAPTOUCH_SLIDER_MAX + sum * (count - 1) / 2)
+         / (sum * (count - 1));
+}
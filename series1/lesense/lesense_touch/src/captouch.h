@@ -0,0 +1,80 @@
+/***************************************************************************//**
+ * @file captouch.h
+ * @brief Capacitive touch engine with baseline tracking, adaptive thresholds,
+ * multi-touch and slider position
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef CAPTOUCH_H
+#define CAPTOUCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAPTOUCH_MAX_CHANNELS           (16)
+// Slider positions are 0 to CAPTOUCH_SLIDER_MAX
+#define CAPTOUCH_SLIDER_MAX             (255)
+
+// Invalid configuration or channel
+#define CAPTOUCH_ERR_PARAM              (-0x5180)
+// No channel of the slider is touched
+#define CAPTOUCH_ERR_NO_TOUCH           (-0x5100)
+
+typedef struct {
+  uint32_t channels;                    // Number of channels
+  uint16_t minThreshold;                // Lowest touch threshold, in counts
+  uint8_t noiseFactor;                  // Threshold in multiples of the noise
+  uint8_t baselineShift;                // Baseline follows with a time
+                                        // constant of 2^shift samples
+  uint8_t debounce;                     // Samples before touch or release
+  uint32_t maxTouchSamples;             // A longer touch is taken as drift
+                                        // and ends it, 0 for no limit
+} captouchInit_TypeDef;
+
+int captouchInit(const captouchInit_TypeDef *init);
+void captouchUpdate(uint32_t ch, uint32_t count);
+uint32_t captouchTouchedGet(void);
+int32_t captouchDeltaGet(uint32_t ch);
+uint32_t captouchBaselineGet(uint32_t ch);
+uint32_t captouchThresholdGet(uint32_t ch);
+uint32_t captouchWakeLevelGet(uint32_t ch);
+int captouchSliderGet(uint32_t first, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAPTOUCH_H
@@ -0,0 +1,314 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief Capacitive touch on four LESENSE channels in EM2. The channel counts
+ * are copied from the LESENSE result buffer by the LDMA, and the core wakes
+ * up only when a channel count falls below its wake level, or to update the
+ * baselines a few times per second. LED0 is on while any channel is touched,
+ * and LED1 while the finger is on the upper half of the slider.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "em_device.h"
+#include "em_acmp.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_ldma.h"
+#include "em_lesense.h"
+
+#include "bsp.h"
+#include "captouch.h"
+
+/***************************************************************************//**
+ * Macro definitions*/
+ /******************************************************************************/
+
+#define TOUCH_CHANNELS    4
+
+// Touch electrodes on LESENSE channels 0-3
+#if defined(_SILICON_LABS_GECKO_INTERNAL_SDID_100)
+  #define TOUCH_ACMP      ACMP0           // GG11: PC0-PC3
+  #define TOUCH_PORT      gpioPortC
+  #define TOUCH_PIN0      0
+#else
+  #define TOUCH_ACMP      ACMP1           // TG11: PC8-PC11
+  #define TOUCH_PORT      gpioPortC
+  #define TOUCH_PIN0      8
+#endif
+
+#define LESENSE_SCAN_FREQ 40
+
+// Oscillations are counted for this many LFXO cycles per channel
+#define SAMPLE_CLKS       4
+
+// Scans per LDMA interrupt while no channel is touched, and the size of
+// the result buffer
+#define IDLE_SCANS        16
+#define BUF_WORDS         (IDLE_SCANS * TOUCH_CHANNELS)
+
+// Results are at most 20 bits, so this is never a result
+#define BUF_EMPTY         0xFFFFFFFFUL
+
+#define DMA_CH            0
+
+#define TOUCH_CH_IF       (LESENSE_IF_CH0 | LESENSE_IF_CH1 \
+                           | LESENSE_IF_CH2 | LESENSE_IF_CH3)
+#define TOUCH_CH_IEN      (LESENSE_IEN_CH0 | LESENSE_IEN_CH1 \
+                           | LESENSE_IEN_CH2 | LESENSE_IEN_CH3)
+
+/***************************************************************************//**
+ * Global variables*/
+ /******************************************************************************/
+
+volatile uint32_t touched;                // Touched channels
+volatile int sliderPos;                   // Slider position or error
+volatile uint32_t wakeups;                // Interrupts that woke the core
+
+static uint32_t scanBuf[BUF_WORDS];
+static LDMA_Descriptor_t scanDesc;
+static const LDMA_TransferCfg_t scanCfg =
+  LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_LESENSE_BUFDATAV);
+
+/**************************************************************************//**
+ * @brief
+ *    Copy the next words of the LESENSE result buffer to scanBuf. Unused
+ *    words are marked, so a stopped transfer can be processed.
+ *****************************************************************************/
+static void dmaStart(uint32_t words)
+{
+  uint32_t i;
+
+  for (i = 0; i < BUF_WORDS; i++)
+    scanBuf[i] = BUF_EMPTY;
+
+  scanDesc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_P2M_BYTE(&LESENSE->BUFDATA, scanBuf, words);
+  scanDesc.xfer.size = ldmaCtrlSizeWord;
+  LDMA_StartTransfer(DMA_CH, (LDMA_TransferCfg_t *)&scanCfg, &scanDesc);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Pass the copied results to the touch engine, and choose how the core
+ *    is woken up next.
+ *
+ * @details
+ *    While a channel is touched, every scan is processed, so that the
+ *    release and the slider position are seen at once. Otherwise the
+ *    LDMA collects IDLE_SCANS scans, and the LESENSE comparators interrupt
+ *    when a count falls below the wake level of its channel. The wake
+ *    levels follow the baselines and thresholds.
+ *****************************************************************************/
+static void resultsProcess(void)
+{
+  uint32_t i;
+  uint32_t ch;
+
+  for (i = 0; i < BUF_WORDS && scanBuf[i] != BUF_EMPTY; i++)
+  {
+    ch = (scanBuf[i] & _LESENSE_BUFDATA_BUFDATASRC_MASK) >> _LESENSE_BUFDATA_BUFDATASRC_SHIFT;
+    captouchUpdate(ch, scanBuf[i] & _LESENSE_BUFDATA_BUFDATA_MASK);
+  }
+
+  touched = captouchTouchedGet();
+  sliderPos = captouchSliderGet(0, TOUCH_CHANNELS);
+
+  if (touched)
+    BSP_LedSet(0);
+  else
+    BSP_LedClear(0);
+  if (sliderPos > CAPTOUCH_SLIDER_MAX / 2)
+    BSP_LedSet(1);
+  else
+    BSP_LedClear(1);
+
+  if (touched)
+  {
+    dmaStart(TOUCH_CHANNELS);
+    return;
+  }
+
+  for (ch = 0; ch < TOUCH_CHANNELS; ch++)
+    LESENSE_ChannelThresSet(ch, 0, captouchWakeLevelGet(ch));
+  LESENSE_IntClear(TOUCH_CH_IF);
+  LESENSE_IntEnable(TOUCH_CH_IEN);
+  dmaStart(BUF_WORDS);
+}
+
+/**************************************************************************//**
+ * @brief LDMA interrupt, a block of results has been copied
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending = LDMA_IntGet();
+
+  LDMA_IntClear(pending);
+
+  if (pending & (1 << DMA_CH))
+  {
+    wakeups++;
+    resultsProcess();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    LESENSE interrupt, a count is below its wake level. Stop the LDMA,
+ *    process the results copied so far and follow every scan until the
+ *    touch ends.
+ *****************************************************************************/
+void LESENSE_IRQHandler(void)
+{
+  LESENSE_IntDisable(TOUCH_CH_IEN);
+  LESENSE_IntClear(TOUCH_CH_IF);
+  wakeups++;
+
+  LDMA_StopTransfer(DMA_CH);
+  LDMA_IntClear(1 << DMA_CH);
+  resultsProcess();
+}
+
+/**************************************************************************//**
+ * @brief  Sets up the ACMP as a capacitive sense oscillator
+ *****************************************************************************/
+static void setupACMP(void)
+{
+  ACMP_CapsenseInit_TypeDef initACMP = ACMP_CAPSENSE_INIT_DEFAULT;
+
+  CMU_ClockEnable(TOUCH_ACMP == ACMP0 ? cmuClock_ACMP0 : cmuClock_ACMP1, true);
+  ACMP_CapsenseInit(TOUCH_ACMP, &initACMP);
+
+  // LESENSE selects the electrode
+  ACMP_ExternalInputSelect(TOUCH_ACMP, acmpExternalInputAPORT0X);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Sets up LESENSE to count the ACMP oscillations on each channel and
+ *    store the counts in its result buffer
+ *****************************************************************************/
+static void setupLESENSE(void)
+{
+  LESENSE_Init_TypeDef initLesense = LESENSE_INIT_DEFAULT;
+  LESENSE_ChDesc_TypeDef initLesenseCh = LESENSE_CH_CONF_DEFAULT;
+  uint32_t ch;
+
+  initLesense.coreCtrl.scanStart = lesenseScanStartPeriodic;
+  initLesense.coreCtrl.storeScanRes = false;
+  initLesense.coreCtrl.bufOverWr = true;
+  initLesense.coreCtrl.wakeupOnDMA = lesenseDMAWakeUpBufValid;   // LDMA in EM2
+  initLesense.coreCtrl.biasMode = lesenseBiasModeDutyCycle;
+  initLesense.perCtrl.acmp0Mode = (TOUCH_ACMP == ACMP0) ? lesenseACMPModeMux : lesenseACMPModeDisable;
+  initLesense.perCtrl.acmp1Mode = (TOUCH_ACMP == ACMP0) ? lesenseACMPModeDisable : lesenseACMPModeMux;
+  initLesense.perCtrl.warmupMode = lesenseWarmupModeNormal;
+
+  // Count the oscillations for SAMPLE_CLKS LF cycles, and compare the count
+  // with the wake level. The wake level is 0 until there is a baseline.
+  initLesenseCh.enaScanCh = true;
+  initLesenseCh.enaPin = true;
+  initLesenseCh.enaInt = false;
+  initLesenseCh.chPinExMode = lesenseChPinExDis;
+  initLesenseCh.chPinIdleMode = lesenseChPinIdleDis;
+  initLesenseCh.storeCntRes = true;
+  initLesenseCh.exClk = lesenseClkLF;
+  initLesenseCh.sampleClk = lesenseClkLF;
+  initLesenseCh.exTime = 0;
+  initLesenseCh.sampleDelay = SAMPLE_CLKS;
+  initLesenseCh.measDelay = 0;
+  initLesenseCh.sampleMode = lesenseSampleModeCounter;
+  initLesenseCh.intMode = lesenseSetIntLevel;
+  initLesenseCh.cntThres = 0;
+  initLesenseCh.compMode = lesenseCompModeLess;
+
+  // Use LFXO as LESENSE clock source
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFXO);
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockEnable(cmuClock_LESENSE, true);
+
+  LESENSE_Init(&initLesense, true);
+  for (ch = 0; ch < TOUCH_CHANNELS; ch++)
+    LESENSE_ChannelConfig(&initLesenseCh, ch);
+
+  LESENSE_ScanFreqSet(0, LESENSE_SCAN_FREQ);
+  LESENSE_ClkDivSet(lesenseClkLF, lesenseClkDiv_1);
+
+  LESENSE_IntClear(_LESENSE_IFC_MASK);
+  NVIC_ClearPendingIRQ(LESENSE_IRQn);
+  NVIC_EnableIRQ(LESENSE_IRQn);
+}
+
+/***************************************************************************//**
+ * @brief  Main function
+ ******************************************************************************/
+int main(void)
+{
+  /*Initialize DCDC for series 1 board*/
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_STK_DEFAULT;
+  LDMA_Init_t initLdma = LDMA_INIT_DEFAULT;
+  captouchInit_TypeDef initTouch = {
+    .channels = TOUCH_CHANNELS,
+    .minThreshold = 20,             // Counts, depends on the electrodes
+    .noiseFactor = 6,
+    .baselineShift = 6,             // 64 samples, 1.6 s at 40 Hz
+    .debounce = 2,
+    .maxTouchSamples = 30 * LESENSE_SCAN_FREQ,
+  };
+  int i;
+
+  /* Chip errata */
+  CHIP_Init();
+
+  // Init DCDC regulator with kit specific parameters
+  EMU_DCDCInit(&dcdcInit);
+
+  /* Initialize LED Driver*/
+  BSP_LedsInit();
+
+  // The electrode pins are analog
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  for (i = 0; i < TOUCH_CHANNELS; i++)
+    GPIO_PinModeSet(TOUCH_PORT, TOUCH_PIN0 + i, gpioModeDisabled, 0);
+
+  captouchInit(&initTouch);
+  setupACMP();
+  setupLESENSE();
+
+  LDMA_Init(&initLdma);
+  dmaStart(BUF_WORDS);
+  LESENSE_ScanStart();
+
+  while (1)
+    EMU_EnterEM2(false);
+}
@@ -0,0 +1,273 @@
+/***************************************************************************//**
+ * @file captouch_test.c
+ * @brief Host test of captouch.c: baseline drift, adaptive threshold, start-up
+ * touch, touch timeout and slider, with synthetic count traces
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Isrc test/captouch_test.c src/captouch.c
+//       -o captouch_test
+//   ./captouch_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "captouch.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define CHANNELS        (4)
+#define IDLE_COUNT      (2000)
+
+static int checks;
+static int failures;
+
+static uint32_t seed = 99;
+
+// As in main.c, but with a lower minimum threshold and a touch timeout of
+// 1500 samples
+static const captouchInit_TypeDef config = { CHANNELS, 15, 6, 6, 2, 1500 };
+
+static int touchStarts[CHANNELS];
+
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+/***************************************************************************//**
+ * @brief Approximately normal noise with the given standard deviation
+ ******************************************************************************/
+static int32_t noise(int32_t sigma)
+{
+  int32_t sum = 0;
+  int i;
+
+  // The sum of 12 uniform values in 0-1 has a variance of 1
+  for (i = 0; i < 12; i++) {
+    sum += random32() & 0xFFFF;
+  }
+  return ((sum - 6 * 0x10000) * sigma) / 0x10000;
+}
+
+/***************************************************************************//**
+ * @brief Add a sample and count the touches that start
+ ******************************************************************************/
+static void feed(uint32_t ch, int32_t count)
+{
+  uint32_t before = captouchTouchedGet();
+
+  captouchUpdate(ch, (uint32_t)count);
+  if ((captouchTouchedGet() & ~before & (1UL << ch)) != 0) {
+    touchStarts[ch]++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The count drifts down by 300 with noise, and a finger lowers it by 60
+ *   for 40 samples out of every 1000. Every touch is found and the
+ *   baseline follows the drift.
+ ******************************************************************************/
+static void testDrift(void)
+{
+  int32_t base;
+  bool touch;
+  int expected = 0;
+  int n;
+
+  CHECK(captouchInit(&config) == 0);
+  touchStarts[0] = 0;
+  for (n = 0; n < 20000; n++) {
+    base = IDLE_COUNT - 300 * n / 20000;
+    touch = n > 500 && (n % 1000) < 40;
+    if (touch && n % 1000 == 0) {
+      expected++;
+    }
+    feed(0, base + noise(3) - (touch ? 60 : 0));
+    if (n % 1000 == 500) {
+      CHECK(abs((int)captouchBaselineGet(0) - base) < 4);
+      CHECK(captouchTouchedGet() == 0);
+    }
+  }
+  CHECK(touchStarts[0] == expected);
+  CHECK(captouchThresholdGet(0) >= 15 && captouchThresholdGet(0) < 40);
+}
+
+/***************************************************************************//**
+ * @brief A noisier channel gets a higher threshold and no false touches
+ ******************************************************************************/
+static void testNoise(void)
+{
+  int n;
+
+  for (n = 0; n < 20000; n++) {
+    feed(1, IDLE_COUNT + noise(8));
+    if (n == 2000) {
+      touchStarts[1] = 0;
+    }
+  }
+  CHECK(captouchThresholdGet(1) > captouchThresholdGet(0));
+  CHECK(touchStarts[1] == 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A finger on the electrode at start-up is forgotten, and a touch longer
+ *   than the timeout ends and becomes the baseline.
+ ******************************************************************************/
+static void testStartupAndTimeout(void)
+{
+  int n;
+
+  CHECK(captouchInit(&config) == 0);
+  for (n = 0; n < 100; n++) {
+    feed(2, IDLE_COUNT - 60 + noise(3));
+  }
+  for (n = 0; n < 200; n++) {
+    feed(2, IDLE_COUNT + noise(3));
+  }
+  CHECK(captouchBaselineGet(2) > IDLE_COUNT - 10);
+  CHECK(captouchTouchedGet() == 0);
+
+  for (n = 0; n < 1600; n++) {
+    feed(2, IDLE_COUNT - 100 + noise(3));
+  }
+  CHECK(captouchTouchedGet() == 0);
+  CHECK(captouchBaselineGet(2) < IDLE_COUNT - 90);
+  for (n = 0; n < 300; n++) {
+    feed(2, IDLE_COUNT + noise(3));
+  }
+  CHECK(captouchTouchedGet() == 0);
+  CHECK(captouchBaselineGet(2) > IDLE_COUNT - 10);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A finger moves over the four electrodes, 20 steps apart, and lowers each
+ *   count by up to 80 with a triangular profile. The slider position follows
+ *   the finger. Then two separate channels are touched at once.
+ ******************************************************************************/
+static void testSlider(void)
+{
+  int32_t delta;
+  int last = -1;
+  int pos;
+  int x, rep, n;
+  uint32_t ch;
+
+  CHECK(captouchInit(&config) == 0);
+  for (n = 0; n < 200; n++) {
+    for (ch = 0; ch < CHANNELS; ch++) {
+      feed(ch, IDLE_COUNT + noise(2));
+    }
+  }
+
+  for (x = 0; x <= 60; x++) {
+    for (rep = 0; rep < 3; rep++) {
+      for (ch = 0; ch < CHANNELS; ch++) {
+        delta = 80 - 3 * abs(x - 20 * (int)ch);
+        feed(ch, IDLE_COUNT + noise(2) - (delta > 0 ? delta : 0));
+      }
+    }
+    pos = captouchSliderGet(0, CHANNELS);
+    CHECK(pos >= 0 && pos <= CAPTOUCH_SLIDER_MAX);
+    CHECK(abs(pos - x * CAPTOUCH_SLIDER_MAX / 60) <= 20);
+    CHECK(pos >= last - 10);
+    last = pos;
+  }
+  CHECK(captouchTouchedGet() != 0);
+
+  for (n = 0; n < 10; n++) {
+    for (ch = 0; ch < CHANNELS; ch++) {
+      feed(ch, IDLE_COUNT + noise(2));
+    }
+  }
+  CHECK(captouchTouchedGet() == 0);
+  CHECK(captouchSliderGet(0, CHANNELS) == CAPTOUCH_ERR_NO_TOUCH);
+
+  for (n = 0; n < 5; n++) {
+    feed(0, IDLE_COUNT - 100);
+    feed(1, IDLE_COUNT);
+    feed(2, IDLE_COUNT);
+    feed(3, IDLE_COUNT - 100);
+  }
+  CHECK(captouchTouchedGet() == 0x9);
+  CHECK(captouchWakeLevelGet(1)
+        == captouchBaselineGet(1) - captouchThresholdGet(1));
+}
+
+/***************************************************************************//**
+ * @brief Invalid configurations and channels
+ ******************************************************************************/
+static void testInvalid(void)
+{
+  captouchInit_TypeDef bad = config;
+
+  CHECK(captouchInit(&config) == 0);
+  CHECK(captouchSliderGet(2, 3) == CAPTOUCH_ERR_PARAM);
+  CHECK(captouchSliderGet(0, 0) == CAPTOUCH_ERR_PARAM);
+  CHECK(captouchDeltaGet(CHANNELS) == 0);
+
+  bad.channels = CAPTOUCH_MAX_CHANNELS + 1;
+  CHECK(captouchInit(&bad) == CAPTOUCH_ERR_PARAM);
+  bad = config;
+  bad.debounce = 0;
+  CHECK(captouchInit(&bad) == CAPTOUCH_ERR_PARAM);
+  bad = config;
+  bad.minThreshold = 0;
+  CHECK(captouchInit(&bad) == CAPTOUCH_ERR_PARAM);
+}
+
+int main(void)
+{
+  testDrift();
+  testNoise();
+  testStartupAndTimeout();
+  testSlider();
+  testInvalid();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
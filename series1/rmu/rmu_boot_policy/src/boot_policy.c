@@ -0,0 +1,286 @@
+/***************************************************************************//**
+ * @file boot_policy.c
+ * @brief Reset cause classification and boot path selection for a fast boot
+ * after warm resets
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "boot_policy.h"
+#include <stddef.h>
+
+// The reset cause picks one of four boot paths, and each path has a fixed
+// set of actions. A power-on or brown-out reset loses RAM, or may have
+// corrupted it, so it gets the cold path: retained RAM is cleared and the
+// self-tests and full diagnostics run. A lockup or watchdog reset keeps
+// RAM, which still holds the state at the time of the fault, so the
+// retained RAM is kept for analysis but the diagnostics run. A pin reset
+// or a system reset request is a warm reset that keeps RAM and skips all
+// tests. An EM4 wake-up has lost RAM, as Series 1 does not retain RAM in
+// EM4, but it is not a fault, so it clears retained RAM and skips the
+// tests.
+//
+// A record in retained RAM holds the boot time statistics of each path. It
+// also works as a canary for the retained RAM: if the record does not check
+// out after a reset that should have kept RAM, RAM was not kept after all
+// (for example after a debugger download), and the cold path is used.
+//
+// RAM does not survive EM4, so the record is also copied to storage that
+// does, such as the RTCC retention registers. When the record in RAM does
+// not check out, the statistics are taken from that copy if it does, so the
+// boot time of the EM4 path is reported against the last cold boot.
+
+#define RECORD_MAGIC      (0x426F6F74UL)  // "Boot"
+
+// Only 32-bit words, BOOT_POLICY_EM4_WORDS of them
+typedef struct {
+  uint32_t magic;
+  bootPolicyPathStats_TypeDef paths[bootPathCount];
+  uint32_t check;
+} record_TypeDef;
+
+// Causes in order of precedence. If several bits are set, the first match
+// wins: a power-on or brown-out reset means RAM is lost whatever else
+// happened, a fault is reported before the reset it caused, and a pin reset
+// in EM4 has lost RAM like any EM4 wake-up.
+static const struct {
+  uint32_t mask;
+  bootCause_TypeDef cause;
+} causeTable[] = {
+  { RMU_RSTCAUSE_PORST,     bootCausePowerOn },
+#if defined(RMU_RSTCAUSE_AVDDBOD)
+  { RMU_RSTCAUSE_AVDDBOD,   bootCauseBrownOut },
+#endif
+#if defined(RMU_RSTCAUSE_DVDDBOD)
+  { RMU_RSTCAUSE_DVDDBOD,   bootCauseBrownOut },
+#endif
+#if defined(RMU_RSTCAUSE_DECBOD)
+  { RMU_RSTCAUSE_DECBOD,    bootCauseBrownOut },
+#endif
+  { RMU_RSTCAUSE_LOCKUPRST, bootCauseLockup },
+  { RMU_RSTCAUSE_WDOGRST,   bootCauseWatchdog },
+  { RMU_RSTCAUSE_EM4RST,    bootCauseEM4Wake },
+  { RMU_RSTCAUSE_EXTRST,    bootCausePin },
+  { RMU_RSTCAUSE_SYSREQRST, bootCauseSysReq },
+};
+
+static const bootPath_TypeDef pathTable[bootCauseCount] = {
+  [bootCausePowerOn]  = bootPathCold,
+  [bootCauseBrownOut] = bootPathCold,
+  [bootCauseLockup]   = bootPathFault,
+  [bootCauseWatchdog] = bootPathFault,
+  [bootCauseEM4Wake]  = bootPathEM4,
+  [bootCausePin]      = bootPathWarm,
+  [bootCauseSysReq]   = bootPathWarm,
+  [bootCauseUnknown]  = bootPathCold,
+};
+
+static const uint32_t actionTable[bootPathCount] = {
+  [bootPathCold]  = BOOT_POLICY_CLEAR_RETAINED | BOOT_POLICY_SELF_TEST
+                    | BOOT_POLICY_DIAGNOSTICS,
+  [bootPathFault] = BOOT_POLICY_SELF_TEST | BOOT_POLICY_DIAGNOSTICS,
+  [bootPathWarm]  = 0,
+  [bootPathEM4]   = BOOT_POLICY_CLEAR_RETAINED,
+};
+
+static BOOT_POLICY_RETAINED record_TypeDef record;
+static volatile uint32_t *em4Store;
+static bootPolicyReport_TypeDef current;
+
+/***************************************************************************//**
+ * @brief FNV-1a hash of the record, without the check word
+ ******************************************************************************/
+static uint32_t recordHash(void)
+{
+  const uint8_t *p = (const uint8_t *)&record;
+  uint32_t hash = 0x811C9DC5;
+  size_t i;
+
+  for (i = 0; i < offsetof(record_TypeDef, check); i++) {
+    hash = (hash ^ p[i]) * 0x01000193;
+  }
+  return hash;
+}
+
+static bool recordValid(void)
+{
+  return record.magic == RECORD_MAGIC && record.check == recordHash();
+}
+
+/***************************************************************************//**
+ * @brief Seal the record and copy it to the EM4 retained storage
+ ******************************************************************************/
+static void recordSeal(void)
+{
+  const uint32_t *words = (const uint32_t *)&record;
+  size_t i;
+
+  record.magic = RECORD_MAGIC;
+  record.check = recordHash();
+  if (em4Store != NULL) {
+    for (i = 0; i < BOOT_POLICY_EM4_WORDS; i++) {
+      em4Store[i] = words[i];
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Take the record from the EM4 retained storage
+ *
+ * @return true if the copy checks out
+ ******************************************************************************/
+static bool recordRestore(void)
+{
+  uint32_t *words = (uint32_t *)&record;
+  size_t i;
+
+  if (em4Store == NULL) {
+    return false;
+  }
+  for (i = 0; i < BOOT_POLICY_EM4_WORDS; i++) {
+    words[i] = em4Store[i];
+  }
+  return recordValid();
+}
+
+/***************************************************************************//**
+ * @brief Classify the reset cause
+ *
+ * @param resetCause RMU_RSTCAUSE bits, as returned by RMU_ResetCauseGet()
+ ******************************************************************************/
+bootCause_TypeDef bootPolicyClassify(uint32_t resetCause)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof(causeTable) / sizeof(causeTable[0]); i++) {
+    if (resetCause & causeTable[i].mask) {
+      return causeTable[i].cause;
+    }
+  }
+  return bootCauseUnknown;
+}
+
+/***************************************************************************//**
+ * @brief Boot path for a reset cause
+ ******************************************************************************/
+bootPath_TypeDef bootPolicyPathGet(bootCause_TypeDef cause)
+{
+  if ((unsigned)cause >= bootCauseCount) {
+    return bootPathCold;
+  }
+  return pathTable[cause];
+}
+
+/***************************************************************************//**
+ * @brief BOOT_POLICY_ actions of a boot path
+ ******************************************************************************/
+uint32_t bootPolicyActionsGet(bootPath_TypeDef path)
+{
+  if ((unsigned)path >= bootPathCount) {
+    return actionTable[bootPathCold];
+  }
+  return actionTable[path];
+}
+
+/***************************************************************************//**
+ * @brief Pick the boot path, call once early in main()
+ *
+ * @param resetCause RMU_RSTCAUSE bits, as returned by RMU_ResetCauseGet()
+ * @param em4Retained BOOT_POLICY_EM4_WORDS words that are kept in EM4, or
+ * NULL to lose the statistics on an EM4 wake-up
+ *
+ * @return BOOT_POLICY_ actions that the boot must do
+ ******************************************************************************/
+uint32_t bootPolicyStart(uint32_t resetCause, volatile uint32_t *em4Retained)
+{
+  size_t i;
+
+  em4Store = em4Retained;
+  current.cause = bootPolicyClassify(resetCause);
+  current.path = bootPolicyPathGet(current.cause);
+  current.retainedValid = recordValid();
+
+  if (!current.retainedValid) {
+    // A path that keeps retained RAM cannot trust it
+    if (!(bootPolicyActionsGet(current.path) & BOOT_POLICY_CLEAR_RETAINED)) {
+      current.path = bootPathCold;
+    }
+    if (!recordRestore()) {
+      for (i = 0; i < bootPathCount; i++) {
+        record.paths[i].boots = 0;
+        record.paths[i].lastTime = 0;
+      }
+    }
+    recordSeal();
+  }
+
+  current.actions = bootPolicyActionsGet(current.path);
+  current.time = 0;
+  return current.actions;
+}
+
+/***************************************************************************//**
+ * @brief Record the boot time, call when the boot is done
+ *
+ * @param time Time since the start of the boot, in any unit
+ ******************************************************************************/
+void bootPolicyDone(uint32_t time)
+{
+  current.time = time;
+  record.paths[current.path].boots++;
+  record.paths[current.path].lastTime = time;
+  recordSeal();
+}
+
+/***************************************************************************//**
+ * @brief Get the report of this boot and the boot time of each path
+ *
+ * @details
+ *    The time saved by a path is the last cold boot time minus the last
+ *    boot time of the path, or 0 if either path has not been seen since
+ *    both the retained RAM and the EM4 retained copy were last lost.
+ ******************************************************************************/
+void bootPolicyReportGet(bootPolicyReport_TypeDef *report)
+{
+  const bootPolicyPathStats_TypeDef *cold = &record.paths[bootPathCold];
+  size_t i;
+
+  *report = current;
+  for (i = 0; i < bootPathCount; i++) {
+    report->paths[i] = record.paths[i];
+    if (cold->boots != 0 && record.paths[i].boots != 0) {
+      report->saved[i] = (int32_t)(cold->lastTime - record.paths[i].lastTime);
+    } else {
+      report->saved[i] = 0;
+    }
+  }
+}
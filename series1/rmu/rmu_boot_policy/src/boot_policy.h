@@ -0,0 +1,115 @@
+/***************************************************************************//**
+ * @file boot_policy.h
+ * @brief Reset cause classification and boot path selection for a fast boot
+ * after warm resets
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef BOOT_POLICY_H
+#define BOOT_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Places a variable in RAM that the startup code does not initialize, so
+// that it keeps its value over resets that do not lose RAM. The linker
+// scripts src/rmu_boot_policy.ld (GCC) and src/rmu_boot_policy.icf (IAR)
+// leave .noinit out of the startup initialization.
+#if defined(__ICCARM__)
+#define BOOT_POLICY_RETAINED            __no_init
+#elif defined(__GNUC__)
+#define BOOT_POLICY_RETAINED            __attribute__((section(".noinit")))
+#else
+#define BOOT_POLICY_RETAINED
+#endif
+
+// Words of storage kept in EM4, such as RTCC retention registers or BURAM,
+// that bootPolicyStart() uses for a copy of the boot time statistics: a
+// magic and a check word, and two words for each boot path
+#define BOOT_POLICY_EM4_WORDS           (2 + 2 * 4)
+
+// Boot actions
+#define BOOT_POLICY_CLEAR_RETAINED      (0x1UL) // Retained RAM is not valid
+#define BOOT_POLICY_SELF_TEST           (0x2UL) // Run the start-up self-tests
+#define BOOT_POLICY_DIAGNOSTICS         (0x4UL) // Run the full diagnostics
+
+typedef enum {
+  bootCausePowerOn,
+  bootCauseBrownOut,
+  bootCauseLockup,
+  bootCauseWatchdog,
+  bootCauseEM4Wake,
+  bootCausePin,
+  bootCauseSysReq,
+  bootCauseUnknown,
+  bootCauseCount
+} bootCause_TypeDef;
+
+typedef enum {
+  bootPathCold,                         // RAM lost or not trusted
+  bootPathFault,                        // RAM kept, after a fault
+  bootPathWarm,                         // RAM kept, requested reset
+  bootPathEM4,                          // RAM lost, but no fault
+  bootPathCount
+} bootPath_TypeDef;
+
+typedef struct {
+  uint32_t boots;                       // Boots that took the path
+  uint32_t lastTime;                    // Boot time of the last of them
+} bootPolicyPathStats_TypeDef;
+
+typedef struct {
+  bootCause_TypeDef cause;
+  bootPath_TypeDef path;
+  uint32_t actions;
+  bool retainedValid;                   // The retained record checked out
+  uint32_t time;                        // Boot time of this boot
+  bootPolicyPathStats_TypeDef paths[bootPathCount];
+  int32_t saved[bootPathCount];         // Time saved against the cold path
+} bootPolicyReport_TypeDef;
+
+bootCause_TypeDef bootPolicyClassify(uint32_t resetCause);
+bootPath_TypeDef bootPolicyPathGet(bootCause_TypeDef cause);
+uint32_t bootPolicyActionsGet(bootPath_TypeDef path);
+uint32_t bootPolicyStart(uint32_t resetCause, volatile uint32_t *em4Retained);
+void bootPolicyDone(uint32_t time);
+void bootPolicyReportGet(bootPolicyReport_TypeDef *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_POLICY_H
@@ -0,0 +1,371 @@
+/***************************************************************************//**
+ * @file gg11_main_rmu_boot_policy.c
+ * @brief This project demonstrates a boot that is shortened according to
+ * the reset cause.
+ *
+ * A power-on reset runs the self-tests and diagnostics and clears the
+ * retained RAM, a watchdog reset runs the tests but keeps the retained RAM,
+ * and a pin reset, a system reset request or an EM4 wake-up skips the tests.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_cryotimer.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_rmu.h"
+#include "em_wdog.h"
+
+#include "bspconfig.h"
+#include "boot_policy.h"
+
+// Level that turns an LED on, the GG11 STK LEDs are active low
+#define LED_ON      0
+
+// Flash checked by the self-test, and RAM tested by the diagnostics
+#define FLASH_CHECK_BYTES (64 * 1024)
+#define RAM_TEST_WORDS    2048
+
+// Reset causes kept in the retained log
+#define LOG_ENTRIES       1024
+
+// Reset cause and boot report, for viewing in the debugger.  The boot times
+// in the report are in us from the start of main().
+uint32_t resetCause;
+bootPolicyReport_TypeDef bootReport;
+uint32_t flashCrc;
+bool ramTestPassed;
+
+/*
+ * Log of the reset causes, kept over the resets that keep RAM.  It stands
+ * in for application state that would otherwise be rebuilt on every boot.
+ */
+static BOOT_POLICY_RETAINED struct {
+  uint32_t count;
+  uint32_t cause[LOG_ENTRIES];
+} resetLog;
+
+static uint32_t ramTestArea[RAM_TEST_WORDS];
+
+static volatile bool em4Request;
+static volatile bool hang;
+
+/**************************************************************************//**
+ * @brief
+ *    Time in us since the start of main().  HFCLK is the HFRCO during the
+ *    whole boot, so the cycle counter runs at a fixed rate.  Cortex-M0+
+ *    parts such as the EFM32TG11 have no DWT cycle counter, and use the
+ *    24-bit SysTick instead, which is enough for a boot of up to 2^24
+ *    cycles.
+ *****************************************************************************/
+static uint32_t timeNow(void)
+{
+#if defined(DWT)
+  uint32_t cycles = DWT->CYCCNT;
+#else
+  // SysTick counts down
+  uint32_t cycles = (SysTick_LOAD_RELOAD_Msk - SysTick->VAL)
+                    & SysTick_LOAD_RELOAD_Msk;
+#endif
+
+  return (uint32_t)((uint64_t)cycles * 1000000 / SystemCoreClock);
+}
+
+static void timeInit(void)
+{
+#if defined(DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#else
+  SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+  SysTick->VAL = 0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Enable access to the RTCC retention registers, which keep the boot
+ *    statistics in EM4 Hibernate.  The RTCC itself is not started.
+ *****************************************************************************/
+static void initRetention(void)
+{
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_ULFRCO);
+  CMU_ClockEnable(cmuClock_RTCC, true);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Self-test, stands in for an application image check
+ *****************************************************************************/
+static void selfTest(void)
+{
+  const uint8_t *p = (const uint8_t *)FLASH_BASE;
+  uint32_t crc = 0xFFFFFFFF;
+  uint32_t i;
+  int bit;
+
+  for (i = 0; i < FLASH_CHECK_BYTES; i++)
+  {
+    crc ^= p[i];
+    for (bit = 0; bit < 8; bit++)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  flashCrc = ~crc;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Diagnostics, a March C- test of a RAM area
+ *****************************************************************************/
+static bool marchElement(int up, uint32_t expect, uint32_t write)
+{
+  volatile uint32_t *ram = ramTestArea;
+  int i;
+
+  for (i = 0; i < RAM_TEST_WORDS; i++)
+  {
+    int n = up ? i : RAM_TEST_WORDS - 1 - i;
+
+    if (ram[n] != expect)
+      return false;
+    ram[n] = write;
+  }
+  return true;
+}
+
+static void diagnostics(void)
+{
+  volatile uint32_t *ram = ramTestArea;
+  int i;
+
+  for (i = 0; i < RAM_TEST_WORDS; i++)
+    ram[i] = 0;
+
+  ramTestPassed = marchElement(1, 0, 0xFFFFFFFF)
+                  && marchElement(1, 0xFFFFFFFF, 0)
+                  && marchElement(0, 0, 0xFFFFFFFF)
+                  && marchElement(0, 0xFFFFFFFF, 0)
+                  && marchElement(1, 0, 0);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    GPIO interrupt handler for PB0 and PB1.  Releasing PB1 requests a
+ *    system reset.  PB0 enters EM4, or stops feeding the watchdog if PB1
+ *    is held down.
+ *****************************************************************************/
+static void buttonIrq(void)
+{
+  uint32_t flags = GPIO_IntGet();
+
+  GPIO_IntClear(flags);
+
+  if (flags & (1 << BSP_GPIO_PB0_PIN))
+  {
+    if (GPIO_PinInGet(BSP_GPIO_PB1_PORT, BSP_GPIO_PB1_PIN) == 0)
+      hang = true;
+    else
+      em4Request = true;
+  }
+
+  if ((flags & (1 << BSP_GPIO_PB1_PIN)) && !hang)
+    NVIC_SystemReset();
+}
+
+void GPIO_EVEN_IRQHandler(void)
+{
+  buttonIrq();
+}
+
+void GPIO_ODD_IRQHandler(void)
+{
+  buttonIrq();
+}
+
+void CRYOTIMER_IRQHandler(void)
+{
+  CRYOTIMER_IntClear(CRYOTIMER_IFC_PERIOD);
+  __DSB();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Configure the LEDs, PB0 to interrupt when pressed and PB1 when
+ *    released
+ *****************************************************************************/
+static void initGPIO(void)
+{
+  CMU_ClockEnable(cmuClock_GPIO, true);
+
+  GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, !LED_ON);
+  GPIO_PinModeSet(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN, gpioModePushPull, !LED_ON);
+
+  GPIO_PinModeSet(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, gpioModeInputPullFilter, 1);
+  GPIO_PinModeSet(BSP_GPIO_PB1_PORT, BSP_GPIO_PB1_PIN, gpioModeInputPullFilter, 1);
+  GPIO_ExtIntConfig(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, BSP_GPIO_PB0_PIN, false, true, true);
+  GPIO_ExtIntConfig(BSP_GPIO_PB1_PORT, BSP_GPIO_PB1_PIN, BSP_GPIO_PB1_PIN, true, false, true);
+
+  NVIC_ClearPendingIRQ(GPIO_EVEN_IRQn);
+  NVIC_EnableIRQ(GPIO_EVEN_IRQn);
+  NVIC_ClearPendingIRQ(GPIO_ODD_IRQn);
+  NVIC_EnableIRQ(GPIO_ODD_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start the CRYOTIMER on the ULFRCO with a period of about 1 s.  It
+ *    wakes the main loop from EM2, and the device from EM4.
+ *****************************************************************************/
+static void initCRYO(void)
+{
+  CRYOTIMER_Init_TypeDef init = CRYOTIMER_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_CRYOTIMER, true);
+
+  init.osc = cryotimerOscULFRCO;
+  init.presc = cryotimerPresc_1;
+  init.period = cryotimerPeriod_1k;
+  init.em4Wakeup = true;
+  CRYOTIMER_Init(&init);
+
+  CRYOTIMER_IntClear(CRYOTIMER_IFC_PERIOD);
+  CRYOTIMER_IntEnable(CRYOTIMER_IEN_PERIOD);
+  NVIC_ClearPendingIRQ(CRYOTIMER_IRQn);
+  NVIC_EnableIRQ(CRYOTIMER_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start the watchdog with a timeout of about 2 s
+ *****************************************************************************/
+static void initWDOG(void)
+{
+  WDOG_Init_TypeDef init = WDOG_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  init.em2Run = true;
+  init.clkSel = wdogClkSelULFRCO;
+  init.perSel = wdogPeriod_2k;
+  WDOG_Init(&init);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Enter EM4 Hibernate, which keeps the RTCC retention registers.  The
+ *    CRYOTIMER wakes the device with an EM4 reset.
+ *****************************************************************************/
+static void enterEM4(void)
+{
+  EMU_EM4Init_TypeDef em4Init = EMU_EM4INIT_DEFAULT;
+
+  em4Init.em4State = emuEM4Hibernate;
+  em4Init.pinRetentionMode = emuPinRetentionDisable;
+  em4Init.retainUlfrco = true;
+  EMU_EM4Init(&em4Init);
+
+  EMU_EnterEM4();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint32_t actions;
+
+  timeInit();
+  CHIP_Init();
+
+  // Initialize DCDC with kit specific parameters
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  // Pick the boot path, and clear the reset cause for the next reset
+  resetCause = RMU_ResetCauseGet();
+  RMU_ResetCauseClear();
+  initRetention();
+  actions = bootPolicyStart(resetCause, &RTCC->RET[0].REG);
+
+  if (actions & BOOT_POLICY_CLEAR_RETAINED)
+  {
+    uint32_t i;
+
+    resetLog.count = 0;
+    for (i = 0; i < LOG_ENTRIES; i++)
+      resetLog.cause[i] = 0;
+  }
+  resetLog.cause[resetLog.count++ % LOG_ENTRIES] = resetCause;
+
+  if (actions & BOOT_POLICY_SELF_TEST)
+    selfTest();
+
+  if (actions & BOOT_POLICY_DIAGNOSTICS)
+    diagnostics();
+
+  initGPIO();
+  initCRYO();
+  initWDOG();
+
+  bootPolicyDone(timeNow());
+  bootPolicyReportGet(&bootReport);
+
+  // LED0 for a cold boot, LED1 for a warm boot, both for an EM4 wake-up.
+  // Both blink after a fault.
+  if (bootReport.path == bootPathCold || bootReport.path == bootPathEM4)
+    GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, LED_ON);
+  if (bootReport.path == bootPathWarm || bootReport.path == bootPathEM4)
+    GPIO_PinModeSet(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN, gpioModePushPull, LED_ON);
+
+  while (1)
+  {
+    EMU_EnterEM2(true);
+
+    if (em4Request)
+      enterEM4();
+
+    if (!hang)
+      WDOG_Feed();
+
+    if (bootReport.path == bootPathFault)
+    {
+      GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+      GPIO_PinOutToggle(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN);
+    }
+  }
+}
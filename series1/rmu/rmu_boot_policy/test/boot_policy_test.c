@@ -0,0 +1,254 @@
+/***************************************************************************//**
+ * @file boot_policy_test.c
+ * @brief Host test of boot_policy.c: reset cause classification, boot paths
+ * and the retained record over a sequence of resets
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/boot_policy_test.c
+//       -o boot_policy_test
+//   ./boot_policy_test
+//
+// boot_policy.c is included rather than linked, so the test can corrupt the
+// retained record the way a lost or overwritten RAM would. On the host the
+// record is an ordinary static variable, so it keeps its value from one
+// simulated reset to the next. The program prints one line per failed check
+// and exits with status 1 if any check failed.
+
+#include "boot_policy.c"
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define CAUSE_BITS      (9)
+
+#define BROWN_OUT       (RMU_RSTCAUSE_AVDDBOD | RMU_RSTCAUSE_DVDDBOD \
+                         | RMU_RSTCAUSE_DECBOD)
+#define ALL_ACTIONS     (BOOT_POLICY_CLEAR_RETAINED | BOOT_POLICY_SELF_TEST \
+                         | BOOT_POLICY_DIAGNOSTICS)
+
+static int checks;
+static int failures;
+
+// Stands in for the RTCC retention registers, kept over every reset here
+static uint32_t em4Words[BOOT_POLICY_EM4_WORDS];
+
+static const uint32_t causeBits[CAUSE_BITS] = {
+  RMU_RSTCAUSE_PORST,
+  RMU_RSTCAUSE_AVDDBOD,
+  RMU_RSTCAUSE_DVDDBOD,
+  RMU_RSTCAUSE_DECBOD,
+  RMU_RSTCAUSE_EXTRST,
+  RMU_RSTCAUSE_LOCKUPRST,
+  RMU_RSTCAUSE_SYSREQRST,
+  RMU_RSTCAUSE_WDOGRST,
+  RMU_RSTCAUSE_EM4RST
+};
+
+/***************************************************************************//**
+ * @brief Reference classification, the table of the readme as an if chain
+ ******************************************************************************/
+static bootCause_TypeDef referenceCause(uint32_t resetCause)
+{
+  if (resetCause & RMU_RSTCAUSE_PORST) {
+    return bootCausePowerOn;
+  }
+  if (resetCause & BROWN_OUT) {
+    return bootCauseBrownOut;
+  }
+  if (resetCause & RMU_RSTCAUSE_LOCKUPRST) {
+    return bootCauseLockup;
+  }
+  if (resetCause & RMU_RSTCAUSE_WDOGRST) {
+    return bootCauseWatchdog;
+  }
+  if (resetCause & RMU_RSTCAUSE_EM4RST) {
+    return bootCauseEM4Wake;
+  }
+  if (resetCause & RMU_RSTCAUSE_EXTRST) {
+    return bootCausePin;
+  }
+  if (resetCause & RMU_RSTCAUSE_SYSREQRST) {
+    return bootCauseSysReq;
+  }
+  return bootCauseUnknown;
+}
+
+/***************************************************************************//**
+ * @brief Every combination of cause bits, with unrelated bits set, gets the
+ * cause, path and actions of the readme table
+ ******************************************************************************/
+static void testClassify(void)
+{
+  for (uint32_t n = 0; n < (1u << CAUSE_BITS); n++) {
+    uint32_t resetCause = 0;
+    bootCause_TypeDef cause;
+    bootPath_TypeDef path;
+    uint32_t actions;
+
+    for (int b = 0; b < CAUSE_BITS; b++) {
+      if (n & (1u << b)) {
+        resetCause |= causeBits[b];
+      }
+    }
+    // Bits that are not reset causes are ignored
+    resetCause |= (n * 0x9E3779B9u) & 0x0000E0E2u;
+
+    cause = bootPolicyClassify(resetCause);
+    path = bootPolicyPathGet(cause);
+    actions = bootPolicyActionsGet(path);
+    CHECK(cause == referenceCause(resetCause));
+    if (resetCause & (RMU_RSTCAUSE_PORST | BROWN_OUT)) {
+      CHECK(path == bootPathCold && actions == ALL_ACTIONS);
+    } else if (resetCause & (RMU_RSTCAUSE_LOCKUPRST | RMU_RSTCAUSE_WDOGRST)) {
+      CHECK(path == bootPathFault);
+      CHECK(actions == (BOOT_POLICY_SELF_TEST | BOOT_POLICY_DIAGNOSTICS));
+    } else if (resetCause & RMU_RSTCAUSE_EM4RST) {
+      CHECK(path == bootPathEM4 && actions == BOOT_POLICY_CLEAR_RETAINED);
+    } else if (resetCause & (RMU_RSTCAUSE_EXTRST | RMU_RSTCAUSE_SYSREQRST)) {
+      CHECK(path == bootPathWarm && actions == 0);
+    } else {
+      CHECK(path == bootPathCold && actions == ALL_ACTIONS);
+    }
+  }
+
+  // Out of range values take the cold path
+  CHECK(bootPolicyPathGet(bootCauseCount) == bootPathCold);
+  CHECK(bootPolicyActionsGet(bootPathCount) == ALL_ACTIONS);
+}
+
+/***************************************************************************//**
+ * @brief A sequence of resets, as in the How To Test steps of the readme,
+ * with the retained record lost or corrupted on the way
+ ******************************************************************************/
+static void testRecord(void)
+{
+  bootPolicyReport_TypeDef report;
+
+  // After a download the record is not valid, so even a pin reset is cold
+  CHECK(bootPolicyStart(RMU_RSTCAUSE_EXTRST, em4Words) == ALL_ACTIONS);
+  bootPolicyReportGet(&report);
+  CHECK(report.cause == bootCausePin && report.path == bootPathCold);
+  CHECK(!report.retainedValid);
+  bootPolicyDone(1000);
+
+  // System reset request: warm, and the saving against the cold boot
+  CHECK(bootPolicyStart(RMU_RSTCAUSE_SYSREQRST, em4Words) == 0);
+  bootPolicyDone(100);
+  bootPolicyReportGet(&report);
+  CHECK(report.path == bootPathWarm && report.retainedValid);
+  CHECK(report.time == 100);
+  CHECK(report.paths[bootPathCold].boots == 1);
+  CHECK(report.paths[bootPathWarm].boots == 1);
+  CHECK(report.saved[bootPathWarm] == 900);
+  CHECK(report.saved[bootPathCold] == 0 && report.saved[bootPathFault] == 0);
+
+  // Watchdog: fault path, and the statistics are kept
+  CHECK(bootPolicyStart(RMU_RSTCAUSE_WDOGRST, em4Words)
+        == (BOOT_POLICY_SELF_TEST | BOOT_POLICY_DIAGNOSTICS));
+  bootPolicyDone(950);
+  bootPolicyReportGet(&report);
+  CHECK(report.path == bootPathFault && report.saved[bootPathFault] == 50);
+
+  // A reset before the boot is done leaves the record valid
+  bootPolicyStart(RMU_RSTCAUSE_SYSREQRST, em4Words);
+  CHECK(bootPolicyStart(RMU_RSTCAUSE_EXTRST, em4Words) == 0);
+  bootPolicyDone(120);
+  bootPolicyReportGet(&report);
+  CHECK(report.paths[bootPathWarm].boots == 2);
+  CHECK(report.paths[bootPathWarm].lastTime == 120);
+
+  // EM4 loses RAM: the statistics come from the EM4 retained copy
+  record.paths[bootPathCold].boots ^= 0x40;
+  CHECK(bootPolicyStart(RMU_RSTCAUSE_EM4RST, em4Words)
+        == BOOT_POLICY_CLEAR_RETAINED);
+  bootPolicyDone(300);
+  bootPolicyReportGet(&report);
+  CHECK(report.path == bootPathEM4 && !report.retainedValid);
+  CHECK(report.paths[bootPathEM4].boots == 1);
+  CHECK(report.paths[bootPathCold].boots == 1);
+  CHECK(report.paths[bootPathWarm].boots == 2);
+  CHECK(report.saved[bootPathEM4] == 700);
+
+  // With the copy lost as well, the statistics start over
+  record.magic = 0;
+  em4Words[1] ^= 1;
+  CHECK(bootPolicyStart(RMU_RSTCAUSE_EM4RST, em4Words)
+        == BOOT_POLICY_CLEAR_RETAINED);
+  bootPolicyDone(300);
+  bootPolicyReportGet(&report);
+  CHECK(report.path == bootPathEM4 && !report.retainedValid);
+  CHECK(report.paths[bootPathEM4].boots == 1);
+  CHECK(report.paths[bootPathCold].boots == 0);
+  CHECK(report.saved[bootPathEM4] == 0);
+
+  // Without EM4 retained storage, an EM4 wake-up loses the statistics
+  record.magic = 0;
+  bootPolicyStart(RMU_RSTCAUSE_EM4RST, NULL);
+  bootPolicyReportGet(&report);
+  CHECK(report.paths[bootPathEM4].boots == 0);
+
+  // A warm reset with a corrupted record is cold
+  record.magic = 0;
+  CHECK(bootPolicyStart(RMU_RSTCAUSE_SYSREQRST, em4Words) == ALL_ACTIONS);
+  bootPolicyDone(1100);
+
+  // An EM4 wake-up with a valid record keeps the statistics
+  bootPolicyStart(RMU_RSTCAUSE_EM4RST, em4Words);
+  bootPolicyDone(200);
+  bootPolicyReportGet(&report);
+  CHECK(report.retainedValid && report.saved[bootPathEM4] == 900);
+
+  // A power-on reset is cold even with a valid record
+  CHECK(bootPolicyStart(RMU_RSTCAUSE_PORST | RMU_RSTCAUSE_EXTRST, em4Words)
+        == ALL_ACTIONS);
+  bootPolicyReportGet(&report);
+  CHECK(report.retainedValid && report.path == bootPathCold);
+}
+
+int main(void)
+{
+  testClassify();
+  testRecord();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
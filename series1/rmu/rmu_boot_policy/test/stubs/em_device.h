@@ -0,0 +1,18 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// Only the RMU reset cause bits of Series 1 are provided.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+#define RMU_RSTCAUSE_PORST              (0x1UL << 0)
+#define RMU_RSTCAUSE_AVDDBOD            (0x1UL << 2)
+#define RMU_RSTCAUSE_DVDDBOD            (0x1UL << 3)
+#define RMU_RSTCAUSE_DECBOD             (0x1UL << 4)
+#define RMU_RSTCAUSE_EXTRST             (0x1UL << 8)
+#define RMU_RSTCAUSE_LOCKUPRST          (0x1UL << 9)
+#define RMU_RSTCAUSE_SYSREQRST          (0x1UL << 10)
+#define RMU_RSTCAUSE_WDOGRST            (0x1UL << 11)
+#define RMU_RSTCAUSE_EM4RST             (0x1UL << 16)
+
+#endif // EM_DEVICE_H
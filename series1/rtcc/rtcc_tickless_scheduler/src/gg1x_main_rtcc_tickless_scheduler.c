@@ -0,0 +1,288 @@
+/***************************************************************************//**
+ * @file gg1x_main_rtcc_tickless_scheduler.c
+ * @brief This project demonstrates a tickless cooperative scheduler that
+ * uses an RTCC compare channel for its timers and sleeps in the deepest
+ * energy mode the active peripherals allow.
+ *
+ * LED0 blinks from a periodic timer.  PB0 stops and restarts the
+ * blinking, and PB1 holds the device in EM1 for a few seconds as if a
+ * USART transfer were active, with LED1 on.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_rtcc.h"
+
+#include "bsp.h"
+#include "sched.h"
+
+// Level that turns an LED on, the GG11/GG12 kit RGB LEDs are active low
+#define LED_ON      0
+
+// RTCC ticks per second, the RTCC counts the LFXO without prescaling
+#define TICKS_PER_SECOND  32768
+
+// RTCC channel used for the scheduler timers
+#define SCHED_CC    1
+
+/*
+ * Wakeup latency in RTCC ticks.  With the HFRCO as HFCLK, EM2 and EM3
+ * wake-up takes a few microseconds, which is less than one tick.  If
+ * the HFXO is used as HFCLK, add its start-up time.
+ */
+#define EM2_WAKEUP_TICKS  1
+#define EM3_WAKEUP_TICKS  1
+
+// LED0 blink period and the time PB1 keeps the device in EM1
+#define BLINK_TICKS       (TICKS_PER_SECOND / 2)
+#define BUSY_TICKS        (3 * TICKS_PER_SECOND)
+
+// Scheduler statistics, for viewing in the debugger
+schedStats_TypeDef schedStats;
+
+static uint32_t blinkTask;
+static uint32_t pb0Task;
+static uint32_t pb1Task;
+static uint32_t busyDoneTask;
+
+static schedTimer_TypeDef blinkTimer;
+static schedTimer_TypeDef busyTimer;
+
+static bool busy;
+
+/**************************************************************************//**
+ * @brief
+ *    Scheduler timer hooks for the RTCC.
+ *****************************************************************************/
+static uint32_t rtccNow(void)
+{
+  return RTCC_CounterGet();
+}
+
+static void rtccArm(uint32_t tick)
+{
+  RTCC_ChannelCCVSet(SCHED_CC, tick);
+  RTCC_IntClear(RTCC_IF_CC1);
+  RTCC_IntEnable(RTCC_IEN_CC1);
+
+  /*
+   * The scheduler arms at least SCHED_MIN_SLEEP_TICKS ahead, but if
+   * the match was missed anyway, set the flag so that the sleep is
+   * ended immediately instead of after a full counter wrap.
+   */
+  if ((int32_t)(tick - RTCC_CounterGet()) <= 0)
+    RTCC_IntSet(RTCC_IF_CC1);
+}
+
+static void rtccDisarm(void)
+{
+  RTCC_IntDisable(RTCC_IEN_CC1);
+  RTCC_IntClear(RTCC_IF_CC1);
+}
+
+static void enterEM(schedEM_TypeDef em)
+{
+  if (em == schedEM1)
+    EMU_EnterEM1();
+  else if (em == schedEM2)
+    EMU_EnterEM2(true);
+  else
+    EMU_EnterEM3(true);
+}
+
+void RTCC_IRQHandler(void)
+{
+  // The scheduler checks its timers after wake-up
+  RTCC_IntClear(RTCC_IF_CC1);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    GPIO interrupt handlers for PB0 and PB1.
+ *****************************************************************************/
+static void buttonIrq(void)
+{
+  uint32_t flags = GPIO_IntGet();
+
+  GPIO_IntClear(flags);
+
+  if (flags & (1 << BSP_GPIO_PB0_PIN))
+    schedTaskPost(pb0Task);
+
+  if (flags & (1 << BSP_GPIO_PB1_PIN))
+    schedTaskPost(pb1Task);
+}
+
+void GPIO_EVEN_IRQHandler(void)
+{
+  buttonIrq();
+}
+
+void GPIO_ODD_IRQHandler(void)
+{
+  buttonIrq();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Tasks.
+ *****************************************************************************/
+static void blink(void)
+{
+  GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+}
+
+// PB0: stop or restart blinking.  With no timer running, the device
+// sleeps in EM3 until the next button press.
+static void pb0Pressed(void)
+{
+  if (blinkTimer.running)
+  {
+    schedTimerStop(&blinkTimer);
+    GPIO_PinOutClear(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+  }
+  else
+    schedTimerStart(&blinkTimer, 0, BLINK_TICKS, blinkTask);
+}
+
+// PB1: stay in EM1 for BUSY_TICKS, as an active USART would require
+static void pb1Pressed(void)
+{
+  if (!busy)
+  {
+    busy = true;
+    schedPeriphRequire(schedPeriphUSART);
+    GPIO_PinModeSet(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN, gpioModePushPull, LED_ON);
+  }
+  schedTimerStart(&busyTimer, BUSY_TICKS, 0, busyDoneTask);
+}
+
+static void busyDone(void)
+{
+  busy = false;
+  schedPeriphRelease(schedPeriphUSART);
+  GPIO_PinModeSet(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN, gpioModePushPull, !LED_ON);
+  schedStatsGet(&schedStats);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start the LFXO and the RTCC as a free running 32-bit counter.
+ *****************************************************************************/
+void rtccInit(void)
+{
+  CMU_LFXOInit_TypeDef lfxo = CMU_LFXOINIT_DEFAULT;
+  CMU_LFXOInit(&lfxo);
+  CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_LFXO);
+  CMU_ClockEnable(cmuClock_RTCC, true);
+
+  RTCC_Init_TypeDef rtcc = RTCC_INIT_DEFAULT;
+  rtcc.enable   = false;
+  rtcc.debugRun = false;
+  rtcc.presc    = rtccCntPresc_1;
+  RTCC_Init(&rtcc);
+
+  RTCC_CCChConf_TypeDef compCfg = RTCC_CH_INIT_COMPARE_DEFAULT;
+  RTCC_ChannelInit(SCHED_CC, &compCfg);
+
+  RTCC_IntClear(_RTCC_IF_MASK);
+  NVIC_ClearPendingIRQ(RTCC_IRQn);
+  NVIC_EnableIRQ(RTCC_IRQn);
+
+  RTCC_Enable(true);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Configure PB0 and PB1 to interrupt on the falling edge.  GPIO
+ *    interrupts wake the device from EM3.
+ *****************************************************************************/
+void buttonInit(void)
+{
+  GPIO_PinModeSet(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, gpioModeInputPullFilter, 1);
+  GPIO_PinModeSet(BSP_GPIO_PB1_PORT, BSP_GPIO_PB1_PIN, gpioModeInputPullFilter, 1);
+  GPIO_ExtIntConfig(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, BSP_GPIO_PB0_PIN, false, true, true);
+  GPIO_ExtIntConfig(BSP_GPIO_PB1_PORT, BSP_GPIO_PB1_PIN, BSP_GPIO_PB1_PIN, false, true, true);
+
+  NVIC_ClearPendingIRQ(GPIO_EVEN_IRQn);
+  NVIC_EnableIRQ(GPIO_EVEN_IRQn);
+  NVIC_ClearPendingIRQ(GPIO_ODD_IRQn);
+  NVIC_EnableIRQ(GPIO_ODD_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Main function
+ *****************************************************************************/
+int main(void)
+{
+  schedInit_TypeDef schedInitData = {
+    .now = rtccNow,
+    .arm = rtccArm,
+    .disarm = rtccDisarm,
+    .sleep = enterEM,
+    .wakeupTicks = { 0, 0, EM2_WAKEUP_TICKS, EM3_WAKEUP_TICKS },
+    .timerEM = schedEM2,      // The LFXO stops in EM3
+    .deepestEM = schedEM3,
+  };
+
+  CHIP_Init();
+
+  // Initialize DCDC with kit specific parameters
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockEnable(cmuClock_GPIO, true);
+
+  GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, !LED_ON);
+  GPIO_PinModeSet(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN, gpioModePushPull, !LED_ON);
+
+  rtccInit();
+  buttonInit();
+
+  schedInit(&schedInitData);
+  blinkTask = schedTaskCreate(blink);
+  pb0Task = schedTaskCreate(pb0Pressed);
+  pb1Task = schedTaskCreate(pb1Pressed);
+  busyDoneTask = schedTaskCreate(busyDone);
+
+  schedTimerStart(&blinkTimer, 0, BLINK_TICKS, blinkTask);
+
+  // Run tasks and sleep in the deepest possible energy mode in between
+  schedRun();
+}
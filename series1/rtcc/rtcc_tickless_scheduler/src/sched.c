@@ -0,0 +1,389 @@
+/***************************************************************************//**
+ * @file sched.c
+ * @brief Tickless cooperative scheduler that sleeps in the deepest allowed
+ * energy mode
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_core.h"
+#include "sched.h"
+#include <stddef.h>
+
+// Tasks are posted by setting their bit in pendingTasks and run in id order,
+// lowest id first. Timers are kept in a list sorted by expiry, so only the
+// head is compared with the current tick and programmed into the low energy
+// timer. There is no periodic tick, the core only wakes for a due timer or
+// for an interrupt that posts a task.
+
+static schedInit_TypeDef hal;
+static schedTaskFn_TypeDef tasks[SCHED_MAX_TASKS];
+static uint32_t taskCount;
+static volatile uint32_t pendingTasks;
+static schedTimer_TypeDef *timerQueue;
+static uint16_t emRequirements[schedEMCount];
+static schedStats_TypeDef stats;
+
+// Deepest energy mode of each peripheral class
+static const uint8_t periphEM[schedPeriphCount] = {
+  [schedPeriphUSART] = schedEM1,
+  [schedPeriphTIMER] = schedEM1,
+  [schedPeriphLDMA] = schedEM1,
+  [schedPeriphADC] = schedEM1,
+  [schedPeriphLEUART] = schedEM2,
+  [schedPeriphLETIMER] = schedEM2,
+  [schedPeriphLESENSE] = schedEM2,
+  [schedPeriphRTCC] = schedEM2,
+  [schedPeriphCRYOTIMER] = schedEM3,
+  [schedPeriphGPIO] = schedEM3,
+  [schedPeriphACMP] = schedEM3,
+};
+
+/***************************************************************************//**
+ * @brief Check whether tick a is at or before tick b, across wrap-around
+ ******************************************************************************/
+static inline bool tickBeforeEq(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) <= 0;
+}
+
+/***************************************************************************//**
+ * @brief Link a timer into the queue after all timers due at the same time
+ ******************************************************************************/
+static void timerInsert(schedTimer_TypeDef *timer)
+{
+  schedTimer_TypeDef **link = &timerQueue;
+
+  while (*link != NULL && tickBeforeEq((*link)->expiry, timer->expiry)) {
+    link = &(*link)->next;
+  }
+  timer->next = *link;
+  *link = timer;
+  timer->running = true;
+}
+
+/***************************************************************************//**
+ * @brief Unlink a timer from the queue
+ ******************************************************************************/
+static void timerRemove(schedTimer_TypeDef *timer)
+{
+  schedTimer_TypeDef **link = &timerQueue;
+
+  while (*link != NULL && *link != timer) {
+    link = &(*link)->next;
+  }
+  if (*link != NULL) {
+    *link = timer->next;
+  }
+  timer->next = NULL;
+  timer->running = false;
+}
+
+/***************************************************************************//**
+ * @brief Post the tasks of all due timers and reload the periodic ones
+ ******************************************************************************/
+static void timersProcess(void)
+{
+  schedTimer_TypeDef *timer;
+  uint32_t now;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  now = hal.now();
+  while (timerQueue != NULL && tickBeforeEq(timerQueue->expiry, now)) {
+    timer = timerQueue;
+    timerQueue = timer->next;
+    timer->next = NULL;
+    timer->running = false;
+    pendingTasks |= 1UL << timer->task;
+    stats.timersFired++;
+
+    if (timer->period != 0) {
+      // Keep the period phase, but skip periods that were missed entirely
+      timer->expiry += timer->period;
+      if (tickBeforeEq(timer->expiry, now)) {
+        timer->expiry = now + timer->period;
+      }
+      timerInsert(timer);
+    }
+  }
+  CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief Run the tasks that are pending, lowest id first
+ ******************************************************************************/
+static void tasksProcess(void)
+{
+  uint32_t pending;
+  uint32_t task;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  pending = pendingTasks;
+  pendingTasks = 0;
+  CORE_EXIT_CRITICAL();
+
+  for (task = 0; pending != 0; task++, pending >>= 1) {
+    if ((pending & 1) != 0) {
+      stats.tasksRun++;
+      tasks[task]();
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Set up the scheduler with a low energy timer
+ ******************************************************************************/
+void schedInit(const schedInit_TypeDef *init)
+{
+  uint32_t i;
+
+  hal = *init;
+  taskCount = 0;
+  pendingTasks = 0;
+  timerQueue = NULL;
+  for (i = 0; i < schedEMCount; i++) {
+    emRequirements[i] = 0;
+  }
+  stats = (schedStats_TypeDef){ 0 };
+}
+
+/***************************************************************************//**
+ * @brief Add a task
+ *
+ * @return The task id, which is also its priority (0 runs first), or
+ * SCHED_ERR_NO_TASK.
+ ******************************************************************************/
+int schedTaskCreate(schedTaskFn_TypeDef fn)
+{
+  if (taskCount >= SCHED_MAX_TASKS) {
+    return SCHED_ERR_NO_TASK;
+  }
+  tasks[taskCount] = fn;
+  return (int)taskCount++;
+}
+
+/***************************************************************************//**
+ * @brief Mark a task to run, can be called from interrupt handlers
+ ******************************************************************************/
+void schedTaskPost(uint32_t task)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  pendingTasks |= 1UL << task;
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief Start or restart a timer
+ *
+ * @param timer Timer, must stay valid while it is running.
+ * @param delay Ticks until the task is posted.
+ * @param period Ticks between later posts, or 0 for a one-shot timer.
+ * @param task Task to post.
+ ******************************************************************************/
+void schedTimerStart(schedTimer_TypeDef *timer, uint32_t delay,
+                     uint32_t period, uint32_t task)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  if (timer->running) {
+    timerRemove(timer);
+  }
+  timer->expiry = hal.now() + delay;
+  timer->period = period;
+  timer->task = (uint8_t)task;
+  timerInsert(timer);
+  CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief Stop a timer, does nothing if it is not running
+ ******************************************************************************/
+void schedTimerStop(schedTimer_TypeDef *timer)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  if (timer->running) {
+    timerRemove(timer);
+  }
+  CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief Do not sleep deeper than em until the matching schedEMRelease()
+ ******************************************************************************/
+void schedEMRequire(schedEM_TypeDef em)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  emRequirements[em]++;
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief Release a requirement taken with schedEMRequire()
+ ******************************************************************************/
+void schedEMRelease(schedEM_TypeDef em)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (emRequirements[em] > 0) {
+    emRequirements[em]--;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+/***************************************************************************//**
+ * @brief Require the deepest energy mode a peripheral works in, e.g. EM1
+ * while a USART transfer is active
+ ******************************************************************************/
+void schedPeriphRequire(schedPeriph_TypeDef periph)
+{
+  schedEMRequire((schedEM_TypeDef)periphEM[periph]);
+}
+
+/***************************************************************************//**
+ * @brief Release a requirement taken with schedPeriphRequire()
+ ******************************************************************************/
+void schedPeriphRelease(schedPeriph_TypeDef periph)
+{
+  schedEMRelease((schedEM_TypeDef)periphEM[periph]);
+}
+
+/***************************************************************************//**
+ * @brief Choose the energy mode for the next sleep
+ *
+ * @details The deepest mode allowed by all requirements is used, and no mode
+ * deeper than the low energy timer runs in while a timer is queued. If the
+ * next timer is due before the wakeup latency of that mode has passed, a
+ * shallower mode is used. The timer is armed early by the wakeup latency so
+ * that the task runs on time. Must be called with interrupts disabled.
+ *
+ * @param armed Set to true if the low energy timer must be armed.
+ * @param armTick Tick to arm the low energy timer at.
+ * @return The energy mode, or schedEM0 if the scheduler must not sleep.
+ ******************************************************************************/
+schedEM_TypeDef schedSleepModeGet(bool *armed, uint32_t *armTick)
+{
+  schedEM_TypeDef em = hal.deepestEM;
+  int32_t remaining;
+  uint32_t i;
+
+  *armed = false;
+  if (pendingTasks != 0) {
+    return schedEM0;
+  }
+
+  for (i = schedEM0; i < (uint32_t)em; i++) {
+    if (emRequirements[i] > 0) {
+      em = (schedEM_TypeDef)i;
+      break;
+    }
+  }
+
+  if (timerQueue != NULL && em != schedEM0) {
+    if (em > hal.timerEM) {
+      em = hal.timerEM;
+    }
+    remaining = (int32_t)(timerQueue->expiry - hal.now());
+    while (em > schedEM0
+           && remaining < (int32_t)(hal.wakeupTicks[em] + SCHED_MIN_SLEEP_TICKS)) {
+      em = (schedEM_TypeDef)(em - 1);
+    }
+    if (em != schedEM0) {
+      *armed = true;
+      *armTick = timerQueue->expiry - hal.wakeupTicks[em];
+    }
+  }
+
+  return em;
+}
+
+/***************************************************************************//**
+ * @brief Run due timers and pending tasks, then sleep until the next event
+ ******************************************************************************/
+void schedRunOnce(void)
+{
+  schedEM_TypeDef em;
+  bool armed;
+  uint32_t armTick;
+  uint32_t start;
+  CORE_DECLARE_IRQ_STATE;
+
+  timersProcess();
+  tasksProcess();
+
+  // Decide and sleep with interrupts disabled, so that an interrupt that
+  // posts a task after the decision still wakes the core
+  CORE_ENTER_CRITICAL();
+  em = schedSleepModeGet(&armed, &armTick);
+  if (em != schedEM0) {
+    if (armed) {
+      hal.arm(armTick);
+    } else {
+      hal.disarm();
+    }
+    start = hal.now();
+    hal.sleep(em);
+    stats.sleepTicks[em] += hal.now() - start;
+  }
+  stats.sleeps[em]++;
+  CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief Run the scheduler forever
+ ******************************************************************************/
+void schedRun(void)
+{
+  while (1) {
+    schedRunOnce();
+  }
+}
+
+/***************************************************************************//**
+ * @brief Get the scheduler statistics
+ ******************************************************************************/
+void schedStatsGet(schedStats_TypeDef *statsOut)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  *statsOut = stats;
+  CORE_EXIT_CRITICAL();
+}
@@ -0,0 +1,130 @@
+/***************************************************************************//**
+ * @file sched.h
+ * @brief Tickless cooperative scheduler that sleeps in the deepest allowed
+ * energy mode
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of tasks, task ids are 0..SCHED_MAX_TASKS-1
+#define SCHED_MAX_TASKS                 (32)
+
+// Timers closer than this are not worth a sleep, the scheduler polls them
+#define SCHED_MIN_SLEEP_TICKS           (2)
+
+// Returned by schedTaskCreate() if all task ids are used
+#define SCHED_ERR_NO_TASK               (-0x5A80)
+
+// Energy modes the scheduler sleeps in. EM4 is not used, since waking from
+// it is a reset.
+typedef enum {
+  schedEM0 = 0,                         // Do not sleep
+  schedEM1 = 1,
+  schedEM2 = 2,
+  schedEM3 = 3,
+  schedEMCount
+} schedEM_TypeDef;
+
+// Peripheral classes and the deepest energy mode each one works in
+typedef enum {
+  schedPeriphUSART,                     // HF peripherals, EM1
+  schedPeriphTIMER,
+  schedPeriphLDMA,
+  schedPeriphADC,
+  schedPeriphLEUART,                    // LF peripherals, EM2
+  schedPeriphLETIMER,
+  schedPeriphLESENSE,
+  schedPeriphRTCC,
+  schedPeriphCRYOTIMER,                 // Asynchronous wake sources, EM3
+  schedPeriphGPIO,
+  schedPeriphACMP,
+  schedPeriphCount
+} schedPeriph_TypeDef;
+
+typedef void (*schedTaskFn_TypeDef)(void);
+
+// Timer, owned by the application and linked into the queue while running
+typedef struct schedTimer {
+  struct schedTimer *next;
+  uint32_t expiry;                      // Tick at which the timer is due
+  uint32_t period;                      // Reload in ticks, 0 for one-shot
+  uint8_t task;                         // Task posted when the timer is due
+  bool running;
+} schedTimer_TypeDef;
+
+// Low energy timer used for the timer queue, e.g. RTCC, RTC or LETIMER
+typedef struct {
+  uint32_t (*now)(void);                // Current tick count
+  void (*arm)(uint32_t tick);           // Interrupt at this tick
+  void (*disarm)(void);
+  void (*sleep)(schedEM_TypeDef em);    // Enter em, interrupts disabled
+  uint32_t wakeupTicks[schedEMCount];   // Wakeup latency of each mode
+  schedEM_TypeDef timerEM;              // Deepest mode the timer runs in
+  schedEM_TypeDef deepestEM;            // Deepest mode to use at all
+} schedInit_TypeDef;
+
+typedef struct {
+  uint32_t sleeps[schedEMCount];        // Sleeps per mode (EM0 = polls)
+  uint32_t sleepTicks[schedEMCount];    // Ticks spent asleep per mode
+  uint32_t tasksRun;
+  uint32_t timersFired;
+} schedStats_TypeDef;
+
+void schedInit(const schedInit_TypeDef *init);
+int schedTaskCreate(schedTaskFn_TypeDef fn);
+void schedTaskPost(uint32_t task);
+void schedTimerStart(schedTimer_TypeDef *timer, uint32_t delay,
+                     uint32_t period, uint32_t task);
+void schedTimerStop(schedTimer_TypeDef *timer);
+void schedEMRequire(schedEM_TypeDef em);
+void schedEMRelease(schedEM_TypeDef em);
+void schedPeriphRequire(schedPeriph_TypeDef periph);
+void schedPeriphRelease(schedPeriph_TypeDef periph);
+schedEM_TypeDef schedSleepModeGet(bool *armed, uint32_t *armTick);
+void schedRunOnce(void);
+void schedRun(void);
+void schedStatsGet(schedStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCHED_H
@@ -0,0 +1,331 @@
+/***************************************************************************//**
+ * @file sched_test.c
+ * @brief Host test of sched.c with a simulated low energy timer: energy mode
+ * selection, early wake-up, timer order and counter wrap
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/sched_test.c src/sched.c
+//       -o sched_test
+//   ./sched_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "sched.h"
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define QUEUE_TIMERS    (50)
+
+static int checks;
+static int failures;
+
+// Simulated timer: current tick, armed compare value, and the mode of the
+// last sleep. A sleep lasts until the compare match plus the wake-up latency
+// of the mode, or 1000 ticks (an interrupt) if nothing is armed.
+static uint32_t simNow;
+static uint32_t armTick;
+static bool armed;
+static bool armedInPast;
+static bool unarmedNotEM3;
+
+static uint32_t runTick[4];
+static int runCount[4];
+
+static uint32_t seed = 7;
+
+/***************************************************************************//**
+ * @brief Small LCG, so that the test does not depend on the C library rand()
+ ******************************************************************************/
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+static uint32_t simTimerNow(void)
+{
+  return simNow;
+}
+
+static void simTimerArm(uint32_t tick)
+{
+  armTick = tick;
+  armed = true;
+}
+
+static void simTimerDisarm(void)
+{
+  armed = false;
+}
+
+static void simSleep(schedEM_TypeDef em);
+
+static const schedInit_TypeDef schedInitSim = {
+  simTimerNow, simTimerArm, simTimerDisarm, simSleep,
+  { 0, 0, 10, 20 }, schedEM2, schedEM3
+};
+
+static void simSleep(schedEM_TypeDef em)
+{
+  if (!armed) {
+    if (em != schedEM3) {
+      unarmedNotEM3 = true;
+    }
+    simNow += 1000;
+    return;
+  }
+  if ((int32_t)(armTick - simNow) < 1) {
+    armedInPast = true;
+  }
+  simNow = armTick + schedInitSim.wakeupTicks[em];
+}
+
+static void simTask(int n)
+{
+  runTick[n] = simNow;
+  runCount[n]++;
+}
+
+static void task0(void)
+{
+  simTask(0);
+}
+
+static void task1(void)
+{
+  simTask(1);
+}
+
+static void task2(void)
+{
+  simTask(2);
+}
+
+static void task3(void)
+{
+  simTask(3);
+}
+
+/***************************************************************************//**
+ * @brief Energy mode selection from the required peripherals and modes
+ ******************************************************************************/
+static void testEnergyModes(void)
+{
+  bool timerArmed;
+  uint32_t tick;
+
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM3);
+  CHECK(!timerArmed);
+
+  schedPeriphRequire(schedPeriphUSART);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM1);
+  schedPeriphRequire(schedPeriphLEUART);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM1);
+  schedPeriphRelease(schedPeriphUSART);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM2);
+  schedPeriphRelease(schedPeriphLEUART);
+  schedPeriphRequire(schedPeriphGPIO);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM3);
+  schedPeriphRelease(schedPeriphGPIO);
+
+  // LDMA needs the HF clock
+  schedPeriphRequire(schedPeriphLDMA);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM1);
+  schedPeriphRelease(schedPeriphLDMA);
+
+  schedEMRequire(schedEM0);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM0);
+  schedEMRelease(schedEM0);
+
+  // A release without a require is ignored
+  schedPeriphRelease(schedPeriphLDMA);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM3);
+}
+
+/***************************************************************************//**
+ * @brief A running timer limits the mode to the timer mode, and the
+ * wake-up is armed early by the latency of the chosen mode
+ ******************************************************************************/
+static void testTimerModes(void)
+{
+  static schedTimer_TypeDef timer;
+  bool timerArmed;
+  uint32_t tick;
+
+  simNow = 1000;
+  schedTimerStart(&timer, 100, 0, 1);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM2);
+  CHECK(timerArmed);
+  CHECK(tick == 1090);
+
+  // Too short for the EM2 latency, and just long enough
+  schedTimerStart(&timer, 11, 0, 1);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM1);
+  CHECK(tick == 1011);
+  schedTimerStart(&timer, 12, 0, 1);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM2);
+  CHECK(tick == 1002);
+
+  // Closer than SCHED_MIN_SLEEP_TICKS, or a task pending: no sleep
+  schedTimerStart(&timer, 1, 0, 1);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM0);
+  schedTaskPost(3);
+  schedTimerStart(&timer, 100, 0, 1);
+  CHECK(schedSleepModeGet(&timerArmed, &tick) == schedEM0);
+  schedRunOnce();
+  CHECK(runCount[3] == 1);
+  schedTimerStop(&timer);
+}
+
+/***************************************************************************//**
+ * @brief Timers fire on time in expiry order, periodic timers keep their
+ * phase, also when the counter wraps
+ ******************************************************************************/
+static void testTimerRun(void)
+{
+  static schedTimer_TypeDef timer1;
+  static schedTimer_TypeDef timer2;
+  static schedTimer_TypeDef timer3;
+  const uint32_t base = 0xFFFFFF00u;
+  schedStats_TypeDef stats;
+  int periodic = 0;
+  int before;
+
+  simNow = base;
+  schedTimerStart(&timer1, 500, 0, 1);
+  schedTimerStart(&timer2, 200, 300, 2);
+  schedTimerStart(&timer3, 200, 0, 0);
+
+  for (int i = 0; i < 200 && runCount[2] < 10; i++) {
+    before = runCount[2];
+    schedRunOnce();
+    if (runCount[2] != before) {
+      CHECK(runTick[2] == base + 200 + 300u * (uint32_t)periodic);
+      periodic++;
+    }
+  }
+  CHECK(periodic == 10);
+  CHECK(runCount[0] == 1);
+  CHECK(runTick[0] == base + 200);
+  CHECK(runCount[1] == 1);
+  CHECK(runTick[1] == base + 500);
+  schedTimerStop(&timer2);
+
+  schedStatsGet(&stats);
+  CHECK(stats.sleeps[schedEM2] > 0);
+  CHECK(stats.sleeps[schedEM3] == 0);
+  CHECK(stats.timersFired == 12);
+  CHECK(!armedInPast);
+  CHECK(!unarmedNotEM3);
+}
+
+/***************************************************************************//**
+ * @brief Random starts and stops: the wake-up is always armed for the timer
+ * that expires first
+ ******************************************************************************/
+static void testQueueOrder(void)
+{
+  static schedTimer_TypeDef timers[QUEUE_TIMERS];
+  static uint32_t expiry[QUEUE_TIMERS];
+  static bool running[QUEUE_TIMERS];
+  bool timerArmed;
+  uint32_t tick;
+  schedEM_TypeDef em;
+  int first;
+  int k;
+
+  for (int r = 0; r < 20000; r++) {
+    k = (int)(random32() % QUEUE_TIMERS);
+    if (random32() % 3) {
+      uint32_t delay = random32() % 5000;
+
+      schedTimerStart(&timers[k], delay, 0, (uint32_t)k % 4);
+      expiry[k] = simNow + delay;
+      running[k] = true;
+    } else {
+      schedTimerStop(&timers[k]);
+      running[k] = false;
+    }
+
+    first = -1;
+    for (int j = 0; j < QUEUE_TIMERS; j++) {
+      if (running[j]
+          && (first < 0 || (int32_t)(expiry[j] - expiry[first]) < 0)) {
+        first = j;
+      }
+    }
+    em = schedSleepModeGet(&timerArmed, &tick);
+    if (first >= 0 && em != schedEM0) {
+      CHECK(timerArmed);
+      CHECK(tick + schedInitSim.wakeupTicks[em] == expiry[first]);
+    }
+
+    if (r % 100 == 0) {
+      schedRunOnce();
+      for (int j = 0; j < QUEUE_TIMERS; j++) {
+        if (running[j] && (int32_t)(expiry[j] - simNow) <= 0) {
+          running[j] = false;
+        }
+      }
+    }
+  }
+  CHECK(!armedInPast);
+}
+
+int main(void)
+{
+  schedInit(&schedInitSim);
+  CHECK(schedTaskCreate(task0) == 0);
+  CHECK(schedTaskCreate(task1) == 1);
+  CHECK(schedTaskCreate(task2) == 2);
+  CHECK(schedTaskCreate(task3) == 3);
+
+  testEnergyModes();
+  testTimerModes();
+  testTimerRun();
+  testQueueOrder();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+// Host stand-in for em_core.h, used by the tests in the parent directory.
+// The tests run in a single thread, so the critical sections are empty.
+#ifndef EM_CORE_H
+#define EM_CORE_H
+
+#define CORE_DECLARE_IRQ_STATE          int coreIrqState = 0
+#define CORE_ENTER_CRITICAL()           ((void)coreIrqState)
+#define CORE_EXIT_CRITICAL()            ((void)coreIrqState)
+#define CORE_ENTER_ATOMIC()             ((void)coreIrqState)
+#define CORE_EXIT_ATOMIC()              ((void)coreIrqState)
+
+#endif // EM_CORE_H
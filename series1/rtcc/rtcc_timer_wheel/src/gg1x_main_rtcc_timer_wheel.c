@@ -0,0 +1,235 @@
+/***************************************************************************//**
+ * @file gg1x_main_rtcc_timer_wheel.c
+ * @brief This project demonstrates a hierarchical timer wheel that runs
+ * a thousand software timers from a single RTCC compare channel.
+ *
+ * Each timer models the timeout of a protocol transaction.  A periodic
+ * heartbeat timer toggles LED0 and completes a few transactions, which
+ * cancels their timeouts.  Between expiries, the device sleeps in EM2.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_rtcc.h"
+
+#include "bsp.h"
+#include "timer_wheel.h"
+
+// Level that turns an LED on, the GG11/GG12 kit RGB LEDs are active low
+#define LED_ON      0
+
+// RTCC ticks per second, the RTCC counts the LFXO without prescaling
+#define TICKS_PER_SECOND  32768
+
+// RTCC channel used for the timer wheel
+#define WHEEL_CC    1
+
+// Number of transaction timeouts and their range in ticks
+#define TIMEOUT_COUNT     1000
+#define TIMEOUT_MIN       (TICKS_PER_SECOND / 100)
+#define TIMEOUT_RANGE     (2 * TICKS_PER_SECOND)
+
+// Heartbeat period, and the transactions completed in each one
+#define HEARTBEAT_TICKS   (TICKS_PER_SECOND / 2)
+#define COMPLETIONS       50
+
+// Counters and wheel statistics, for viewing in the debugger
+volatile uint32_t timeouts;
+volatile uint32_t completions;
+timerWheelStats_TypeDef timerWheelStats;
+
+static timerWheelTimer_TypeDef transactions[TIMEOUT_COUNT];
+static timerWheelTimer_TypeDef heartbeat;
+
+static uint32_t randomState = 0x2545F491;
+
+/**************************************************************************//**
+ * @brief
+ *    Timer wheel hooks for the RTCC.
+ *****************************************************************************/
+static uint32_t rtccNow(void)
+{
+  return RTCC_CounterGet();
+}
+
+static void rtccArm(uint32_t tick)
+{
+  RTCC_ChannelCCVSet(WHEEL_CC, tick);
+  RTCC_IntClear(RTCC_IF_CC1);
+  RTCC_IntEnable(RTCC_IEN_CC1);
+
+  // If the tick has passed already, set the flag so that the wheel is
+  // processed immediately instead of after a full counter wrap
+  if ((int32_t)(tick - RTCC_CounterGet()) <= 0)
+    RTCC_IntSet(RTCC_IF_CC1);
+}
+
+static void rtccDisarm(void)
+{
+  RTCC_IntDisable(RTCC_IEN_CC1);
+  RTCC_IntClear(RTCC_IF_CC1);
+}
+
+void RTCC_IRQHandler(void)
+{
+  // The main loop processes the wheel after wake-up
+  RTCC_IntClear(RTCC_IF_CC1);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Pseudo-random numbers (xorshift32) for the demo timeouts.
+ *****************************************************************************/
+static uint32_t randomGet(void)
+{
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+static uint32_t randomTimeout(void)
+{
+  return TIMEOUT_MIN + randomGet() % TIMEOUT_RANGE;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Timer callbacks.
+ *****************************************************************************/
+// A transaction timed out, start the next one
+static void transactionTimeout(timerWheelTimer_TypeDef *timer)
+{
+  timeouts++;
+  timerWheelStart(timer, randomTimeout(), 0, transactionTimeout);
+}
+
+// Complete some transactions, which cancels and restarts their timeouts
+static void heartbeatExpired(timerWheelTimer_TypeDef *timer)
+{
+  timerWheelTimer_TypeDef *transaction;
+  uint32_t i;
+
+  (void)timer;
+  GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+
+  for (i = 0; i < COMPLETIONS; i++)
+  {
+    transaction = &transactions[randomGet() % TIMEOUT_COUNT];
+    timerWheelStop(transaction);
+    completions++;
+    timerWheelStart(transaction, randomTimeout(), 0, transactionTimeout);
+  }
+
+  timerWheelStatsGet(&timerWheelStats);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start the LFXO and the RTCC as a free running 32-bit counter.
+ *****************************************************************************/
+void rtccInit(void)
+{
+  CMU_LFXOInit_TypeDef lfxo = CMU_LFXOINIT_DEFAULT;
+  CMU_LFXOInit(&lfxo);
+  CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_LFXO);
+  CMU_ClockEnable(cmuClock_RTCC, true);
+
+  RTCC_Init_TypeDef rtcc = RTCC_INIT_DEFAULT;
+  rtcc.enable   = false;
+  rtcc.debugRun = false;
+  rtcc.presc    = rtccCntPresc_1;
+  RTCC_Init(&rtcc);
+
+  RTCC_CCChConf_TypeDef compCfg = RTCC_CH_INIT_COMPARE_DEFAULT;
+  RTCC_ChannelInit(WHEEL_CC, &compCfg);
+
+  RTCC_IntClear(_RTCC_IF_MASK);
+  NVIC_ClearPendingIRQ(RTCC_IRQn);
+  NVIC_EnableIRQ(RTCC_IRQn);
+
+  RTCC_Enable(true);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Main function
+ *****************************************************************************/
+int main(void)
+{
+  timerWheelInit_TypeDef wheelInit = {
+    .now = rtccNow,
+    .arm = rtccArm,
+    .disarm = rtccDisarm,
+  };
+  uint32_t next;
+  uint32_t i;
+  CORE_DECLARE_IRQ_STATE;
+
+  CHIP_Init();
+
+  // Initialize DCDC with kit specific parameters
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockEnable(cmuClock_GPIO, true);
+
+  GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, !LED_ON);
+
+  rtccInit();
+
+  timerWheelInit(&wheelInit);
+  for (i = 0; i < TIMEOUT_COUNT; i++)
+    timerWheelStart(&transactions[i], randomTimeout(), 0, transactionTimeout);
+  timerWheelStart(&heartbeat, HEARTBEAT_TICKS, HEARTBEAT_TICKS, heartbeatExpired);
+
+  while (1)
+  {
+    timerWheelProcess();
+
+    /*
+     * Sleep with interrupts disabled, so that a compare match after the
+     * check still ends the sleep.  All timers due in the same RTCC tick
+     * run after one wake-up.
+     */
+    CORE_ENTER_CRITICAL();
+    if (!timerWheelNextGet(&next) || (int32_t)(next - RTCC_CounterGet()) > 0)
+      EMU_EnterEM2(true);
+    CORE_EXIT_CRITICAL();
+  }
+}
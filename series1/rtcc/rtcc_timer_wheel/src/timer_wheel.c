@@ -0,0 +1,456 @@
+/***************************************************************************//**
+ * @file timer_wheel.c
+ * @brief Hierarchical timer wheel driven by one low energy timer compare
+ * channel
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_core.h"
+#include "timer_wheel.h"
+#include <stddef.h>
+
+// A running timer is in one slot of one level. Level l has a slot for each
+// value of bits [5l, 5l + 4] of the tick, and a timer is put on the lowest
+// level at which its expiry and the wheel time agree in all higher bits.
+// Level 0 slots therefore hold the timers of one tick each. When the wheel
+// time reaches the start of a higher level slot, its timers are moved down
+// (cascaded), which is at most once per level for each timer.
+//
+// Starting and stopping a timer is O(1): the slot lists are doubly linked
+// and a bit per slot tells which slots are in use, so the next event is
+// found with CLZ in each level's occupancy mask. All timers due in the same
+// tick are in the same level 0 slot and run after a single wakeup.
+
+#define SLOT_MASK       (TIMER_WHEEL_SLOTS - 1)
+
+// Index of a timer that is in a list taken out of the wheel for processing
+#define INDEX_DETACHED  (0xFFFF)
+
+static timerWheelInit_TypeDef hal;
+static timerWheelTimer_TypeDef *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static uint32_t occupied[TIMER_WHEEL_LEVELS];
+static uint32_t wheelTime;              // Ticks before this are processed
+static bool armed;
+static uint32_t armedTick;
+static bool processing;
+static timerWheelStats_TypeDef stats;
+
+static inline bool tickBeforeEq(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) <= 0;
+}
+
+static inline uint32_t levelShift(uint32_t level)
+{
+  return level * TIMER_WHEEL_SLOT_BITS;
+}
+
+// Index of the lowest set bit, x must not be 0
+static inline uint32_t lowestBit(uint32_t x)
+{
+  return __CLZ(__RBIT(x));
+}
+
+/***************************************************************************//**
+ * @brief Tick at which a timer is placed, a timer that is already due is put
+ * in the slot of the next tick to process
+ ******************************************************************************/
+static uint32_t placeTick(const timerWheelTimer_TypeDef *timer)
+{
+  return tickBeforeEq(timer->expiry, wheelTime) ? wheelTime : timer->expiry;
+}
+
+/***************************************************************************//**
+ * @brief Link a timer into the slot for its expiry
+ ******************************************************************************/
+static void timerLink(timerWheelTimer_TypeDef *timer)
+{
+  uint32_t tick = placeTick(timer);
+  uint32_t diff = tick ^ wheelTime;
+  uint32_t level = 0;
+  uint32_t slot;
+
+  if (diff != 0) {
+    level = (31 - __CLZ(diff)) / TIMER_WHEEL_SLOT_BITS;
+  }
+  slot = (tick >> levelShift(level)) & SLOT_MASK;
+
+  timer->next = slots[level][slot];
+  if (timer->next != NULL) {
+    timer->next->pprev = &timer->next;
+  }
+  slots[level][slot] = timer;
+  timer->pprev = &slots[level][slot];
+  timer->index = (uint16_t)(level * TIMER_WHEEL_SLOTS + slot);
+  occupied[level] |= 1UL << slot;
+}
+
+/***************************************************************************//**
+ * @brief Unlink a timer, the occupancy bit is cleared if its slot is empty
+ ******************************************************************************/
+static void timerUnlink(timerWheelTimer_TypeDef *timer)
+{
+  uint32_t index = timer->index;
+
+  *timer->pprev = timer->next;
+  if (timer->next != NULL) {
+    timer->next->pprev = timer->pprev;
+  } else if (index != INDEX_DETACHED
+             && timer->pprev == &slots[index / TIMER_WHEEL_SLOTS][index & SLOT_MASK]) {
+    occupied[index / TIMER_WHEEL_SLOTS] &= ~(1UL << (index & SLOT_MASK));
+  }
+  timer->next = NULL;
+  timer->pprev = NULL;
+}
+
+/***************************************************************************//**
+ * @brief Take all timers out of a slot
+ *
+ * @param head List head to move the timers to, must stay valid until the
+ * list is empty, since timerUnlink() links through it.
+ ******************************************************************************/
+static void slotDetach(uint32_t level, uint32_t slot,
+                       timerWheelTimer_TypeDef **head)
+{
+  timerWheelTimer_TypeDef *timer;
+
+  *head = slots[level][slot];
+  if (*head != NULL) {
+    (*head)->pprev = head;
+  }
+  for (timer = *head; timer != NULL; timer = timer->next) {
+    timer->index = INDEX_DETACHED;
+  }
+  slots[level][slot] = NULL;
+  occupied[level] &= ~(1UL << slot);
+}
+
+/***************************************************************************//**
+ * @brief Find the next tick at which the wheel has work to do
+ *
+ * @details This is the tick of the first used level 0 slot, or, if level 0
+ * is empty, the start of the first used slot on the lowest used level, where
+ * its timers have to be cascaded. Slots behind the wheel time can only be in
+ * use on the top level after the tick count has wrapped.
+ *
+ * @param level Set to the level of the event.
+ * @param slot Set to the slot of the event.
+ * @return false if no timer is running.
+ ******************************************************************************/
+static bool nextEventGet(uint32_t *tick, uint32_t *level, uint32_t *slot)
+{
+  uint32_t l;
+  uint32_t shift;
+  uint32_t index;
+  uint32_t ahead;
+  uint32_t base;
+
+  for (l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+    if (occupied[l] == 0) {
+      continue;
+    }
+    shift = levelShift(l);
+    index = (wheelTime >> shift) & SLOT_MASK;
+    ahead = occupied[l] & (~0UL << index);
+
+    // Start of the current rotation of this level
+    base = (shift + TIMER_WHEEL_SLOT_BITS < 32)
+           ? wheelTime & ~((1UL << (shift + TIMER_WHEEL_SLOT_BITS)) - 1) : 0;
+    if (ahead != 0) {
+      *slot = lowestBit(ahead);
+    } else {
+      *slot = lowestBit(occupied[l]);
+      base += (uint32_t)TIMER_WHEEL_SLOTS << shift;
+    }
+    *tick = base + (*slot << shift);
+    *level = l;
+    return true;
+  }
+  return false;
+}
+
+/***************************************************************************//**
+ * @brief Find the earliest expiry, which is an exact tick even when the next
+ * event is a cascade
+ ******************************************************************************/
+static bool nextExpiryGet(uint32_t *tick)
+{
+  timerWheelTimer_TypeDef *timer;
+  uint32_t level;
+  uint32_t slot;
+  uint32_t earliest;
+  uint32_t place;
+
+  if (!nextEventGet(tick, &level, &slot)) {
+    return false;
+  }
+  if (level == 0) {
+    return true;
+  }
+
+  // Only this slot is scanned, all timers in later slots expire later
+  earliest = placeTick(slots[level][slot]);
+  for (timer = slots[level][slot]->next; timer != NULL; timer = timer->next) {
+    place = placeTick(timer);
+    if (tickBeforeEq(place, earliest)) {
+      earliest = place;
+    }
+  }
+  *tick = earliest;
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief Arm the compare channel for the earliest expiry
+ ******************************************************************************/
+static void rearm(void)
+{
+  uint32_t tick;
+
+  if (nextExpiryGet(&tick)) {
+    if (!armed || tick != armedTick) {
+      armed = true;
+      armedTick = tick;
+      stats.arms++;
+      hal.arm(tick);
+    }
+  } else if (armed) {
+    armed = false;
+    hal.disarm();
+  }
+}
+
+/***************************************************************************//**
+ * @brief Move the timers of the higher level slots that start at tick down
+ * to lower levels, highest level first
+ ******************************************************************************/
+static void cascade(uint32_t tick)
+{
+  timerWheelTimer_TypeDef *list;
+  timerWheelTimer_TypeDef *timer;
+  uint32_t level;
+  uint32_t shift;
+
+  for (level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+    shift = levelShift(level);
+    if ((tick & ((1UL << shift) - 1)) != 0) {
+      continue;
+    }
+    slotDetach(level, (tick >> shift) & SLOT_MASK, &list);
+    while (list != NULL) {
+      timer = list;
+      timerUnlink(timer);
+      timerLink(timer);
+      stats.cascades++;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Set up an empty wheel with a low energy timer
+ ******************************************************************************/
+void timerWheelInit(const timerWheelInit_TypeDef *init)
+{
+  uint32_t level;
+  uint32_t slot;
+
+  hal = *init;
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+      slots[level][slot] = NULL;
+    }
+    occupied[level] = 0;
+  }
+  wheelTime = hal.now();
+  armed = false;
+  processing = false;
+  stats = (timerWheelStats_TypeDef){ 0 };
+  hal.disarm();
+}
+
+/***************************************************************************//**
+ * @brief Start or restart a timer, can be called from interrupt handlers and
+ * from timer callbacks
+ *
+ * @param timer Timer, must stay valid while it is running.
+ * @param delay Ticks until the callback is run, at most
+ * TIMER_WHEEL_MAX_DELAY.
+ * @param period Ticks between later runs, or 0 for a one-shot timer.
+ * @param callback Function run from timerWheelProcess() when the timer
+ * expires.
+ ******************************************************************************/
+void timerWheelStart(timerWheelTimer_TypeDef *timer, uint32_t delay,
+                     uint32_t period, timerWheelCallback_TypeDef callback)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  if (timer->pprev != NULL) {
+    timerUnlink(timer);
+    stats.running--;
+  }
+  timer->expiry = hal.now() + delay;
+  timer->period = period;
+  timer->callback = callback;
+  timerLink(timer);
+  stats.running++;
+
+  // Only an earlier expiry changes the compare value, a later one is seen
+  // when the wheel is processed
+  if (!processing && (!armed || !tickBeforeEq(armedTick, placeTick(timer)))) {
+    armed = true;
+    armedTick = placeTick(timer);
+    stats.arms++;
+    hal.arm(armedTick);
+  }
+  CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief Stop a timer, does nothing if it is not running
+ ******************************************************************************/
+void timerWheelStop(timerWheelTimer_TypeDef *timer)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  if (timer->pprev != NULL) {
+    timerUnlink(timer);
+    stats.running--;
+
+    // Avoid a wakeup for nothing if this was the armed timer
+    if (!processing && armed && tickBeforeEq(placeTick(timer), armedTick)) {
+      rearm();
+    }
+  }
+  CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief Check if a timer is running
+ ******************************************************************************/
+bool timerWheelRunning(const timerWheelTimer_TypeDef *timer)
+{
+  return timer->pprev != NULL;
+}
+
+/***************************************************************************//**
+ * @brief Get the tick at which timerWheelProcess() must be called next
+ *
+ * @return false if no timer is running.
+ ******************************************************************************/
+bool timerWheelNextGet(uint32_t *tick)
+{
+  *tick = armedTick;
+  return armed;
+}
+
+/***************************************************************************//**
+ * @brief Run the callbacks of all due timers and arm the compare channel for
+ * the next expiry
+ *
+ * @details Call this after each wakeup. Ticks that were missed are caught up
+ * in one call, and the callbacks are run with interrupts enabled.
+ ******************************************************************************/
+void timerWheelProcess(void)
+{
+  timerWheelTimer_TypeDef *due;
+  timerWheelTimer_TypeDef *timer;
+  uint32_t tick;
+  uint32_t level;
+  uint32_t slot;
+  uint32_t now;
+  uint32_t fired;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  processing = true;
+  now = hal.now();
+  while (nextEventGet(&tick, &level, &slot) && tickBeforeEq(tick, now)) {
+    // Nothing is due between the wheel time and tick, so jump to it
+    wheelTime = tick;
+    cascade(tick);
+    slotDetach(0, tick & SLOT_MASK, &due);
+
+    fired = 0;
+    while (due != NULL) {
+      timer = due;
+      timerUnlink(timer);
+      stats.running--;
+      fired++;
+
+      if (timer->period != 0) {
+        // Keep the period phase, but skip periods that were missed entirely
+        timer->expiry += timer->period;
+        if (tickBeforeEq(timer->expiry, now)) {
+          timer->expiry = now + timer->period;
+        }
+        timerLink(timer);
+        stats.running++;
+      }
+
+      // The callback may start or stop any timer, including this one
+      CORE_EXIT_CRITICAL();
+      timer->callback(timer);
+      CORE_ENTER_CRITICAL();
+    }
+
+    if (fired > 0) {
+      stats.fired += fired;
+      stats.ticks++;
+      if (fired > stats.maxPerTick) {
+        stats.maxPerTick = fired;
+      }
+    }
+    now = hal.now();
+  }
+
+  // Nothing is due up to now either. A timer started later with an expiry
+  // at or before now goes in the slot of now and runs on the next call.
+  wheelTime = now;
+  processing = false;
+  rearm();
+  CORE_EXIT_CRITICAL();
+}
+
+/***************************************************************************//**
+ * @brief Get the wheel statistics
+ ******************************************************************************/
+void timerWheelStatsGet(timerWheelStats_TypeDef *statsOut)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  *statsOut = stats;
+  CORE_EXIT_CRITICAL();
+}
@@ -0,0 +1,103 @@
+/***************************************************************************//**
+ * @file timer_wheel.h
+ * @brief Hierarchical timer wheel driven by one low energy timer compare
+ * channel
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Each level has 2^TIMER_WHEEL_SLOT_BITS slots, one bit per slot in a
+// 32-bit occupancy mask
+#define TIMER_WHEEL_SLOT_BITS           (5)
+#define TIMER_WHEEL_SLOTS               (1 << TIMER_WHEEL_SLOT_BITS)
+
+// Number of levels, enough to cover the 32-bit tick count
+#define TIMER_WHEEL_LEVELS              ((32 + TIMER_WHEEL_SLOT_BITS - 1) \
+                                         / TIMER_WHEEL_SLOT_BITS)
+
+// Longest delay, later expiries cannot be told apart from past ones
+#define TIMER_WHEEL_MAX_DELAY           (0x7FFFFFFFUL)
+
+typedef struct timerWheelTimer timerWheelTimer_TypeDef;
+
+typedef void (*timerWheelCallback_TypeDef)(timerWheelTimer_TypeDef *timer);
+
+// Timer, owned by the application and linked into a slot while running.
+// Must be zero initialized before it is first started.
+struct timerWheelTimer {
+  timerWheelTimer_TypeDef *next;
+  timerWheelTimer_TypeDef **pprev;      // Link pointing here, NULL if stopped
+  uint32_t expiry;                      // Tick at which the timer is due
+  uint32_t period;                      // Reload in ticks, 0 for one-shot
+  timerWheelCallback_TypeDef callback;
+  uint16_t index;                       // Level and slot of the list
+};
+
+// Low energy timer that drives the wheel, e.g. an RTCC compare channel
+typedef struct {
+  uint32_t (*now)(void);                // Current tick count
+  void (*arm)(uint32_t tick);           // Interrupt at this tick
+  void (*disarm)(void);
+} timerWheelInit_TypeDef;
+
+typedef struct {
+  uint32_t running;                     // Timers currently in the wheel
+  uint32_t fired;                       // Callbacks run
+  uint32_t ticks;                       // Ticks in which timers fired
+  uint32_t maxPerTick;                  // Most timers fired in one tick
+  uint32_t cascades;                    // Timers moved to a lower level
+  uint32_t arms;                        // Compare channel updates
+} timerWheelStats_TypeDef;
+
+void timerWheelInit(const timerWheelInit_TypeDef *init);
+void timerWheelStart(timerWheelTimer_TypeDef *timer, uint32_t delay,
+                     uint32_t period, timerWheelCallback_TypeDef callback);
+void timerWheelStop(timerWheelTimer_TypeDef *timer);
+bool timerWheelRunning(const timerWheelTimer_TypeDef *timer);
+bool timerWheelNextGet(uint32_t *tick);
+void timerWheelProcess(void);
+void timerWheelStatsGet(timerWheelStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMER_WHEEL_H
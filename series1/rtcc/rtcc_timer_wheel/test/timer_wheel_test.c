@@ -0,0 +1,394 @@
+/***************************************************************************//**
+ * @file timer_wheel_test.c
+ * @brief Host test of timer_wheel.c against a reference that scans every timer
+ * for the next expiry
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/timer_wheel_test.c
+//       src/timer_wheel.c -o timer_wheel_test
+//   ./timer_wheel_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "timer_wheel.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define TIMERS          (3000)
+#define STOPPED         (0xFFFFFFFFUL)
+
+static int checks;
+static int failures;
+
+// Simulated RTCC compare channel
+static uint32_t simNow;
+static uint32_t armTick;
+static bool armed;
+
+static timerWheelTimer_TypeDef timers[TIMERS];
+
+// Reference state of each timer
+static bool refRunning[TIMERS];
+static uint32_t refExpiry[TIMERS];
+static uint32_t refPeriod[TIMERS];
+
+// Timers fired and stopped by callbacks in the current processing pass, and
+// the starts and stops done by callbacks, applied to the reference after
+// the pass
+static bool fired[TIMERS];
+static bool stoppedInPass[TIMERS];
+static int pending;
+static int pendingTimer[TIMERS];
+static uint32_t pendingDelay[TIMERS];
+static uint32_t pendingPeriod[TIMERS];
+static bool doubleFire;
+
+static uint32_t seed = 88;
+
+static uint32_t simTimerNow(void)
+{
+  return simNow;
+}
+
+static void simTimerArm(uint32_t tick)
+{
+  armTick = tick;
+  armed = true;
+}
+
+static void simTimerDisarm(void)
+{
+  armed = false;
+}
+
+static const timerWheelInit_TypeDef wheelInit = {
+  simTimerNow, simTimerArm, simTimerDisarm
+};
+
+/***************************************************************************//**
+ * @brief Xorshift generator, so that the test does not depend on the C
+ * library rand()
+ ******************************************************************************/
+static uint32_t random32(void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+/***************************************************************************//**
+ * @brief Random delay, from a few ticks to the longest allowed
+ ******************************************************************************/
+static uint32_t randomDelay(void)
+{
+  switch (random32() % 6) {
+    case 0:
+      return random32() % 4;
+    case 1:
+      return random32() % 40;
+    case 2:
+      return random32() % 3000;
+    case 3:
+      return random32() % 400000;
+    case 4:
+      return random32() % TIMER_WHEEL_MAX_DELAY;
+    default:
+      return random32() % (1u << 20);
+  }
+}
+
+/***************************************************************************//**
+ * @brief True if tick a is not after tick b
+ ******************************************************************************/
+static bool notAfter(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) <= 0;
+}
+
+static void refStart(int i, uint32_t delay, uint32_t period)
+{
+  refRunning[i] = true;
+  refExpiry[i] = simNow + delay;
+  refPeriod[i] = period;
+}
+
+/***************************************************************************//**
+ * @brief Earliest reference expiry
+ * @return false if no timer is running
+ ******************************************************************************/
+static bool refNext(uint32_t *tick)
+{
+  bool any = false;
+
+  for (int i = 0; i < TIMERS; i++) {
+    if (refRunning[i] && (!any || notAfter(refExpiry[i], *tick))) {
+      *tick = refExpiry[i];
+      any = true;
+    }
+  }
+  return any;
+}
+
+/***************************************************************************//**
+ * @brief Callback that only records the timer
+ ******************************************************************************/
+static void basicCallback(timerWheelTimer_TypeDef *timer)
+{
+  fired[timer - timers] = true;
+}
+
+/***************************************************************************//**
+ * @brief Callback: records the timer and sometimes restarts it or stops
+ * another timer that has not fired yet
+ ******************************************************************************/
+static void callback(timerWheelTimer_TypeDef *timer)
+{
+  int i = (int)(timer - timers);
+  int j;
+
+  if (fired[i]) {
+    doubleFire = true;
+  }
+  fired[i] = true;
+
+  if (random32() % 3 == 0) {
+    pendingTimer[pending] = i;
+    pendingDelay[pending] = 1 + randomDelay() % 100000;
+    pendingPeriod[pending] = (random32() % 4 == 0) ? 1 + random32() % 999 : 0;
+    timerWheelStart(timer, pendingDelay[pending], pendingPeriod[pending],
+                    callback);
+    pending++;
+  }
+  if (random32() % 5 == 0) {
+    j = (int)(random32() % TIMERS);
+    if (!fired[j]) {
+      timerWheelStop(&timers[j]);
+      stoppedInPass[j] = true;
+      pendingTimer[pending] = j;
+      pendingDelay[pending] = STOPPED;
+      pending++;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Run timerWheelProcess() and compare the fired timers, the running
+ * timers and the armed tick with the reference
+ ******************************************************************************/
+static void processAndCompare(void)
+{
+  bool due;
+  bool any;
+  uint32_t next = 0;
+  uint32_t tick;
+  int mismatches = 0;
+
+  memset(fired, 0, sizeof(fired));
+  memset(stoppedInPass, 0, sizeof(stoppedInPass));
+  pending = 0;
+
+  timerWheelProcess();
+
+  for (int i = 0; i < TIMERS; i++) {
+    due = refRunning[i] && notAfter(refExpiry[i], simNow) && !stoppedInPass[i];
+    if (due != fired[i]) {
+      mismatches++;
+    }
+    if (due && refPeriod[i] != 0) {
+      refExpiry[i] += refPeriod[i];
+      if (notAfter(refExpiry[i], simNow)) {
+        refExpiry[i] = simNow + refPeriod[i];
+      }
+    } else if (due || stoppedInPass[i]) {
+      refRunning[i] = false;
+    }
+  }
+  for (int k = 0; k < pending; k++) {
+    if (pendingDelay[k] == STOPPED) {
+      refRunning[pendingTimer[k]] = false;
+    } else {
+      refStart(pendingTimer[k], pendingDelay[k], pendingPeriod[k]);
+    }
+  }
+  for (int i = 0; i < TIMERS; i++) {
+    if (refRunning[i] != timerWheelRunning(&timers[i])) {
+      mismatches++;
+    }
+  }
+  CHECK(mismatches == 0);
+
+  // The compare channel is armed to the exact earliest expiry, or to the
+  // next tick if that expiry has passed
+  any = refNext(&next);
+  CHECK(timerWheelNextGet(&tick) == any);
+  CHECK(armed == any);
+  if (any) {
+    CHECK(armTick == tick);
+    CHECK(notAfter(next, tick));
+    CHECK(notAfter(tick, notAfter(next, simNow) ? simNow + 1 : next));
+  }
+}
+
+/***************************************************************************//**
+ * @brief Random starts, stops and time steps from a given start tick, with
+ * late wake-ups and counter wrap
+ ******************************************************************************/
+static void runRandom(uint32_t start, int steps)
+{
+  uint32_t next = 0;
+  uint32_t tick;
+  uint32_t delay;
+  uint32_t period;
+  int ops;
+  int i;
+
+  simNow = start;
+  memset(timers, 0, sizeof(timers));
+  memset(refRunning, 0, sizeof(refRunning));
+  timerWheelInit(&wheelInit);
+
+  for (int s = 0; s < steps; s++) {
+    ops = (int)(random32() % 20);
+    for (int k = 0; k < ops; k++) {
+      i = (int)(random32() % TIMERS);
+      if (random32() % 4 == 0) {
+        timerWheelStop(&timers[i]);
+        refRunning[i] = false;
+      } else {
+        delay = randomDelay();
+        period = (random32() % 5 == 0) ? 1 + random32() % 50000 : 0;
+        timerWheelStart(&timers[i], delay, period, callback);
+        refStart(i, delay, period);
+      }
+    }
+
+    // Never armed later than the earliest expiry
+    if (refNext(&next)) {
+      CHECK(timerWheelNextGet(&tick));
+      CHECK(notAfter(tick, notAfter(next, simNow) ? simNow + 1 : next));
+    }
+
+    // Wake at the armed tick, a little later or much later
+    switch (random32() % 3) {
+      case 0:
+        if (timerWheelNextGet(&tick) && notAfter(simNow, tick)) {
+          simNow = tick;
+        } else {
+          simNow++;
+        }
+        break;
+      case 1:
+        simNow += random32() % 100;
+        break;
+      default:
+        simNow += random32() % 2000000;
+        break;
+    }
+    processAndCompare();
+  }
+  CHECK(!doubleFire);
+}
+
+/***************************************************************************//**
+ * @brief Timers due in the same tick fire in one pass, a periodic timer keeps
+ * its phase, and a stopped timer does not fire
+ ******************************************************************************/
+static void testBasic(void)
+{
+  timerWheelStats_TypeDef stats;
+  uint32_t tick;
+
+  simNow = 1000;
+  memset(timers, 0, sizeof(timers));
+  timerWheelInit(&wheelInit);
+  CHECK(!timerWheelNextGet(&tick));
+  CHECK(!armed);
+
+  for (int i = 0; i < 100; i++) {
+    timerWheelStart(&timers[i], 5000, 0, basicCallback);
+  }
+  timerWheelStart(&timers[100], 100, 100, basicCallback);
+  timerWheelStart(&timers[101], 3000, 0, basicCallback);
+  timerWheelStop(&timers[101]);
+  CHECK(!timerWheelRunning(&timers[101]));
+  CHECK(timerWheelNextGet(&tick));
+  CHECK(tick == 1100);
+  CHECK(armTick == 1100);
+
+  for (int n = 1; n <= 49; n++) {
+    memset(fired, 0, sizeof(fired));
+    simNow = 1000 + 100 * (uint32_t)n;
+    timerWheelProcess();
+    CHECK(fired[100]);
+    CHECK(armTick == simNow + 100);
+  }
+  CHECK(!fired[101]);
+
+  timerWheelStop(&timers[100]);
+  memset(fired, 0, sizeof(fired));
+  simNow = 6000;
+  timerWheelProcess();
+  timerWheelStatsGet(&stats);
+  CHECK(stats.maxPerTick == 100);
+  CHECK(stats.running == 0);
+  CHECK(!armed);
+  for (int i = 0; i < 100; i++) {
+    CHECK(fired[i]);
+    CHECK(!timerWheelRunning(&timers[i]));
+  }
+}
+
+int main(void)
+{
+  testBasic();
+  runRandom(0, 20000);
+  runRandom(0xFFFF0000u, 20000);
+  runRandom(0x7FFFFF00u, 20000);
+  runRandom(0xFFFFFFF0u, 5000);
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
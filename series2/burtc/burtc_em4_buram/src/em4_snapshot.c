@@ -0,0 +1,180 @@
+/***************************************************************************//**
+ * @file em4_snapshot.c
+ * @brief Application state snapshot in EM4 retention registers
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em4_snapshot.h"
+#include <string.h>
+
+// The snapshot is stored as one header word, the state rounded up to whole
+// words, and a CRC-32 over both. The CRC is written last, so a reset while
+// saving leaves a snapshot that is rejected instead of half of a new one.
+// Retention registers only take word accesses, so the state is copied word
+// by word through a local buffer.
+
+#define HEADER(version, words)  ((EM4_SNAPSHOT_MAGIC << 16) \
+                                 | ((uint32_t)(version) << 8) | (words))
+
+// CRC-32 (IEEE 802.3, reflected) nibble table, small enough for a boot path
+static const uint32_t crcTable[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+  0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+  0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crcWord(uint32_t crc, uint32_t word)
+{
+  uint32_t i;
+
+  crc ^= word;
+  for (i = 0; i < 8; i++) {
+    crc = (crc >> 4) ^ crcTable[crc & 0xF];
+  }
+  return crc;
+}
+
+/***************************************************************************//**
+ * @brief Update a CRC-32, e.g. to hash a peripheral init structure
+ *
+ * @param crc 0 to start, or the result of the previous call.
+ * @param data Data to add.
+ * @param size Size of data in bytes.
+ ******************************************************************************/
+uint32_t em4SnapshotCrc32(uint32_t crc, const void *data, uint32_t size)
+{
+  const uint8_t *p = data;
+  uint32_t i;
+
+  crc = ~crc;
+  while (size-- > 0) {
+    crc ^= *p++;
+    for (i = 0; i < 2; i++) {
+      crc = (crc >> 4) ^ crcTable[crc & 0xF];
+    }
+  }
+  return ~crc;
+}
+
+/***************************************************************************//**
+ * @brief Save a state to retention registers before entering EM4
+ *
+ * @param ret First retention register, e.g. &BURAM->RET[0].REG.
+ * @param retWords Number of retention registers that can be used.
+ * @param version Layout version of the state, change it when the state
+ * structure changes.
+ * @param state State to save.
+ * @param size Size of state in bytes.
+ * @return 0 or EM4_SNAPSHOT_ERR_SIZE.
+ ******************************************************************************/
+int em4SnapshotSave(volatile uint32_t *ret, uint32_t retWords,
+                    uint8_t version, const void *state, uint32_t size)
+{
+  const uint8_t *p = state;
+  uint32_t words = (size + 3) / 4;
+  uint32_t header;
+  uint32_t crc;
+  uint32_t word;
+  uint32_t i;
+
+  if (words > 0xFF || words + EM4_SNAPSHOT_OVERHEAD_WORDS > retWords) {
+    return EM4_SNAPSHOT_ERR_SIZE;
+  }
+
+  header = HEADER(version, words);
+  ret[0] = header;
+  crc = crcWord(0xFFFFFFFFUL, header);
+  for (i = 0; i < words; i++) {
+    word = 0;
+    memcpy(&word, p + 4 * i, (size - 4 * i < 4) ? size - 4 * i : 4);
+    ret[1 + i] = word;
+    crc = crcWord(crc, word);
+  }
+  ret[1 + words] = ~crc;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Restore a state after an EM4 wakeup
+ *
+ * @details state is only written if the snapshot is valid, so it can hold
+ * the defaults for a cold start when this fails.
+ *
+ * @return 0 if state was restored, or EM4_SNAPSHOT_ERR_EMPTY,
+ * EM4_SNAPSHOT_ERR_VERSION, EM4_SNAPSHOT_ERR_CRC or EM4_SNAPSHOT_ERR_SIZE.
+ ******************************************************************************/
+int em4SnapshotRestore(const volatile uint32_t *ret, uint32_t retWords,
+                       uint8_t version, void *state, uint32_t size)
+{
+  uint8_t *p = state;
+  uint32_t words = (size + 3) / 4;
+  uint32_t header;
+  uint32_t crc;
+  uint32_t word;
+  uint32_t i;
+
+  if (words > 0xFF || words + EM4_SNAPSHOT_OVERHEAD_WORDS > retWords) {
+    return EM4_SNAPSHOT_ERR_SIZE;
+  }
+
+  header = ret[0];
+  if ((header >> 16) != EM4_SNAPSHOT_MAGIC) {
+    return EM4_SNAPSHOT_ERR_EMPTY;
+  }
+  if (header != HEADER(version, words)) {
+    return EM4_SNAPSHOT_ERR_VERSION;
+  }
+
+  // Check the CRC before anything is copied
+  crc = crcWord(0xFFFFFFFFUL, header);
+  for (i = 0; i < words; i++) {
+    crc = crcWord(crc, ret[1 + i]);
+  }
+  if (~crc != ret[1 + words]) {
+    return EM4_SNAPSHOT_ERR_CRC;
+  }
+
+  for (i = 0; i < words; i++) {
+    word = ret[1 + i];
+    memcpy(p + 4 * i, &word, (size - 4 * i < 4) ? size - 4 * i : 4);
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Invalidate the snapshot, so that the next boot is a cold start
+ ******************************************************************************/
+void em4SnapshotInvalidate(volatile uint32_t *ret)
+{
+  ret[0] = 0;
+}
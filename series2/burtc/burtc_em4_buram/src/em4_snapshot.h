@@ -0,0 +1,75 @@
+/***************************************************************************//**
+ * @file em4_snapshot.h
+ * @brief Application state snapshot in EM4 retention registers
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef EM4_SNAPSHOT_H
+#define EM4_SNAPSHOT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Header word: magic, layout version and payload length in words
+#define EM4_SNAPSHOT_MAGIC              (0x534EUL)
+
+// Header and CRC words around the payload
+#define EM4_SNAPSHOT_OVERHEAD_WORDS     (2)
+
+// Retention words needed for a state of the given size in bytes
+#define EM4_SNAPSHOT_WORDS(size)        ((((size) + 3) / 4) \
+                                         + EM4_SNAPSHOT_OVERHEAD_WORDS)
+
+// No snapshot, e.g. after a power-on reset
+#define EM4_SNAPSHOT_ERR_EMPTY          (-0x5A00)
+// Snapshot of another state layout or size
+#define EM4_SNAPSHOT_ERR_VERSION        (-0x5980)
+// Snapshot corrupted, e.g. by a reset while it was saved
+#define EM4_SNAPSHOT_ERR_CRC            (-0x5900)
+// State does not fit in the retention registers
+#define EM4_SNAPSHOT_ERR_SIZE           (-0x5880)
+
+int em4SnapshotSave(volatile uint32_t *ret, uint32_t retWords,
+                    uint8_t version, const void *state, uint32_t size);
+int em4SnapshotRestore(const volatile uint32_t *ret, uint32_t retWords,
+                       uint8_t version, void *state, uint32_t size);
+void em4SnapshotInvalidate(volatile uint32_t *ret);
+uint32_t em4SnapshotCrc32(uint32_t crc, const void *data, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EM4_SNAPSHOT_H
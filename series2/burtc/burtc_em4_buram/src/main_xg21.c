@@ -3,6 +3,8 @@
  * @brief This project uses the BURTC (Backup Real Time Counter) to wake the
  * device from EM4 mode and thus trigger a reset. This project also shows how to
  * use the BURAM retention registers to have data persist between resets.
+ * The application state is kept as a snapshot with a CRC, so that after an
+ * EM4 wakeup the configuration that is still valid is not done again.
  *******************************************************************************
  * # License
  * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
@@ -45,10 +47,27 @@
 #include "bsp.h"
 #include "retargetserial.h"
 #include "stdio.h"
+#include <stdbool.h>
+#include "em4_snapshot.h"
 
 // Number of 1 KHz ULFRCO clocks between BURTC interrupts
 #define BURTC_IRQ_PERIOD 	3000
 
+// Layout version of appState_TypeDef, change it when the structure changes
+#define SNAPSHOT_VERSION  1
+
+// Number of BURAM retention registers
+#define BURAM_REG_COUNT   (sizeof(BURAM->RET) / sizeof(BURAM->RET[0]))
+
+// Application state that is kept through EM4
+typedef struct {
+  uint32_t wakeups;         // Number of EM4 wakeups since the last cold start
+  uint32_t burtcHash;       // Hash of the BURTC configuration in use
+  uint32_t coldCycles;      // Init time of the last cold start
+} appState_TypeDef;
+
+static appState_TypeDef appState;
+
 /**************************************************************************//**
  * @brief  BURTC Handler
  *****************************************************************************/
@@ -69,49 +88,65 @@ void initGPIO(void)
 
 /**************************************************************************//**
  * @brief  Configure BURTC to interrupt every BURTC_IRQ_PERIOD and
- *         wake from EM4
+ *         wake from EM4, unless it is running with this configuration
  *****************************************************************************/
-void initBURTC(void)
+void initBURTC(bool warm)
 {
+  uint32_t config[5];
+  uint32_t hash;
+
   CMU_ClockSelectSet(cmuClock_EM4GRPACLK, cmuSelect_ULFRCO);
 
   BURTC_Init_TypeDef burtcInit = BURTC_INIT_DEFAULT;
   burtcInit.compare0Top = true; // reset counter when counter reaches compare value
   burtcInit.em4comp = true;     // BURTC compare interrupt wakes from EM4 (causes reset)
-  BURTC_Init(&burtcInit);
 
-  BURTC_CounterReset();
-  BURTC_CompareSet(0, BURTC_IRQ_PERIOD);
+  // The BURTC keeps running in EM4, so after a warm start it only has to be
+  // initialized if its configuration has changed. BURTC_Init() waits for
+  // the BURTC clock domain, which takes several milliseconds.
+  // The settings are hashed one by one, since the structure has padding
+  config[0] = burtcInit.clkDiv;
+  config[1] = burtcInit.compare0Top;
+  config[2] = burtcInit.em4comp;
+  config[3] = burtcInit.em4overflow;
+  config[4] = BURTC_IRQ_PERIOD;
+  hash = em4SnapshotCrc32(0, config, sizeof(config));
+  if (!warm || hash != appState.burtcHash)
+  {
+    BURTC_Init(&burtcInit);
+
+    BURTC_CounterReset();
+    BURTC_CompareSet(0, BURTC_IRQ_PERIOD);
 
-  BURTC_IntEnable(BURTC_IEN_COMP); 		// compare match
+    BURTC_IntEnable(BURTC_IEN_COMP); 		// compare match
+    BURTC_Enable(true);
+    appState.burtcHash = hash;
+  }
   NVIC_EnableIRQ(BURTC_IRQn);
-  BURTC_Enable(true);
 }
 
 /**************************************************************************//**
- * @brief	Check RSTCAUSE for EM4 wakeups (reset) and save wakeup count
- *          to BURAM
+ * @brief	Check RSTCAUSE and restore the application state after an EM4
+ *          wakeup
+ *
+ * @return  true for a warm start with a valid state snapshot
  *****************************************************************************/
-void checkResetCause (void)
+bool restoreState(void)
 {
   uint32_t cause = RMU_ResetCauseGet();
   RMU_ResetCauseClear();
 
-  // Print reset cause
-  if (cause & EMU_RSTCAUSE_PIN)
+  // A pin reset during EM4 sets both causes, and is a cold start
+  if ((cause & EMU_RSTCAUSE_EM4) && !(cause & EMU_RSTCAUSE_PIN)
+      && em4SnapshotRestore(&BURAM->RET[0].REG, BURAM_REG_COUNT, SNAPSHOT_VERSION,
+                            &appState, sizeof(appState)) == 0)
   {
-    printf("-- RSTCAUSE = PIN \n");
-    BURAM->RET[0].REG = 0; // reset EM4 wakeup counter
-  }
-  else if (cause & EMU_RSTCAUSE_EM4)
-  {
-    printf("-- RSTCAUSE = EM4 wakeup \n");
-    BURAM->RET[0].REG += 1; // increment EM4 wakeup counter
+    appState.wakeups++;
+    return true;
   }
 
-  // Print # of EM4 wakeups
-  printf("-- Number of EM4 wakeups = %ld \n", BURAM->RET[0].REG);
-  printf("-- BURTC ISR will toggle LED every ~3 seconds \n");
+  appState = (appState_TypeDef){ 0 };
+  return false;
 }
 
 /**************************************************************************//**
@@ -119,20 +154,42 @@ void checkResetCause (void)
  *****************************************************************************/
 int main(void)
 {
+  bool warm;
+  uint32_t cycles;
+
   CHIP_Init();
+
+  // Count the cycles from reset until the device is ready
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
   EMU_UnlatchPinRetention();
 
+  // Check RESETCAUSE and restore the state saved before EM4
+  warm = restoreState();
+
   // Init
   RETARGET_SerialInit();
   RETARGET_SerialCrLf(1);
-  printf("In EM0 \n");
   initGPIO();
-  initBURTC();
+  initBURTC(warm);
   EMU_EM4Init_TypeDef em4Init = EMU_EM4INIT_DEFAULT;
   EMU_EM4Init(&em4Init);
 
-  // Check RESETCAUSE, update and print EM4 wakeup count
-  checkResetCause();
+  cycles = DWT->CYCCNT;
+  if (!warm)
+    appState.coldCycles = cycles;
+
+  printf("In EM0 \n");
+  if (warm)
+    printf("-- RSTCAUSE = EM4 wakeup, state restored from BURAM \n");
+  else
+    printf("-- Cold start \n");
+  printf("-- Number of EM4 wakeups = %lu \n", appState.wakeups);
+  printf("-- Init took %lu cycles (cold start: %lu cycles) \n",
+         cycles, appState.coldCycles);
+  printf("-- BURTC ISR will toggle LED every ~3 seconds \n");
 
   // Wait for user to press PB0, reset BURTC counter
   printf("Press PB0 to enter EM4 \n");
@@ -141,12 +198,15 @@ int main(void)
   BURTC_CounterReset(); // reset BURTC counter to wait full ~3 sec before EM4 wakeup
   printf("-- BURTC counter reset \n");
 
+  // Save the state last, so that it matches the configuration in EM4
+  em4SnapshotSave(&BURAM->RET[0].REG, BURAM_REG_COUNT, SNAPSHOT_VERSION,
+                  &appState, sizeof(appState));
+
   // Enter EM4
   printf("Entering EM4 and wake on BURTC compare in ~3 seconds \n\n");
   for(volatile uint32_t i=0; i<1000; i++); // delay for printf to finish
-  EMU_EnterEM4();
 
+  EMU_EnterEM4();
   // This line should never be reached
   while(1);
 }
-
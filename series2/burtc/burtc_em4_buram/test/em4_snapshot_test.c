@@ -0,0 +1,217 @@
+/***************************************************************************//**
+ * @file em4_snapshot_test.c
+ * @brief Host test of em4_snapshot.c: CRC-32, save and restore of all state
+ * sizes, bit flips, version changes and interrupted saves
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Isrc test/em4_snapshot_test.c src/em4_snapshot.c
+//       -o em4_snapshot_test
+//   ./em4_snapshot_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed. The retention registers are an array in RAM, so the
+// test assumes a little endian host like the target.
+
+#include "em4_snapshot.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+// Number of BURAM retention registers
+#define RET_WORDS       (32)
+
+static int checks;
+static int failures;
+
+static uint32_t seed = 89;
+
+/***************************************************************************//**
+ * @brief Small LCG, so that the test does not depend on the C library rand()
+ ******************************************************************************/
+static uint8_t random8(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return (uint8_t)(seed >> 16);
+}
+
+/***************************************************************************//**
+ * @brief Bit by bit CRC-32 (IEEE 802.3) as reference
+ ******************************************************************************/
+static uint32_t refCrc32(const uint8_t *data, size_t size)
+{
+  uint32_t crc = 0xFFFFFFFFUL;
+
+  while (size-- > 0) {
+    crc ^= *data++;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320UL : 0);
+    }
+  }
+  return ~crc;
+}
+
+/***************************************************************************//**
+ * @brief em4SnapshotCrc32() against the check value and the reference, in one
+ * call and continued over two calls
+ ******************************************************************************/
+static void testCrc(void)
+{
+  uint8_t data[64];
+  uint32_t crc;
+
+  CHECK(em4SnapshotCrc32(0, "123456789", 9) == 0xCBF43926UL);
+  CHECK(em4SnapshotCrc32(0, data, 0) == 0);
+
+  for (size_t len = 0; len <= sizeof(data); len++) {
+    for (size_t i = 0; i < len; i++) {
+      data[i] = random8();
+    }
+    CHECK(em4SnapshotCrc32(0, data, len) == refCrc32(data, len));
+    crc = em4SnapshotCrc32(0, data, len / 2);
+    crc = em4SnapshotCrc32(crc, data + len / 2, len - len / 2);
+    CHECK(crc == refCrc32(data, len));
+  }
+}
+
+/***************************************************************************//**
+ * @brief Save and restore every state size, and check that any single bit
+ * flip, another version or another size is rejected without touching the
+ * state
+ ******************************************************************************/
+static void testSaveRestore(void)
+{
+  volatile uint32_t ret[RET_WORDS];
+  uint8_t state[RET_WORDS * 4];
+  uint8_t out[RET_WORDS * 4 + 1];
+  uint32_t words;
+  int err;
+
+  memset((void *)ret, 0, sizeof(ret));
+  CHECK(em4SnapshotRestore(ret, RET_WORDS, 1, out, 10)
+        == EM4_SNAPSHOT_ERR_EMPTY);
+
+  for (uint32_t size = 0; size <= sizeof(state); size++) {
+    for (uint32_t i = 0; i < size; i++) {
+      state[i] = random8();
+    }
+    err = em4SnapshotSave(ret, RET_WORDS, 3, state, size);
+    if (EM4_SNAPSHOT_WORDS(size) > RET_WORDS) {
+      CHECK(err == EM4_SNAPSHOT_ERR_SIZE);
+      continue;
+    }
+    CHECK(err == 0);
+
+    memset(out, 0xAA, sizeof(out));
+    CHECK(em4SnapshotRestore(ret, RET_WORDS, 3, out, size) == 0);
+    CHECK(memcmp(out, state, size) == 0);
+    CHECK(out[size] == 0xAA);
+
+    // The last word is the CRC-32 of the header and the payload words
+    words = (size + 3) / 4;
+    CHECK(ret[1 + words] == refCrc32((const uint8_t *)ret, 4 * (words + 1)));
+
+    CHECK(em4SnapshotRestore(ret, RET_WORDS, 4, out, size)
+          == EM4_SNAPSHOT_ERR_VERSION);
+    if (size >= 4) {
+      CHECK(em4SnapshotRestore(ret, RET_WORDS, 3, out, size - 4)
+            == EM4_SNAPSHOT_ERR_VERSION);
+    }
+
+    for (uint32_t k = 0; k < words + EM4_SNAPSHOT_OVERHEAD_WORDS; k++) {
+      for (int b = 0; b < 32; b++) {
+        ret[k] ^= 1UL << b;
+        memset(out, 0x55, sizeof(out));
+        err = em4SnapshotRestore(ret, RET_WORDS, 3, out, size);
+        CHECK(err != 0);
+        CHECK(out[0] == 0x55);
+        ret[k] ^= 1UL << b;
+      }
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief A reset while a new snapshot of the same layout is saved leaves
+ * the old header and some old words: the snapshot must be rejected unless
+ * no payload word was written yet
+ ******************************************************************************/
+static void testInterruptedSave(void)
+{
+  volatile uint32_t ret[RET_WORDS];
+  volatile uint32_t torn[RET_WORDS];
+  uint8_t oldState[40];
+  uint8_t newState[40];
+  uint8_t out[40];
+
+  for (int i = 0; i < 40; i++) {
+    oldState[i] = (uint8_t)i;
+    newState[i] = (uint8_t)(100 + i);
+  }
+
+  CHECK(em4SnapshotSave(ret, RET_WORDS, 1, oldState, 40) == 0);
+  for (int written = 1; written <= 11; written++) {
+    memcpy((void *)torn, (const void *)ret, sizeof(torn));
+    CHECK(em4SnapshotSave(torn, RET_WORDS, 1, newState, 40) == 0);
+    for (int j = written; j < 12; j++) {
+      torn[j] = ret[j];
+    }
+    CHECK(em4SnapshotRestore(torn, RET_WORDS, 1, out, 40)
+          == ((written == 1) ? 0 : EM4_SNAPSHOT_ERR_CRC));
+  }
+
+  em4SnapshotInvalidate(ret);
+  CHECK(em4SnapshotRestore(ret, RET_WORDS, 1, out, 40)
+        == EM4_SNAPSHOT_ERR_EMPTY);
+  CHECK(em4SnapshotSave(ret, 8, 1, oldState, 40) == EM4_SNAPSHOT_ERR_SIZE);
+  CHECK(em4SnapshotRestore(ret, 8, 1, out, 40) == EM4_SNAPSHOT_ERR_SIZE);
+}
+
+int main(void)
+{
+  testCrc();
+  testSaveRestore();
+  testInterruptedSave();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,652 @@
+/***************************************************************************//**
+ * @file clock_plan.c
+ * @brief Clock tree planner that selects oscillators, DPLL settings and
+ * prescalers for a set of peripheral clock rate requirements
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "clock_plan.h"
+#include <stddef.h>
+
+// The planner tries every source for each branch that a requirement needs,
+// and for the banded oscillators used by such a selection, every band and,
+// for the HFRCODPLL, every DPLL setting that makes a multiple of an exact
+// rate. For each combination the prescalers are found directly, and the
+// combination that meets all requirements with the lowest estimated current
+// is kept. Only the current of the oscillators and branches that are used
+// is counted, so an oscillator that is only needed for a reference is paid
+// for once, and a branch that no requirement uses is left alone.
+//
+// The planner uses no hardware, so it can also be built for the host to
+// plan at build time.
+
+#define DPLL_N_MIN      (300)
+#define DPLL_N_MAX      (4095)
+#define DPLL_M_MAX      (4095)
+
+typedef struct {
+  uint32_t hz;                          // Output, rounded
+  uint8_t ref;
+  uint16_t n;
+  uint16_t m;
+} dpllSetting_TypeDef;
+
+// Approximate typical figures, only used to rank the options. Use the data
+// sheet of the exact device when the estimated current matters.
+static const uint32_t hfrcodpllBands[] = {
+  1000000, 2000000, 4000000, 7000000, 13000000, 16000000, 19000000,
+  26000000, 32000000, 38000000, 48000000, 56000000, 64000000, 80000000
+};
+
+static const uint32_t hfrcoem23Bands[] = {
+  1000000, 2000000, 4000000, 13000000, 16000000, 19000000, 26000000,
+  32000000, 40000000
+};
+
+#define COUNT_OF(a)     ((uint8_t)(sizeof(a) / sizeof((a)[0])))
+
+const clockPlanDevice_TypeDef clockPlanDeviceXG21 = {
+  .osc = {
+    [clockPlanFSRCO]     = { 20000000, NULL, 0, 20000, 100000, 0 },
+    [clockPlanHFRCODPLL] = { 0, hfrcodpllBands, COUNT_OF(hfrcodpllBands), 5000, 20000, 3000 },
+    [clockPlanHFRCOEM23] = { 0, hfrcoem23Bands, COUNT_OF(hfrcoem23Bands), 5000, 10000, 2000 },
+    [clockPlanHFXO]      = { 38400000, NULL, 0, 50, 400000, 0 },
+    [clockPlanLFRCO]     = { 32768, NULL, 0, 20000, 200, 0 },
+    [clockPlanLFXO]      = { 32768, NULL, 0, 100, 200, 0 },
+    [clockPlanULFRCO]    = { 1000, NULL, 0, 200000, 70, 0 },
+  },
+  .branch = {
+    [clockPlanSYSCLK] = {
+      { clockPlanFSRCO, clockPlanHFRCODPLL, clockPlanHFXO, CLOCK_PLAN_NONE },
+      80000000, 30000
+    },
+    [clockPlanEM01GRPACLK] = {
+      { clockPlanHFRCODPLL, clockPlanHFXO, clockPlanFSRCO, CLOCK_PLAN_NONE },
+      80000000, 2000
+    },
+    [clockPlanIADCCLK] = {
+      { CLOCK_PLAN_BRANCH(clockPlanEM01GRPACLK), clockPlanFSRCO, clockPlanHFRCOEM23,
+        CLOCK_PLAN_NONE },
+      80000000, 1000
+    },
+    [clockPlanEM23GRPACLK] = {
+      { clockPlanLFRCO, clockPlanLFXO, clockPlanULFRCO, CLOCK_PLAN_NONE },
+      32768, 0
+    },
+  },
+  .dpllMinHz = 2000000,
+  .dpllMaxHz = 80000000,
+  .dpllNa = 20000,
+  .dpllRefs = (1 << clockPlanHFXO) | (1 << clockPlanLFXO),
+};
+
+// The xG22 runs at up to 76.8 MHz, has a lower current HFXO and an LFRCO
+// with a precision mode
+const clockPlanDevice_TypeDef clockPlanDeviceXG22 = {
+  .osc = {
+    [clockPlanFSRCO]     = { 20000000, NULL, 0, 20000, 100000, 0 },
+    [clockPlanHFRCODPLL] = { 0, hfrcodpllBands, COUNT_OF(hfrcodpllBands), 5000, 20000, 3000 },
+    [clockPlanHFRCOEM23] = { 0, hfrcoem23Bands, COUNT_OF(hfrcoem23Bands), 5000, 10000, 2000 },
+    [clockPlanHFXO]      = { 38400000, NULL, 0, 50, 180000, 0 },
+    [clockPlanLFRCO]     = { 32768, NULL, 0, 500, 400, 0 },
+    [clockPlanLFXO]      = { 32768, NULL, 0, 100, 200, 0 },
+    [clockPlanULFRCO]    = { 1000, NULL, 0, 200000, 70, 0 },
+  },
+  .branch = {
+    [clockPlanSYSCLK] = {
+      { clockPlanFSRCO, clockPlanHFRCODPLL, clockPlanHFXO, CLOCK_PLAN_NONE },
+      76800000, 30000
+    },
+    [clockPlanEM01GRPACLK] = {
+      { clockPlanHFRCODPLL, clockPlanHFXO, clockPlanFSRCO, clockPlanHFRCOEM23 },
+      76800000, 2000
+    },
+    [clockPlanIADCCLK] = {
+      { CLOCK_PLAN_BRANCH(clockPlanEM01GRPACLK), clockPlanFSRCO, clockPlanHFRCOEM23,
+        CLOCK_PLAN_NONE },
+      76800000, 1000
+    },
+    [clockPlanEM23GRPACLK] = {
+      { clockPlanLFRCO, clockPlanLFXO, clockPlanULFRCO, CLOCK_PLAN_NONE },
+      32768, 0
+    },
+  },
+  .dpllMinHz = 2000000,
+  .dpllMaxHz = 80000000,
+  .dpllNa = 20000,
+  .dpllRefs = (1 << clockPlanHFXO) | (1 << clockPlanLFXO),
+};
+
+// Planner state
+static const clockPlanDevice_TypeDef *dev;
+static const clockPlanReq_TypeDef *req;
+static uint32_t reqCount;
+static uint8_t reqBranches;             // Branches with requirements
+static uint8_t selection[clockPlanBranchCount];
+static dpllSetting_TypeDef dpll[CLOCK_PLAN_MAX_DPLL];
+static uint32_t dpllCount;
+static clockPlan_TypeDef trial;
+static clockPlan_TypeDef *best;
+static bool found;
+static uint32_t bestErrorSum;
+
+static uint32_t divCeil(uint64_t a, uint64_t b)
+{
+  return (uint32_t)((a + b - 1) / b);
+}
+
+static bool oscPresent(uint32_t osc)
+{
+  return dev->osc[osc].hz != 0 || dev->osc[osc].bandCount != 0;
+}
+
+// Smallest allowed prescaler not below d, 0 if there is none
+static uint32_t div1Up(const clockPlanReq_TypeDef *r, uint32_t d)
+{
+  uint32_t p = 1;
+
+  if (d < 1) {
+    d = 1;
+  }
+  if (r->div1Pow2) {
+    while (p < d && p <= r->div1Max / 2) {
+      p <<= 1;
+    }
+    if (p < d) {
+      return 0;
+    }
+    d = p;
+  }
+  return (d <= r->div1Max) ? d : 0;
+}
+
+// Largest allowed prescaler not above d, 0 if there is none
+static uint32_t div1Down(const clockPlanReq_TypeDef *r, uint32_t d)
+{
+  uint32_t p = 1;
+
+  if (d > r->div1Max) {
+    d = r->div1Max;
+  }
+  if (r->div1Pow2 && d >= 1) {
+    while (p <= d / 2) {
+      p <<= 1;
+    }
+    d = p;
+  }
+  return d;
+}
+
+static int32_t errorPpm(uint32_t hz, uint32_t rate, uint32_t div)
+{
+  int64_t actual = (int64_t)rate * div;
+
+  return (int32_t)((((int64_t)hz - actual) * 1000000 + actual / 2) / actual);
+}
+
+/***************************************************************************//**
+ * @brief Find the prescaler and counter for one requirement
+ *
+ * @param hz Branch frequency.
+ * @param ppm Tolerance of the branch frequency.
+ * @return false if the requirement cannot be met from this frequency.
+ ******************************************************************************/
+static bool reqSolve(const clockPlanReq_TypeDef *r, uint32_t hz, uint32_t ppm,
+                     clockPlanOut_TypeDef *out)
+{
+  uint32_t div2Max = (r->div2Max != 0) ? r->div2Max : 1;
+  uint32_t minDiv1 = 1;
+  uint32_t total;
+  uint32_t d1;
+  uint32_t d2;
+  uint32_t i;
+  int32_t err;
+  int32_t bestErr = INT32_MAX;
+
+  if (r->stage1MaxHz != 0) {
+    minDiv1 = divCeil(hz, r->stage1MaxHz);
+  }
+
+  if (r->type == clockPlanAtMost) {
+    total = divCeil(hz, r->hz);
+    d1 = div1Up(r, (minDiv1 > divCeil(total, div2Max)) ? minDiv1
+                                                       : divCeil(total, div2Max));
+    if (d1 == 0) {
+      return false;
+    }
+    d2 = divCeil(total, d1);
+    out->div1 = d1;
+    out->div2 = d2;
+  } else if (r->type == clockPlanAtLeast) {
+    total = hz / r->hz;
+    if (r->div2Max == 0) {
+      d1 = div1Down(r, total);
+      d2 = 1;
+    } else {
+      d1 = div1Up(r, (minDiv1 > divCeil(total, div2Max)) ? minDiv1
+                                                         : divCeil(total, div2Max));
+      d2 = (d1 != 0) ? total / d1 : 0;
+    }
+    if (total == 0 || d1 < minDiv1 || d1 == 0 || d2 == 0) {
+      return false;
+    }
+    out->div1 = d1;
+    out->div2 = d2;
+  } else {
+    // The division error has to fit in what the source tolerance leaves
+    if (ppm >= r->ppm) {
+      return false;
+    }
+    if (r->div2Max == 0) {
+      // A prescaler alone, try the two nearest values
+      total = hz / r->hz;
+      for (i = 0; i < 2; i++) {
+        d1 = (i == 0) ? div1Down(r, total) : div1Up(r, total + 1);
+        if (d1 == 0 || d1 < minDiv1) {
+          continue;
+        }
+        err = errorPpm(hz, r->hz, d1);
+        if ((err < 0 ? -err : err) < (bestErr < 0 ? -bestErr : bestErr)) {
+          bestErr = err;
+          out->div1 = d1;
+          out->div2 = 1;
+        }
+      }
+    } else {
+      // Try every prescaler, with the nearest counter period for each. The
+      // smallest prescaler does not always give the smallest error, and a
+      // source that misses the tolerance may cost more current elsewhere.
+      total = (uint32_t)(((uint64_t)hz + r->hz / 2) / r->hz);
+      if (total == 0) {
+        return false;
+      }
+      d1 = div1Up(r, (minDiv1 > divCeil(total, div2Max)) ? minDiv1
+                                                         : divCeil(total, div2Max));
+      while (d1 != 0) {
+        d2 = (uint32_t)(((uint64_t)hz + (uint64_t)r->hz * d1 / 2)
+                        / ((uint64_t)r->hz * d1));
+        if (d2 == 0) {
+          // Larger prescalers only round to zero as well
+          break;
+        }
+        if (d2 <= div2Max) {
+          err = errorPpm(hz, r->hz, d1 * d2);
+          if ((err < 0 ? -err : err) < (bestErr < 0 ? -bestErr : bestErr)) {
+            bestErr = err;
+            out->div1 = d1;
+            out->div2 = d2;
+            if (err == 0) {
+              break;
+            }
+          }
+        }
+        if (d1 >= r->div1Max) {
+          break;
+        }
+        d1 = div1Up(r, d1 + 1);
+      }
+    }
+    if (bestErr == INT32_MAX
+        || (uint32_t)(bestErr < 0 ? -bestErr : bestErr) > r->ppm - ppm) {
+      return false;
+    }
+  }
+
+  out->hz = hz / (out->div1 * out->div2);
+  out->errorPpm = errorPpm(hz, r->hz, out->div1 * out->div2);
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief Find the DPLL setting closest to a frequency for one reference
+ ******************************************************************************/
+static bool dpllSolve(uint32_t hz, uint32_t ref, dpllSetting_TypeDef *s)
+{
+  uint64_t fRef = dev->osc[ref].hz;
+  bool have = false;
+  uint64_t bestNum = 0;
+  uint64_t bestDen = 1;
+  uint64_t n1;
+  uint64_t num;
+  uint32_t m1;
+
+  for (m1 = 1; m1 <= DPLL_M_MAX + 1; m1++) {
+    n1 = ((uint64_t)hz * m1 + fRef / 2) / fRef;
+    if (n1 < DPLL_N_MIN + 1) {
+      continue;
+    }
+    if (n1 > DPLL_N_MAX + 1) {
+      break;
+    }
+    // Error is |fRef * n1 / m1 - hz|, compared as num / m1
+    num = fRef * n1 > (uint64_t)hz * m1 ? fRef * n1 - (uint64_t)hz * m1
+                                        : (uint64_t)hz * m1 - fRef * n1;
+    if (!have || num * bestDen < bestNum * m1) {
+      have = true;
+      bestNum = num;
+      bestDen = m1;
+      s->n = (uint16_t)(n1 - 1);
+      s->m = (uint16_t)(m1 - 1);
+      if (num == 0) {
+        break;
+      }
+    }
+  }
+  if (!have) {
+    return false;
+  }
+  s->ref = (uint8_t)ref;
+  s->hz = (uint32_t)((fRef * (s->n + 1) + (s->m + 1) / 2) / (s->m + 1));
+  return s->hz >= dev->dpllMinHz && s->hz <= dev->dpllMaxHz;
+}
+
+/***************************************************************************//**
+ * @brief Make the DPLL settings to try, the multiples of each exact rate
+ * closest to each HFRCODPLL band
+ ******************************************************************************/
+static void dpllCandidates(void)
+{
+  const clockPlanOscDesc_TypeDef *hfrco = &dev->osc[clockPlanHFRCODPLL];
+  dpllSetting_TypeDef s;
+  uint32_t target;
+  uint32_t k;
+  uint32_t i;
+  uint32_t b;
+  uint32_t ref;
+  uint32_t j;
+
+  dpllCount = 0;
+  if (dev->dpllMinHz == 0) {
+    return;
+  }
+  for (i = 0; i < reqCount; i++) {
+    if (req[i].type != clockPlanExact) {
+      continue;
+    }
+    for (b = 0; b < hfrco->bandCount; b++) {
+      k = (hfrco->bands[b] + req[i].hz / 2) / req[i].hz;
+      target = k * req[i].hz;
+      if (k == 0 || target < dev->dpllMinHz || target > dev->dpllMaxHz) {
+        continue;
+      }
+      for (ref = 0; ref < clockPlanOscCount; ref++) {
+        if (!(dev->dpllRefs & (1 << ref)) || dev->osc[ref].hz == 0
+            || !dpllSolve(target, ref, &s)) {
+          continue;
+        }
+        for (j = 0; j < dpllCount; j++) {
+          if (dpll[j].ref == s.ref && dpll[j].n == s.n && dpll[j].m == s.m) {
+            break;
+          }
+        }
+        if (j == dpllCount && dpllCount < CLOCK_PLAN_MAX_DPLL) {
+          dpll[dpllCount++] = s;
+        }
+      }
+    }
+  }
+}
+
+static uint64_t oscCurrent(uint32_t osc, uint32_t hz)
+{
+  return dev->osc[osc].baseNa + (uint64_t)dev->osc[osc].naPerMHz * hz / 1000000;
+}
+
+/***************************************************************************//**
+ * @brief Evaluate the current branch selection with the given frequencies
+ * of the banded oscillators
+ ******************************************************************************/
+static void evaluate(uint8_t used, uint32_t oscUsed, uint32_t hfrcoOption,
+                     uint32_t em23Hz)
+{
+  const dpllSetting_TypeDef *s = NULL;
+  uint32_t ppm[clockPlanBranchCount];
+  uint32_t errorSum = 0;
+  uint64_t current = 0;
+  uint32_t osc;
+  uint32_t b;
+  uint32_t src;
+  uint32_t i;
+
+  trial = (clockPlan_TypeDef){ 0 };
+  for (osc = 0; osc < clockPlanOscCount; osc++) {
+    if (oscUsed & (1 << osc)) {
+      trial.oscHz[osc] = dev->osc[osc].hz;
+    }
+  }
+  if (oscUsed & (1 << clockPlanHFRCODPLL)) {
+    if (hfrcoOption < dev->osc[clockPlanHFRCODPLL].bandCount) {
+      trial.oscHz[clockPlanHFRCODPLL] = dev->osc[clockPlanHFRCODPLL].bands[hfrcoOption];
+    } else {
+      s = &dpll[hfrcoOption - dev->osc[clockPlanHFRCODPLL].bandCount];
+      trial.oscHz[clockPlanHFRCODPLL] = s->hz;
+      trial.oscHz[s->ref] = dev->osc[s->ref].hz;
+      trial.dpll = true;
+      trial.dpllRef = s->ref;
+      trial.dpllN = s->n;
+      trial.dpllM = s->m;
+    }
+  }
+  if (oscUsed & (1 << clockPlanHFRCOEM23)) {
+    trial.oscHz[clockPlanHFRCOEM23] = em23Hz;
+  }
+
+  // The current does not depend on the prescalers, so check it first
+  for (osc = 0; osc < clockPlanOscCount; osc++) {
+    if (trial.oscHz[osc] != 0) {
+      current += oscCurrent(osc, trial.oscHz[osc]);
+    }
+  }
+  if (trial.dpll) {
+    current += dev->dpllNa;
+  }
+
+  for (b = 0; b < clockPlanBranchCount; b++) {
+    trial.branchSource[b] = CLOCK_PLAN_NONE;
+    if (!(used & (1 << b))) {
+      continue;
+    }
+    src = selection[b];
+    trial.branchSource[b] = (uint8_t)src;
+    if (src < clockPlanOscCount) {
+      trial.branchHz[b] = trial.oscHz[src];
+      ppm[b] = (trial.dpll && src == clockPlanHFRCODPLL)
+               ? dev->osc[trial.dpllRef].ppm : dev->osc[src].ppm;
+    } else {
+      trial.branchHz[b] = trial.branchHz[src - clockPlanOscCount];
+      ppm[b] = ppm[src - clockPlanOscCount];
+    }
+    if (trial.branchHz[b] > dev->branch[b].maxHz) {
+      return;
+    }
+    current += (uint64_t)dev->branch[b].naPerMHz * trial.branchHz[b] / 1000000;
+  }
+
+  if (found && current > best->currentNa) {
+    return;
+  }
+
+  for (i = 0; i < reqCount; i++) {
+    b = req[i].branch;
+    if (!reqSolve(&req[i], trial.branchHz[b], ppm[b], &trial.out[i])) {
+      return;
+    }
+    errorSum += (uint32_t)(trial.out[i].errorPpm < 0 ? -trial.out[i].errorPpm
+                                                     : trial.out[i].errorPpm);
+  }
+
+  if (found && current == best->currentNa && errorSum >= bestErrorSum) {
+    return;
+  }
+  trial.currentNa = (uint32_t)current;
+  *best = trial;
+  bestErrorSum = errorSum;
+  found = true;
+}
+
+/***************************************************************************//**
+ * @brief Evaluate a complete branch selection for all frequencies of the
+ * banded oscillators it uses
+ ******************************************************************************/
+static void selectionEvaluate(void)
+{
+  uint8_t used = reqBranches;
+  uint32_t oscUsed = 0;
+  uint32_t hfrcoOptions = 1;
+  uint32_t em23Options = 1;
+  uint32_t h;
+  uint32_t e;
+  int b;
+
+  // A branch that a used branch selects is used, and its number is lower
+  for (b = clockPlanBranchCount - 1; b >= 0; b--) {
+    if (!(used & (1 << b))) {
+      continue;
+    }
+    if (selection[b] < clockPlanOscCount) {
+      oscUsed |= 1UL << selection[b];
+    } else {
+      used |= (uint8_t)(1 << (selection[b] - clockPlanOscCount));
+    }
+  }
+
+  if (oscUsed & (1 << clockPlanHFRCODPLL)) {
+    hfrcoOptions = dev->osc[clockPlanHFRCODPLL].bandCount + dpllCount;
+  }
+  if (oscUsed & (1 << clockPlanHFRCOEM23)) {
+    em23Options = dev->osc[clockPlanHFRCOEM23].bandCount;
+  }
+  for (h = 0; h < hfrcoOptions; h++) {
+    for (e = 0; e < em23Options; e++) {
+      evaluate(used, oscUsed, h,
+               (oscUsed & (1 << clockPlanHFRCOEM23))
+               ? dev->osc[clockPlanHFRCOEM23].bands[e] : 0);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Try all sources for the branches from b on
+ ******************************************************************************/
+static void branchSelect(uint32_t b, uint8_t needed)
+{
+  const clockPlanBranchDesc_TypeDef *branch;
+  uint32_t src;
+  uint32_t i;
+
+  if (b == clockPlanBranchCount) {
+    selectionEvaluate();
+    return;
+  }
+  if (!(needed & (1 << b))) {
+    selection[b] = CLOCK_PLAN_NONE;
+    branchSelect(b + 1, needed);
+    return;
+  }
+  branch = &dev->branch[b];
+  for (i = 0; i < CLOCK_PLAN_BRANCH_SOURCES; i++) {
+    src = branch->sources[i];
+    if (src == CLOCK_PLAN_NONE) {
+      break;
+    }
+    if (src < clockPlanOscCount ? !oscPresent(src)
+        : !(needed & (1 << (src - clockPlanOscCount)))) {
+      continue;
+    }
+    selection[b] = (uint8_t)src;
+    branchSelect(b + 1, needed);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Plan the clock tree for a set of requirements
+ *
+ * @details The plan gives the oscillator frequencies, the DPLL setting if the
+ * HFRCODPLL is locked, the source of each branch (CLOCK_PLAN_NONE if no
+ * requirement needs the branch) and the prescalers of each requirement, for
+ * the plan with the lowest estimated current. Exact rates must be within the
+ * tolerance including the tolerance of the oscillator, while rate limits
+ * and branch limits are compared with the nominal frequency.
+ *
+ * @return 0, CLOCK_PLAN_ERR_INVALID or CLOCK_PLAN_ERR_NO_PLAN.
+ ******************************************************************************/
+int clockPlanSolve(const clockPlanDevice_TypeDef *device,
+                   const clockPlanReq_TypeDef *reqs, uint32_t count,
+                   clockPlan_TypeDef *plan)
+{
+  uint8_t needed;
+  uint32_t src;
+  uint32_t i;
+  int b;
+
+  if (count > CLOCK_PLAN_MAX_REQS) {
+    return CLOCK_PLAN_ERR_INVALID;
+  }
+  reqBranches = 0;
+  for (i = 0; i < count; i++) {
+    if (reqs[i].branch >= clockPlanBranchCount || reqs[i].hz == 0
+        || reqs[i].div1Max == 0) {
+      return CLOCK_PLAN_ERR_INVALID;
+    }
+    reqBranches |= (uint8_t)(1 << reqs[i].branch);
+  }
+
+  dev = device;
+  req = reqs;
+  reqCount = count;
+
+  // Branches that may be used: those with requirements, and any branch that
+  // they can select
+  needed = reqBranches;
+  for (b = clockPlanBranchCount - 1; b >= 0; b--) {
+    if (!(needed & (1 << b))) {
+      continue;
+    }
+    for (i = 0; i < CLOCK_PLAN_BRANCH_SOURCES; i++) {
+      src = dev->branch[b].sources[i];
+      if (src == CLOCK_PLAN_NONE || src < clockPlanOscCount) {
+        continue;
+      }
+      if (src - clockPlanOscCount >= (uint32_t)b) {
+        return CLOCK_PLAN_ERR_INVALID;
+      }
+      needed |= (uint8_t)(1 << (src - clockPlanOscCount));
+    }
+  }
+
+  dpllCandidates();
+  best = plan;
+  found = false;
+  branchSelect(0, needed);
+
+  return found ? 0 : CLOCK_PLAN_ERR_NO_PLAN;
+}
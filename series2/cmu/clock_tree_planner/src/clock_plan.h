@@ -0,0 +1,161 @@
+/***************************************************************************//**
+ * @file clock_plan.h
+ * @brief Clock tree planner that selects oscillators, DPLL settings and
+ * prescalers for a set of peripheral clock rate requirements
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef CLOCK_PLAN_H
+#define CLOCK_PLAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLOCK_PLAN_MAX_REQS             (8)
+#define CLOCK_PLAN_MAX_DPLL             (32)
+#define CLOCK_PLAN_BRANCH_SOURCES       (4)
+
+// Branch source entry for an unused position, and plan source of a branch
+// that is not used
+#define CLOCK_PLAN_NONE                 (0xFF)
+
+// A branch source that is the output of another (lower numbered) branch
+#define CLOCK_PLAN_BRANCH(b)            (clockPlanOscCount + (b))
+
+// The device description or the requirements are invalid
+#define CLOCK_PLAN_ERR_INVALID          (-0x5700)
+// No combination of clocks meets all requirements
+#define CLOCK_PLAN_ERR_NO_PLAN          (-0x5680)
+
+typedef enum {
+  clockPlanFSRCO,
+  clockPlanHFRCODPLL,
+  clockPlanHFRCOEM23,
+  clockPlanHFXO,
+  clockPlanLFRCO,
+  clockPlanLFXO,
+  clockPlanULFRCO,
+  clockPlanOscCount
+} clockPlanOsc_TypeDef;
+
+typedef enum {
+  clockPlanSYSCLK,
+  clockPlanEM01GRPACLK,
+  clockPlanIADCCLK,
+  clockPlanEM23GRPACLK,
+  clockPlanBranchCount
+} clockPlanBranch_TypeDef;
+
+typedef enum {
+  clockPlanExact,                       // Rate within the tolerance
+  clockPlanAtMost,                      // Rate limit, e.g. a clock maximum
+  clockPlanAtLeast                      // Rate minimum, e.g. for throughput
+} clockPlanRate_TypeDef;
+
+// Oscillator, with a fixed frequency or a choice of bands. Oscillators that
+// the device does not have are left zero.
+typedef struct {
+  uint32_t hz;                          // Fixed frequency, 0 if banded
+  const uint32_t *bands;                // Band frequencies, ascending
+  uint8_t bandCount;
+  uint32_t ppm;                         // Frequency tolerance
+  uint32_t baseNa;                      // Current when running
+  uint32_t naPerMHz;                    // Additional current per MHz
+} clockPlanOscDesc_TypeDef;
+
+// Clock branch, a clock select with the oscillators (or branches) it can
+// select, CLOCK_PLAN_NONE terminated
+typedef struct {
+  uint8_t sources[CLOCK_PLAN_BRANCH_SOURCES];
+  uint32_t maxHz;
+  uint32_t naPerMHz;                    // Current of the clocked logic
+} clockPlanBranchDesc_TypeDef;
+
+// Device clock tree. The DPLL locks the HFRCODPLL to fRef * (N + 1) / (M + 1).
+typedef struct {
+  clockPlanOscDesc_TypeDef osc[clockPlanOscCount];
+  clockPlanBranchDesc_TypeDef branch[clockPlanBranchCount];
+  uint32_t dpllMinHz;                   // 0 if there is no DPLL
+  uint32_t dpllMaxHz;
+  uint32_t dpllNa;
+  uint8_t dpllRefs;                     // Mask of reference oscillators
+} clockPlanDevice_TypeDef;
+
+// Peripheral clock requirement: the branch clock is divided by a prescaler
+// (div1) and optionally a counter (div2), e.g. a TIMER prescaler and top
+// value, and the result must meet the rate.
+typedef struct {
+  uint8_t branch;
+  clockPlanRate_TypeDef type;
+  uint32_t hz;
+  uint32_t ppm;                         // Tolerance, for clockPlanExact
+  uint32_t div1Max;                     // Largest prescaler, 1 for none
+  bool div1Pow2;                        // Prescaler is a power of 2
+  uint32_t div2Max;                     // Largest counter period, 0 if none
+  uint32_t stage1MaxHz;                 // Limit after the prescaler, 0 if none
+} clockPlanReq_TypeDef;
+
+typedef struct {
+  uint32_t hz;                          // Rate, from the nominal frequency
+  int32_t errorPpm;                     // Rate error, without the tolerance
+  uint32_t div1;
+  uint32_t div2;
+} clockPlanOut_TypeDef;
+
+typedef struct {
+  uint32_t oscHz[clockPlanOscCount];    // Oscillators to run, 0 if off
+  bool dpll;                            // HFRCODPLL locked by the DPLL
+  uint8_t dpllRef;                      // Reference oscillator
+  uint16_t dpllN;
+  uint16_t dpllM;
+  uint8_t branchSource[clockPlanBranchCount];
+  uint32_t branchHz[clockPlanBranchCount];
+  uint32_t currentNa;                   // Estimated clock tree current
+  clockPlanOut_TypeDef out[CLOCK_PLAN_MAX_REQS];
+} clockPlan_TypeDef;
+
+extern const clockPlanDevice_TypeDef clockPlanDeviceXG21;
+extern const clockPlanDevice_TypeDef clockPlanDeviceXG22;
+
+int clockPlanSolve(const clockPlanDevice_TypeDef *device,
+                   const clockPlanReq_TypeDef *reqs, uint32_t reqCount,
+                   clockPlan_TypeDef *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLOCK_PLAN_H
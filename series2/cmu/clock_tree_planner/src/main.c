@@ -0,0 +1,332 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief This project demonstrates a clock tree planner that selects the
+ * oscillators, DPLL setting, clock branch sources and peripheral prescalers
+ * for a set of clock rate requirements with the lowest estimated current.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_iadc.h"
+#include "em_letimer.h"
+#include "em_timer.h"
+#include "clock_plan.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+// Square wave on PA6, TIMER0 overflows at twice this rate
+#define OUT_FREQ                  44100
+#define OUT_PPM                   200
+
+// IADC conversions per second, and CLK_ADC (10 MHz max in normal mode)
+#define IADC_RATE                 1000
+#define CLK_ADC_FREQ              10000000
+
+// LETIMER0 interrupts per second
+#define TICK_RATE                 1
+
+// Minimum core clock
+#define SYSCLK_MIN_FREQ           32000000
+
+// Index of each requirement in the plan
+enum {
+  REQ_SYSCLK,
+  REQ_TIMER0,
+  REQ_IADC,
+  REQ_LETIMER0,
+  REQ_COUNT
+};
+
+#if defined(_SILICON_LABS_32B_SERIES_2_CONFIG_1)
+#define CLOCK_PLAN_DEVICE         clockPlanDeviceXG21
+#else
+#define CLOCK_PLAN_DEVICE         clockPlanDeviceXG22
+#endif
+
+/*******************************************************************************
+ ***************************   GLOBAL VARIABLES   *******************************
+ ******************************************************************************/
+
+// Clock rate requirements
+static const clockPlanReq_TypeDef clockReqs[REQ_COUNT] = {
+  // Core clock, no prescaler
+  [REQ_SYSCLK] = { clockPlanSYSCLK, clockPlanAtLeast, SYSCLK_MIN_FREQ, 0,
+                   1, false, 0, 0 },
+  // TIMER0 prescaler (1 to 1024) and top value
+  [REQ_TIMER0] = { clockPlanEM01GRPACLK, clockPlanExact, 2 * OUT_FREQ, OUT_PPM,
+                   1024, false, 65536, 0 },
+  // IADC HSCLKRATE (1 to 4, CLK_SRC_ADC at most 40 MHz) and timer cycles
+  [REQ_IADC] = { clockPlanIADCCLK, clockPlanExact, IADC_RATE, 10000,
+                 4, false, 65536, 40000000 },
+  // LETIMER0 top value, 24 bits
+  [REQ_LETIMER0] = { clockPlanEM23GRPACLK, clockPlanExact, TICK_RATE, 1000,
+                     1, false, 0x1000000, 0 },
+};
+
+// Plan and result of clockPlanSolve(), for viewing in the debugger
+clockPlan_TypeDef clockPlan;
+int clockPlanStatus;
+
+// Latest AVDD measurement, and LETIMER0 ticks
+volatile uint32_t avddMillivolts;
+volatile uint32_t ticks;
+
+/**************************************************************************//**
+ * @brief
+ *    CMU clock select for a planner oscillator or branch
+ *****************************************************************************/
+static CMU_Select_TypeDef sourceSelect(uint8_t source)
+{
+  switch (source)
+  {
+    case clockPlanFSRCO:      return cmuSelect_FSRCO;
+    case clockPlanHFRCODPLL:  return cmuSelect_HFRCODPLL;
+    case clockPlanHFRCOEM23:  return cmuSelect_HFRCOEM23;
+    case clockPlanHFXO:       return cmuSelect_HFXO;
+    case clockPlanLFRCO:      return cmuSelect_LFRCO;
+    case clockPlanLFXO:       return cmuSelect_LFXO;
+    case clockPlanULFRCO:     return cmuSelect_ULFRCO;
+    case CLOCK_PLAN_BRANCH(clockPlanEM01GRPACLK): return cmuSelect_EM01GRPACLK;
+    default:                  return cmuSelect_Error;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start the oscillators and select the branch sources of a plan
+ *
+ * @details
+ *    SYSCLK runs from the FSRCO while the HFRCODPLL is set up, since it
+ *    runs from the HFRCODPLL after reset.  The plan must have a SYSCLK
+ *    requirement, so that SYSCLK is switched back.
+ *****************************************************************************/
+static void clockPlanApply(const clockPlan_TypeDef *plan)
+{
+  static const CMU_Clock_TypeDef branchClock[clockPlanBranchCount] = {
+    [clockPlanSYSCLK]      = cmuClock_SYSCLK,
+    [clockPlanEM01GRPACLK] = cmuClock_EM01GRPACLK,
+    [clockPlanIADCCLK]     = cmuClock_IADCCLK,
+    [clockPlanEM23GRPACLK] = cmuClock_EM23GRPACLK,
+  };
+  uint32_t b;
+
+  CMU_ClockSelectSet(cmuClock_SYSCLK, cmuSelect_FSRCO);
+
+  if (plan->oscHz[clockPlanHFXO])
+  {
+    CMU_HFXOInit_TypeDef hfxoInit = CMU_HFXOINIT_WSTK_DEFAULT;
+    CMU_HFXOInit(&hfxoInit);
+  }
+
+  if (plan->oscHz[clockPlanLFXO])
+  {
+    CMU_LFXOInit_TypeDef lfxoInit = CMU_LFXOINIT_DEFAULT;
+    CMU_LFXOInit(&lfxoInit);
+  }
+
+  if (plan->dpll)
+  {
+    CMU_DPLLInit_TypeDef dpllInit = CMU_DPLL_LFXO_TO_40MHZ;
+    dpllInit.frequency = plan->oscHz[clockPlanHFRCODPLL];
+    dpllInit.n = plan->dpllN;
+    dpllInit.m = plan->dpllM;
+    dpllInit.refClk = sourceSelect(plan->dpllRef);
+
+    // Wait for lock, the reference has just been started
+    while (!CMU_DPLLLock(&dpllInit));
+  }
+  else if (plan->oscHz[clockPlanHFRCODPLL])
+  {
+    CMU_HFRCODPLLBandSet((CMU_HFRCODPLLFreq_TypeDef)plan->oscHz[clockPlanHFRCODPLL]);
+  }
+
+  if (plan->oscHz[clockPlanHFRCOEM23])
+  {
+    CMU_HFRCOEM23BandSet((CMU_HFRCOEM23Freq_TypeDef)plan->oscHz[clockPlanHFRCOEM23]);
+  }
+
+  // Lower numbered branches first, since later ones may select them
+  for (b = 0; b < clockPlanBranchCount; b++)
+  {
+    if (plan->branchSource[b] != CLOCK_PLAN_NONE)
+      CMU_ClockSelectSet(branchClock[b], sourceSelect(plan->branchSource[b]));
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    TIMER0 toggles PA6 on each overflow, with the planned prescaler and
+ *    top value
+ *****************************************************************************/
+void initTIMER(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+  TIMER_InitCC_TypeDef timerCCInit = TIMER_INITCC_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+
+  GPIO_PinModeSet(gpioPortA, 6, gpioModePushPull, 0);
+
+  timerInit.prescale = (TIMER_Prescale_TypeDef)(clockPlan.out[REQ_TIMER0].div1 - 1);
+  timerInit.enable = false;
+  timerCCInit.mode = timerCCModeCompare;
+  timerCCInit.cmoa = timerOutputActionToggle;
+
+  TIMER_Init(TIMER0, &timerInit);
+
+  // Route Timer0 CC0 output to PA6
+  GPIO->TIMERROUTE[0].ROUTEEN  = GPIO_TIMER_ROUTEEN_CC0PEN;
+  GPIO->TIMERROUTE[0].CC0ROUTE = (gpioPortA << _GPIO_TIMER_CC0ROUTE_PORT_SHIFT)
+                                 | (6 << _GPIO_TIMER_CC0ROUTE_PIN_SHIFT);
+
+  TIMER_InitCC(TIMER0, 0, &timerCCInit);
+  TIMER_TopSet(TIMER0, clockPlan.out[REQ_TIMER0].div2 - 1);
+  TIMER_Enable(TIMER0, true);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    IADC converts AVDD when its timer expires, with the planned
+ *    CLK_SRC_ADC prescaler and timer cycles
+ *****************************************************************************/
+void initIADC(void)
+{
+  IADC_Init_t init = IADC_INIT_DEFAULT;
+  IADC_AllConfigs_t initAllConfigs = IADC_ALLCONFIGS_DEFAULT;
+  IADC_InitSingle_t initSingle = IADC_INITSINGLE_DEFAULT;
+  IADC_SingleInput_t initSingleInput = IADC_SINGLEINPUT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_IADC0, true);
+  IADC_reset(IADC0);
+
+  init.warmup = iadcWarmupKeepWarm;
+  init.srcClkPrescale = clockPlan.out[REQ_IADC].div1 - 1;
+  init.timerCycles = clockPlan.out[REQ_IADC].div2;
+
+  // Internal 1.21 V reference, AVDD is measured divided by 4
+  initAllConfigs.configs[0].reference = iadcCfgReferenceInt1V2;
+  initAllConfigs.configs[0].vRef = 1210;
+  initAllConfigs.configs[0].adcClkPrescale = IADC_calcAdcClkPrescale(IADC0,
+                                                                    CLK_ADC_FREQ,
+                                                                    0,
+                                                                    iadcCfgModeNormal,
+                                                                    init.srcClkPrescale);
+
+  initSingle.triggerSelect = iadcTriggerSelTimer;
+  initSingle.dataValidLevel = _IADC_SINGLEFIFOCFG_DVL_VALID1;
+  initSingle.start = true;
+
+  initSingleInput.posInput = iadcPosInputAvdd;
+  initSingleInput.negInput = iadcNegInputGnd;
+
+  IADC_init(IADC0, &init, &initAllConfigs);
+  IADC_initSingle(IADC0, &initSingle, &initSingleInput);
+
+  IADC_enableInt(IADC0, IADC_IEN_SINGLEFIFODVL);
+  NVIC_ClearPendingIRQ(IADC_IRQn);
+  NVIC_EnableIRQ(IADC_IRQn);
+
+  IADC_command(IADC0, iadcCmdEnableTimer);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    LETIMER0 interrupts on underflow, with the planned top value
+ *****************************************************************************/
+void initLETIMER(void)
+{
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  letimerInit.comp0Top = true;
+  letimerInit.topValue = clockPlan.out[REQ_LETIMER0].div2 - 1;
+  letimerInit.repMode = letimerRepeatFree;
+
+  LETIMER_IntEnable(LETIMER0, LETIMER_IEN_UF);
+  NVIC_ClearPendingIRQ(LETIMER0_IRQn);
+  NVIC_EnableIRQ(LETIMER0_IRQn);
+
+  LETIMER_Init(LETIMER0, &letimerInit);
+}
+
+/**************************************************************************//**
+ * @brief  Interrupt handlers
+ *****************************************************************************/
+void IADC_IRQHandler(void)
+{
+  IADC_Result_t sample = IADC_pullSingleFifoResult(IADC0);
+
+  // 12-bit result of AVDD / 4 against 1.21 V
+  avddMillivolts = sample.data * 4 * 1210 / 0xFFF;
+  IADC_clearInt(IADC0, IADC_IF_SINGLEFIFODVL);
+}
+
+void LETIMER0_IRQHandler(void)
+{
+  LETIMER_IntClear(LETIMER0, LETIMER_IF_UF);
+  ticks++;
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  // Chip errata
+  CHIP_Init();
+
+  // Plan the clock tree for the requirements, and stop here if they
+  // cannot be met
+  clockPlanStatus = clockPlanSolve(&CLOCK_PLAN_DEVICE, clockReqs, REQ_COUNT, &clockPlan);
+  if (clockPlanStatus != 0)
+    while (1);
+
+  clockPlanApply(&clockPlan);
+
+  // Initializations
+  initTIMER();
+  initIADC();
+  initLETIMER();
+
+  while (1)
+  {
+    EMU_EnterEM1();
+  }
+}
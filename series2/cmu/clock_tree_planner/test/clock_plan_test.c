@@ -0,0 +1,533 @@
+/***************************************************************************//**
+ * @file clock_plan_test.c
+ * @brief Host test of clock_plan.c: the example requirements, family
+ * differences, invalid requirements and random requirements against a
+ * brute force search
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Isrc test/clock_plan_test.c src/clock_plan.c
+//       -o clock_plan_test
+//   ./clock_plan_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "clock_plan.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define EXAMPLE_REQS    (4)
+#define RANDOM_SETS     (400)
+#define RANDOM_REQS     (4)
+
+// Larger than any plan current, for "no plan found"
+#define NO_CURRENT      (1e18)
+
+static int checks;
+static int failures;
+
+static uint32_t seed = 92;
+
+static const clockPlanDevice_TypeDef *const devices[] = {
+  &clockPlanDeviceXG21,
+  &clockPlanDeviceXG22
+};
+
+// The requirements of main.c
+static const clockPlanReq_TypeDef exampleReqs[EXAMPLE_REQS] = {
+  { clockPlanSYSCLK, clockPlanAtLeast, 32000000, 0, 1, false, 0, 0 },
+  { clockPlanEM01GRPACLK, clockPlanExact, 88200, 200, 1024, false, 65536, 0 },
+  { clockPlanIADCCLK, clockPlanExact, 1000, 10000, 4, false, 65536, 40000000 },
+  { clockPlanEM23GRPACLK, clockPlanExact, 1, 1000, 32768, true, 16777216, 0 },
+};
+
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+/***************************************************************************//**
+ * @brief Tolerance of the oscillator at the root of a branch, in ppm
+ ******************************************************************************/
+static uint32_t sourcePpm(const clockPlanDevice_TypeDef *device,
+                          const clockPlan_TypeDef *plan, uint32_t branch)
+{
+  uint32_t source = plan->branchSource[branch];
+
+  if (source >= clockPlanOscCount) {
+    return sourcePpm(device, plan, source - clockPlanOscCount);
+  }
+  if (source == clockPlanHFRCODPLL && plan->dpll) {
+    return device->osc[plan->dpllRef].ppm;
+  }
+  return device->osc[source].ppm;
+}
+
+/***************************************************************************//**
+ * @brief Check a plan against the device limits and the requirements, without
+ * using the planner's own calculations
+ ******************************************************************************/
+static void planCheck(const clockPlanDevice_TypeDef *device,
+                      const clockPlanReq_TypeDef *reqs, uint32_t reqCount,
+                      const clockPlan_TypeDef *plan)
+{
+  const clockPlanOscDesc_TypeDef *dpllOsc = &device->osc[clockPlanHFRCODPLL];
+
+  if (plan->dpll) {
+    double hz = (double)device->osc[plan->dpllRef].hz
+                * (plan->dpllN + 1) / (plan->dpllM + 1);
+    double diff = hz - plan->oscHz[clockPlanHFRCODPLL];
+
+    CHECK(plan->dpllN >= 300 && plan->dpllN <= 4095 && plan->dpllM <= 4095);
+    CHECK(diff <= 1 && diff >= -1);
+    CHECK(plan->oscHz[plan->dpllRef] != 0);
+  } else if (plan->oscHz[clockPlanHFRCODPLL] != 0) {
+    bool band = false;
+
+    for (int i = 0; i < dpllOsc->bandCount; i++) {
+      band |= (dpllOsc->bands[i] == plan->oscHz[clockPlanHFRCODPLL]);
+    }
+    CHECK(band);
+  }
+
+  for (int b = 0; b < clockPlanBranchCount; b++) {
+    uint32_t source = plan->branchSource[b];
+    uint32_t hz;
+    bool listed = false;
+
+    if (source == CLOCK_PLAN_NONE) {
+      continue;
+    }
+    for (int i = 0; i < CLOCK_PLAN_BRANCH_SOURCES; i++) {
+      listed |= (device->branch[b].sources[i] == source);
+    }
+    CHECK(listed);
+    hz = (source < clockPlanOscCount) ? plan->oscHz[source]
+         : plan->branchHz[source - clockPlanOscCount];
+    CHECK(hz != 0 && hz == plan->branchHz[b]);
+    CHECK(hz <= device->branch[b].maxHz);
+  }
+
+  for (uint32_t i = 0; i < reqCount; i++) {
+    const clockPlanReq_TypeDef *req = &reqs[i];
+    const clockPlanOut_TypeDef *out = &plan->out[i];
+    uint32_t div2Max = req->div2Max ? req->div2Max : 1;
+    double hz = plan->branchHz[req->branch];
+    double rate;
+
+    CHECK(plan->branchSource[req->branch] != CLOCK_PLAN_NONE);
+    if (plan->branchSource[req->branch] == CLOCK_PLAN_NONE) {
+      continue;
+    }
+    CHECK(out->div1 >= 1 && out->div1 <= req->div1Max);
+    CHECK(out->div2 >= 1 && out->div2 <= div2Max);
+    CHECK(!req->div1Pow2 || (out->div1 & (out->div1 - 1)) == 0);
+    CHECK(req->stage1MaxHz == 0 || hz / out->div1 <= req->stage1MaxHz);
+    rate = hz / out->div1 / out->div2;
+    if (req->type == clockPlanAtMost) {
+      CHECK(rate <= req->hz);
+    } else if (req->type == clockPlanAtLeast) {
+      CHECK(rate >= req->hz);
+    } else {
+      double ppm = (rate - req->hz) / req->hz * 1e6;
+
+      if (ppm < 0) {
+        ppm = -ppm;
+      }
+      CHECK(ppm + sourcePpm(device, plan, req->branch) <= req->ppm + 0.5);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Whether some prescaler and counter setting meets a requirement from
+ * a branch at hz with a tolerance of ppm
+ ******************************************************************************/
+static bool reqMet(const clockPlanReq_TypeDef *req, double hz, double ppm)
+{
+  uint32_t div2Max = req->div2Max ? req->div2Max : 1;
+
+  for (uint32_t div1 = 1; div1 <= req->div1Max;
+       div1 = req->div1Pow2 ? div1 * 2 : div1 + 1) {
+    double stage1 = hz / div1;
+
+    if (req->stage1MaxHz != 0 && stage1 > req->stage1MaxHz) {
+      continue;
+    }
+    if (req->type == clockPlanExact) {
+      uint32_t div2 = (uint32_t)(stage1 / req->hz);
+
+      if (ppm >= req->ppm) {
+        return false;
+      }
+      for (uint32_t d = div2; d <= div2 + 1; d++) {
+        double err = (stage1 / d - req->hz) / req->hz * 1e6;
+
+        if (d < 1 || d > div2Max) {
+          continue;
+        }
+        if ((err < 0 ? -err : err) + ppm <= req->ppm) {
+          return true;
+        }
+      }
+    } else if (req->type == clockPlanAtMost) {
+      uint32_t div2 = (uint32_t)((stage1 + req->hz - 1) / req->hz);
+
+      if (div2 < 1) {
+        div2 = 1;
+      }
+      while (stage1 / div2 > req->hz) {
+        div2++;
+      }
+      if (div2 <= div2Max) {
+        return true;
+      }
+    } else {
+      uint32_t div2 = (uint32_t)(stage1 / req->hz);
+
+      if (div2 >= 1 && div2 <= div2Max) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/***************************************************************************//**
+ * @brief Frequency of an oscillator for the given HFRCODPLL and HFRCOEM23
+ * bands
+ ******************************************************************************/
+static uint32_t oscHz(const clockPlanDevice_TypeDef *device, uint32_t osc,
+                      int dpllBand, int em23Band)
+{
+  if (osc == clockPlanHFRCODPLL) {
+    return device->osc[osc].bands[dpllBand];
+  }
+  if (osc == clockPlanHFRCOEM23) {
+    return device->osc[osc].bands[em23Band];
+  }
+  return device->osc[osc].hz;
+}
+
+/***************************************************************************//**
+ * @brief Lowest current of any plan without the DPLL, by trying every branch
+ * source and every band, or NO_CURRENT if there is none
+ ******************************************************************************/
+static double bruteForce(const clockPlanDevice_TypeDef *device,
+                         const clockPlanReq_TypeDef *reqs, uint32_t reqCount)
+{
+  const int choices = CLOCK_PLAN_BRANCH_SOURCES + 1;
+  int dpllBands = device->osc[clockPlanHFRCODPLL].bandCount;
+  int em23Bands = device->osc[clockPlanHFRCOEM23].bandCount;
+  int combinations = 1;
+  double best = NO_CURRENT;
+
+  for (int b = 0; b < clockPlanBranchCount; b++) {
+    combinations *= choices;
+  }
+
+  // Each branch is unused (choice -1) or uses one of its listed sources
+  for (int c = 0; c < combinations; c++) {
+    int choice[clockPlanBranchCount];
+    uint32_t used = 0;
+    bool valid = true;
+    int x = c;
+
+    for (int b = 0; b < clockPlanBranchCount; b++) {
+      choice[b] = x % choices - 1;
+      x /= choices;
+    }
+    for (uint32_t i = 0; i < reqCount; i++) {
+      used |= 1u << reqs[i].branch;
+    }
+    for (int b = clockPlanBranchCount - 1; b >= 0 && valid; b--) {
+      uint32_t source;
+
+      if (!(used & (1u << b))) {
+        valid = (choice[b] < 0);
+        continue;
+      }
+      if (choice[b] < 0) {
+        valid = false;
+        break;
+      }
+      source = device->branch[b].sources[choice[b]];
+      if (source == CLOCK_PLAN_NONE) {
+        valid = false;
+      } else if (source >= clockPlanOscCount) {
+        used |= 1u << (source - clockPlanOscCount);
+      } else if (device->osc[source].hz == 0
+                 && device->osc[source].bandCount == 0) {
+        valid = false;
+      }
+    }
+    // A branch that only became used through a later branch must not
+    // have been skipped above
+    for (int b = 0; b < clockPlanBranchCount && valid; b++) {
+      valid = ((used & (1u << b)) != 0) == (choice[b] >= 0);
+    }
+    if (!valid) {
+      continue;
+    }
+
+    for (int h = 0; h < dpllBands; h++) {
+      for (int e = 0; e < em23Bands; e++) {
+        double hz[clockPlanBranchCount];
+        double ppm[clockPlanBranchCount];
+        double current = 0;
+        uint32_t oscOn = 0;
+        bool ok = true;
+
+        for (int b = 0; b < clockPlanBranchCount && ok; b++) {
+          uint32_t source;
+
+          if (!(used & (1u << b))) {
+            continue;
+          }
+          source = device->branch[b].sources[choice[b]];
+          if (source >= clockPlanOscCount) {
+            hz[b] = hz[source - clockPlanOscCount];
+            ppm[b] = ppm[source - clockPlanOscCount];
+          } else {
+            oscOn |= 1u << source;
+            hz[b] = oscHz(device, source, h, e);
+            ppm[b] = device->osc[source].ppm;
+          }
+          ok = (hz[b] <= device->branch[b].maxHz);
+          current += device->branch[b].naPerMHz * hz[b] / 1e6;
+        }
+        // Only try the bands of the oscillators in use
+        if (!ok || (h != 0 && !(oscOn & (1u << clockPlanHFRCODPLL)))
+            || (e != 0 && !(oscOn & (1u << clockPlanHFRCOEM23)))) {
+          continue;
+        }
+        for (uint32_t o = 0; o < clockPlanOscCount; o++) {
+          if (oscOn & (1u << o)) {
+            current += device->osc[o].baseNa + (double)device->osc[o].naPerMHz
+                       * oscHz(device, o, h, e) / 1e6;
+          }
+        }
+        for (uint32_t i = 0; i < reqCount && ok; i++) {
+          ok = reqMet(&reqs[i], hz[reqs[i].branch], ppm[reqs[i].branch]);
+        }
+        if (ok && current < best) {
+          best = current;
+        }
+      }
+    }
+  }
+  return best;
+}
+
+/***************************************************************************//**
+ * @brief The requirements of main.c give a valid plan on both families
+ ******************************************************************************/
+static void testExample(void)
+{
+  clockPlan_TypeDef plan;
+
+  for (int d = 0; d < 2; d++) {
+    CHECK(clockPlanSolve(devices[d], exampleReqs, EXAMPLE_REQS, &plan) == 0);
+    planCheck(devices[d], exampleReqs, EXAMPLE_REQS, &plan);
+
+    // The plan described in the readme
+    CHECK(plan.dpll && plan.dpllRef == clockPlanLFXO);
+    CHECK(plan.oscHz[clockPlanHFXO] == 0);
+    CHECK(plan.branchSource[clockPlanEM23GRPACLK] == clockPlanLFXO);
+    CHECK(plan.out[1].div1 * plan.out[1].div2 == 363);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Requirements that only one family can meet
+ ******************************************************************************/
+static void testFamilies(void)
+{
+  const clockPlanReq_TypeDef fast = {
+    clockPlanSYSCLK, clockPlanAtLeast, 78000000, 0, 1, false, 0, 0
+  };
+  const clockPlanReq_TypeDef tick = {
+    clockPlanEM23GRPACLK, clockPlanExact, 1, 1000, 32768, true, 16777216, 0
+  };
+  clockPlan_TypeDef plan;
+  clockPlanDevice_TypeDef noLfxo;
+
+  // SYSCLK runs at up to 80 MHz on the xG21 and 76.8 MHz on the xG22
+  CHECK(clockPlanSolve(&clockPlanDeviceXG21, &fast, 1, &plan) == 0);
+  CHECK(plan.branchHz[clockPlanSYSCLK] == 80000000);
+  CHECK(clockPlanSolve(&clockPlanDeviceXG22, &fast, 1, &plan)
+        == CLOCK_PLAN_ERR_NO_PLAN);
+
+  // Without an LFXO, only the xG22 precision LFRCO meets 1000 ppm
+  noLfxo = clockPlanDeviceXG21;
+  memset(&noLfxo.osc[clockPlanLFXO], 0, sizeof(noLfxo.osc[0]));
+  CHECK(clockPlanSolve(&noLfxo, &tick, 1, &plan) == CLOCK_PLAN_ERR_NO_PLAN);
+  noLfxo = clockPlanDeviceXG22;
+  memset(&noLfxo.osc[clockPlanLFXO], 0, sizeof(noLfxo.osc[0]));
+  CHECK(clockPlanSolve(&noLfxo, &tick, 1, &plan) == 0);
+  CHECK(plan.branchSource[clockPlanEM23GRPACLK] == clockPlanLFRCO);
+}
+
+/***************************************************************************//**
+ * @brief An exact rate that only a large prescaler divides closely enough
+ ******************************************************************************/
+static void testDividers(void)
+{
+  // 38.4 MHz / (62 * 136) is 4554.08 Hz, within 100 ppm with the HFXO alone
+  const clockPlanReq_TypeDef req = {
+    clockPlanEM01GRPACLK, clockPlanExact, 4554, 100, 419, false, 190, 0
+  };
+  clockPlan_TypeDef plan;
+  clockPlanDevice_TypeDef noDpll = clockPlanDeviceXG21;
+
+  noDpll.dpllMinHz = 0;
+  CHECK(clockPlanSolve(&noDpll, &req, 1, &plan) == 0);
+  planCheck(&noDpll, &req, 1, &plan);
+  CHECK(plan.branchSource[clockPlanEM01GRPACLK] == clockPlanHFXO);
+  CHECK(plan.out[0].div1 * plan.out[0].div2 == 62 * 136);
+
+  CHECK(clockPlanSolve(&clockPlanDeviceXG21, &req, 1, &plan) == 0);
+  planCheck(&clockPlanDeviceXG21, &req, 1, &plan);
+  CHECK(plan.currentNa <= bruteForce(&clockPlanDeviceXG21, &req, 1) + 1);
+}
+
+/***************************************************************************//**
+ * @brief Invalid and impossible requirements
+ ******************************************************************************/
+static void testInvalid(void)
+{
+  const clockPlanReq_TypeDef badBranch = {
+    clockPlanBranchCount, clockPlanExact, 1, 1, 1, false, 0, 0
+  };
+  const clockPlanReq_TypeDef tooTight = {
+    clockPlanEM23GRPACLK, clockPlanExact, 1, 10, 32768, true, 16777216, 0
+  };
+  clockPlan_TypeDef plan;
+
+  CHECK(clockPlanSolve(&clockPlanDeviceXG21, &badBranch, 1, &plan)
+        == CLOCK_PLAN_ERR_INVALID);
+  CHECK(clockPlanSolve(&clockPlanDeviceXG21, &tooTight, 1, &plan)
+        == CLOCK_PLAN_ERR_NO_PLAN);
+}
+
+/***************************************************************************//**
+ * @brief Random requirement sets: every plan is valid, none draws more
+ * current than the best plan without the DPLL, and the planner finds a plan
+ * whenever the brute force search does
+ ******************************************************************************/
+static void testRandom(void)
+{
+  static const uint32_t ppms[] = { 20, 100, 1000, 10000, 30000 };
+  clockPlanReq_TypeDef reqs[RANDOM_REQS];
+  clockPlan_TypeDef plan;
+
+  for (int it = 0; it < RANDOM_SETS; it++) {
+    uint32_t count = 1 + random32() % RANDOM_REQS;
+
+    for (uint32_t i = 0; i < count; i++) {
+      clockPlanReq_TypeDef *req = &reqs[i];
+      bool lf;
+      uint32_t spread;
+
+      memset(req, 0, sizeof(*req));
+      req->branch = random32() % clockPlanBranchCount;
+      req->type = (clockPlanRate_TypeDef)(random32() % 3);
+      req->ppm = ppms[random32() % 5];
+      lf = (req->branch == clockPlanEM23GRPACLK);
+      switch (random32() % 3) {
+        case 0:
+          req->div1Max = 1;
+          break;
+        case 1:
+          req->div1Max = 1 + random32() % 1024;
+          break;
+        default:
+          req->div1Max = 1u << (random32() % 16);
+          req->div1Pow2 = true;
+          break;
+      }
+      req->div2Max = (random32() % 2) ? 0 : 1 + random32() % 65536;
+      // One call per statement, so the order does not depend on the compiler
+      spread = 1 + random32() % 1000;
+      if (lf) {
+        req->hz = 1 + random32() % 32768 / spread;
+      } else {
+        req->hz = 1000 + random32() * 1000 % 40000000 / spread;
+      }
+      if (req->type == clockPlanAtLeast && !lf && req->div1Max == 1
+          && req->div2Max == 0) {
+        req->hz = 1000000 + random32() * 1000 % 50000000;
+      }
+      if (random32() % 4 == 0) {
+        req->stage1MaxHz = lf ? 16384 : 10000000 + random32() * 1000 % 30000000;
+      }
+    }
+
+    for (int d = 0; d < 2; d++) {
+      double best = bruteForce(devices[d], reqs, count);
+      int ret = clockPlanSolve(devices[d], reqs, count, &plan);
+
+      if (ret == 0) {
+        planCheck(devices[d], reqs, count, &plan);
+        CHECK(plan.currentNa <= best + 1);
+      } else {
+        CHECK(ret == CLOCK_PLAN_ERR_NO_PLAN);
+        CHECK(best == NO_CURRENT);
+      }
+    }
+  }
+}
+
+int main(void)
+{
+  testExample();
+  testFamilies();
+  testDividers();
+  testInvalid();
+  testRandom();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,291 @@
+/***************************************************************************//**
+ * @file aead_frame_test.c
+ * @brief Host test of aead_frame.c: RFC 3610 packet vectors, both key sizes
+ * against mbed TLS CCM, tampered frames and bad lengths
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, with the mbed TLS of the
+// Gecko SDK built for the host (make -C <mbedtls> lib):
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc -I<mbedtls>/include
+//       test/aead_frame_test.c src/aead_frame.c
+//       -L<mbedtls>/library -lmbedcrypto -o aead_frame_test
+//   ./aead_frame_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "aead_frame.h"
+#include "mbedtls/ccm.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define NONCE_SIZE      AEAD_FRAME_NONCE_SIZE
+#define TAG_SIZE        AEAD_FRAME_TAG_SIZE
+
+static int checks;
+static int failures;
+
+static uint8_t frame[600];
+
+// RFC 3610 packet vectors #1 to #3: key C0..CF, 8-byte header 00..07 and a
+// payload of 23, 24 and 25 bytes counting up from 08
+static const uint8_t rfcKey[16] = {
+  0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+  0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf
+};
+
+static const uint8_t rfcNonce[3][NONCE_SIZE] = {
+  { 0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4,
+    0xa5 },
+  { 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4,
+    0xa5 },
+  { 0x00, 0x00, 0x00, 0x05, 0x04, 0x03, 0x02, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4,
+    0xa5 },
+};
+
+// Ciphertext followed by the 8-byte tag
+static const uint8_t rfcSealed[3][33] = {
+  { 0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2, 0xf0, 0x66, 0xd0, 0xc2,
+    0xc0, 0xf9, 0x89, 0x80, 0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84, 0x17,
+    0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0 },
+  { 0x72, 0xc9, 0x1a, 0x36, 0xe1, 0x35, 0xf8, 0xcf, 0x29, 0x1c, 0xa8, 0x94,
+    0x08, 0x5c, 0x87, 0xe3, 0xcc, 0x15, 0xc4, 0x39, 0xc9, 0xe4, 0x3a, 0x3b,
+    0xa0, 0x91, 0xd5, 0x6e, 0x10, 0x40, 0x09, 0x16 },
+  { 0x51, 0xb1, 0xe5, 0xf4, 0x4a, 0x19, 0x7d, 0x1d, 0xa4, 0x6b, 0x0f, 0x8e,
+    0x2d, 0x28, 0x2a, 0xe8, 0x71, 0xe8, 0x38, 0xbb, 0x64, 0xda, 0x85, 0x96,
+    0x57, 0x4a, 0xda, 0xa7, 0x6f, 0xbd, 0x9f, 0xb0, 0xc5 },
+};
+
+/***************************************************************************//**
+ * @brief Check whether a buffer holds only zeros
+ ******************************************************************************/
+static bool isZero(const uint8_t *buf, size_t len)
+{
+  while (len--) {
+    if (*buf++ != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief Seal and open the RFC 3610 packet vectors in place
+ ******************************************************************************/
+static void testRfcVectors(void)
+{
+  size_t frameLen;
+  size_t payloadLen;
+  uint8_t *payload;
+
+  if (TAG_SIZE != 8) {
+    printf("RFC 3610 vectors skipped, they need AEAD_FRAME_TAG_SIZE 8\n");
+    return;
+  }
+  CHECK(aeadFrameSetKey(rfcKey, 128) == 0);
+
+  for (int v = 0; v < 3; v++) {
+    size_t len = 23 + v;
+
+    memset(frame, 0xee, sizeof(frame));
+    for (size_t i = 0; i < 8; i++) {
+      frame[i] = (uint8_t)i;
+    }
+    payload = aeadFramePayload(frame, 8);
+    CHECK(payload == frame + 8 + NONCE_SIZE);
+    for (size_t i = 0; i < len; i++) {
+      payload[i] = (uint8_t)(8 + i);
+    }
+
+    CHECK(aeadFrameSeal(frame, sizeof(frame), 8, len, rfcNonce[v],
+                        &frameLen) == 0);
+    CHECK(frameLen == AEAD_FRAME_OVERHEAD(8) + len);
+    CHECK(memcmp(frame + 8, rfcNonce[v], NONCE_SIZE) == 0);
+    CHECK(memcmp(payload, rfcSealed[v], len + TAG_SIZE) == 0);
+    CHECK(frame[frameLen] == 0xee);
+
+    CHECK(aeadFrameOpen(frame, frameLen, 8, &payloadLen) == 0);
+    CHECK(payloadLen == len);
+    for (size_t i = 0; i < len; i++) {
+      CHECK(payload[i] == 8 + i);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief Compare random frames with mbed TLS CCM for both key sizes, with
+ * header and payload sizes around the block boundaries, and check that a
+ * frame with any field modified is rejected and its payload wiped
+ ******************************************************************************/
+static void testReference(void)
+{
+  static const size_t headerSizes[] = { 0, 1, 13, 14, 15, 30, 31, 100 };
+  static const size_t payloadSizes[] = { 0, 1, 15, 16, 17, 32, 33, 300 };
+  mbedtls_ccm_context ref;
+  uint8_t key[32];
+  uint8_t nonce[NONCE_SIZE];
+  uint8_t header[100];
+  uint8_t plain[300];
+  uint8_t expected[300 + TAG_SIZE];
+  uint8_t copy[sizeof(frame)];
+  size_t frameLen;
+  size_t payloadLen;
+
+  srand(1);
+  for (size_t i = 0; i < sizeof(key); i++) {
+    key[i] = (uint8_t)rand();
+  }
+
+  for (unsigned int bits = 128; bits <= 256; bits += 128) {
+    CHECK(aeadFrameSetKey(key, bits) == 0);
+    mbedtls_ccm_init(&ref);
+    CHECK(mbedtls_ccm_setkey(&ref, MBEDTLS_CIPHER_ID_AES, key, bits) == 0);
+
+    for (size_t h = 0; h < sizeof(headerSizes) / sizeof(headerSizes[0]); h++) {
+      for (size_t p = 0; p < sizeof(payloadSizes) / sizeof(payloadSizes[0]);
+           p++) {
+        size_t hLen = headerSizes[h];
+        size_t pLen = payloadSizes[p];
+        size_t pos[4];
+
+        for (size_t i = 0; i < hLen; i++) {
+          header[i] = (uint8_t)rand();
+        }
+        for (size_t i = 0; i < pLen; i++) {
+          plain[i] = (uint8_t)rand();
+        }
+        for (size_t i = 0; i < NONCE_SIZE; i++) {
+          nonce[i] = (uint8_t)rand();
+        }
+        CHECK(mbedtls_ccm_encrypt_and_tag(&ref, pLen, nonce, NONCE_SIZE,
+                                          header, hLen, plain, expected,
+                                          expected + pLen, TAG_SIZE) == 0);
+
+        // The nonce may already be in place in the frame
+        memcpy(frame, header, hLen);
+        memcpy(frame + hLen, nonce, NONCE_SIZE);
+        memcpy(aeadFramePayload(frame, hLen), plain, pLen);
+        CHECK(aeadFrameSeal(frame, sizeof(frame), hLen, pLen, frame + hLen,
+                            &frameLen) == 0);
+        CHECK(frameLen == AEAD_FRAME_OVERHEAD(hLen) + pLen);
+        CHECK(memcmp(frame, header, hLen) == 0);
+        CHECK(memcmp(frame + hLen, nonce, NONCE_SIZE) == 0);
+        CHECK(memcmp(aeadFramePayload(frame, hLen), expected,
+                     pLen + TAG_SIZE) == 0);
+
+        // Header, nonce, payload and tag
+        pos[0] = 0;
+        pos[1] = hLen;
+        pos[2] = hLen + NONCE_SIZE;
+        pos[3] = frameLen - 1;
+        for (int t = 0; t < 4; t++) {
+          if ((t == 0 && hLen == 0) || (t == 2 && pLen == 0)) {
+            continue;
+          }
+          memcpy(copy, frame, frameLen);
+          copy[pos[t]] ^= 0x40;
+          CHECK(aeadFrameOpen(copy, frameLen, hLen, &payloadLen)
+                == AEAD_FRAME_ERR_AUTH_FAILED);
+          CHECK(isZero(aeadFramePayload(copy, hLen), pLen));
+        }
+
+        CHECK(aeadFrameOpen(frame, frameLen, hLen, &payloadLen) == 0);
+        CHECK(payloadLen == pLen);
+        CHECK(memcmp(aeadFramePayload(frame, hLen), plain, pLen) == 0);
+      }
+    }
+    mbedtls_ccm_free(&ref);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Check the length and key checks
+ ******************************************************************************/
+static void testBadInput(void)
+{
+  static const uint8_t key[16] = { 0 };
+  static const uint8_t nonce[NONCE_SIZE] = { 0 };
+  size_t frameLen;
+  size_t payloadLen;
+
+  CHECK(aeadFrameSetKey(key, 64) != 0);
+  // No key is set after a failed aeadFrameSetKey()
+  CHECK(aeadFrameSeal(frame, sizeof(frame), 0, 0, nonce, &frameLen)
+        == AEAD_FRAME_ERR_BAD_INPUT);
+
+  CHECK(aeadFrameSetKey(key, 128) == 0);
+  // Buffer one byte too small, and smaller than header and nonce
+  CHECK(aeadFrameSeal(frame, AEAD_FRAME_OVERHEAD(8) + 23 - 1, 8, 23, nonce,
+                      &frameLen) == AEAD_FRAME_ERR_BAD_INPUT);
+  CHECK(aeadFrameSeal(frame, 10, 8, 0, nonce, &frameLen)
+        == AEAD_FRAME_ERR_BAD_INPUT);
+  CHECK(aeadFrameSeal(frame, sizeof(frame), 0, AEAD_FRAME_MAX_PAYLOAD + 1,
+                      nonce, &frameLen) == AEAD_FRAME_ERR_BAD_INPUT);
+  CHECK(aeadFrameSeal(frame, sizeof(frame), AEAD_FRAME_MAX_HEADER + 1, 0,
+                      nonce, &frameLen) == AEAD_FRAME_ERR_BAD_INPUT);
+  // Frame shorter than header, nonce and tag
+  CHECK(aeadFrameOpen(frame, AEAD_FRAME_OVERHEAD(8) - 1, 8, &payloadLen)
+        == AEAD_FRAME_ERR_BAD_INPUT);
+
+  CHECK(aeadFrameSeal(frame, sizeof(frame), 0, 0, nonce, &frameLen) == 0);
+  CHECK(frameLen == AEAD_FRAME_OVERHEAD(0));
+  CHECK(aeadFrameOpen(frame, frameLen, 0, &payloadLen) == 0);
+  CHECK(payloadLen == 0);
+
+  aeadFrameFree();
+  CHECK(aeadFrameOpen(frame, frameLen, 0, &payloadLen)
+        == AEAD_FRAME_ERR_BAD_INPUT);
+}
+
+int main(void)
+{
+  testRfcVectors();
+  testReference();
+  testBadInput();
+  aeadFrameFree();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,262 @@
+/***************************************************************************//**
+ * @file dispatch_test.c
+ * @brief Host test of crypto_dispatch.c: software SHA-256 against FIPS 180-2
+ * test vectors and the accelerator path, and the stored selection table
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, with the mbed TLS of the
+// Gecko SDK built for the host (make -C <mbedtls> lib):
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc -I<mbedtls>/include
+//       test/dispatch_test.c test/stubs/host_flash.c src/crypto_dispatch.c
+//       -L<mbedtls>/library -lmbedcrypto -o dispatch_test
+//   ./dispatch_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "crypto_dispatch.h"
+#include "em_device.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define LAST_PAGE       (hostFlash + FLASH_SIZE - FLASH_PAGE_SIZE)
+
+extern unsigned hostFlashErases;
+extern unsigned hostUserDataErases;
+
+static int checks;
+static int failures;
+
+// FIPS 180-2 appendix B: "abc", the 448-bit message and one million 'a'
+static const char *vectorMessage[3] = {
+  "abc",
+  "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+  NULL
+};
+
+static const uint8_t vectorDigest[3][32] = {
+  {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde,
+    0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+    0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+  },
+  {
+    0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93,
+    0x0c, 0x3e, 0x60, 0x39, 0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+    0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+  },
+  {
+    0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2,
+    0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e,
+    0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+  }
+};
+
+// Input data for the backend comparison
+static uint8_t data[1024];
+
+/***************************************************************************//**
+ * @brief Force all SHA-256 operations to one backend by patching the
+ *   selection table in RAM
+ ******************************************************************************/
+static void setThreshold(uint32_t threshold)
+{
+  dispatchTable_TypeDef *table = (dispatchTable_TypeDef *)dispatchTableGet();
+
+  table->threshold[DISPATCH_OP_SHA256] = threshold;
+}
+
+/***************************************************************************//**
+ * @brief Software SHA-256 against the test vectors, in one piece and fed in
+ *   uneven chunks
+ ******************************************************************************/
+static void testVectors(void)
+{
+  static uint8_t million[1000000];
+  dispatchSha256_TypeDef ctx;
+  uint8_t digest[32];
+  const uint8_t *msg;
+  size_t length;
+  size_t offset;
+  size_t chunk;
+  int i;
+
+  setThreshold(DISPATCH_NEVER);
+  memset(million, 'a', sizeof(million));
+  for (i = 0; i < 3; i++) {
+    msg = vectorMessage[i] ? (const uint8_t *)vectorMessage[i] : million;
+    length = vectorMessage[i] ? strlen(vectorMessage[i]) : sizeof(million);
+
+    CHECK(dispatchSha256(msg, length, digest) == 0);
+    CHECK(memcmp(digest, vectorDigest[i], 32) == 0);
+
+    dispatchSha256Init(&ctx, length);
+    CHECK(!ctx.hardware);
+    CHECK(dispatchSha256Starts(&ctx) == 0);
+    for (offset = 0, chunk = 1; offset < length; offset += chunk, chunk += 7) {
+      if (chunk > length - offset) {
+        chunk = length - offset;
+      }
+      CHECK(dispatchSha256Update(&ctx, msg + offset, chunk) == 0);
+    }
+    CHECK(dispatchSha256Finish(&ctx, digest) == 0);
+    dispatchSha256Free(&ctx);
+    CHECK(memcmp(digest, vectorDigest[i], 32) == 0);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Both backends give the same digest for every length around the
+ *   block boundaries, and a cloned context continues on its backend
+ ******************************************************************************/
+static void testBackends(void)
+{
+  dispatchSha256_TypeDef ctx;
+  dispatchSha256_TypeDef copy;
+  uint8_t hw[32];
+  uint8_t sw[32];
+  uint8_t cloned[32];
+  size_t length;
+  int hardware;
+
+  for (length = 0; length <= 300; length++) {
+    setThreshold(0);
+    CHECK(dispatchSha256(data, length, hw) == 0);
+    setThreshold(DISPATCH_NEVER);
+    CHECK(dispatchSha256(data, length, sw) == 0);
+    CHECK(memcmp(hw, sw, 32) == 0);
+  }
+
+  for (hardware = 0; hardware < 2; hardware++) {
+    setThreshold(hardware ? 0 : DISPATCH_NEVER);
+    dispatchSha256Init(&ctx, 100);
+    CHECK(ctx.hardware == hardware);
+    CHECK(dispatchSha256Starts(&ctx) == 0);
+    CHECK(dispatchSha256Update(&ctx, data, 70) == 0);
+    dispatchSha256Clone(&copy, &ctx);
+    CHECK(copy.hardware == hardware);
+    CHECK(dispatchSha256Update(&ctx, data + 70, 30) == 0);
+    CHECK(dispatchSha256Finish(&ctx, hw) == 0);
+    CHECK(dispatchSha256Update(&copy, data + 70, 30) == 0);
+    CHECK(dispatchSha256Finish(&copy, cloned) == 0);
+    dispatchSha256Free(&ctx);
+    dispatchSha256Free(&copy);
+    CHECK(dispatchSha256(data, 100, sw) == 0);
+    CHECK(memcmp(hw, sw, 32) == 0);
+    CHECK(memcmp(cloned, sw, 32) == 0);
+  }
+
+  // Selection at the threshold
+  setThreshold(128);
+  CHECK(!dispatchUseHardware(DISPATCH_OP_SHA256, 127));
+  CHECK(dispatchUseHardware(DISPATCH_OP_SHA256, 128));
+}
+
+/***************************************************************************//**
+ * @brief Store and load of the selection table. Only the last main flash
+ *   page may be erased, the user data page must be left alone.
+ ******************************************************************************/
+static void testStore(void)
+{
+  const dispatchTable_TypeDef *table;
+  uint8_t userData[USERDATA_SIZE];
+  uint32_t threshold;
+  size_t i;
+
+  memset(hostFlash, 0xFF, FLASH_SIZE);
+  for (i = 0; i < USERDATA_SIZE; i++) {
+    hostUserData[i] = (uint8_t)(i * 13);
+  }
+  memcpy(userData, hostUserData, USERDATA_SIZE);
+
+  // Erased flash: defaults
+  CHECK(!dispatchInit());
+  table = dispatchTableGet();
+  CHECK(table->threshold[DISPATCH_OP_SHA256] == 128);
+
+  // The host cycle counter does not run, so both backends take the same
+  // time and the calibrated threshold is the smallest size
+  dispatchCalibrate();
+  threshold = table->threshold[DISPATCH_OP_SHA256];
+  CHECK(threshold == 0);
+
+  // A stale table in the page is replaced
+  memset(LAST_PAGE, 0x00, 64);
+  CHECK(dispatchStore() == 0);
+  CHECK(hostFlashErases == 1);
+  CHECK(hostUserDataErases == 0);
+  CHECK(memcmp(hostUserData, userData, USERDATA_SIZE) == 0);
+  CHECK(memcmp(LAST_PAGE, table, sizeof(*table)) == 0);
+  for (i = 0; i < FLASH_SIZE - FLASH_PAGE_SIZE; i++) {
+    if (hostFlash[i] != 0xFF) {
+      break;
+    }
+  }
+  CHECK(i == FLASH_SIZE - FLASH_PAGE_SIZE);
+
+  setThreshold(500);
+  CHECK(dispatchInit());
+  CHECK(table->threshold[DISPATCH_OP_SHA256] == threshold);
+
+  // A corrupted table is ignored
+  LAST_PAGE[4] ^= 0x01;
+  CHECK(!dispatchInit());
+  CHECK(table->threshold[DISPATCH_OP_SHA256] == 128);
+}
+
+int main(void)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 7 + 3);
+  }
+
+  dispatchInit();
+  testVectors();
+  testBackends();
+  testStore();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+/***************************************************************************//**
+ * @file kdf_test.c
+ * @brief Host test of kdf.c against published PBKDF2-HMAC-SHA256 and
+ * HKDF-SHA256 test vectors, on both SHA-256 backends of crypto_dispatch.c
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, with the mbed TLS of the
+// Gecko SDK built for the host (make -C <mbedtls> lib):
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc -I<mbedtls>/include
+//       test/kdf_test.c test/stubs/host_flash.c src/kdf.c
+//       src/crypto_dispatch.c -L<mbedtls>/library -lmbedcrypto -o kdf_test
+//   ./kdf_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "kdf.h"
+#include "crypto_dispatch.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+static int checks;
+static int failures;
+
+// RFC 7914 section 11: P = "passwd", S = "salt", c = 1, dkLen = 64
+static const uint8_t pbkdf2Key1[64] = {
+  0x55, 0xac, 0x04, 0x6e, 0x56, 0xe3, 0x08, 0x9f, 0xec, 0x16, 0x91, 0xc2,
+  0x25, 0x44, 0xb6, 0x05, 0xf9, 0x41, 0x85, 0x21, 0x6d, 0xde, 0x04, 0x65,
+  0xe6, 0x8b, 0x9d, 0x57, 0xc2, 0x0d, 0xac, 0xbc, 0x49, 0xca, 0x9c, 0xcc,
+  0xf1, 0x79, 0xb6, 0x45, 0x99, 0x16, 0x64, 0xb3, 0x9d, 0x77, 0xef, 0x31,
+  0x7c, 0x71, 0xb8, 0x45, 0xb1, 0xe3, 0x0b, 0xd5, 0x09, 0x11, 0x20, 0x41,
+  0xd3, 0xa1, 0x97, 0x83
+};
+
+// P = "password", S = "salt", c = 4096, dkLen = 32
+static const uint8_t pbkdf2Key2[32] = {
+  0xc5, 0xe4, 0x78, 0xd5, 0x92, 0x88, 0xc8, 0x41, 0xaa, 0x53, 0x0d, 0xb6,
+  0x84, 0x5c, 0x4c, 0x8d, 0x96, 0x28, 0x93, 0xa0, 0x01, 0xce, 0x4e, 0x11,
+  0xa4, 0x96, 0x38, 0x73, 0xaa, 0x98, 0x13, 0x4a
+};
+
+// P = "passwordPASSWORDpassword" x 3 (longer than the HMAC block),
+// S = "saltSALT" x 4 + "salt", c = 4096, dkLen = 40 (partial last block)
+static const uint8_t pbkdf2Key3[40] = {
+  0x54, 0xf1, 0xe8, 0x3a, 0xac, 0x97, 0x88, 0x45, 0x47, 0x13, 0x7c, 0xcb,
+  0x9f, 0xd8, 0x5c, 0x51, 0x29, 0x13, 0xcc, 0x2a, 0xb4, 0x66, 0xa1, 0x65,
+  0x72, 0xd9, 0xb2, 0x3c, 0xa6, 0xc9, 0x9f, 0x5b, 0x3c, 0xbc, 0xd8, 0xea,
+  0xec, 0x15, 0xdb, 0x46
+};
+
+// RFC 5869 test case 1
+static const uint8_t hkdfOkm1[42] = {
+  0x3c, 0xb2, 0x5f, 0x25, 0xfa, 0xac, 0xd5, 0x7a, 0x90, 0x43, 0x4f, 0x64,
+  0xd0, 0x36, 0x2f, 0x2a, 0x2d, 0x2d, 0x0a, 0x90, 0xcf, 0x1a, 0x5a, 0x4c,
+  0x5d, 0xb0, 0x2d, 0x56, 0xec, 0xc4, 0xc5, 0xbf, 0x34, 0x00, 0x72, 0x08,
+  0xd5, 0xb8, 0x87, 0x18, 0x58, 0x65
+};
+
+// RFC 5869 test case 2, long inputs
+static const uint8_t hkdfOkm2[82] = {
+  0xb1, 0x1e, 0x39, 0x8d, 0xc8, 0x03, 0x27, 0xa1, 0xc8, 0xe7, 0xf7, 0x8c,
+  0x59, 0x6a, 0x49, 0x34, 0x4f, 0x01, 0x2e, 0xda, 0x2d, 0x4e, 0xfa, 0xd8,
+  0xa0, 0x50, 0xcc, 0x4c, 0x19, 0xaf, 0xa9, 0x7c, 0x59, 0x04, 0x5a, 0x99,
+  0xca, 0xc7, 0x82, 0x72, 0x71, 0xcb, 0x41, 0xc6, 0x5e, 0x59, 0x0e, 0x09,
+  0xda, 0x32, 0x75, 0x60, 0x0c, 0x2f, 0x09, 0xb8, 0x36, 0x77, 0x93, 0xa9,
+  0xac, 0xa3, 0xdb, 0x71, 0xcc, 0x30, 0xc5, 0x81, 0x79, 0xec, 0x3e, 0x87,
+  0xc1, 0x4c, 0x01, 0xd5, 0xc1, 0xf3, 0x43, 0x4f, 0x1d, 0x87
+};
+
+// RFC 5869 test case 3, no salt and no info
+static const uint8_t hkdfOkm3[42] = {
+  0x8d, 0xa4, 0xe7, 0x75, 0xa5, 0x63, 0xc1, 0x8f, 0x71, 0x5f, 0x80, 0x2a,
+  0x06, 0x3c, 0x5a, 0x31, 0xb8, 0xa1, 0x1f, 0x5c, 0x5e, 0xe1, 0x87, 0x9e,
+  0xc3, 0x45, 0x4e, 0x5f, 0x3c, 0x73, 0x8d, 0x2d, 0x9d, 0x20, 0x13, 0x95,
+  0xfa, 0xa4, 0xb6, 0x1a, 0x96, 0xc8
+};
+
+/***************************************************************************//**
+ * @brief Force all SHA-256 operations to one backend by patching the
+ *   selection table in RAM
+ ******************************************************************************/
+static void setThreshold(uint32_t threshold)
+{
+  dispatchTable_TypeDef *table = (dispatchTable_TypeDef *)dispatchTableGet();
+
+  table->threshold[DISPATCH_OP_SHA256] = threshold;
+}
+
+/***************************************************************************//**
+ * @brief PBKDF2 test vectors and input checks
+ ******************************************************************************/
+static void testPbkdf2(void)
+{
+  uint8_t key[64];
+  uint8_t password[72];
+  uint8_t salt[36];
+  int i;
+
+  CHECK(kdfPbkdf2HmacSha256((const uint8_t *)"passwd", 6,
+                            (const uint8_t *)"salt", 4,
+                            1, key, 64) == 0);
+  CHECK(memcmp(key, pbkdf2Key1, 64) == 0);
+
+  CHECK(kdfPbkdf2HmacSha256((const uint8_t *)"password", 8,
+                            (const uint8_t *)"salt", 4,
+                            4096, key, 32) == 0);
+  CHECK(memcmp(key, pbkdf2Key2, 32) == 0);
+
+  for (i = 0; i < 3; i++) {
+    memcpy(password + 24 * i, "passwordPASSWORDpassword", 24);
+  }
+  for (i = 0; i < 4; i++) {
+    memcpy(salt + 8 * i, "saltSALT", 8);
+  }
+  memcpy(salt + 32, "salt", 4);
+  memset(key, 0xA5, sizeof(key));
+  CHECK(kdfPbkdf2HmacSha256(password, sizeof(password), salt, sizeof(salt),
+                            4096, key, 40) == 0);
+  CHECK(memcmp(key, pbkdf2Key3, 40) == 0);
+  CHECK(key[40] == 0xA5);
+
+  CHECK(kdfPbkdf2HmacSha256((const uint8_t *)"password", 8,
+                            (const uint8_t *)"salt", 4,
+                            0, key, 32) == KDF_ERR_BAD_INPUT_DATA);
+}
+
+/***************************************************************************//**
+ * @brief HKDF test vectors and input checks
+ ******************************************************************************/
+static void testHkdf(void)
+{
+  uint8_t ikm[80];
+  uint8_t salt[80];
+  uint8_t info[80];
+  uint8_t okm[82];
+  int i;
+
+  memset(ikm, 0x0B, 22);
+  for (i = 0; i < 13; i++) {
+    salt[i] = (uint8_t)i;
+  }
+  for (i = 0; i < 10; i++) {
+    info[i] = (uint8_t)(0xF0 + i);
+  }
+  CHECK(kdfHkdfSha256(salt, 13, ikm, 22, info, 10, okm, 42) == 0);
+  CHECK(memcmp(okm, hkdfOkm1, 42) == 0);
+
+  for (i = 0; i < 80; i++) {
+    ikm[i] = (uint8_t)i;
+    salt[i] = (uint8_t)(0x60 + i);
+    info[i] = (uint8_t)(0xB0 + i);
+  }
+  CHECK(kdfHkdfSha256(salt, 80, ikm, 80, info, 80, okm, 82) == 0);
+  CHECK(memcmp(okm, hkdfOkm2, 82) == 0);
+
+  memset(ikm, 0x0B, 22);
+  CHECK(kdfHkdfSha256(NULL, 0, ikm, 22, NULL, 0, okm, 42) == 0);
+  CHECK(memcmp(okm, hkdfOkm3, 42) == 0);
+
+  CHECK(kdfHkdfSha256(NULL, 0, ikm, 22, NULL, 0, okm, 255 * 32 + 1)
+        == KDF_ERR_BAD_INPUT_DATA);
+}
+
+/***************************************************************************//**
+ * @brief Derived key cache: hits, eviction of the oldest slot and clear
+ ******************************************************************************/
+static void testCache(void)
+{
+  uint8_t key[KDF_SHA256_SIZE];
+  uint8_t salt[2] = { 's', '0' };
+  bool cached;
+  int i;
+
+  kdfCacheClear();
+  CHECK(kdfDeriveKeyCached((const uint8_t *)"password", 8,
+                           (const uint8_t *)"salt", 4, key, &cached) == 0);
+  CHECK(!cached);
+  CHECK(memcmp(key, pbkdf2Key2, 32) == 0);
+
+  memset(key, 0, sizeof(key));
+  CHECK(kdfDeriveKeyCached((const uint8_t *)"password", 8,
+                           (const uint8_t *)"salt", 4, key, &cached) == 0);
+  CHECK(cached);
+  CHECK(memcmp(key, pbkdf2Key2, 32) == 0);
+
+  // The same bytes split differently between password and salt are a
+  // different entry
+  CHECK(kdfDeriveKeyCached((const uint8_t *)"passwords", 9,
+                           (const uint8_t *)"alt", 3, key, &cached) == 0);
+  CHECK(!cached);
+
+  // Fill the remaining slots, which evicts the oldest entry
+  for (i = 0; i < KDF_CACHE_SLOTS - 1; i++) {
+    salt[1] = (uint8_t)('0' + i);
+    CHECK(kdfDeriveKeyCached((const uint8_t *)"pw", 2, salt, 2, key, &cached)
+          == 0);
+    CHECK(!cached);
+  }
+  CHECK(kdfDeriveKeyCached((const uint8_t *)"password", 8,
+                           (const uint8_t *)"salt", 4, key, &cached) == 0);
+  CHECK(!cached);
+  CHECK(memcmp(key, pbkdf2Key2, 32) == 0);
+
+  kdfCacheClear();
+  CHECK(kdfDeriveKeyCached((const uint8_t *)"password", 8,
+                           (const uint8_t *)"salt", 4, key, &cached) == 0);
+  CHECK(!cached);
+}
+
+int main(void)
+{
+  static const uint32_t thresholds[] = { 0, 64, DISPATCH_NEVER };
+  size_t i;
+
+  dispatchInit();
+  for (i = 0; i < sizeof(thresholds) / sizeof(thresholds[0]); i++) {
+    setThreshold(thresholds[i]);
+    testPbkdf2();
+    testHkdf();
+    testCache();
+  }
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+// Host stand-in for em_cmu.h
+#ifndef EM_CMU_H
+#define EM_CMU_H
+
+#include <stdbool.h>
+
+typedef enum {
+  cmuClock_MSC
+} CMU_Clock_TypeDef;
+
+static inline void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void)clock;
+  (void)enable;
+}
+
+#endif // EM_CMU_H
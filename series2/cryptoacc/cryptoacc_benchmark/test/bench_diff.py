@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Compare two crypto benchmark logs captured from the VCOM port.
+
+Usage: bench_diff.py [--threshold PERCENT] baseline.log candidate.log
+
+Both logs must contain the BENCH-BEGIN ... BENCH-END table printed by the
+se_benchmark/cryptoacc_benchmark examples. Results are matched on
+(backend, operation, bytes) and compared on the minimum cycle count, which
+is less sensitive to interrupts than the mean. The script exits with status
+1 when any operation is slower than the threshold (default 5 %) or is
+missing from the candidate log, so it can be used to gate a release.
+"""
+
+import argparse
+import sys
+
+FORMAT_VERSION = 1
+
+
+def parse_log(path):
+    """Return ({(backend, op, bytes): (min, mean)}, {backend: (fw, hclk)})."""
+    results = {}
+    runs = {}
+    backend = None
+    with open(path, 'r', errors='replace') as log:
+        for line in log:
+            fields = line.strip().split(',')
+            if fields[0] == 'BENCH-BEGIN' and len(fields) == 5:
+                if int(fields[1]) != FORMAT_VERSION:
+                    sys.exit('%s: unsupported format version %s'
+                             % (path, fields[1]))
+                backend = fields[3]
+                runs[backend] = (fields[2], int(fields[4]))
+            elif fields[0] == 'BENCH' and len(fields) == 6 and backend:
+                key = (backend, fields[1], int(fields[2]))
+                # Keep the best result when the table was printed more
+                # than once ('r' pressed)
+                sample = (int(fields[4]), int(fields[5]))
+                if key not in results or sample[0] < results[key][0]:
+                    results[key] = sample
+            elif fields[0] == 'BENCH-ERROR':
+                print('%s: %s' % (path, line.strip()), file=sys.stderr)
+            elif fields[0] == 'BENCH-END':
+                backend = None
+    return results, runs
+
+
+def throughput(length, cycles, hclk):
+    """Bytes per second for data operations, operations per second else."""
+    if cycles == 0:
+        return 'n/a'
+    if length == 0:
+        return '%.1f op/s' % (hclk / cycles)
+    return '%.1f kB/s' % (length * hclk / cycles / 1000)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='regression threshold in percent (default 5)')
+    parser.add_argument('baseline')
+    parser.add_argument('candidate')
+    args = parser.parse_args()
+
+    base, base_runs = parse_log(args.baseline)
+    cand, cand_runs = parse_log(args.candidate)
+    if not base:
+        sys.exit('%s: no benchmark results found' % args.baseline)
+
+    for backend in sorted(set(base_runs) | set(cand_runs)):
+        print('%-9s baseline %-12s candidate %s'
+              % (backend,
+                 base_runs.get(backend, ('-',))[0],
+                 cand_runs.get(backend, ('-',))[0]))
+        if (backend in base_runs and backend in cand_runs
+                and base_runs[backend][1] != cand_runs[backend][1]):
+            print('  warning: HCLK differs (%d Hz vs %d Hz)'
+                  % (base_runs[backend][1], cand_runs[backend][1]))
+
+    print('%-9s %-18s %6s %10s %10s %8s  %s'
+          % ('backend', 'operation', 'bytes', 'baseline', 'candidate',
+             'change', 'throughput'))
+    failed = 0
+    for key in sorted(set(base) | set(cand)):
+        backend, op, length = key
+        if key not in cand:
+            print('%-9s %-18s %6d %10d %10s %8s  MISSING'
+                  % (backend, op, length, base[key][0], '-', '-'))
+            failed += 1
+            continue
+        if key not in base:
+            print('%-9s %-18s %6d %10s %10d %8s  new'
+                  % (backend, op, length, '-', cand[key][0], '-'))
+            continue
+        old = base[key][0]
+        new = cand[key][0]
+        change = (new - old) * 100.0 / old if old else 0.0
+        flag = ''
+        if change > args.threshold:
+            flag = '  REGRESSION'
+            failed += 1
+        print('%-9s %-18s %6d %10d %10d %+7.1f%%  %s%s'
+              % (backend, op, length, old, new, change,
+                 throughput(length, new, cand_runs[backend][1]), flag))
+
+    if failed:
+        print('%d result(s) regressed by more than %.1f %% or are missing'
+              % (failed, args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,209 @@
+/***************************************************************************//**
+ * @file ecdh_pool.c
+ * @brief Pool of ephemeral ECDH key pairs generated in idle time.
+ * See readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "ecdh_pool.h"
+#include "mbedtls/platform_util.h"
+#include <string.h>
+
+// Key pairs are kept in a ring and handed out oldest first. A slot is wiped
+// as soon as its pair is copied out, so every pair is used exactly once.
+// The pool is not reentrant: call all functions from the same (thread)
+// context, typically the main loop.
+static ecdhPoolKey_TypeDef poolKeys[ECDH_POOL_SIZE];
+static uint32_t poolHead;               // Oldest pair
+static uint32_t poolCount;              // Number of pairs in the pool
+static ecdhPoolGenerate_TypeDef poolGenerate;
+static void *poolContext;
+static ecdhPoolStats_TypeDef poolStats;
+
+/***************************************************************************//**
+ * @brief Generate one key pair into the next free slot
+ * @return 0 on success, or the error code of the generate function
+ ******************************************************************************/
+static int generateOne(void)
+{
+  int ret;
+  ecdhPoolKey_TypeDef *slot;
+
+  slot = &poolKeys[(poolHead + poolCount) % ECDH_POOL_SIZE];
+  ret = poolGenerate(slot, poolContext);
+  if (ret != 0) {
+    // Do not leave a partial key behind
+    mbedtls_platform_zeroize(slot, sizeof(*slot));
+    return ret;
+  }
+  poolCount++;
+  poolStats.generated++;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Initialize an empty pool
+ * @param generate Function generating one key pair
+ * @param *context Passed to the generate function
+ ******************************************************************************/
+void ecdhPoolInit(ecdhPoolGenerate_TypeDef generate, void *context)
+{
+  ecdhPoolWipe();
+  poolGenerate = generate;
+  poolContext = context;
+  memset(&poolStats, 0, sizeof(poolStats));
+}
+
+/***************************************************************************//**
+ * @brief Refill the pool before the application goes to sleep
+ * @param nextMode Energy mode the application is about to enter
+ * @return Number of key pairs generated, or a negative error code
+ *
+ * Generating a pair costs one scalar multiplication, so the policy follows
+ * the cost of waking up again:
+ * - EM1: the core wakes up often and cheaply, generate at most one pair per
+ *   call so no single idle period is stretched by more than one pair.
+ * - EM2/EM3: each wakeup restarts the high frequency clocks, so nothing is
+ *   done until the pool is down to ECDH_POOL_LOW_WATERMARK pairs, and then it
+ *   is refilled completely in one go.
+ * - EM4: RAM is not retained, the pool is wiped and not refilled.
+ ******************************************************************************/
+int ecdhPoolIdle(ecdhPoolEnergyMode_TypeDef nextMode)
+{
+  int ret;
+  uint32_t target;
+  uint32_t generated = 0;
+
+  if (poolGenerate == NULL) {
+    return ECDH_POOL_ERR_BAD_INPUT_DATA;
+  }
+
+  switch (nextMode) {
+    case ECDH_POOL_EM1:
+      target = poolCount + 1;
+      break;
+
+    case ECDH_POOL_EM2:
+    case ECDH_POOL_EM3:
+      target = (poolCount <= ECDH_POOL_LOW_WATERMARK) ? ECDH_POOL_SIZE : 0;
+      break;
+
+    case ECDH_POOL_EM4:
+      ecdhPoolWipe();
+      return 0;
+
+    default:
+      return ECDH_POOL_ERR_BAD_INPUT_DATA;
+  }
+  if (target > ECDH_POOL_SIZE) {
+    target = ECDH_POOL_SIZE;
+  }
+
+  while (poolCount < target) {
+    ret = generateOne();
+    if (ret != 0) {
+      return ret;
+    }
+    generated++;
+  }
+  return (int)generated;
+}
+
+/***************************************************************************//**
+ * @brief Take an ephemeral key pair, generating one in line if the pool is
+ *   empty
+ * @param *key Pointer to the key pair. The caller must wipe it with
+ *   mbedtls_platform_zeroize() once the shared secret is computed.
+ * @return 0 on success, or a negative error code
+ ******************************************************************************/
+int ecdhPoolTake(ecdhPoolKey_TypeDef *key)
+{
+  int ret;
+  ecdhPoolKey_TypeDef *slot;
+
+  if ((poolGenerate == NULL) || (key == NULL)) {
+    return ECDH_POOL_ERR_BAD_INPUT_DATA;
+  }
+
+  if (poolCount == 0) {
+    // Pool miss, the scalar multiplication is back on the critical path
+    ret = poolGenerate(key, poolContext);
+    if (ret != 0) {
+      mbedtls_platform_zeroize(key, sizeof(*key));
+      return ret;
+    }
+    poolStats.generated++;
+    poolStats.misses++;
+    return 0;
+  }
+
+  slot = &poolKeys[poolHead];
+  memcpy(key, slot, sizeof(*key));
+  mbedtls_platform_zeroize(slot, sizeof(*slot));
+  poolHead = (poolHead + 1) % ECDH_POOL_SIZE;
+  poolCount--;
+  poolStats.hits++;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Number of key pairs ready in the pool
+ ******************************************************************************/
+uint32_t ecdhPoolCount(void)
+{
+  return poolCount;
+}
+
+/***************************************************************************//**
+ * @brief Wipe all key pairs in the pool
+ ******************************************************************************/
+void ecdhPoolWipe(void)
+{
+  mbedtls_platform_zeroize(poolKeys, sizeof(poolKeys));
+  poolHead = 0;
+  poolCount = 0;
+}
+
+/***************************************************************************//**
+ * @brief Get the usage counters of the pool
+ * @param *stats Pointer to the counters
+ ******************************************************************************/
+void ecdhPoolStatsGet(ecdhPoolStats_TypeDef *stats)
+{
+  *stats = poolStats;
+}
@@ -0,0 +1,98 @@
+/***************************************************************************//**
+ * @file ecdh_pool.h
+ * @brief Pool of ephemeral ECDH key pairs generated in idle time.
+ * See readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef ECDH_POOL_H
+#define ECDH_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of key pairs held by the pool
+#define ECDH_POOL_SIZE                  (4)
+
+// Before deep sleep (EM2/EM3) the pool is refilled only when it holds this
+// many key pairs or fewer, so that one wakeup generates several pairs
+#define ECDH_POOL_LOW_WATERMARK         (1)
+
+// Size of the private key and of each public key coordinate (P-256)
+#define ECDH_POOL_KEY_SIZE              (32)
+
+// Returned if the pool has not been initialized
+#define ECDH_POOL_ERR_BAD_INPUT_DATA    (-0x5D80)
+
+// Ephemeral key pair, private key d and public key Q = (X, Y)
+typedef struct {
+  uint8_t d[ECDH_POOL_KEY_SIZE];
+  uint8_t x[ECDH_POOL_KEY_SIZE];
+  uint8_t y[ECDH_POOL_KEY_SIZE];
+} ecdhPoolKey_TypeDef;
+
+// Energy mode the application is about to enter, selects the refill policy
+typedef enum {
+  ECDH_POOL_EM1 = 1,            // Short sleep: generate at most one pair
+  ECDH_POOL_EM2 = 2,            // Deep sleep: refill in one batch if low
+  ECDH_POOL_EM3 = 3,            // Deep sleep: refill in one batch if low
+  ECDH_POOL_EM4 = 4             // RAM is lost: wipe the pool, no refill
+} ecdhPoolEnergyMode_TypeDef;
+
+// Usage counters
+typedef struct {
+  uint32_t generated;           // Pairs generated, in idle time or in line
+  uint32_t hits;                // Pairs taken from the pool
+  uint32_t misses;              // Pairs generated in line, pool was empty
+} ecdhPoolStats_TypeDef;
+
+// Generates one key pair, returns 0 on success or an mbed TLS error code
+typedef int (*ecdhPoolGenerate_TypeDef)(ecdhPoolKey_TypeDef *key,
+                                        void *context);
+
+void ecdhPoolInit(ecdhPoolGenerate_TypeDef generate, void *context);
+int ecdhPoolIdle(ecdhPoolEnergyMode_TypeDef nextMode);
+int ecdhPoolTake(ecdhPoolKey_TypeDef *key);
+uint32_t ecdhPoolCount(void);
+void ecdhPoolWipe(void);
+void ecdhPoolStatsGet(ecdhPoolStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ECDH_POOL_H
@@ -47,9 +47,11 @@
 #include "em_device.h"
 #include "em_emu.h"
 #include "retargetserial.h"
+#include "ecdh_pool.h"
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/ecdh.h"
 #include "mbedtls/entropy.h"
+#include "mbedtls/platform_util.h"
 #include "mbedtls/timing.h"
 #include <inttypes.h>
 #include <stdio.h>
@@ -83,6 +85,7 @@ static void clearEcdhContext(void)
   mbedtls_ctr_drbg_free(&ctrDrbg);
   mbedtls_ecdh_free(&clientCtx);
   mbedtls_ecdh_free(&serverCtx);
+  ecdhPoolWipe();
 }
 
 /***************************************************************************//**
@@ -120,10 +123,138 @@ static bool seedRandomNumber(void)
   return true;
 }
 
+/***************************************************************************//**
+ * @brief Generate one ephemeral key pair for the key pool
+ * @param key Pointer to the key pair buffer
+ * @param context Pointer to the CTR_DRBG context
+ * @return 0 if successful, or an mbed TLS error code
+ ******************************************************************************/
+static int generatePoolKey(ecdhPoolKey_TypeDef *key, void *context)
+{
+  int ret;                      // Return code
+  mbedtls_ecp_group grp;        // Curve
+  mbedtls_mpi d;                // Private key
+  mbedtls_ecp_point Q;          // Public key
+
+  mbedtls_ecp_group_init(&grp);
+  mbedtls_mpi_init(&d);
+  mbedtls_ecp_point_init(&Q);
+
+  ret = mbedtls_ecp_group_load(&grp, MBEDTLS_ECC_ID);
+  if (ret == 0) {
+    ret = mbedtls_ecdh_gen_public(&grp, &d, &Q,
+                                  mbedtls_ctr_drbg_random, context);
+  }
+  if (ret == 0) {
+    ret = mbedtls_mpi_write_binary(&d, key->d, KEY_SIZE);
+  }
+  if (ret == 0) {
+    ret = mbedtls_mpi_write_binary(&Q.X, key->x, KEY_SIZE);
+  }
+  if (ret == 0) {
+    ret = mbedtls_mpi_write_binary(&Q.Y, key->y, KEY_SIZE);
+  }
+
+  // mbedtls_mpi_free() wipes the private key
+  mbedtls_ecp_group_free(&grp);
+  mbedtls_mpi_free(&d);
+  mbedtls_ecp_point_free(&Q);
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Refill the ephemeral key pool, as done before entering EM2
+ * @return true if successful and false otherwise.
+ ******************************************************************************/
+static bool fillKeyPool(void)
+{
+  int ret;                      // Return code
+  uint32_t cycles;              // Cycle counter
+
+  mbedtls_printf("  . Pre-generating ephemeral keys in idle time...");
+
+  DWT->CYCCNT = 0;
+  ret = ecdhPoolIdle(ECDH_POOL_EM2);
+  cycles = DWT->CYCCNT;
+
+  if (ret < 0) {
+    mbedtls_printf(" failed\n  ! ecdhPoolIdle returned %d\n", ret);
+    return false;
+  }
+
+  mbedtls_printf(" ok  (generated: %d, in pool: %" PRIu32 ", cycles: %" PRIu32
+                 " time: %" PRIu32 " ms)\n",
+                 ret,
+                 ecdhPoolCount(),
+                 cycles,
+                 cycles / (CMU_ClockFreqGet(cmuClock_HCLK) / 1000));
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief Setup ECDH for the client with a key pair from the key pool
+ * @param peerCtx Pointer to ECDH context
+ * @param ecpPointX Pointer to ECP point X buffer
+ * @param ecpPointY Pointer to ECP point Y buffer
+ * @return true if successful and false otherwise.
+ ******************************************************************************/
+static bool setupEcdhPeerFromPool(mbedtls_ecdh_context *peerCtx,
+                                  unsigned char *ecpPointX,
+                                  unsigned char *ecpPointY)
+{
+  int ret;                      // Return code
+  uint32_t cycles;              // Cycle counter
+  ecdhPoolKey_TypeDef key;      // Ephemeral key pair
+
+  mbedtls_printf("  . Setting up client context from the key pool...");
+
+  // Initialize the ECDH context
+  mbedtls_ecdh_init(peerCtx);
+
+  // Take a pre-generated key pair instead of calling mbedtls_ecdh_gen_public
+  DWT->CYCCNT = 0;
+  ret = mbedtls_ecp_group_load(&peerCtx->grp, MBEDTLS_ECC_ID);
+  if (ret == 0) {
+    ret = ecdhPoolTake(&key);
+  }
+  if (ret == 0) {
+    ret = mbedtls_mpi_read_binary(&peerCtx->d, key.d, KEY_SIZE);
+  }
+  if (ret == 0) {
+    ret = mbedtls_mpi_read_binary(&peerCtx->Q.X, key.x, KEY_SIZE);
+  }
+  if (ret == 0) {
+    ret = mbedtls_mpi_read_binary(&peerCtx->Q.Y, key.y, KEY_SIZE);
+  }
+  if (ret == 0) {
+    ret = mbedtls_mpi_lset(&peerCtx->Q.Z, 1);
+  }
+  cycles = DWT->CYCCNT;
+
+  if (ret == 0) {
+    memcpy(ecpPointX, key.x, KEY_SIZE);
+    memcpy(ecpPointY, key.y, KEY_SIZE);
+  }
+  // The pool copy is already wiped, wipe this one too
+  mbedtls_platform_zeroize(&key, sizeof(key));
+
+  if (ret != 0) {
+    mbedtls_printf(" failed\n  ! setup from key pool returned %d\n", ret);
+    return false;
+  }
+
+  mbedtls_printf(" ok  (key size: %d bits, cycles: %" PRIu32 " time: %"
+                 PRIu32 " ms)\n",
+                 (int)peerCtx->grp.pbits,
+                 cycles,
+                 cycles / (CMU_ClockFreqGet(cmuClock_HCLK) / 1000));
+  return true;
+}
+
 /***************************************************************************//**
  * @brief Setup ECDH for client and server
  * @param mode True for client, false for server
- * @param peerCtr Pointer to ECDH context
+ * @param peerCtx Pointer to ECDH context
  * @param ecpPointX Pointer to ECP point X buffer
  * @param ecpPointY Pointer to ECP point Y buffer
  * @return true if successful and false otherwise.
@@ -179,7 +310,7 @@ static bool setupEcdhPeer(bool mode,
     return false;
   }
 
-  mbedtls_printf(" ok  (key size: %" PRIu16 " bits, cycles: %" PRIu32 " time: %"
+  mbedtls_printf(" ok  (key size: %d bits, cycles: %" PRIu32 " time: %"
                  PRIu32 " ms)\n",
                  (int)peerCtx->grp.pbits,
                  cycles,
@@ -190,7 +321,7 @@ static bool setupEcdhPeer(bool mode,
 /***************************************************************************//**
  * @brief Use peer's key to generate shared secret
  * @param mode True to use client key, false to use server key
- * @param peerCtr Pointer to ECDH context
+ * @param peerCtx Pointer to ECDH context
  * @param ecpPointX Pointer to ECP point X buffer
  * @param ecpPointY Pointer to ECP point Y buffer
  * @return true if successful and false otherwise.
@@ -324,8 +455,16 @@ int main(void)
     goto cleanup;
   }
 
-  // Setup ECDH client
-  if (!setupEcdhPeer(CLIENT, &clientCtx, clientXtoServer, clientYtoServer)) {
+  // Fill the ephemeral key pool, the application would do this before it
+  // goes to sleep
+  ecdhPoolInit(generatePoolKey, &ctrDrbg);
+  if (!fillKeyPool()) {
+    goto cleanup;
+  }
+
+  // Setup ECDH client from the key pool, the handshake only has to compute
+  // the shared secret
+  if (!setupEcdhPeerFromPool(&clientCtx, clientXtoServer, clientYtoServer)) {
     goto cleanup;
   }
 
@@ -347,7 +486,12 @@ int main(void)
   }
 
   // Verify shared secret
-  verifyPeerSecret();
+  if (!verifyPeerSecret()) {
+    goto cleanup;
+  }
+
+  // Idle again, the EM2 policy only refills once the pool is running low
+  fillKeyPool();
 
   // Clean up before exit
   cleanup:
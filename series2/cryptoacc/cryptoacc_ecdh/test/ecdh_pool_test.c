@@ -0,0 +1,214 @@
+/***************************************************************************//**
+ * @file ecdh_pool_test.c
+ * @brief Host test of the refill policy and key handling of ecdh_pool.c
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, with the mbed TLS of the
+// Gecko SDK built for the host (make -C <mbedtls> lib):
+//
+//   gcc -Wall -Wextra -Isrc -I<mbedtls>/include test/ecdh_pool_test.c
+//       -L<mbedtls>/library -lmbedcrypto -o ecdh_pool_test
+//   ./ecdh_pool_test
+//
+// ecdh_pool.c is included rather than linked, so the test can check that
+// the slots of the ring are wiped. Key pairs come from a fake generator that
+// numbers them, so the test can check that each pair is handed out once.
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "ecdh_pool.c"
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define MAX_KEYS                        (100)
+#define GENERATOR_ERROR                 (-0x4F80)
+
+static int checks;
+static int failures;
+
+// Fake generator state
+static uint32_t generatorSerial;
+static int generatorFailures;
+
+// Number of times each key pair was handed out
+static int keyUses[MAX_KEYS];
+
+/***************************************************************************//**
+ * @brief Fake key pair generator. Writes the serial number of the pair into
+ *   d and x. When told to fail, it leaves a partly written pair behind.
+ ******************************************************************************/
+static int fakeGenerate(ecdhPoolKey_TypeDef *key, void *context)
+{
+  (void)context;
+  memset(key, 0xAA, sizeof(*key));
+  if (generatorFailures > 0) {
+    generatorFailures--;
+    return GENERATOR_ERROR;
+  }
+  generatorSerial++;
+  memcpy(key->d, &generatorSerial, sizeof(generatorSerial));
+  memcpy(key->x, &generatorSerial, sizeof(generatorSerial));
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Serial number of a key pair from fakeGenerate()
+ ******************************************************************************/
+static uint32_t keySerial(const ecdhPoolKey_TypeDef *key)
+{
+  uint32_t serial;
+
+  memcpy(&serial, key->d, sizeof(serial));
+  return serial;
+}
+
+/***************************************************************************//**
+ * @brief Check that a buffer only holds zeros
+ ******************************************************************************/
+static bool isWiped(const void *buffer, size_t length)
+{
+  const uint8_t *p = buffer;
+
+  while (length--) {
+    if (*p++ != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief Take a key pair and record its use
+ ******************************************************************************/
+static int takeKey(ecdhPoolKey_TypeDef *key)
+{
+  int ret = ecdhPoolTake(key);
+
+  if ((ret == 0) && (keySerial(key) < MAX_KEYS)) {
+    keyUses[keySerial(key)]++;
+  }
+  return ret;
+}
+
+int main(void)
+{
+  ecdhPoolKey_TypeDef key;
+  ecdhPoolStats_TypeDef stats;
+  uint32_t i;
+  int round;
+
+  // Not initialized
+  CHECK(ecdhPoolIdle(ECDH_POOL_EM1) == ECDH_POOL_ERR_BAD_INPUT_DATA);
+  CHECK(ecdhPoolTake(&key) == ECDH_POOL_ERR_BAD_INPUT_DATA);
+
+  ecdhPoolInit(fakeGenerate, NULL);
+
+  // EM1 generates one pair per call until the pool is full
+  for (i = 1; i <= ECDH_POOL_SIZE + 2; i++) {
+    CHECK(ecdhPoolIdle(ECDH_POOL_EM1) == ((i <= ECDH_POOL_SIZE) ? 1 : 0));
+  }
+  CHECK(ecdhPoolCount() == ECDH_POOL_SIZE);
+  CHECK(ecdhPoolIdle(ECDH_POOL_EM2) == 0);
+
+  // Pairs are handed out oldest first, and the slot is wiped at once
+  CHECK(takeKey(&key) == 0);
+  CHECK(keySerial(&key) == 1);
+  CHECK(isWiped(&poolKeys[0], sizeof(poolKeys[0])));
+  CHECK(takeKey(&key) == 0);
+  CHECK(keySerial(&key) == 2);
+
+  // Above the low watermark, deep sleep does not refill
+  CHECK(ecdhPoolIdle(ECDH_POOL_EM3) == 0);
+  CHECK(ecdhPoolCount() == ECDH_POOL_SIZE - 2);
+  while (ecdhPoolCount() > ECDH_POOL_LOW_WATERMARK) {
+    CHECK(takeKey(&key) == 0);
+  }
+
+  // At the low watermark, deep sleep refills in one batch
+  CHECK(ecdhPoolIdle(ECDH_POOL_EM2) == ECDH_POOL_SIZE - ECDH_POOL_LOW_WATERMARK);
+  CHECK(ecdhPoolCount() == ECDH_POOL_SIZE);
+
+  // Drain the pool, then a miss generates a pair in line
+  for (i = 0; i < ECDH_POOL_SIZE; i++) {
+    CHECK(takeKey(&key) == 0);
+  }
+  CHECK(isWiped(poolKeys, sizeof(poolKeys)));
+  CHECK(takeKey(&key) == 0);
+  ecdhPoolStatsGet(&stats);
+  CHECK(stats.misses == 1);
+  CHECK(stats.hits == 2 * ECDH_POOL_SIZE - 1);
+  CHECK(stats.generated == generatorSerial);
+
+  // A failing generator leaves no partial pair in the pool or the output
+  generatorFailures = 1;
+  CHECK(ecdhPoolIdle(ECDH_POOL_EM2) == GENERATOR_ERROR);
+  CHECK(ecdhPoolCount() == 0);
+  CHECK(isWiped(poolKeys, sizeof(poolKeys)));
+  generatorFailures = 1;
+  CHECK(ecdhPoolTake(&key) == GENERATOR_ERROR);
+  CHECK(isWiped(&key, sizeof(key)));
+
+  // Mixed refills and takes across many wrap-arounds of the ring
+  for (round = 0; round < 40; round++) {
+    ecdhPoolIdle((round % 2) ? ECDH_POOL_EM1 : ECDH_POOL_EM2);
+    for (i = 0; i < (uint32_t)(round % 3) + 1; i++) {
+      CHECK(takeKey(&key) == 0);
+    }
+  }
+
+  // EM4 wipes the pool
+  ecdhPoolIdle(ECDH_POOL_EM1);
+  CHECK(ecdhPoolCount() > 0);
+  CHECK(ecdhPoolIdle(ECDH_POOL_EM4) == 0);
+  CHECK(ecdhPoolCount() == 0);
+  CHECK(isWiped(poolKeys, sizeof(poolKeys)));
+  CHECK(ecdhPoolIdle((ecdhPoolEnergyMode_TypeDef)0)
+        == ECDH_POOL_ERR_BAD_INPUT_DATA);
+
+  // No pair was handed out twice
+  CHECK(generatorSerial < MAX_KEYS);
+  for (i = 1; i <= generatorSerial; i++) {
+    CHECK(keyUses[i] <= 1);
+  }
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
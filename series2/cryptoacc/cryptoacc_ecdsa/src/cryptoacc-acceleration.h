@@ -301,7 +301,16 @@
    4 = Optimize speed at the expense of RAM
  */
 #define MBEDTLS_ECP_WINDOW_SIZE        3
+
+/* Keep the point multiplication table of the generator in RAM after its
+   first use. Only done when ECDSA verification runs in software, where
+   ecdsa_keyring.c relies on it to also keep the tables of the trusted public
+   keys. With hardware ECDSA the table would only cost RAM. */
+#if defined(MBEDTLS_ECDSA_VERIFY_ALT)
 #define MBEDTLS_ECP_FIXED_POINT_OPTIM  0
+#else
+#define MBEDTLS_ECP_FIXED_POINT_OPTIM  1
+#endif
 
 /* Significant speed benefit at the expense of some ROM */
 #define MBEDTLS_ECP_NIST_OPTIM
@@ -0,0 +1,60 @@
+/***************************************************************************//**
+ * @file ecdsa_det.h
+ * @brief Deterministic ECDSA signing (RFC 6979) with a hardware scalar
+ * multiplication
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef ECDSA_DET_H
+#define ECDSA_DET_H
+
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/md.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int ecdsaDetSign(mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
+                 const mbedtls_mpi *d, const unsigned char *hash,
+                 size_t hashLen, mbedtls_md_type_t mdAlg);
+int ecdsaDetWriteSignature(mbedtls_ecdsa_context *ctx,
+                           mbedtls_md_type_t mdAlg,
+                           const unsigned char *hash, size_t hashLen,
+                           unsigned char *sig, size_t *sigLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ECDSA_DET_H
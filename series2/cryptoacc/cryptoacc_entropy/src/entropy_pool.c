@@ -0,0 +1,435 @@
+/***************************************************************************//**
+ * @file entropy_pool.c
+ * @brief Buffered TRNG entropy pool with health tests and CTR-DRBG
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "entropy_pool.h"
+#include "em_device.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/platform_util.h"
+#include "mbedtls/sha256.h"
+#include <stdbool.h>
+#include <string.h>
+
+// Size of a SHA-256 digest, the unit in which seed material is produced
+#define SEED_BLOCK_SIZE         (32)
+
+// Raw TRNG bytes are health tested as they are read and kept in a ring until
+// the DRBG asks for seed material. entropyPoolRefill() tops the ring up and
+// is meant to be called from the idle loop, so that a reseed normally finds
+// the bytes it needs already in RAM. The service is not reentrant: call all
+// functions from the same (thread) context, typically the main loop.
+static uint8_t poolData[ENTROPY_POOL_SIZE];
+static uint32_t poolHead;               // Oldest byte
+static uint32_t poolCount;              // Number of bytes in the pool
+static entropyPoolSource_TypeDef poolSource;
+static void *poolContext;
+static bool poolSeeded;
+static mbedtls_ctr_drbg_context ctrDrbg;
+static entropyPoolStats_TypeDef poolStats;
+
+// Health test state (NIST SP 800-90B, section 4.4)
+static uint8_t rctLast;                 // Last sample
+static uint32_t rctRun;                 // Number of identical samples in a row
+static uint8_t aptFirst;                // First sample of the current window
+static uint32_t aptMatches;             // Samples equal to aptFirst
+static uint32_t aptIndex;               // Position in the current window
+
+/***************************************************************************//**
+ * @brief Latch a health failure and drop everything read so far
+ * @param health Cause of the failure
+ ******************************************************************************/
+static void healthFail(entropyPoolHealth_TypeDef health)
+{
+  if (poolStats.health == ENTROPY_POOL_HEALTH_OK) {
+    poolStats.health = health;
+  }
+  mbedtls_platform_zeroize(poolData, sizeof(poolData));
+  poolHead = 0;
+  poolCount = 0;
+}
+
+/***************************************************************************//**
+ * @brief Run the Repetition Count and Adaptive Proportion Tests on one sample
+ * @param sample Raw TRNG byte
+ * @return true if both tests passed
+ ******************************************************************************/
+static bool healthTest(uint8_t sample)
+{
+  bool pass = true;
+
+  if (rctRun != 0 && sample == rctLast) {
+    if (++rctRun >= ENTROPY_POOL_RCT_CUTOFF) {
+      poolStats.rctFailures++;
+      healthFail(ENTROPY_POOL_HEALTH_RCT_FAIL);
+      pass = false;
+    }
+  } else {
+    rctLast = sample;
+    rctRun = 1;
+  }
+
+  if (aptIndex == 0) {
+    aptFirst = sample;
+    aptMatches = 1;
+  } else if (sample == aptFirst) {
+    if (++aptMatches >= ENTROPY_POOL_APT_CUTOFF) {
+      poolStats.aptFailures++;
+      healthFail(ENTROPY_POOL_HEALTH_APT_FAIL);
+      pass = false;
+    }
+  }
+  if (++aptIndex == ENTROPY_POOL_APT_WINDOW) {
+    aptIndex = 0;
+  }
+  return pass;
+}
+
+/***************************************************************************//**
+ * @brief Read and health test raw bytes from the TRNG
+ * @param output Buffer for the raw bytes
+ * @param length Number of bytes to read
+ * @return 0 on success, ENTROPY_POOL_ERR_HEALTH if the source failed
+ ******************************************************************************/
+static int readSource(uint8_t *output, size_t length)
+{
+  int ret;
+  size_t i;
+  size_t got;
+  uint32_t start;
+
+  if (poolStats.health != ENTROPY_POOL_HEALTH_OK) {
+    return ENTROPY_POOL_ERR_HEALTH;
+  }
+
+  while (length > 0) {
+    got = 0;
+    start = DWT->CYCCNT;
+    ret = poolSource(poolContext, output, length, &got);
+    poolStats.trngCycles += DWT->CYCCNT - start;
+    if (ret != 0 || got == 0 || got > length) {
+      healthFail(ENTROPY_POOL_HEALTH_SOURCE_FAIL);
+      return ENTROPY_POOL_ERR_HEALTH;
+    }
+    poolStats.trngBytes += got;
+
+    for (i = 0; i < got; i++) {
+      if (!healthTest(output[i])) {
+        return ENTROPY_POOL_ERR_HEALTH;
+      }
+    }
+    output += got;
+    length -= got;
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Move bytes out of the pool, wiping them behind
+ * @param output Buffer for the bytes
+ * @param length Number of bytes wanted
+ * @return Number of bytes copied, may be less than length
+ ******************************************************************************/
+static size_t poolTake(uint8_t *output, size_t length)
+{
+  size_t n;
+  size_t taken = 0;
+
+  while (length > 0 && poolCount > 0) {
+    n = ENTROPY_POOL_SIZE - poolHead;   // Contiguous bytes up to the wrap
+    if (n > poolCount) {
+      n = poolCount;
+    }
+    if (n > length) {
+      n = length;
+    }
+    memcpy(output, &poolData[poolHead], n);
+    mbedtls_platform_zeroize(&poolData[poolHead], n);
+    poolHead = (poolHead + n) % ENTROPY_POOL_SIZE;
+    poolCount -= n;
+    output += n;
+    length -= n;
+    taken += n;
+  }
+  return taken;
+}
+
+/***************************************************************************//**
+ * @brief Seed material callback for the DRBG (mbedtls f_entropy)
+ * @details Each 32-byte block of output is the SHA-256 of
+ *          ENTROPY_POOL_OVERSAMPLE * 32 raw bytes. They are taken from the
+ *          pool first and read from the TRNG in line if the pool runs dry.
+ * @param context Unused
+ * @param output Buffer for the seed material
+ * @param length Number of bytes wanted
+ * @return 0 on success, ENTROPY_POOL_ERR_HEALTH if the source failed
+ ******************************************************************************/
+static int entropyPoolFunc(void *context, unsigned char *output, size_t length)
+{
+  int ret = 0;
+  size_t n;
+  size_t have;
+  bool stalled = false;
+  uint8_t raw[SEED_BLOCK_SIZE * ENTROPY_POOL_OVERSAMPLE];
+  uint8_t digest[SEED_BLOCK_SIZE];
+
+  (void) context;
+  poolStats.reseeds++;
+
+  while (length > 0) {
+    have = poolTake(raw, sizeof(raw));
+    if (have < sizeof(raw)) {
+      stalled = true;
+      if ((ret = readSource(&raw[have], sizeof(raw) - have)) != 0) {
+        break;
+      }
+    }
+    if ((ret = mbedtls_sha256_ret(raw, sizeof(raw), digest, 0)) != 0) {
+      break;
+    }
+
+    n = (length < SEED_BLOCK_SIZE) ? length : SEED_BLOCK_SIZE;
+    memcpy(output, digest, n);
+    output += n;
+    length -= n;
+  }
+
+  if (stalled) {
+    poolStats.stalls++;
+  }
+  mbedtls_platform_zeroize(raw, sizeof(raw));
+  mbedtls_platform_zeroize(digest, sizeof(digest));
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Start the entropy service
+ * @details Runs the start-up health tests, fills the pool and seeds the DRBG.
+ *          Also clears a latched health failure.
+ * @param source Noise source, typically mbedtls_hardware_poll
+ * @param context Passed to the source on each call
+ * @return 0 on success, ENTROPY_POOL_ERR_HEALTH if the source failed, or an
+ *         mbed TLS error code
+ ******************************************************************************/
+int entropyPoolInit(entropyPoolSource_TypeDef source, void *context)
+{
+  int ret;
+  uint32_t i;
+  uint8_t discard[ENTROPY_POOL_REFILL_CHUNK];
+  static const unsigned char personalization[] = "entropy_pool";
+
+  if (source == NULL) {
+    return ENTROPY_POOL_ERR_BAD_INPUT_DATA;
+  }
+
+  entropyPoolFree();
+  poolSource = source;
+  poolContext = context;
+
+  // Start-up tests: the first samples only go through the health tests
+  for (i = 0; i < ENTROPY_POOL_STARTUP_SAMPLES; i += sizeof(discard)) {
+    if ((ret = readSource(discard, sizeof(discard))) != 0) {
+      mbedtls_platform_zeroize(discard, sizeof(discard));
+      return ret;
+    }
+  }
+  mbedtls_platform_zeroize(discard, sizeof(discard));
+
+  while ((ret = entropyPoolRefill()) > 0) {
+  }
+  if (ret != 0) {
+    return ret;
+  }
+
+  mbedtls_ctr_drbg_init(&ctrDrbg);
+  if ((ret = mbedtls_ctr_drbg_seed(&ctrDrbg, entropyPoolFunc, NULL,
+                                   personalization,
+                                   sizeof(personalization) - 1)) != 0) {
+    mbedtls_ctr_drbg_free(&ctrDrbg);
+    return (poolStats.health != ENTROPY_POOL_HEALTH_OK)
+           ? ENTROPY_POOL_ERR_HEALTH : ret;
+  }
+  mbedtls_ctr_drbg_set_reseed_interval(&ctrDrbg, ENTROPY_POOL_RESEED_INTERVAL);
+  poolSeeded = true;
+
+  // Replace what the initial seed consumed
+  while ((ret = entropyPoolRefill()) > 0) {
+  }
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Top up the pool with at most ENTROPY_POOL_REFILL_CHUNK bytes
+ * @details Call from the idle loop, before entering EM1, until it returns 0.
+ * @return Number of bytes added, 0 if the pool is full, or a negative error
+ *         code
+ ******************************************************************************/
+int entropyPoolRefill(void)
+{
+  int ret;
+  size_t n;
+  size_t tail;
+  uint8_t chunk[ENTROPY_POOL_REFILL_CHUNK];
+
+  if (poolSource == NULL) {
+    return ENTROPY_POOL_ERR_BAD_INPUT_DATA;
+  }
+  if (poolStats.health != ENTROPY_POOL_HEALTH_OK) {
+    return ENTROPY_POOL_ERR_HEALTH;
+  }
+
+  n = ENTROPY_POOL_SIZE - poolCount;
+  if (n > sizeof(chunk)) {
+    n = sizeof(chunk);
+  }
+  if (n == 0) {
+    return 0;
+  }
+
+  if ((ret = readSource(chunk, n)) == 0) {
+    // Append at the tail, in two pieces if the ring wraps
+    tail = (poolHead + poolCount) % ENTROPY_POOL_SIZE;
+    if (tail + n <= ENTROPY_POOL_SIZE) {
+      memcpy(&poolData[tail], chunk, n);
+    } else {
+      memcpy(&poolData[tail], chunk, ENTROPY_POOL_SIZE - tail);
+      memcpy(poolData, &chunk[ENTROPY_POOL_SIZE - tail],
+             n - (ENTROPY_POOL_SIZE - tail));
+    }
+    poolCount += n;
+    ret = (int) n;
+  }
+  mbedtls_platform_zeroize(chunk, sizeof(chunk));
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Get random bytes from the DRBG (mbedtls f_rng)
+ * @details Does not touch the TRNG unless a reseed is due and the pool is
+ *          short of seed material.
+ * @param rng Unused, so that the function can be passed as f_rng with NULL
+ * @param output Buffer for the random bytes
+ * @param length Number of bytes wanted
+ * @return 0 on success, ENTROPY_POOL_ERR_HEALTH if a health test has failed,
+ *         or an mbed TLS error code
+ ******************************************************************************/
+int entropyGetRandom(void *rng, unsigned char *output, size_t length)
+{
+  int ret = 0;
+  size_t n;
+  size_t done = 0;
+  uint32_t cycles;
+
+  (void) rng;
+  if (!poolSeeded || (output == NULL && length > 0)) {
+    return ENTROPY_POOL_ERR_BAD_INPUT_DATA;
+  }
+  if (poolStats.health != ENTROPY_POOL_HEALTH_OK) {
+    return ENTROPY_POOL_ERR_HEALTH;
+  }
+
+  cycles = DWT->CYCCNT;
+  while (done < length) {
+    n = length - done;
+    if (n > MBEDTLS_CTR_DRBG_MAX_REQUEST) {
+      n = MBEDTLS_CTR_DRBG_MAX_REQUEST;
+    }
+    if ((ret = mbedtls_ctr_drbg_random(&ctrDrbg, &output[done], n)) != 0) {
+      break;
+    }
+    done += n;
+  }
+  cycles = DWT->CYCCNT - cycles;
+
+  if (ret != 0) {
+    mbedtls_platform_zeroize(output, length);
+    if (poolStats.health != ENTROPY_POOL_HEALTH_OK) {
+      ret = ENTROPY_POOL_ERR_HEALTH;
+    }
+    return ret;
+  }
+
+  poolStats.requests++;
+  poolStats.randomBytes += length;
+  poolStats.lastCycles = cycles;
+  if (cycles > poolStats.maxCycles) {
+    poolStats.maxCycles = cycles;
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Get the number of raw bytes in the pool
+ * @return Pool level in bytes
+ ******************************************************************************/
+uint32_t entropyPoolLevel(void)
+{
+  return poolCount;
+}
+
+/***************************************************************************//**
+ * @brief Get the throughput, latency and health counters
+ * @param stats Receives a copy of the counters
+ ******************************************************************************/
+void entropyPoolStatsGet(entropyPoolStats_TypeDef *stats)
+{
+  *stats = poolStats;
+}
+
+/***************************************************************************//**
+ * @brief Stop the entropy service and wipe its state
+ ******************************************************************************/
+void entropyPoolFree(void)
+{
+  if (poolSeeded) {
+    mbedtls_ctr_drbg_free(&ctrDrbg);
+    poolSeeded = false;
+  }
+  mbedtls_platform_zeroize(poolData, sizeof(poolData));
+  poolHead = 0;
+  poolCount = 0;
+  poolSource = NULL;
+  poolContext = NULL;
+  memset(&poolStats, 0, sizeof(poolStats));
+  rctLast = 0;
+  rctRun = 0;
+  aptFirst = 0;
+  aptMatches = 0;
+  aptIndex = 0;
+}
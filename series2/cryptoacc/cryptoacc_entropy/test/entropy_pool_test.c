@@ -0,0 +1,290 @@
+/***************************************************************************//**
+ * @file entropy_pool_test.c
+ * @brief Host test of entropy_pool.c with a simulated TRNG: pool accounting,
+ * reseeds from the pool, and the health tests on faulty sources
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, with the mbed TLS of the
+// Gecko SDK built for the host (make -C <mbedtls> lib):
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc -I<mbedtls>/include
+//       test/entropy_pool_test.c -L<mbedtls>/library -lmbedcrypto
+//       -o entropy_pool_test
+//   ./entropy_pool_test
+//
+// entropy_pool.c is included rather than linked, so the test can drain the
+// pool and force DRBG reseeds. The program prints one line per failed check
+// and exits with status 1 if any check failed.
+
+#include "entropy_pool.c"
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+// Cycles charged for each call of the simulated TRNG
+#define TRNG_CALL_CYCLES                (100)
+
+// Behaviour of the simulated TRNG
+typedef enum {
+  TRNG_GOOD,            // Uniform random bytes
+  TRNG_STUCK,           // Always the same byte
+  TRNG_BIASED,          // Every fourth byte is the same, no long runs
+  TRNG_ERROR            // Returns an error
+} trngMode_TypeDef;
+
+DWT_Type hostDwt;
+
+static int checks;
+static int failures;
+
+static trngMode_TypeDef trngMode;
+static size_t trngMaxChunk = 1000;
+static uint32_t trngCalls;
+static uint32_t trngState = 0x12345678;
+
+/***************************************************************************//**
+ * @brief Simulated TRNG with the signature of mbedtls_hardware_poll(). It
+ *   returns at most trngMaxChunk bytes per call.
+ ******************************************************************************/
+static int trngPoll(void *context, unsigned char *output, size_t length,
+                    size_t *outputLength)
+{
+  size_t i;
+
+  (void)context;
+  trngCalls++;
+  hostDwt.CYCCNT += TRNG_CALL_CYCLES;
+  if (trngMode == TRNG_ERROR) {
+    return -1;
+  }
+  if (length > trngMaxChunk) {
+    length = trngMaxChunk;
+  }
+  for (i = 0; i < length; i++) {
+    trngState ^= trngState << 13;
+    trngState ^= trngState >> 17;
+    trngState ^= trngState << 5;
+    if ((trngMode == TRNG_STUCK)
+        || ((trngMode == TRNG_BIASED) && (i % 4 == 0))) {
+      output[i] = 0xA5;
+    } else {
+      output[i] = (unsigned char)trngState;
+    }
+  }
+  *outputLength = length;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Check that a buffer only holds zeros
+ ******************************************************************************/
+static bool isWiped(const void *buffer, size_t length)
+{
+  const uint8_t *p = buffer;
+
+  while (length--) {
+    if (*p++ != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief Refill the pool until it is full or an error occurs
+ ******************************************************************************/
+static int refillAll(void)
+{
+  int ret;
+
+  while ((ret = entropyPoolRefill()) > 0) {
+  }
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Start-up, requests, reseeds from the pool and in-line stalls
+ ******************************************************************************/
+static void testNormalOperation(void)
+{
+  static uint8_t large[3000];
+  entropyPoolStats_TypeDef stats;
+  uint8_t first[32];
+  uint8_t second[32];
+  uint8_t raw[200];
+  uint32_t calls;
+  uint32_t reseeds;
+  uint32_t head;
+  int i;
+
+  // Not initialized
+  CHECK(entropyGetRandom(NULL, first, sizeof(first))
+        == ENTROPY_POOL_ERR_BAD_INPUT_DATA);
+  CHECK(entropyPoolRefill() == ENTROPY_POOL_ERR_BAD_INPUT_DATA);
+  CHECK(entropyPoolInit(NULL, NULL) == ENTROPY_POOL_ERR_BAD_INPUT_DATA);
+
+  // Start-up with a source that returns short reads
+  trngMaxChunk = 7;
+  CHECK(entropyPoolInit(trngPoll, NULL) == 0);
+  trngMaxChunk = 1000;
+  CHECK(entropyPoolLevel() == ENTROPY_POOL_SIZE);
+  entropyPoolStatsGet(&stats);
+  CHECK(stats.health == ENTROPY_POOL_HEALTH_OK);
+  CHECK(stats.reseeds >= 1);
+  CHECK(stats.stalls == 0);
+  CHECK(stats.trngBytes
+        >= ENTROPY_POOL_STARTUP_SAMPLES + ENTROPY_POOL_SIZE + 64);
+  CHECK(stats.trngCycles == TRNG_CALL_CYCLES * trngCalls);
+
+  // Requests are served by the DRBG without touching the TRNG
+  calls = trngCalls;
+  reseeds = stats.reseeds;
+  CHECK(entropyGetRandom(NULL, first, sizeof(first)) == 0);
+  CHECK(entropyGetRandom(NULL, second, sizeof(second)) == 0);
+  CHECK(memcmp(first, second, sizeof(first)) != 0);
+  for (i = 2; i < ENTROPY_POOL_RESEED_INTERVAL; i++) {
+    CHECK(entropyGetRandom(NULL, first, sizeof(first)) == 0);
+  }
+  entropyPoolStatsGet(&stats);
+  CHECK(stats.reseeds == reseeds);
+
+  // The next request reseeds from the pool, still without the TRNG
+  CHECK(entropyGetRandom(NULL, first, sizeof(first)) == 0);
+  entropyPoolStatsGet(&stats);
+  CHECK(stats.reseeds == reseeds + 1);
+  CHECK(trngCalls == calls);
+  CHECK(entropyPoolLevel() < ENTROPY_POOL_SIZE);
+  CHECK((ENTROPY_POOL_SIZE - entropyPoolLevel())
+        % (SEED_BLOCK_SIZE * ENTROPY_POOL_OVERSAMPLE) == 0);
+  CHECK(refillAll() == 0);
+  CHECK(entropyPoolLevel() == ENTROPY_POOL_SIZE);
+  CHECK(entropyPoolRefill() == 0);
+
+  // Requests larger than MBEDTLS_CTR_DRBG_MAX_REQUEST are split
+  CHECK(entropyGetRandom(NULL, large, sizeof(large)) == 0);
+  entropyPoolStatsGet(&stats);
+  CHECK(stats.requests == ENTROPY_POOL_RESEED_INTERVAL + 2);
+  CHECK(stats.randomBytes
+        == 32 * (ENTROPY_POOL_RESEED_INTERVAL + 1) + sizeof(large));
+  CHECK(stats.maxCycles >= stats.lastCycles);
+
+  // A reseed with an empty pool reads the TRNG in line
+  poolTake(raw, sizeof(raw));
+  poolTake(raw, sizeof(raw));
+  CHECK(entropyPoolLevel() == 0);
+  CHECK(mbedtls_ctr_drbg_reseed(&ctrDrbg, NULL, 0) == 0);
+  entropyPoolStatsGet(&stats);
+  CHECK(stats.stalls == 1);
+  CHECK(entropyPoolLevel() == 0);
+
+  // Refills across the end of the ring keep the order
+  CHECK(refillAll() == 0);
+  head = poolHead;
+  CHECK(poolTake(raw, sizeof(raw)) == sizeof(raw));
+  CHECK(entropyPoolLevel() == ENTROPY_POOL_SIZE - sizeof(raw));
+  CHECK(refillAll() == 0);
+  CHECK(entropyPoolLevel() == ENTROPY_POOL_SIZE);
+  CHECK(poolHead == (head + sizeof(raw)) % ENTROPY_POOL_SIZE);
+}
+
+/***************************************************************************//**
+ * @brief Faulty sources trip the health tests, which latch until
+ *   entropyPoolInit() is called again
+ ******************************************************************************/
+static void testHealth(void)
+{
+  entropyPoolStats_TypeDef stats;
+  uint8_t output[32];
+  uint8_t raw[ENTROPY_POOL_SIZE];
+
+  // A stuck source fails the Repetition Count Test during a refill
+  poolTake(raw, 64);
+  trngMode = TRNG_STUCK;
+  CHECK(entropyPoolRefill() == ENTROPY_POOL_ERR_HEALTH);
+  entropyPoolStatsGet(&stats);
+  CHECK(stats.health == ENTROPY_POOL_HEALTH_RCT_FAIL);
+  CHECK(stats.rctFailures == 1);
+  CHECK(entropyPoolLevel() == 0);
+  CHECK(isWiped(poolData, sizeof(poolData)));
+  memset(output, 0x11, sizeof(output));
+  CHECK(entropyGetRandom(NULL, output, sizeof(output))
+        == ENTROPY_POOL_ERR_HEALTH);
+  CHECK(entropyPoolRefill() == ENTROPY_POOL_ERR_HEALTH);
+
+  // A biased source fails the Adaptive Proportion Test at start-up
+  trngMode = TRNG_BIASED;
+  CHECK(entropyPoolInit(trngPoll, NULL) == ENTROPY_POOL_ERR_HEALTH);
+  entropyPoolStatsGet(&stats);
+  CHECK(stats.health == ENTROPY_POOL_HEALTH_APT_FAIL);
+  CHECK(stats.aptFailures == 1);
+  CHECK(stats.rctFailures == 0);
+
+  // A good source works again after a new start-up
+  trngMode = TRNG_GOOD;
+  CHECK(entropyPoolInit(trngPoll, NULL) == 0);
+  CHECK(entropyGetRandom(NULL, output, sizeof(output)) == 0);
+
+  // A source error during a reseed fails the request and wipes the output
+  mbedtls_ctr_drbg_set_reseed_interval(&ctrDrbg, 1);
+  poolTake(raw, sizeof(raw));
+  trngMode = TRNG_ERROR;
+  memset(output, 0x11, sizeof(output));
+  CHECK(entropyGetRandom(NULL, output, sizeof(output))
+        == ENTROPY_POOL_ERR_HEALTH);
+  CHECK(isWiped(output, sizeof(output)));
+  entropyPoolStatsGet(&stats);
+  CHECK(stats.health == ENTROPY_POOL_HEALTH_SOURCE_FAIL);
+
+  // Freeing twice must be harmless
+  entropyPoolFree();
+  CHECK(!poolSeeded);
+  entropyPoolFree();
+  CHECK(entropyGetRandom(NULL, output, sizeof(output))
+        == ENTROPY_POOL_ERR_BAD_INPUT_DATA);
+}
+
+int main(void)
+{
+  testNormalOperation();
+  testHealth();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 /***************************************************************************//**
  * @file main_gpio_int_s2_xg21.c
- * @brief Demonstrates basic interrupt functionality on GPIO using push buttons
+ * @brief Demonstrates basic interrupt functionality on GPIO using push buttons,
+ * with table-driven dispatch and debounce by gpio_dispatch.c
  *******************************************************************************
  * # License
  * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
@@ -36,7 +37,10 @@
 #include "em_chip.h"
 #include "em_gpio.h"
 #include "em_emu.h"
+#include "em_cmu.h"
+#include "em_rtcc.h"
 #include "bsp.h"
+#include "gpio_dispatch.h"
 
 // must re-map GPIO to pins on port A/B for interrupts to work in EM2/3
 #define  BUTTON_0_PORT  gpioPortA
@@ -45,14 +49,104 @@
 #define  BUTTON_1_PORT  gpioPortA
 #define  BUTTON_1_PIN   5
 
+/* RTCC ticks per second, the RTCC counts the ULFRCO, which runs in EM3 */
+#define TICKS_PER_SECOND  1000
+
+/* Time to ignore a push button after a press */
+#define DEBOUNCE_TICKS    (TICKS_PER_SECOND / 20)
+
+/* RTCC channel used for debouncing */
+#define DEBOUNCE_CC       1
+
+/**************************************************************************//**
+ * @brief Debounce timer hooks for the RTCC.
+ *****************************************************************************/
+static uint32_t rtccNow(void)
+{
+  return RTCC_CounterGet();
+}
+
+static void rtccArm(uint32_t tick)
+{
+  RTCC_ChannelCCVSet(DEBOUNCE_CC, tick);
+  RTCC_IntClear(RTCC_IF_CC1);
+  RTCC_IntEnable(RTCC_IEN_CC1);
+
+  /* Set the flag if the match has already been missed */
+  if ((int32_t)(tick - RTCC_CounterGet()) <= 0)
+  {
+    RTCC_IntSet(RTCC_IF_CC1);
+  }
+}
+
+static void rtccDisarm(void)
+{
+  RTCC_IntDisable(RTCC_IEN_CC1);
+  RTCC_IntClear(RTCC_IF_CC1);
+}
+
+static const gpioDispatchTimer_TypeDef debounceTimer = {
+  .now = rtccNow,
+  .arm = rtccArm,
+  .disarm = rtccDisarm,
+};
+
+void RTCC_IRQHandler(void)
+{
+  RTCC_IntClear(RTCC_IF_CC1);
+  gpioDispatchTimeout();
+}
+
+/**************************************************************************//**
+ * @brief Setup the RTCC as a free running 32-bit counter on the ULFRCO.
+ *****************************************************************************/
+static void rtccSetup(void)
+{
+  RTCC_Init_TypeDef rtccInit = RTCC_INIT_DEFAULT;
+  RTCC_CCChConf_TypeDef rtccInitCompareChannel = RTCC_CH_INIT_COMPARE_DEFAULT;
+
+  CMU_ClockSelectSet(cmuClock_RTCCCLK, cmuSelect_ULFRCO);
+
+  RTCC_ChannelInit(DEBOUNCE_CC, &rtccInitCompareChannel);
+
+  rtccInit.enable = false;
+  rtccInit.presc = rtccCntPresc_1;
+  RTCC_Init(&rtccInit);
+
+  RTCC_IntClear(_RTCC_IF_MASK);
+  NVIC_ClearPendingIRQ(RTCC_IRQn);
+  NVIC_EnableIRQ(RTCC_IRQn);
+
+  RTCC_Enable(true);
+}
+
+/**************************************************************************//**
+ * @brief Push button callbacks, called from the GPIO interrupt handlers.
+ *****************************************************************************/
+static void pb0Pressed(uint32_t intNo)
+{
+  (void)intNo;
+  GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+}
+
+static void pb1Pressed(uint32_t intNo)
+{
+  (void)intNo;
+  GPIO_PinOutToggle(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN);
+}
+
 /**************************************************************************//**
  * @brief Setup GPIO interrupt for pushbuttons.
  *****************************************************************************/
 static void gpioSetup(void)
 {
-  /* Configure Button PB0 as input and enable interrupt */
-  GPIO_PinModeSet(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, gpioModeInputPull, 1);
-  GPIO_PinModeSet(BUTTON_0_PORT, BUTTON_0_PIN, gpioModeInputPull, 1);
+  /* Interrupt numbers are the pin numbers, debounce both buttons */
+  gpioDispatchInit(&debounceTimer);
+  gpioDispatchRegister(BUTTON_0_PIN, pb0Pressed, DEBOUNCE_TICKS);
+  gpioDispatchRegister(BUTTON_1_PIN, pb1Pressed, DEBOUNCE_TICKS);
+
+  /* Configure Button PB0 as input with glitch filter and enable interrupt */
+  GPIO_PinModeSet(BUTTON_0_PORT, BUTTON_0_PIN, gpioModeInputPullFilter, 1);
   GPIO_ExtIntConfig(BUTTON_0_PORT,
                     BUTTON_0_PIN,
                     BUTTON_0_PIN,
@@ -60,9 +154,8 @@ static void gpioSetup(void)
                     true,
                     true);
 
-  /* Configure Button PB1 as input and enable interrupt */
-  GPIO_PinModeSet(BSP_GPIO_PB1_PORT, BSP_GPIO_PB1_PIN, gpioModeInputPull, 1);
-  GPIO_PinModeSet(BUTTON_1_PORT, BUTTON_1_PIN, gpioModeInputPull, 1);
+  /* Configure Button PB1 as input with glitch filter and enable interrupt */
+  GPIO_PinModeSet(BUTTON_1_PORT, BUTTON_1_PIN, gpioModeInputPullFilter, 1);
   GPIO_ExtIntConfig(BUTTON_1_PORT,
                     BUTTON_1_PIN,
                     BUTTON_1_PIN,
@@ -70,53 +163,17 @@ static void gpioSetup(void)
                     true,
                     true);
 
-  /* Enable EVEN interrupt to catch button press that changes slew rate */
+  /* Enable EVEN and ODD interrupts, both are handled by gpio_dispatch.c */
   NVIC_ClearPendingIRQ(GPIO_EVEN_IRQn);
   NVIC_EnableIRQ(GPIO_EVEN_IRQn);
-
-  /* Enable ODD interrupt to catch button press that changes slew rate */
   NVIC_ClearPendingIRQ(GPIO_ODD_IRQn);
   NVIC_EnableIRQ(GPIO_ODD_IRQn);
 
-  /* Configure pB00 as a push pull output for LED drive */
+  /* Configure LED0 and LED1 as a push pull output for LED drive */
   GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, 1);
-  
-  /* Configure pB01 as a push pull output for LED drive */
   GPIO_PinModeSet(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN, gpioModePushPull, 1);
 }
 
-/**************************************************************************//**
- * @brief GPIO Interrupt handler for even pins.
- *****************************************************************************/
-void GPIO_EVEN_IRQHandler(void)
-{
-  /* Get and clear all pending GPIO interrupts */
-  uint32_t interruptMask = GPIO_IntGet();
-  GPIO_IntClear(interruptMask);
-
-  /* Check if button 0 was pressed */
-  if (interruptMask & (1 << BUTTON_0_PIN))
-  {
-    GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
-  }
-}
-
-/**************************************************************************//**
- * @brief GPIO Interrupt handler for even pins.
- *****************************************************************************/
-void GPIO_ODD_IRQHandler(void)
-{
-  /* Get and clear all pending GPIO interrupts */
-  uint32_t interruptMask = GPIO_IntGet();
-  GPIO_IntClear(interruptMask);
-
-  /* Check if button 1 was pressed */
-  if (interruptMask & (1 << BUTTON_1_PIN))
-  {
-    GPIO_PinOutToggle(BSP_GPIO_LED1_PORT, BSP_GPIO_LED1_PIN);
-  }
-}
-
 /**************************************************************************//**
  * @brief  Main function
  *****************************************************************************/
@@ -125,7 +182,8 @@ int main(void)
   /* Chip errata */
   CHIP_Init();
 
-  /* Initialize Push Buttons and PA0 */
+  /* Initialize the debounce timer, Push Buttons and LEDs */
+  rtccSetup();
   gpioSetup();
 
   /* Infinite loop */
@@ -0,0 +1,394 @@
+/***************************************************************************//**
+ * @file aead_frame.c
+ * @brief In-place authenticated encryption (AES-CCM) of framed payloads
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+
+// Series 0 devices seal frames with the AES peripheral through emlib, other
+// devices through mbed TLS CCM, which is accelerated by the SE or CRYPTOACC
+// when MBEDTLS_CCM_ALT is defined. Both follow NIST SP 800-38C.
+#if defined(AES_PRESENT) && (AES_COUNT > 0)
+#define AEAD_FRAME_EM_AES
+#include "em_aes.h"
+#else
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+#include "mbedtls/ccm.h"
+#include "mbedtls/platform_util.h"
+#endif
+
+#include "aead_frame.h"
+#include <stdbool.h>
+#include <string.h>
+
+#if (AEAD_FRAME_TAG_SIZE < 4) || (AEAD_FRAME_TAG_SIZE > 16) \
+  || (AEAD_FRAME_TAG_SIZE % 2 != 0)
+#error "AEAD_FRAME_TAG_SIZE must be an even number from 4 to 16"
+#endif
+
+// Size of the CCM length field, 15 - AEAD_FRAME_NONCE_SIZE
+#define CCM_L                   (15 - AEAD_FRAME_NONCE_SIZE)
+
+#define AES_BLOCK_SIZE          (16)
+
+#if defined(AEAD_FRAME_EM_AES)
+// Key and AES blocks are kept word aligned for emlib
+static uint32_t aesKey[8];
+static unsigned int aesKeyBits;
+#else
+static mbedtls_ccm_context ccmCtx;
+static bool ccmReady;
+#endif
+
+#if defined(AEAD_FRAME_EM_AES)
+/***************************************************************************//**
+ * @brief Wipe a buffer in a way the compiler does not optimize out
+ * @param buf Pointer to the buffer
+ * @param len Number of bytes
+ ******************************************************************************/
+static void zeroize(void *buf, size_t len)
+{
+  volatile uint8_t *p = buf;
+
+  while (len--) {
+    *p++ = 0;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Encrypt one AES block in place with the frame key
+ * @param block Pointer to the word aligned block
+ ******************************************************************************/
+static void aesEncryptBlock(uint32_t *block)
+{
+#if defined(AES_CTRL_AES256)
+  if (aesKeyBits == 256) {
+    AES_ECB256((uint8_t *)block, (uint8_t *)block, AES_BLOCK_SIZE,
+               (uint8_t *)aesKey, true);
+    return;
+  }
+#endif
+  AES_ECB128((uint8_t *)block, (uint8_t *)block, AES_BLOCK_SIZE,
+             (uint8_t *)aesKey, true);
+}
+
+/***************************************************************************//**
+ * @brief Run CCM over a frame in a single pass
+ * @details Each payload block is added to the CBC-MAC and encrypted (or
+ *          decrypted and then added) in place before moving to the next one,
+ *          so the payload is read and written once.
+ * @param frame Pointer to the frame, starting with the header
+ * @param headerLen Size of the header (associated data)
+ * @param payloadLen Size of the payload
+ * @param tag Receives the computed tag
+ * @param encrypt true to seal, false to open
+ ******************************************************************************/
+static void ccmCrypt(uint8_t *frame, size_t headerLen, size_t payloadLen,
+                     uint8_t *tag, bool encrypt)
+{
+  size_t i;
+  size_t j;
+  size_t n;
+  size_t pos;
+  uint32_t counter;
+  const uint8_t *nonce = &frame[headerLen];
+  uint8_t *payload = &frame[headerLen + AEAD_FRAME_NONCE_SIZE];
+  uint32_t mac[AES_BLOCK_SIZE / 4];     // CBC-MAC state
+  uint32_t ctr[AES_BLOCK_SIZE / 4];     // Counter block A(i)
+  uint32_t key[AES_BLOCK_SIZE / 4];     // Key stream block S(i)
+  uint8_t *macBytes = (uint8_t *)mac;
+  uint8_t *ctrBytes = (uint8_t *)ctr;
+  uint8_t *keyBytes = (uint8_t *)key;
+
+  // B(0): flags, nonce and payload length
+  macBytes[0] = (uint8_t)(((headerLen > 0) ? 0x40 : 0)
+                          | (((AEAD_FRAME_TAG_SIZE - 2) / 2) << 3)
+                          | (CCM_L - 1));
+  memcpy(&macBytes[1], nonce, AEAD_FRAME_NONCE_SIZE);
+  macBytes[14] = (uint8_t)(payloadLen >> 8);
+  macBytes[15] = (uint8_t)payloadLen;
+  aesEncryptBlock(mac);
+
+  // Header, prefixed with its 2-byte length and zero padded
+  if (headerLen > 0) {
+    macBytes[0] ^= (uint8_t)(headerLen >> 8);
+    macBytes[1] ^= (uint8_t)headerLen;
+    pos = 2;
+    for (i = 0; i < headerLen; i++) {
+      macBytes[pos++] ^= frame[i];
+      if (pos == AES_BLOCK_SIZE) {
+        aesEncryptBlock(mac);
+        pos = 0;
+      }
+    }
+    if (pos != 0) {
+      aesEncryptBlock(mac);
+    }
+  }
+
+  // Payload, block by block
+  ctrBytes[0] = CCM_L - 1;
+  memcpy(&ctrBytes[1], nonce, AEAD_FRAME_NONCE_SIZE);
+  counter = 0;
+  for (i = 0; i < payloadLen; i += n) {
+    n = payloadLen - i;
+    if (n > AES_BLOCK_SIZE) {
+      n = AES_BLOCK_SIZE;
+    }
+    counter++;
+    ctrBytes[14] = (uint8_t)(counter >> 8);
+    ctrBytes[15] = (uint8_t)counter;
+    memcpy(key, ctr, AES_BLOCK_SIZE);
+    aesEncryptBlock(key);
+
+    for (j = 0; j < n; j++) {
+      if (encrypt) {
+        macBytes[j] ^= payload[i + j];
+        payload[i + j] ^= keyBytes[j];
+      } else {
+        payload[i + j] ^= keyBytes[j];
+        macBytes[j] ^= payload[i + j];
+      }
+    }
+    aesEncryptBlock(mac);
+  }
+
+  // Tag is the CBC-MAC encrypted with S(0)
+  ctrBytes[14] = 0;
+  ctrBytes[15] = 0;
+  memcpy(key, ctr, AES_BLOCK_SIZE);
+  aesEncryptBlock(key);
+  for (j = 0; j < AEAD_FRAME_TAG_SIZE; j++) {
+    tag[j] = macBytes[j] ^ keyBytes[j];
+  }
+
+  zeroize(mac, sizeof(mac));
+  zeroize(key, sizeof(key));
+}
+#endif // AEAD_FRAME_EM_AES
+
+/***************************************************************************//**
+ * @brief Set the AES key used for all frames
+ * @param key Pointer to the key
+ * @param keyBits Key size in bits, 128 or 256 (256 only where supported)
+ * @return 0 on success, AEAD_FRAME_ERR_BAD_INPUT or an mbed TLS error code
+ ******************************************************************************/
+int aeadFrameSetKey(const uint8_t *key, unsigned int keyBits)
+{
+  aeadFrameFree();
+
+#if defined(AEAD_FRAME_EM_AES)
+  if (keyBits != 128
+#if defined(AES_CTRL_AES256)
+      && keyBits != 256
+#endif
+      ) {
+    return AEAD_FRAME_ERR_BAD_INPUT;
+  }
+  memcpy(aesKey, key, keyBits / 8);
+  aesKeyBits = keyBits;
+  return 0;
+#else
+  int ret;
+
+  mbedtls_ccm_init(&ccmCtx);
+  if ((ret = mbedtls_ccm_setkey(&ccmCtx, MBEDTLS_CIPHER_ID_AES, key,
+                                keyBits)) != 0) {
+    mbedtls_ccm_free(&ccmCtx);
+    return ret;
+  }
+  ccmReady = true;
+  return 0;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief Get the position of the payload in a frame buffer
+ * @param frame Pointer to the frame buffer
+ * @param headerLen Size of the header
+ * @return Pointer at which the application writes or reads the payload
+ ******************************************************************************/
+uint8_t *aeadFramePayload(uint8_t *frame, size_t headerLen)
+{
+  return &frame[headerLen + AEAD_FRAME_NONCE_SIZE];
+}
+
+/***************************************************************************//**
+ * @brief Encrypt and authenticate a frame in place
+ * @details The header must already be at the start of the frame and the
+ *          plaintext at aeadFramePayload(). The nonce is copied after the
+ *          header, the payload is encrypted where it is and the tag is
+ *          appended. A nonce must never be used twice with the same key.
+ * @param frame Pointer to the frame buffer
+ * @param frameSize Size of the frame buffer
+ * @param headerLen Size of the header
+ * @param payloadLen Size of the payload
+ * @param nonce Pointer to AEAD_FRAME_NONCE_SIZE bytes of nonce, may already
+ *              be in place in the frame
+ * @param frameLen Receives the size of the sealed frame
+ * @return 0 on success, AEAD_FRAME_ERR_BAD_INPUT or an mbed TLS error code
+ ******************************************************************************/
+int aeadFrameSeal(uint8_t *frame, size_t frameSize, size_t headerLen,
+                  size_t payloadLen, const uint8_t *nonce, size_t *frameLen)
+{
+  uint8_t *tag;
+
+#if defined(AEAD_FRAME_EM_AES)
+  if (aesKeyBits == 0) {
+#else
+  if (!ccmReady) {
+#endif
+    return AEAD_FRAME_ERR_BAD_INPUT;
+  }
+  if (headerLen > AEAD_FRAME_MAX_HEADER
+      || payloadLen > AEAD_FRAME_MAX_PAYLOAD
+      || frameSize < AEAD_FRAME_OVERHEAD(headerLen)
+      || payloadLen > frameSize - AEAD_FRAME_OVERHEAD(headerLen)) {
+    return AEAD_FRAME_ERR_BAD_INPUT;
+  }
+
+  if (nonce != &frame[headerLen]) {
+    memmove(&frame[headerLen], nonce, AEAD_FRAME_NONCE_SIZE);
+  }
+  tag = &frame[headerLen + AEAD_FRAME_NONCE_SIZE + payloadLen];
+
+#if defined(AEAD_FRAME_EM_AES)
+  ccmCrypt(frame, headerLen, payloadLen, tag, true);
+#else
+  {
+    int ret;
+    uint8_t *payload = aeadFramePayload(frame, headerLen);
+
+    ret = mbedtls_ccm_encrypt_and_tag(&ccmCtx, payloadLen,
+                                      &frame[headerLen], AEAD_FRAME_NONCE_SIZE,
+                                      frame, headerLen, payload, payload,
+                                      tag, AEAD_FRAME_TAG_SIZE);
+    if (ret != 0) {
+      return ret;
+    }
+  }
+#endif
+
+  *frameLen = AEAD_FRAME_OVERHEAD(headerLen) + payloadLen;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Verify and decrypt a frame in place
+ * @details On success the plaintext is at aeadFramePayload(). If the tag
+ *          does not match, the payload is wiped.
+ * @param frame Pointer to the received frame
+ * @param frameLen Size of the received frame
+ * @param headerLen Size of the header
+ * @param payloadLen Receives the size of the payload
+ * @return 0 on success, AEAD_FRAME_ERR_AUTH_FAILED, AEAD_FRAME_ERR_BAD_INPUT
+ *         or an mbed TLS error code
+ ******************************************************************************/
+int aeadFrameOpen(uint8_t *frame, size_t frameLen, size_t headerLen,
+                  size_t *payloadLen)
+{
+  int ret = 0;
+  size_t len;
+  uint8_t *payload;
+
+#if defined(AEAD_FRAME_EM_AES)
+  if (aesKeyBits == 0) {
+#else
+  if (!ccmReady) {
+#endif
+    return AEAD_FRAME_ERR_BAD_INPUT;
+  }
+  if (headerLen > AEAD_FRAME_MAX_HEADER
+      || frameLen < AEAD_FRAME_OVERHEAD(headerLen)
+      || frameLen - AEAD_FRAME_OVERHEAD(headerLen) > AEAD_FRAME_MAX_PAYLOAD) {
+    return AEAD_FRAME_ERR_BAD_INPUT;
+  }
+  len = frameLen - AEAD_FRAME_OVERHEAD(headerLen);
+  payload = aeadFramePayload(frame, headerLen);
+
+#if defined(AEAD_FRAME_EM_AES)
+  {
+    size_t i;
+    uint8_t diff = 0;
+    uint8_t tag[AEAD_FRAME_TAG_SIZE];
+
+    ccmCrypt(frame, headerLen, len, tag, false);
+
+    // Constant time comparison
+    for (i = 0; i < AEAD_FRAME_TAG_SIZE; i++) {
+      diff |= tag[i] ^ payload[len + i];
+    }
+    zeroize(tag, sizeof(tag));
+    if (diff != 0) {
+      ret = AEAD_FRAME_ERR_AUTH_FAILED;
+    }
+  }
+  if (ret != 0) {
+    zeroize(payload, len);
+    return ret;
+  }
+#else
+  ret = mbedtls_ccm_auth_decrypt(&ccmCtx, len,
+                                 &frame[headerLen], AEAD_FRAME_NONCE_SIZE,
+                                 frame, headerLen, payload, payload,
+                                 &payload[len], AEAD_FRAME_TAG_SIZE);
+  if (ret != 0) {
+    mbedtls_platform_zeroize(payload, len);
+    return (ret == MBEDTLS_ERR_CCM_AUTH_FAILED)
+           ? AEAD_FRAME_ERR_AUTH_FAILED : ret;
+  }
+#endif
+
+  *payloadLen = len;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Wipe the frame key
+ ******************************************************************************/
+void aeadFrameFree(void)
+{
+#if defined(AEAD_FRAME_EM_AES)
+  zeroize(aesKey, sizeof(aesKey));
+  aesKeyBits = 0;
+#else
+  if (ccmReady) {
+    mbedtls_ccm_free(&ccmCtx);
+    ccmReady = false;
+  }
+#endif
+}
@@ -0,0 +1,88 @@
+/***************************************************************************//**
+ * @file aead_frame.h
+ * @brief In-place authenticated encryption (AES-CCM) of framed payloads
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef AEAD_FRAME_H
+#define AEAD_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Frame layout, all fields in one buffer:
+//
+//   | header | nonce | payload | tag |
+//
+// The header is sent in clear and authenticated, the payload is encrypted and
+// authenticated. The application writes the header at the start of the
+// buffer and the payload at aeadFramePayload(), so that the frame can be
+// sealed and opened in place without copying the payload.
+
+// CCM nonce size, 15 - L with a 2-byte length field (payload < 64 KiB)
+#define AEAD_FRAME_NONCE_SIZE           (13)
+
+// Authentication tag size, an even number from 4 to 16
+#define AEAD_FRAME_TAG_SIZE             (8)
+
+// Largest header and payload
+#define AEAD_FRAME_MAX_HEADER           (0xFEFF)
+#define AEAD_FRAME_MAX_PAYLOAD          (0xFFFF)
+
+// Buffer space needed around a payload of the given size
+#define AEAD_FRAME_OVERHEAD(headerLen) \
+  ((headerLen) + AEAD_FRAME_NONCE_SIZE + AEAD_FRAME_TAG_SIZE)
+
+// Returned if a length is out of range, the buffer is too small or no key
+// is set
+#define AEAD_FRAME_ERR_BAD_INPUT        (-0x5C00)
+
+// Returned by aeadFrameOpen() if the tag does not match
+#define AEAD_FRAME_ERR_AUTH_FAILED      (-0x5B80)
+
+int aeadFrameSetKey(const uint8_t *key, unsigned int keyBits);
+uint8_t *aeadFramePayload(uint8_t *frame, size_t headerLen);
+int aeadFrameSeal(uint8_t *frame, size_t frameSize, size_t headerLen,
+                  size_t payloadLen, const uint8_t *nonce, size_t *frameLen);
+int aeadFrameOpen(uint8_t *frame, size_t frameLen, size_t headerLen,
+                  size_t *payloadLen);
+void aeadFrameFree(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AEAD_FRAME_H
@@ -0,0 +1,498 @@
+/***************************************************************************//**
+ * @file crypto_dispatch.c
+ * @brief Size-based dispatch between hardware and software crypto. See
+ * readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "crypto_dispatch.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_msc.h"
+#include <string.h>
+
+#define DISPATCH_MAGIC                  (0x31505344UL)      // "DSP1"
+#define CALIBRATION_SIZE_COUNT          (7)
+#define CALIBRATION_MAX_SIZE            (1024)
+
+// The selection table is kept in the last page of the main flash, which the
+// linker scripts src/se_aescrypt.ld and src/se_aescrypt.icf leave free. The
+// user data page is not used, as it can hold manufacturing tokens such as the
+// crystal tuning value.
+#define DISPATCH_PAGE   (FLASH_BASE + FLASH_SIZE - FLASH_PAGE_SIZE)
+#define DISPATCH_TABLE  ((const dispatchTable_TypeDef *)DISPATCH_PAGE)
+
+// Default selection table, used until a calibrated table is stored
+static const dispatchTable_TypeDef dispatchDefaults = {
+  DISPATCH_MAGIC,
+  {
+    128,                                // DISPATCH_OP_SHA256
+  },
+  0
+};
+
+// Input sizes timed by dispatchCalibrate()
+static const uint32_t calibrationSizes[CALIBRATION_SIZE_COUNT] = {
+  16, 32, 64, 128, 256, 512, 1024
+};
+
+// SHA-256 round constants
+static const uint32_t sha256K[64] = {
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+  0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+  0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+  0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+  0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+  0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+  0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+  0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+  0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+// SHA-256 initial hash value
+static const uint32_t sha256H0[8] = {
+  0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+  0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+// Selection table in use
+static dispatchTable_TypeDef dispatchTable;
+
+// Input data for calibration
+static uint8_t calibrationBuffer[CALIBRATION_MAX_SIZE];
+
+#define ROTR(x, n)      (((x) >> (n)) | ((x) << (32 - (n))))
+
+/***************************************************************************//**
+ * @brief Compute the check word of a selection table
+ * @param *table Pointer to the selection table
+ * @return Check word
+ ******************************************************************************/
+static uint32_t tableCheck(const dispatchTable_TypeDef *table)
+{
+  int i;
+  uint32_t check = table->magic;
+
+  for (i = 0; i < DISPATCH_OP_COUNT; i++) {
+    check = ROTR(check, 7) ^ table->threshold[i];
+  }
+  return ~check;
+}
+
+/***************************************************************************//**
+ * @brief Process one 64-byte block in software
+ * @param *state Pointer to the SHA-256 hash state
+ * @param *block Pointer to the 64-byte block
+ ******************************************************************************/
+static void sha256SwBlock(uint32_t *state, const uint8_t *block)
+{
+  int i;
+  uint32_t a, b, c, d, e, f, g, h, t1, t2;
+  uint32_t w[64];
+
+  for (i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)block[4 * i] << 24)
+           | ((uint32_t)block[4 * i + 1] << 16)
+           | ((uint32_t)block[4 * i + 2] << 8)
+           | (uint32_t)block[4 * i + 3];
+  }
+  for (; i < 64; i++) {
+    w[i] = (ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10))
+           + w[i - 7]
+           + (ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3))
+           + w[i - 16];
+  }
+
+  a = state[0];
+  b = state[1];
+  c = state[2];
+  d = state[3];
+  e = state[4];
+  f = state[5];
+  g = state[6];
+  h = state[7];
+
+  for (i = 0; i < 64; i++) {
+    t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25))
+         + ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+    t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22))
+         + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+/***************************************************************************//**
+ * @brief Feed data into a software SHA-256 computation
+ * @param *sw Pointer to the software SHA-256 state
+ * @param *input Pointer to the input data
+ * @param length Size of the input data in bytes
+ ******************************************************************************/
+static void sha256SwUpdate(dispatchSha256Sw_TypeDef *sw,
+                           const uint8_t *input,
+                           size_t length)
+{
+  uint32_t fill = sw->total & 63;
+  uint32_t chunk;
+
+  sw->total += length;
+
+  // Complete a partially filled block
+  if ((fill > 0) && (length >= (64 - fill))) {
+    chunk = 64 - fill;
+    memcpy(&sw->buffer[fill], input, chunk);
+    sha256SwBlock(sw->state, sw->buffer);
+    input += chunk;
+    length -= chunk;
+    fill = 0;
+  }
+
+  // Process whole blocks directly from the input
+  while (length >= 64) {
+    sha256SwBlock(sw->state, input);
+    input += 64;
+    length -= 64;
+  }
+
+  if (length > 0) {
+    memcpy(&sw->buffer[fill], input, length);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Pad and finish a software SHA-256 computation
+ * @param *sw Pointer to the software SHA-256 state
+ * @param *output Pointer to the 32-byte digest output
+ ******************************************************************************/
+static void sha256SwFinish(dispatchSha256Sw_TypeDef *sw, uint8_t *output)
+{
+  int i;
+  uint32_t fill = sw->total & 63;
+  uint32_t bitsHigh = sw->total >> 29;
+  uint32_t bitsLow = sw->total << 3;
+
+  sw->buffer[fill++] = 0x80;
+  if (fill > 56) {
+    memset(&sw->buffer[fill], 0, 64 - fill);
+    sha256SwBlock(sw->state, sw->buffer);
+    fill = 0;
+  }
+  memset(&sw->buffer[fill], 0, 56 - fill);
+
+  for (i = 0; i < 4; i++) {
+    sw->buffer[56 + i] = (uint8_t)(bitsHigh >> (24 - 8 * i));
+    sw->buffer[60 + i] = (uint8_t)(bitsLow >> (24 - 8 * i));
+  }
+  sha256SwBlock(sw->state, sw->buffer);
+
+  for (i = 0; i < 8; i++) {
+    output[4 * i] = (uint8_t)(sw->state[i] >> 24);
+    output[4 * i + 1] = (uint8_t)(sw->state[i] >> 16);
+    output[4 * i + 2] = (uint8_t)(sw->state[i] >> 8);
+    output[4 * i + 3] = (uint8_t)sw->state[i];
+  }
+}
+
+/***************************************************************************//**
+ * @brief Time a one-shot SHA-256 on one backend
+ * @param hardware True to time the accelerator, false for software
+ * @param length Number of bytes to hash
+ * @return Number of clock cycles
+ ******************************************************************************/
+static uint32_t timeSha256(bool hardware, size_t length)
+{
+  uint32_t start;
+  uint8_t digest[32];
+  dispatchSha256_TypeDef ctx;
+
+  start = DWT->CYCCNT;
+  ctx.hardware = hardware;
+  if (hardware) {
+    mbedtls_sha256_init(&ctx.ctx.hw);
+  }
+  dispatchSha256Starts(&ctx);
+  dispatchSha256Update(&ctx, calibrationBuffer, length);
+  dispatchSha256Finish(&ctx, digest);
+  dispatchSha256Free(&ctx);
+  return DWT->CYCCNT - start;
+}
+
+/***************************************************************************//**
+ * @brief Load the selection table from flash, or the defaults if no valid
+ *   table has been stored
+ * @return True if a calibrated table was loaded from flash
+ ******************************************************************************/
+bool dispatchInit(void)
+{
+  if ((DISPATCH_TABLE->magic == DISPATCH_MAGIC)
+      && (DISPATCH_TABLE->check == tableCheck(DISPATCH_TABLE))) {
+    dispatchTable = *DISPATCH_TABLE;
+    return true;
+  }
+
+  dispatchTable = dispatchDefaults;
+  return false;
+}
+
+/***************************************************************************//**
+ * @brief Time both backends across input sizes and update the thresholds
+ *   of the selection table in RAM. The DWT cycle counter must be enabled.
+ ******************************************************************************/
+void dispatchCalibrate(void)
+{
+  int i;
+  uint32_t threshold;
+
+  for (i = 0; i < CALIBRATION_MAX_SIZE; i++) {
+    calibrationBuffer[i] = (uint8_t)i;
+  }
+
+  // Walk down from the largest size while the accelerator is faster. The
+  // threshold is the smallest size from which the accelerator always wins.
+  threshold = DISPATCH_NEVER;
+  for (i = CALIBRATION_SIZE_COUNT - 1; i >= 0; i--) {
+    if (timeSha256(true, calibrationSizes[i])
+        > timeSha256(false, calibrationSizes[i])) {
+      break;
+    }
+    threshold = (i == 0) ? 0 : calibrationSizes[i];
+  }
+
+  dispatchTable.magic = DISPATCH_MAGIC;
+  dispatchTable.threshold[DISPATCH_OP_SHA256] = threshold;
+  dispatchTable.check = tableCheck(&dispatchTable);
+}
+
+/***************************************************************************//**
+ * @brief Write the selection table in RAM to the last page of the main
+ *   flash. The rest of this page is erased.
+ * @return 0 on success, or DISPATCH_ERR_FLASH
+ ******************************************************************************/
+int dispatchStore(void)
+{
+  int ret = 0;
+
+#if defined(_CMU_CLKEN1_MASK)
+  CMU_ClockEnable(cmuClock_MSC, true);
+#endif
+  MSC_Init();
+  if ((MSC_ErasePage((uint32_t *)DISPATCH_PAGE) != mscReturnOk)
+      || (MSC_WriteWord((uint32_t *)DISPATCH_PAGE,
+                        &dispatchTable,
+                        sizeof(dispatchTable)) != mscReturnOk)) {
+    ret = DISPATCH_ERR_FLASH;
+  }
+  MSC_Deinit();
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Get the selection table in use
+ * @return Pointer to the selection table
+ ******************************************************************************/
+const dispatchTable_TypeDef *dispatchTableGet(void)
+{
+  return &dispatchTable;
+}
+
+/***************************************************************************//**
+ * @brief Select the backend for an operation
+ * @param op Operation
+ * @param length Input size of the operation in bytes
+ * @return True if the operation should run on the accelerator
+ ******************************************************************************/
+bool dispatchUseHardware(dispatchOp_TypeDef op, size_t length)
+{
+  return length >= dispatchTable.threshold[op];
+}
+
+/***************************************************************************//**
+ * @brief Name of a backend
+ * @param hardware True for the accelerator, false for software
+ * @return Backend name
+ ******************************************************************************/
+const char *dispatchBackendName(bool hardware)
+{
+  if (!hardware) {
+    return "software";
+  }
+#if defined(MBEDTLS_SHA256_ALT) && defined(SEMAILBOX_PRESENT)
+  return "SE";
+#elif defined(MBEDTLS_SHA256_ALT) && defined(CRYPTOACC_PRESENT)
+  return "CRYPTOACC";
+#else
+  return "mbed TLS";
+#endif
+}
+
+/***************************************************************************//**
+ * @brief Initialize a SHA-256 context on the backend selected for the
+ *   expected input size
+ * @param *ctx Pointer to the context
+ * @param length Expected total input size in bytes
+ ******************************************************************************/
+void dispatchSha256Init(dispatchSha256_TypeDef *ctx, size_t length)
+{
+  ctx->hardware = dispatchUseHardware(DISPATCH_OP_SHA256, length);
+  if (ctx->hardware) {
+    mbedtls_sha256_init(&ctx->ctx.hw);
+  } else {
+    memset(&ctx->ctx.sw, 0, sizeof(ctx->ctx.sw));
+  }
+}
+
+/***************************************************************************//**
+ * @brief Free a SHA-256 context
+ * @param *ctx Pointer to the context
+ ******************************************************************************/
+void dispatchSha256Free(dispatchSha256_TypeDef *ctx)
+{
+  if (ctx->hardware) {
+    mbedtls_sha256_free(&ctx->ctx.hw);
+  } else {
+    memset(&ctx->ctx.sw, 0, sizeof(ctx->ctx.sw));
+  }
+}
+
+/***************************************************************************//**
+ * @brief Clone a SHA-256 context, including its backend selection
+ * @param *dst Pointer to the destination context, initialized or not
+ * @param *src Pointer to the source context
+ ******************************************************************************/
+void dispatchSha256Clone(dispatchSha256_TypeDef *dst,
+                         const dispatchSha256_TypeDef *src)
+{
+  dst->hardware = src->hardware;
+  if (src->hardware) {
+    mbedtls_sha256_init(&dst->ctx.hw);
+    mbedtls_sha256_clone(&dst->ctx.hw, &src->ctx.hw);
+  } else {
+    dst->ctx.sw = src->ctx.sw;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Start a SHA-256 computation
+ * @param *ctx Pointer to the context
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int dispatchSha256Starts(dispatchSha256_TypeDef *ctx)
+{
+  if (ctx->hardware) {
+    return mbedtls_sha256_starts_ret(&ctx->ctx.hw, 0);
+  }
+
+  memcpy(ctx->ctx.sw.state, sha256H0, sizeof(sha256H0));
+  ctx->ctx.sw.total = 0;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Feed data into a SHA-256 computation
+ * @param *ctx Pointer to the context
+ * @param *input Pointer to the input data
+ * @param length Size of the input data in bytes
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int dispatchSha256Update(dispatchSha256_TypeDef *ctx,
+                         const uint8_t *input, size_t length)
+{
+  if (ctx->hardware) {
+    return mbedtls_sha256_update_ret(&ctx->ctx.hw, input, length);
+  }
+
+  sha256SwUpdate(&ctx->ctx.sw, input, length);
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Finish a SHA-256 computation
+ * @param *ctx Pointer to the context
+ * @param *output Pointer to the 32-byte digest output
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int dispatchSha256Finish(dispatchSha256_TypeDef *ctx, uint8_t *output)
+{
+  if (ctx->hardware) {
+    return mbedtls_sha256_finish_ret(&ctx->ctx.hw, output);
+  }
+
+  sha256SwFinish(&ctx->ctx.sw, output);
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief One-shot SHA-256 on the backend selected for the input size
+ * @param *input Pointer to the input data
+ * @param length Size of the input data in bytes
+ * @param *output Pointer to the 32-byte digest output
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int dispatchSha256(const uint8_t *input, size_t length, uint8_t *output)
+{
+  int ret;
+  dispatchSha256_TypeDef ctx;
+
+  dispatchSha256Init(&ctx, length);
+  ret = dispatchSha256Starts(&ctx);
+  if (ret == 0) {
+    ret = dispatchSha256Update(&ctx, input, length);
+  }
+  if (ret == 0) {
+    ret = dispatchSha256Finish(&ctx, output);
+  }
+  dispatchSha256Free(&ctx);
+  return ret;
+}
@@ -0,0 +1,113 @@
+/***************************************************************************//**
+ * @file crypto_dispatch.h
+ * @brief Size-based dispatch between hardware and software crypto. See
+ * readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef CRYPTO_DISPATCH_H
+#define CRYPTO_DISPATCH_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/sha256.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Threshold for an operation that never runs on the accelerator
+#define DISPATCH_NEVER                  (0xFFFFFFFFUL)
+
+// Returned if the selection table could not be written to flash
+#define DISPATCH_ERR_FLASH              (-0x5F00)
+
+// Dispatchable operations. AES has no software implementation linked when
+// MBEDTLS_AES_ALT is defined, so it always runs on the accelerator.
+typedef enum {
+  DISPATCH_OP_SHA256 = 0,
+  DISPATCH_OP_COUNT
+} dispatchOp_TypeDef;
+
+// Selection table. An operation runs on the accelerator for inputs of at
+// least threshold bytes, and in software for shorter inputs.
+typedef struct {
+  uint32_t magic;
+  uint32_t threshold[DISPATCH_OP_COUNT];
+  uint32_t check;
+} dispatchTable_TypeDef;
+
+// Software SHA-256 state
+typedef struct {
+  uint32_t state[8];
+  uint32_t total;
+  uint8_t buffer[64];
+} dispatchSha256Sw_TypeDef;
+
+// SHA-256 context running on the backend selected at init
+typedef struct {
+  bool hardware;
+  union {
+    mbedtls_sha256_context hw;
+    dispatchSha256Sw_TypeDef sw;
+  } ctx;
+} dispatchSha256_TypeDef;
+
+bool dispatchInit(void);
+void dispatchCalibrate(void);
+int dispatchStore(void);
+const dispatchTable_TypeDef *dispatchTableGet(void);
+bool dispatchUseHardware(dispatchOp_TypeDef op, size_t length);
+const char *dispatchBackendName(bool hardware);
+
+void dispatchSha256Init(dispatchSha256_TypeDef *ctx, size_t length);
+void dispatchSha256Free(dispatchSha256_TypeDef *ctx);
+void dispatchSha256Clone(dispatchSha256_TypeDef *dst,
+                         const dispatchSha256_TypeDef *src);
+int dispatchSha256Starts(dispatchSha256_TypeDef *ctx);
+int dispatchSha256Update(dispatchSha256_TypeDef *ctx,
+                         const uint8_t *input, size_t length);
+int dispatchSha256Finish(dispatchSha256_TypeDef *ctx, uint8_t *output);
+int dispatchSha256(const uint8_t *input, size_t length, uint8_t *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CRYPTO_DISPATCH_H
@@ -0,0 +1,412 @@
+/***************************************************************************//**
+ * @file kdf.c
+ * @brief Key derivation functions (PBKDF2-HMAC-SHA256 and HKDF-SHA256)
+ * with a cache of derived keys. See readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "kdf.h"
+#include "crypto_dispatch.h"
+#include "mbedtls/platform_util.h"
+#include <string.h>
+
+#define HMAC_BLOCK_SIZE                 (64)
+#define HKDF_MAX_OUTPUT_SIZE            (255 * KDF_SHA256_SIZE)
+
+// HMAC-SHA-256 with the padded key already absorbed into the inner and outer
+// SHA-256 states. Each HMAC computed from the midstate costs two SHA-256
+// finish calls instead of four, which halves the accelerator round-trips.
+// The SHA-256 backend is selected by crypto_dispatch.c from the message size.
+typedef struct {
+  dispatchSha256_TypeDef inner;         // SHA-256 state after (key ^ ipad)
+  dispatchSha256_TypeDef outer;         // SHA-256 state after (key ^ opad)
+} kdfHmacMidstate_TypeDef;
+
+// Derived key cache slot. The slot is identified by a SHA-256 digest over
+// the password and salt, so the password itself is not kept in RAM.
+typedef struct {
+  bool valid;
+  uint8_t id[KDF_SHA256_SIZE];
+  uint8_t key[KDF_SHA256_SIZE];
+} kdfCacheSlot_TypeDef;
+
+static kdfCacheSlot_TypeDef kdfCache[KDF_CACHE_SLOTS];
+static uint32_t kdfCacheNext;
+
+/***************************************************************************//**
+ * @brief Absorb an HMAC key into the inner and outer SHA-256 states
+ * @param *ctx Pointer to the midstate to set up
+ * @param *key Pointer to the HMAC key
+ * @param keyLen Size of the HMAC key in bytes
+ * @param dataLen Typical size of the data of each HMAC in bytes, used to
+ *   select the SHA-256 backend
+ * @return 0 on success, or an mbed TLS error code. The states are
+ *   initialized in either case, and must be freed with hmacFree().
+ ******************************************************************************/
+static int hmacSetup(kdfHmacMidstate_TypeDef *ctx,
+                     const uint8_t *key,
+                     size_t keyLen,
+                     size_t dataLen)
+{
+  int i;
+  int ret;
+  uint8_t pad[HMAC_BLOCK_SIZE];
+  uint8_t keyDigest[KDF_SHA256_SIZE];
+
+  dispatchSha256Init(&ctx->inner, HMAC_BLOCK_SIZE + dataLen);
+  dispatchSha256Init(&ctx->outer, HMAC_BLOCK_SIZE + KDF_SHA256_SIZE);
+
+  // Keys longer than a block are hashed first
+  if (keyLen > HMAC_BLOCK_SIZE) {
+    ret = dispatchSha256(key, keyLen, keyDigest);
+    if (ret != 0) {
+      mbedtls_platform_zeroize(keyDigest, sizeof(keyDigest));
+      return ret;
+    }
+    key = keyDigest;
+    keyLen = KDF_SHA256_SIZE;
+  }
+
+  // Inner state: SHA-256(key ^ ipad || ...)
+  memset(pad, 0x36, HMAC_BLOCK_SIZE);
+  for (i = 0; i < (int)keyLen; i++) {
+    pad[i] ^= key[i];
+  }
+  ret = dispatchSha256Starts(&ctx->inner);
+  if (ret == 0) {
+    ret = dispatchSha256Update(&ctx->inner, pad, HMAC_BLOCK_SIZE);
+  }
+
+  // Outer state: SHA-256(key ^ opad || ...)
+  memset(pad, 0x5C, HMAC_BLOCK_SIZE);
+  for (i = 0; i < (int)keyLen; i++) {
+    pad[i] ^= key[i];
+  }
+  if (ret == 0) {
+    ret = dispatchSha256Starts(&ctx->outer);
+  }
+  if (ret == 0) {
+    ret = dispatchSha256Update(&ctx->outer, pad, HMAC_BLOCK_SIZE);
+  }
+
+  mbedtls_platform_zeroize(pad, sizeof(pad));
+  mbedtls_platform_zeroize(keyDigest, sizeof(keyDigest));
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Free the inner and outer SHA-256 states
+ * @param *ctx Pointer to the midstate to free
+ ******************************************************************************/
+static void hmacFree(kdfHmacMidstate_TypeDef *ctx)
+{
+  dispatchSha256Free(&ctx->inner);
+  dispatchSha256Free(&ctx->outer);
+}
+
+/***************************************************************************//**
+ * @brief Compute HMAC-SHA-256 over up to three concatenated inputs
+ * @param *ctx Pointer to the midstate holding the HMAC key
+ * @param *in1 Pointer to the first input, or NULL
+ * @param len1 Size of the first input in bytes
+ * @param *in2 Pointer to the second input, or NULL
+ * @param len2 Size of the second input in bytes
+ * @param *in3 Pointer to the third input, or NULL
+ * @param len3 Size of the third input in bytes
+ * @param *mac Pointer to the 32-byte output. May overlap any input.
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+static int hmacCompute(const kdfHmacMidstate_TypeDef *ctx,
+                       const uint8_t *in1, size_t len1,
+                       const uint8_t *in2, size_t len2,
+                       const uint8_t *in3, size_t len3,
+                       uint8_t *mac)
+{
+  int ret;
+  dispatchSha256_TypeDef sha;
+
+  // Continue from the inner midstate
+  dispatchSha256Clone(&sha, &ctx->inner);
+  ret = dispatchSha256Update(&sha, in1, len1);
+  if ((ret == 0) && (in2 != NULL)) {
+    ret = dispatchSha256Update(&sha, in2, len2);
+  }
+  if ((ret == 0) && (in3 != NULL)) {
+    ret = dispatchSha256Update(&sha, in3, len3);
+  }
+  if (ret == 0) {
+    ret = dispatchSha256Finish(&sha, mac);
+  }
+  dispatchSha256Free(&sha);
+
+  // Continue from the outer midstate with the inner digest
+  if (ret == 0) {
+    dispatchSha256Clone(&sha, &ctx->outer);
+    ret = dispatchSha256Update(&sha, mac, KDF_SHA256_SIZE);
+    if (ret == 0) {
+      ret = dispatchSha256Finish(&sha, mac);
+    }
+    dispatchSha256Free(&sha);
+  }
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief PBKDF2 with HMAC-SHA-256 as pseudorandom function (RFC 8018)
+ * @param *password Pointer to the password
+ * @param passwordLen Size of the password in bytes
+ * @param *salt Pointer to the salt
+ * @param saltLen Size of the salt in bytes
+ * @param iterations Iteration count, at least 1
+ * @param *key Pointer to the derived key output
+ * @param keyLen Size of the derived key in bytes
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int kdfPbkdf2HmacSha256(const uint8_t *password, size_t passwordLen,
+                        const uint8_t *salt, size_t saltLen,
+                        uint32_t iterations,
+                        uint8_t *key, size_t keyLen)
+{
+  int i;
+  int ret;
+  uint32_t j;
+  uint32_t block;
+  size_t chunk;
+  uint8_t counter[4];
+  uint8_t u[KDF_SHA256_SIZE];
+  uint8_t t[KDF_SHA256_SIZE];
+  kdfHmacMidstate_TypeDef hmac;
+
+  if (iterations == 0) {
+    return KDF_ERR_BAD_INPUT_DATA;
+  }
+
+  // The password is absorbed once for all iterations and blocks
+  ret = hmacSetup(&hmac, password, passwordLen, KDF_SHA256_SIZE);
+
+  for (block = 1; (ret == 0) && (keyLen > 0); block++) {
+    // U1 = HMAC(password, salt || INT(block))
+    counter[0] = (uint8_t)(block >> 24);
+    counter[1] = (uint8_t)(block >> 16);
+    counter[2] = (uint8_t)(block >> 8);
+    counter[3] = (uint8_t)block;
+    ret = hmacCompute(&hmac, salt, saltLen, counter, 4, NULL, 0, u);
+    memcpy(t, u, KDF_SHA256_SIZE);
+
+    // T = U1 ^ U2 ^ ... ^ Uc, with Un = HMAC(password, Un-1)
+    for (j = 1; (ret == 0) && (j < iterations); j++) {
+      ret = hmacCompute(&hmac, u, KDF_SHA256_SIZE, NULL, 0, NULL, 0, u);
+      for (i = 0; i < KDF_SHA256_SIZE; i++) {
+        t[i] ^= u[i];
+      }
+    }
+
+    chunk = (keyLen > KDF_SHA256_SIZE) ? KDF_SHA256_SIZE : keyLen;
+    memcpy(key, t, chunk);
+    key += chunk;
+    keyLen -= chunk;
+  }
+
+  hmacFree(&hmac);
+  mbedtls_platform_zeroize(u, sizeof(u));
+  mbedtls_platform_zeroize(t, sizeof(t));
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief HKDF with SHA-256, extract and expand (RFC 5869)
+ * @param *salt Pointer to the salt, or NULL for no salt
+ * @param saltLen Size of the salt in bytes
+ * @param *ikm Pointer to the input keying material
+ * @param ikmLen Size of the input keying material in bytes
+ * @param *info Pointer to the context information, or NULL
+ * @param infoLen Size of the context information in bytes
+ * @param *okm Pointer to the output keying material
+ * @param okmLen Size of the output keying material, at most 255 * 32 bytes
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int kdfHkdfSha256(const uint8_t *salt, size_t saltLen,
+                  const uint8_t *ikm, size_t ikmLen,
+                  const uint8_t *info, size_t infoLen,
+                  uint8_t *okm, size_t okmLen)
+{
+  int ret;
+  size_t chunk;
+  uint8_t counter;
+  uint8_t zeroSalt[KDF_SHA256_SIZE];
+  uint8_t prk[KDF_SHA256_SIZE];
+  uint8_t t[KDF_SHA256_SIZE];
+  kdfHmacMidstate_TypeDef hmac;
+
+  if (okmLen > HKDF_MAX_OUTPUT_SIZE) {
+    return KDF_ERR_BAD_INPUT_DATA;
+  }
+
+  // Extract: PRK = HMAC(salt, IKM), where no salt is HashLen zero bytes
+  if (salt == NULL) {
+    memset(zeroSalt, 0, KDF_SHA256_SIZE);
+    salt = zeroSalt;
+    saltLen = KDF_SHA256_SIZE;
+  }
+  ret = hmacSetup(&hmac, salt, saltLen, ikmLen);
+  if (ret == 0) {
+    ret = hmacCompute(&hmac, ikm, ikmLen, NULL, 0, NULL, 0, prk);
+  }
+  hmacFree(&hmac);
+
+  // Expand: T(n) = HMAC(PRK, T(n-1) || info || n), with T(0) empty
+  if (ret == 0) {
+    ret = hmacSetup(&hmac, prk, KDF_SHA256_SIZE,
+                    KDF_SHA256_SIZE + infoLen + 1);
+  }
+  for (counter = 1; (ret == 0) && (okmLen > 0); counter++) {
+    if (counter == 1) {
+      ret = hmacCompute(&hmac, info, infoLen, &counter, 1, NULL, 0, t);
+    } else {
+      ret = hmacCompute(&hmac, t, KDF_SHA256_SIZE, info, infoLen,
+                        &counter, 1, t);
+    }
+
+    chunk = (okmLen > KDF_SHA256_SIZE) ? KDF_SHA256_SIZE : okmLen;
+    memcpy(okm, t, chunk);
+    okm += chunk;
+    okmLen -= chunk;
+  }
+
+  hmacFree(&hmac);
+  mbedtls_platform_zeroize(prk, sizeof(prk));
+  mbedtls_platform_zeroize(t, sizeof(t));
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Derive a 32-byte key with PBKDF2-HMAC-SHA256, using a cached key
+ *   if the same (password, salt) pair has been derived before
+ * @param *password Pointer to the password
+ * @param passwordLen Size of the password in bytes
+ * @param *salt Pointer to the salt
+ * @param saltLen Size of the salt in bytes
+ * @param *key Pointer to the 32-byte derived key output
+ * @param *cached Set to true if the key was taken from the cache
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int kdfDeriveKeyCached(const uint8_t *password, size_t passwordLen,
+                       const uint8_t *salt, size_t saltLen,
+                       uint8_t *key, bool *cached)
+{
+  int i;
+  int ret;
+  uint32_t slot;
+  uint8_t diff;
+  uint8_t lengths[8];
+  uint8_t id[KDF_SHA256_SIZE];
+  dispatchSha256_TypeDef sha;
+
+  // Slot id = SHA-256(passwordLen || saltLen || password || salt)
+  for (i = 0; i < 4; i++) {
+    lengths[i] = (uint8_t)(passwordLen >> (i << 3));
+    lengths[i + 4] = (uint8_t)(saltLen >> (i << 3));
+  }
+  dispatchSha256Init(&sha, sizeof(lengths) + passwordLen + saltLen);
+  ret = dispatchSha256Starts(&sha);
+  if (ret == 0) {
+    ret = dispatchSha256Update(&sha, lengths, sizeof(lengths));
+  }
+  if (ret == 0) {
+    ret = dispatchSha256Update(&sha, password, passwordLen);
+  }
+  if (ret == 0) {
+    ret = dispatchSha256Update(&sha, salt, saltLen);
+  }
+  if (ret == 0) {
+    ret = dispatchSha256Finish(&sha, id);
+  }
+  dispatchSha256Free(&sha);
+  if (ret != 0) {
+    return ret;
+  }
+
+  // Look up the cache
+  for (slot = 0; slot < KDF_CACHE_SLOTS; slot++) {
+    diff = 0;
+    for (i = 0; i < KDF_SHA256_SIZE; i++) {
+      diff |= kdfCache[slot].id[i] ^ id[i];
+    }
+    if (kdfCache[slot].valid && (diff == 0)) {
+      memcpy(key, kdfCache[slot].key, KDF_SHA256_SIZE);
+      *cached = true;
+      return 0;
+    }
+  }
+
+  // Cache miss, derive the key and store it in the oldest slot
+  *cached = false;
+  ret = kdfPbkdf2HmacSha256(password, passwordLen, salt, saltLen,
+                            KDF_PBKDF2_ITERATIONS, key, KDF_SHA256_SIZE);
+  if (ret != 0) {
+    return ret;
+  }
+
+  slot = kdfCacheNext;
+  kdfCacheNext = (kdfCacheNext + 1) % KDF_CACHE_SLOTS;
+  memcpy(kdfCache[slot].id, id, KDF_SHA256_SIZE);
+  memcpy(kdfCache[slot].key, key, KDF_SHA256_SIZE);
+  kdfCache[slot].valid = true;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Wipe all derived keys from the cache
+ ******************************************************************************/
+void kdfCacheClear(void)
+{
+  mbedtls_platform_zeroize(kdfCache, sizeof(kdfCache));
+  kdfCacheNext = 0;
+}
+
+/***************************************************************************//**
+ * @brief Name of the SHA-256 backend used by the PBKDF2 iterations
+ * @return Backend name
+ ******************************************************************************/
+const char *kdfBackendName(void)
+{
+  return dispatchBackendName(
+    dispatchUseHardware(DISPATCH_OP_SHA256,
+                        HMAC_BLOCK_SIZE + KDF_SHA256_SIZE));
+}
@@ -0,0 +1,78 @@
+/***************************************************************************//**
+ * @file kdf.h
+ * @brief Key derivation functions (PBKDF2-HMAC-SHA256 and HKDF-SHA256)
+ * with a cache of derived keys. See readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef KDF_H
+#define KDF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// SHA-256 digest size and the size of keys derived by kdfDeriveKeyCached()
+#define KDF_SHA256_SIZE                 (32)
+
+// Number of PBKDF2 iterations used by kdfDeriveKeyCached()
+#define KDF_PBKDF2_ITERATIONS           (4096)
+
+// Number of (password, salt) slots in the derived key cache
+#define KDF_CACHE_SLOTS                 (4)
+
+// Returned if an output length is not supported by the KDF
+#define KDF_ERR_BAD_INPUT_DATA          (-0x5F80)
+
+int kdfPbkdf2HmacSha256(const uint8_t *password, size_t passwordLen,
+                        const uint8_t *salt, size_t saltLen,
+                        uint32_t iterations,
+                        uint8_t *key, size_t keyLen);
+int kdfHkdfSha256(const uint8_t *salt, size_t saltLen,
+                  const uint8_t *ikm, size_t ikmLen,
+                  const uint8_t *info, size_t infoLen,
+                  uint8_t *okm, size_t okmLen);
+int kdfDeriveKeyCached(const uint8_t *password, size_t passwordLen,
+                       const uint8_t *salt, size_t saltLen,
+                       uint8_t *key, bool *cached);
+void kdfCacheClear(void);
+const char *kdfBackendName(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KDF_H
@@ -47,9 +47,14 @@
 #include "em_cmu.h"
 #include "em_device.h"
 #include "retargetserial.h"
+#include "aead_frame.h"
+#include "crypto_dispatch.h"
+#include "kdf.h"
 #include "mbedtls/aes.h"
 #include "mbedtls/md.h"
+#include "mbedtls/platform_util.h"
 #include <inttypes.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -67,6 +72,14 @@
 #define MAX_MESSAGE_SIZE_DECRYPTION \
   (2 * MAX_MESSAGE_SIZE_ENCRYPTION + 2 * IV_SIZE + 2 * TAG_SIZE + 1)
 
+// HKDF context information for splitting the derived key into AES and HMAC
+// keys
+#define KDF_INFO                        "aescrypt AES-256-CBC HMAC-SHA-256"
+
+// Frame used to check the in-place AES-CCM API at startup
+#define FRAME_HEADER_SIZE               (8)
+#define FRAME_PAYLOAD_SIZE              (23)
+
 // Global variables
 static char initialVector[IV_SIZE];
 static uint32_t messageSize, maxMessageSize;
@@ -253,21 +266,109 @@ static int selectAesMode(void)
   return mode;
 }
 
+/***************************************************************************//**
+ * @brief Print binary data as ASCII hexadecimal text
+ * @param *binBuf Pointer to binary data for printing
+ * @param binBufLen Size of the binary data in bytes
+ ******************************************************************************/
+static void printHex(const uint8_t *binBuf, uint32_t binBufLen)
+{
+  uint32_t chunk;
+  char hexBuf[2 * TAG_SIZE + 1];        // Hex buffer, +1 for null character
+
+  while (binBufLen > 0) {
+    chunk = (binBufLen > TAG_SIZE) ? TAG_SIZE : binBufLen;
+    binToHex(hexBuf, (uint8_t *)binBuf, chunk);
+    mbedtls_printf(hexBuf);
+    binBuf += chunk;
+    binBufLen -= chunk;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Derive the AES and HMAC keys from the hard-coded key and the IV
+ * @param *keys Pointer to 2 * KEY_SIZE bytes, AES key followed by HMAC key
+ * @param *cached Set to true if the PBKDF2 result was taken from the cache
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+static int deriveKeys(unsigned char *keys, bool *cached)
+{
+  int ret;
+  unsigned char password[KEY_SIZE];
+  unsigned char masterKey[KDF_SHA256_SIZE];
+
+  // Convert ASCII hard-coded key into binary
+  hexToBin(password, KEY_SIZE, aesKey256);
+
+  // masterKey = PBKDF2-HMAC-SHA256(key, IV), cached per (key, IV) pair
+  ret = kdfDeriveKeyCached(password, KEY_SIZE,
+                           (uint8_t *)initialVector, IV_SIZE,
+                           masterKey, cached);
+
+  // Expand the master key into independent AES and HMAC keys
+  if (ret == 0) {
+    ret = kdfHkdfSha256(NULL, 0,
+                        masterKey, KDF_SHA256_SIZE,
+                        (const uint8_t *)KDF_INFO, sizeof(KDF_INFO) - 1,
+                        keys, 2 * KEY_SIZE);
+  }
+
+  mbedtls_platform_zeroize(password, sizeof(password));
+  mbedtls_platform_zeroize(masterKey, sizeof(masterKey));
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Print the cycle counts of an encryption or decryption
+ * @param *operation Name of the operation
+ * @param keyCycles Cycles spent in key derivation and key setup
+ * @param cached True if the derived key was taken from the cache
+ * @param cycles Cycles spent in the bulk AES-CBC and HMAC processing
+ * @param length Number of bytes processed by AES-CBC and HMAC
+ ******************************************************************************/
+static void printCycles(const char *operation,
+                        uint32_t keyCycles,
+                        bool cached,
+                        uint32_t cycles,
+                        uint32_t length)
+{
+  uint32_t total = keyCycles + cycles;
+
+  mbedtls_printf("%s, cycles: %" PRIu32 " time: %" PRIu32 " ms\n",
+                 operation,
+                 total,
+                 total / (CMU_ClockFreqGet(cmuClock_HCLK) / 1000));
+  mbedtls_printf("  Key derivation (%s%s) cycles: %" PRIu32 "\n",
+                 kdfBackendName(),
+                 cached ? ", cached" : "",
+                 keyCycles);
+  if (length > 0) {
+    mbedtls_printf("  AES-CBC + HMAC cycles: %" PRIu32
+                   " (%" PRIu32 ".%02" PRIu32 " cycles/byte)\n",
+                   cycles,
+                   cycles / length,
+                   ((cycles % length) * 100) / length);
+  }
+}
+
 /***************************************************************************//**
  * @brief AES encryption
  ******************************************************************************/
 static void aesEncrypt(void)
 {
   int i;
-  char *bufPtr;                         // Pointer to buffer
-  uint32_t offset;                      // AES block offset
+  uint32_t length;                      // Padded message length
+  uint32_t keyCycles;                   // Key derivation cycle counter
   uint32_t cycles;                      // Cycle counter
-  char hexBuf[2 * TAG_SIZE + 1];        // Hex buffer, +1 for null character
+  bool cached;                          // Derived key taken from cache
+  unsigned char iv[IV_SIZE];            // IV, updated by the CBC operation
   unsigned char digest[TAG_SIZE];       // Buffer for hash value
   unsigned char buffer[TAG_SIZE];       // Generic storage
+  unsigned char keys[2 * KEY_SIZE];     // Derived AES and HMAC keys
 
   mbedtls_aes_context aesCtx;           // AES context
   mbedtls_md_context_t shaCtx;          // SHA context
+  dispatchSha256_TypeDef ivCtx;         // SHA context for IV generation
 
   // Initialize AES and SHA contexts
   mbedtls_aes_init(&aesCtx);
@@ -291,86 +392,72 @@ static void aesEncrypt(void)
     buffer[i] = (unsigned char)(messageSize >> (i << 3));
   }
 
-  // Start and feed data into the message-digest computation
-  mbedtls_md_starts(&shaCtx);
-  mbedtls_md_update(&shaCtx, buffer, 8);
-  mbedtls_md_update(&shaCtx,
-                    (unsigned char*)initialVector,
-                    strlen(initialVector));
+  // Start and feed data into the message-digest computation. The input is
+  // short, so the dispatcher may select software SHA-256.
+  dispatchSha256Init(&ivCtx, 8 + strlen(initialVector));
+  dispatchSha256Starts(&ivCtx);
+  dispatchSha256Update(&ivCtx, buffer, 8);
+  dispatchSha256Update(&ivCtx,
+                       (unsigned char*)initialVector,
+                       strlen(initialVector));
 
   // Finish the digest operation
-  mbedtls_md_finish(&shaCtx, digest);
+  dispatchSha256Finish(&ivCtx, digest);
+  dispatchSha256Free(&ivCtx);
 
   // The last nibble in the IV are actually used
   // to store the file size modulo the AES block size.
   digest[IV_SIZE - 1] = (digest[IV_SIZE - 1] & 0xF0) | (messageSize & 0x0F);
 
-  // Copy the result to IV[0..15]
+  // Copy the result to IV[0..15]. The CBC operation updates its own copy,
+  // initialVector is kept for the output.
   memcpy(initialVector, digest, IV_SIZE);
-
-  // Append the IV at the beginning of the output.
-  binToHex(hexBuf, (uint8_t *)initialVector, IV_SIZE);
-  mbedtls_printf(hexBuf);
-
-  // The digest[0..15] = IV[0..15] and digest[16..31] = 0
-  memset((digest + IV_SIZE), 0, IV_SIZE);
-
-  // Convert ASCII hard-coded key into binary
-  hexToBin((uint8_t *)buffer, KEY_SIZE, aesKey256);
+  memcpy(iv, digest, IV_SIZE);
 
   DWT->CYCCNT = 0;
-  // Hash the IV and the secret key together 8192 times
-  for (i = 0; i < 8192; i++) {
-    mbedtls_md_starts(&shaCtx);
-    mbedtls_md_update(&shaCtx, digest, TAG_SIZE);
-    mbedtls_md_update(&shaCtx, buffer, KEY_SIZE);
-    mbedtls_md_finish(&shaCtx, digest);
+  // Derive the AES and HMAC keys from the secret key and the IV
+  i = deriveKeys(keys, &cached);
+  if (i != 0) {
+    // Clear AES and SHA contexts to exit
+    mbedtls_aes_free(&aesCtx);
+    mbedtls_md_free(&shaCtx);
+    mbedtls_printf("  ! deriveKeys() returned -0x%04x\n", -i);
+    return;
   }
 
-  // Using the result in digest as key to setup the AES and HMAC.
-  mbedtls_aes_setkey_enc(&aesCtx, digest, KEY_SIZE * 8);
-  mbedtls_md_hmac_starts(&shaCtx, digest, TAG_SIZE);
-
-  // Encrypt plain text and write the ciphertext.
-  for (bufPtr = message, offset = 0;
-       offset < messageSize;
-       offset += AES_BLOCK_SIZE, bufPtr += AES_BLOCK_SIZE) {
-    // Copy the plain text to buffer
-    if ((messageSize - offset) > AES_BLOCK_SIZE) {
-      memcpy(buffer, bufPtr, AES_BLOCK_SIZE);
-    } else {
-      // Fill null character (0) on last block if not equal to AES_BLOCK_SIZE
-      memset(buffer, 0, AES_BLOCK_SIZE);
-      memcpy(buffer, bufPtr, (messageSize - offset));
-    }
+  // Using the derived keys to setup the AES and HMAC.
+  mbedtls_aes_setkey_enc(&aesCtx, keys, KEY_SIZE * 8);
+  mbedtls_md_hmac_starts(&shaCtx, keys + KEY_SIZE, KEY_SIZE);
+  mbedtls_platform_zeroize(keys, sizeof(keys));
+  keyCycles = DWT->CYCCNT;
 
-    // Plain text XOR IV
-    for (i = 0; i < AES_BLOCK_SIZE; i++) {
-      buffer[i] = (unsigned char)(buffer[i] ^ initialVector[i]);
-    }
+  // Pad the plain text with null characters (0) up to a whole number of AES
+  // blocks. The message buffer was cleared by selectAesMode().
+  length = (messageSize + AES_BLOCK_SIZE - 1) & ~(AES_BLOCK_SIZE - 1);
 
-    // AES encrypt then HMAC on encrypted text
-    mbedtls_aes_crypt_ecb(&aesCtx, MBEDTLS_AES_ENCRYPT, buffer, buffer);
-    mbedtls_md_hmac_update(&shaCtx, buffer, AES_BLOCK_SIZE);
-
-    // Use the encrypted text to XOR the following plain text
-    memcpy(initialVector, buffer, AES_BLOCK_SIZE);
-
-    // Print out ciphertext
-    binToHex(hexBuf, buffer, AES_BLOCK_SIZE);
-    mbedtls_printf(hexBuf);
-  }
+  DWT->CYCCNT = 0;
+  // Encrypt the whole plain text in place with a single CBC call, then HMAC
+  // the ciphertext with a single update, instead of one call per block.
+  mbedtls_aes_crypt_cbc(&aesCtx,
+                        MBEDTLS_AES_ENCRYPT,
+                        length,
+                        iv,
+                        (unsigned char *)message,
+                        (unsigned char *)message);
+  mbedtls_md_hmac_update(&shaCtx, (unsigned char *)message, length);
 
   // Finally write the HMAC.
   mbedtls_md_hmac_finish(&shaCtx, digest);
   cycles = DWT->CYCCNT;
 
-  // Print out digest, cycles and time
-  binToHex(hexBuf, digest, TAG_SIZE);
-  mbedtls_printf("%s\n", hexBuf);
-  mbedtls_printf("Encryption, cycles: %" PRIu32 " time: %" PRIu32 " ms\n",
-                 cycles,
-                 cycles / (CMU_ClockFreqGet(cmuClock_HCLK) / 1000));
+  // Print out IV, ciphertext and digest outside of the timed region
+  printHex((uint8_t *)initialVector, IV_SIZE);
+  printHex((uint8_t *)message, length);
+  printHex(digest, TAG_SIZE);
+  mbedtls_printf("\n");
+
+  // Print out cycles and time
+  printCycles("Encryption", keyCycles, cached, cycles, length);
 
   // Clear AES and SHA contexts to exit
   mbedtls_aes_free(&aesCtx);
@@ -383,11 +470,14 @@ static void aesEncrypt(void)
 static void aesDecrypt(void)
 {
   int i;
-  char *bufPtr;                         // Pointer to buffer
-  uint32_t offset;                      // AES block offset
+  uint32_t offset;                      // Tag compare result
+  uint32_t length;                      // Binary ciphertext length
+  uint32_t keyCycles;                   // Key derivation cycle counter
   uint32_t cycles;                      // Cycle counter
+  bool cached;                          // Derived key taken from cache
+  unsigned char tag[TAG_SIZE];          // Received message digest tag
   unsigned char digest[TAG_SIZE];       // Buffer for hash value
-  unsigned char buffer[TAG_SIZE];       // Generic storage
+  unsigned char keys[2 * KEY_SIZE];     // Derived AES and HMAC keys
 
   mbedtls_aes_context aesCtx;           // AES context
   mbedtls_md_context_t shaCtx;          // SHA context
@@ -423,78 +513,68 @@ static void aesDecrypt(void)
     return;
   }
 
-  if ((messageSize & 0x0F) != 0) {
+  // The IV and tag are whole AES blocks, so the hex text length must be a
+  // multiple of two hex characters per byte times the AES block size.
+  if ((messageSize & (2 * AES_BLOCK_SIZE - 1)) != 0) {
     // Clear AES and SHA contexts to exit
     mbedtls_aes_free(&aesCtx);
     mbedtls_md_free(&shaCtx);
-    mbedtls_printf("File size not a multiple of 16.\n");
+    mbedtls_printf("File size not a multiple of 32 hex characters (16 bytes).\n");
     return;
   }
 
   // Subtract the IV + HMAC length.
   messageSize -= (2 * IV_SIZE + 2 * TAG_SIZE);
+  length = messageSize / 2;
 
-  // Read the initial vector (IV).
+  // Read the initial vector (IV) and the message digest tag.
   hexToBin((uint8_t *)initialVector, IV_SIZE, message);
+  hexToBin(tag, TAG_SIZE, &message[2 * IV_SIZE + messageSize]);
 
-  // The digest[0..15] = IV[0..15] and digest[16..31] = 0
-  memset((digest + IV_SIZE), 0, IV_SIZE);
-  memcpy(digest, initialVector, IV_SIZE);
-
-  // Convert ASCII hard-coded key into binary
-  hexToBin((uint8_t *)buffer, KEY_SIZE, aesKey256);
+  // Convert the ciphertext into binary in place, at the start of the message
+  // buffer. Each byte written is behind the two hex characters it was read
+  // from, so no input is overwritten before it is converted.
+  hexToBin((uint8_t *)message, length, &message[2 * IV_SIZE]);
 
   DWT->CYCCNT = 0;
-  // Hash the IV and the secret key together 8192 times
-  for (i = 0; i < 8192; i++) {
-    mbedtls_md_starts(&shaCtx);
-    mbedtls_md_update(&shaCtx, digest, TAG_SIZE);
-    mbedtls_md_update(&shaCtx, buffer, KEY_SIZE);
-    mbedtls_md_finish(&shaCtx, digest);
+  // Derive the AES and HMAC keys from the secret key and the IV
+  i = deriveKeys(keys, &cached);
+  if (i != 0) {
+    // Clear AES and SHA contexts to exit
+    mbedtls_aes_free(&aesCtx);
+    mbedtls_md_free(&shaCtx);
+    mbedtls_printf("  ! deriveKeys() returned -0x%04x\n", -i);
+    return;
   }
 
-  // Using the result in digest as key to setup the AES and HMAC.
-  mbedtls_aes_setkey_dec(&aesCtx, digest, KEY_SIZE * 8);
-  mbedtls_md_hmac_starts(&shaCtx, digest, TAG_SIZE);
-
-  // Set null character to end of plain text for print out
-  buffer[AES_BLOCK_SIZE] = 0;
-
-  // Decrypt ciphertext and write the plain text.
-  for (bufPtr = &message[2 * IV_SIZE], offset = 0;
-       offset < messageSize;
-       offset += 2 * AES_BLOCK_SIZE, bufPtr += 2 * AES_BLOCK_SIZE ) {
-    hexToBin(buffer, AES_BLOCK_SIZE, bufPtr);
-    // Copy the binary ciphertext to digest
-    memcpy(digest, buffer, AES_BLOCK_SIZE);
+  // Using the derived keys to setup the AES and HMAC.
+  mbedtls_aes_setkey_dec(&aesCtx, keys, KEY_SIZE * 8);
+  mbedtls_md_hmac_starts(&shaCtx, keys + KEY_SIZE, KEY_SIZE);
+  mbedtls_platform_zeroize(keys, sizeof(keys));
+  keyCycles = DWT->CYCCNT;
 
-    // HMAC then decrypt the ciphertext
-    mbedtls_md_hmac_update(&shaCtx, buffer, AES_BLOCK_SIZE);
-    mbedtls_aes_crypt_ecb(&aesCtx, MBEDTLS_AES_DECRYPT, buffer, buffer);
-
-    // XOR IV to get plain text
-    for (i = 0; i < AES_BLOCK_SIZE; i++) {
-      buffer[i] = (unsigned char)(buffer[i] ^ initialVector[i]);
-    }
-
-    // Restore the ciphertext to XOR the following decrypted text
-    memcpy(initialVector, digest, AES_BLOCK_SIZE);
-
-    // Print out plain text
-    mbedtls_printf((char*) buffer);
-  }
-
-  // Finally write the HMAC.
+  DWT->CYCCNT = 0;
+  // HMAC the whole ciphertext with a single update, then decrypt it in place
+  // with a single CBC call, instead of one call per block.
+  mbedtls_md_hmac_update(&shaCtx, (unsigned char *)message, length);
   mbedtls_md_hmac_finish(&shaCtx, digest);
+  mbedtls_aes_crypt_cbc(&aesCtx,
+                        MBEDTLS_AES_DECRYPT,
+                        length,
+                        (unsigned char *)initialVector,
+                        (unsigned char *)message,
+                        (unsigned char *)message);
   cycles = DWT->CYCCNT;
 
-  // Binary digest to buffer
-  hexToBin(buffer, TAG_SIZE, bufPtr);
+  // Print out plain text outside of the timed region. The null character
+  // padding of the last block terminates the string.
+  message[length] = 0;
+  mbedtls_printf("%s", message);
 
   // Verify the message authentication code.
   offset = 0;
   for (i = 0; i < TAG_SIZE; i++) {
-    offset |= digest[i] ^ buffer[i];
+    offset |= digest[i] ^ tag[i];
   }
 
   if (offset != 0) {
@@ -502,9 +582,7 @@ static void aesDecrypt(void)
                    "or file corrupted.\n");
   } else {
     mbedtls_printf("\nMessage digest tag OK.\n");
-    mbedtls_printf("Decryption, cycles: %" PRIu32 " time: %" PRIu32 " ms\n",
-                   cycles,
-                   cycles / (CMU_ClockFreqGet(cmuClock_HCLK) / 1000));
+    printCycles("Decryption", keyCycles, cached, cycles, length);
   }
 
   // Clear AES and SHA contexts to exit
@@ -512,6 +590,82 @@ static void aesDecrypt(void)
   mbedtls_md_free(&shaCtx);
 }
 
+/***************************************************************************//**
+ * @brief Seal and open a frame in place with AES-CCM (RFC 3610 vector #1)
+ * @return true if successful and false otherwise.
+ ******************************************************************************/
+static bool checkFrameAead(void)
+{
+  int ret;
+  uint32_t i;
+  uint32_t sealCycles;
+  uint32_t openCycles;
+  size_t frameLen;
+  size_t payloadLen;
+  uint8_t *payload;
+  static const uint8_t frameKey[16] = {
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF
+  };
+  static const uint8_t frameNonce[AEAD_FRAME_NONCE_SIZE] = {
+    0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xA0,
+    0xA1, 0xA2, 0xA3, 0xA4, 0xA5
+  };
+  static const uint8_t expected[FRAME_PAYLOAD_SIZE + AEAD_FRAME_TAG_SIZE] = {
+    0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2,
+    0xF0, 0x66, 0xD0, 0xC2, 0xC0, 0xF9, 0x89, 0x80,
+    0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84, 0x17,
+    0xE8, 0xD1, 0x2C, 0xFD, 0xF9, 0x26, 0xE0
+  };
+  static uint8_t frame[AEAD_FRAME_OVERHEAD(FRAME_HEADER_SIZE)
+                       + FRAME_PAYLOAD_SIZE];
+
+  mbedtls_printf("In-place AES-CCM frame check...");
+
+  if ((ret = aeadFrameSetKey(frameKey, 128)) != 0) {
+    mbedtls_printf(" failed\n  ! aeadFrameSetKey returned %d\n", ret);
+    return false;
+  }
+
+  // Header and payload are built directly in the frame buffer
+  payload = aeadFramePayload(frame, FRAME_HEADER_SIZE);
+  for (i = 0; i < FRAME_HEADER_SIZE; i++) {
+    frame[i] = i;
+  }
+  for (i = 0; i < FRAME_PAYLOAD_SIZE; i++) {
+    payload[i] = FRAME_HEADER_SIZE + i;
+  }
+
+  DWT->CYCCNT = 0;
+  ret = aeadFrameSeal(frame, sizeof(frame), FRAME_HEADER_SIZE,
+                      FRAME_PAYLOAD_SIZE, frameNonce, &frameLen);
+  sealCycles = DWT->CYCCNT;
+  if (ret != 0 || memcmp(payload, expected, sizeof(expected)) != 0) {
+    mbedtls_printf(" failed\n  ! aeadFrameSeal returned %d\n", ret);
+    aeadFrameFree();
+    return false;
+  }
+
+  DWT->CYCCNT = 0;
+  ret = aeadFrameOpen(frame, frameLen, FRAME_HEADER_SIZE, &payloadLen);
+  openCycles = DWT->CYCCNT;
+  aeadFrameFree();
+  if (ret != 0 || payloadLen != FRAME_PAYLOAD_SIZE) {
+    mbedtls_printf(" failed\n  ! aeadFrameOpen returned %d\n", ret);
+    return false;
+  }
+  for (i = 0; i < FRAME_PAYLOAD_SIZE; i++) {
+    if (payload[i] != FRAME_HEADER_SIZE + i) {
+      mbedtls_printf(" failed\n  ! decrypted payload mismatch\n");
+      return false;
+    }
+  }
+
+  mbedtls_printf(" ok  (seal cycles: %" PRIu32 " open cycles: %" PRIu32 ")\n",
+                 sealCycles, openCycles);
+  return true;
+}
+
 /***************************************************************************//**
  * @brief Main function
  ******************************************************************************/
@@ -538,6 +692,26 @@ int main(void)
   RETARGET_SerialInit();
   RETARGET_SerialCrLf(1);
 
+  // Load the hardware/software selection table from flash. If none is
+  // stored, calibrate the thresholds with a benchmark run and store them.
+  if (!dispatchInit()) {
+    mbedtls_printf("\nCalibrating hardware/software crypto dispatch.\n");
+    dispatchCalibrate();
+    if (dispatchStore() != 0) {
+      mbedtls_printf("  ! dispatchStore() failed\n");
+    }
+  }
+  if (dispatchTableGet()->threshold[DISPATCH_OP_SHA256] == DISPATCH_NEVER) {
+    mbedtls_printf("SHA-256 runs in software for all input sizes.\n");
+  } else {
+    mbedtls_printf("SHA-256 runs on %s from %" PRIu32 " bytes.\n",
+                   dispatchBackendName(true),
+                   dispatchTableGet()->threshold[DISPATCH_OP_SHA256]);
+  }
+
+  // Check the in-place framed AEAD against a known answer
+  checkFrameAead();
+
   while (1) {
     // Print out welcome text
     mbedtls_printf("\nWelcome to AESCRYPT. ");
@@ -0,0 +1,24 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// The flash and the cycle counter are simulated in RAM by host_flash.c.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+typedef struct {
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+extern DWT_Type hostDwt;
+extern uint8_t hostFlash[];
+extern uint8_t hostUserData[];
+
+#define DWT                             (&hostDwt)
+
+#define FLASH_PAGE_SIZE                 (0x2000UL)
+#define FLASH_SIZE                      (4 * FLASH_PAGE_SIZE)
+#define FLASH_BASE                      ((uintptr_t)hostFlash)
+#define USERDATA_BASE                   ((uintptr_t)hostUserData)
+#define USERDATA_SIZE                   (0x400UL)
+
+#endif // EM_DEVICE_H
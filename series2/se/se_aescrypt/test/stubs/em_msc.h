@@ -0,0 +1,20 @@
+// Host stand-in for em_msc.h. Implemented by host_flash.c with the NOR
+// flash rules: an erase sets a page to 0xFF and a write only clears bits.
+#ifndef EM_MSC_H
+#define EM_MSC_H
+
+#include <stdint.h>
+
+typedef enum {
+  mscReturnOk = 0,
+  mscReturnInvalidAddr = -1,
+  mscReturnUnaligned = -3
+} MSC_Status_TypeDef;
+
+void MSC_Init(void);
+void MSC_Deinit(void);
+MSC_Status_TypeDef MSC_ErasePage(uint32_t *startAddress);
+MSC_Status_TypeDef MSC_WriteWord(uint32_t *address, const void *data,
+                                 uint32_t numBytes);
+
+#endif // EM_MSC_H
@@ -0,0 +1,61 @@
+// Simulated flash, user data page and cycle counter for the host tests.
+// Every erase and write is counted, so a test can check which pages were
+// touched.
+#include "em_device.h"
+#include "em_msc.h"
+#include <string.h>
+
+DWT_Type hostDwt;
+uint8_t hostFlash[FLASH_SIZE] __attribute__((aligned(FLASH_PAGE_SIZE)));
+uint8_t hostUserData[USERDATA_SIZE] __attribute__((aligned(4)));
+unsigned hostFlashErases;
+unsigned hostUserDataErases;
+
+void MSC_Init(void)
+{
+}
+
+void MSC_Deinit(void)
+{
+}
+
+MSC_Status_TypeDef MSC_ErasePage(uint32_t *startAddress)
+{
+  uint8_t *page = (uint8_t *)startAddress;
+
+  if ((page >= hostFlash) && (page < hostFlash + FLASH_SIZE)) {
+    if ((page - hostFlash) % FLASH_PAGE_SIZE) {
+      return mscReturnUnaligned;
+    }
+    memset(page, 0xFF, FLASH_PAGE_SIZE);
+    hostFlashErases++;
+    return mscReturnOk;
+  }
+  if (page == hostUserData) {
+    memset(page, 0xFF, USERDATA_SIZE);
+    hostUserDataErases++;
+    return mscReturnOk;
+  }
+  return mscReturnInvalidAddr;
+}
+
+MSC_Status_TypeDef MSC_WriteWord(uint32_t *address, const void *data,
+                                 uint32_t numBytes)
+{
+  uint8_t *dst = (uint8_t *)address;
+  const uint8_t *src = data;
+  uint32_t i;
+
+  if (((uintptr_t)dst & 3) || (numBytes & 3)) {
+    return mscReturnUnaligned;
+  }
+  if (!((dst >= hostFlash) && (dst + numBytes <= hostFlash + FLASH_SIZE))
+      && !((dst >= hostUserData)
+           && (dst + numBytes <= hostUserData + USERDATA_SIZE))) {
+    return mscReturnInvalidAddr;
+  }
+  for (i = 0; i < numBytes; i++) {
+    dst[i] &= src[i];
+  }
+  return mscReturnOk;
+}
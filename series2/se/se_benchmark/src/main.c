@@ -0,0 +1,516 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief This example benchmarks the mbed TLS crypto primitives. See readme.txt
+ *        for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_device.h"
+#include "retargetserial.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/entropy_poll.h"
+#include "mbedtls/md.h"
+#include "mbedtls/sha256.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define mbedtls_printf  printf
+
+// Version of the result table format and of the benchmark firmware. Override
+// BENCH_FW_VERSION from the IDE settings to tag the results of a given build.
+#define BENCH_FORMAT_VERSION    (1)
+#if !defined(BENCH_FW_VERSION)
+#define BENCH_FW_VERSION        "dev"
+#endif
+
+// Name of the backend reported in the result table
+#if defined(NO_CRYPTO_ACCELERATION)
+#define BENCH_BACKEND           "software"
+#else
+#define BENCH_BACKEND           "SE"
+#endif
+
+#define BENCH_BUFFER_SIZE       (1024)  // Largest message size in bytes
+#define BENCH_ITER_SYMMETRIC    (16)    // Iterations for AES/SHA/TRNG/DRBG
+#define BENCH_ITER_ECC          (4)     // Iterations for ECDSA/ECDH
+
+// Select specific elliptic curve to use
+#define ECPARAMS                MBEDTLS_ECP_DP_SECP256R1
+
+// Benchmark function, runs one iteration over length bytes of data
+typedef int (*benchFunc_TypeDef)(size_t length);
+
+// Benchmark case, one line of the result table
+typedef struct {
+  const char *name;             // Operation name
+  benchFunc_TypeDef func;       // Function measured
+  uint32_t length;              // Data length in bytes, 0 for ECC operations
+  uint32_t iterations;          // Number of measured iterations
+} benchCase_TypeDef;
+
+// Global variables
+static mbedtls_entropy_context entropy;         // Entropy context
+static mbedtls_ctr_drbg_context ctrDrbg;        // CTR_DRBG context
+static mbedtls_aes_context aesEnc128;           // AES-128 encryption context
+static mbedtls_aes_context aesDec128;           // AES-128 decryption context
+static mbedtls_aes_context aesEnc256;           // AES-256 encryption context
+static mbedtls_md_context_t hmacCtx;            // HMAC-SHA-256 context
+static mbedtls_ecdsa_context signCtx;           // ECDSA context for sign
+static mbedtls_ecdsa_context genkeyCtx;         // ECDSA context for genkey
+static mbedtls_ecdh_context localCtx;           // ECDH local context
+static mbedtls_ecdh_context peerCtx;            // ECDH peer context
+static size_t signLen;                          // Length of the signature
+
+// Buffers for data, digest and signature
+static unsigned char benchBuffer[BENCH_BUFFER_SIZE];
+static unsigned char benchIv[16];
+static unsigned char benchStream[16];
+static unsigned char messageHash[32];
+static unsigned char signature[MBEDTLS_ECDSA_MAX_LEN];
+
+// Fixed keys, the values do not affect the timing
+static const unsigned char benchKey[32] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+  0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+  0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+/***************************************************************************//**
+ * @brief AES-128-ECB encryption, one block at a time
+ ******************************************************************************/
+static int benchAesEcb(size_t length)
+{
+  int ret = 0;
+  size_t i;
+
+  for (i = 0; (i < length) && (ret == 0); i += 16) {
+    ret = mbedtls_aes_crypt_ecb(&aesEnc128, MBEDTLS_AES_ENCRYPT,
+                                &benchBuffer[i], &benchBuffer[i]);
+  }
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief AES-128-CBC encryption
+ ******************************************************************************/
+static int benchAesCbcEnc(size_t length)
+{
+  return mbedtls_aes_crypt_cbc(&aesEnc128, MBEDTLS_AES_ENCRYPT, length,
+                               benchIv, benchBuffer, benchBuffer);
+}
+
+/***************************************************************************//**
+ * @brief AES-128-CBC decryption
+ ******************************************************************************/
+static int benchAesCbcDec(size_t length)
+{
+  return mbedtls_aes_crypt_cbc(&aesDec128, MBEDTLS_AES_DECRYPT, length,
+                               benchIv, benchBuffer, benchBuffer);
+}
+
+/***************************************************************************//**
+ * @brief AES-128-CTR encryption
+ ******************************************************************************/
+static int benchAesCtr(size_t length)
+{
+  size_t offset = 0;
+
+  return mbedtls_aes_crypt_ctr(&aesEnc128, length, &offset, benchIv,
+                               benchStream, benchBuffer, benchBuffer);
+}
+
+/***************************************************************************//**
+ * @brief AES-256-CBC encryption
+ ******************************************************************************/
+static int benchAes256CbcEnc(size_t length)
+{
+  return mbedtls_aes_crypt_cbc(&aesEnc256, MBEDTLS_AES_ENCRYPT, length,
+                               benchIv, benchBuffer, benchBuffer);
+}
+
+/***************************************************************************//**
+ * @brief SHA-256 digest
+ ******************************************************************************/
+static int benchSha256(size_t length)
+{
+  return mbedtls_sha256_ret(benchBuffer, length, messageHash, 0);
+}
+
+/***************************************************************************//**
+ * @brief HMAC-SHA-256 with the key already loaded into the context
+ ******************************************************************************/
+static int benchHmacSha256(size_t length)
+{
+  int ret;
+
+  if ((ret = mbedtls_md_hmac_reset(&hmacCtx)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_md_hmac_update(&hmacCtx, benchBuffer, length)) != 0) {
+    return ret;
+  }
+  return mbedtls_md_hmac_finish(&hmacCtx, messageHash);
+}
+
+/***************************************************************************//**
+ * @brief ECDSA key pair generation
+ ******************************************************************************/
+static int benchEcdsaGenkey(size_t length)
+{
+  (void)length;
+  return mbedtls_ecdsa_genkey(&genkeyCtx, ECPARAMS, mbedtls_ctr_drbg_random,
+                              &ctrDrbg);
+}
+
+/***************************************************************************//**
+ * @brief ECDSA signature of a SHA-256 hash
+ ******************************************************************************/
+static int benchEcdsaSign(size_t length)
+{
+  (void)length;
+  return mbedtls_ecdsa_write_signature(&signCtx, MBEDTLS_MD_SHA256,
+                                       messageHash, sizeof(messageHash),
+                                       signature, &signLen,
+                                       mbedtls_ctr_drbg_random, &ctrDrbg);
+}
+
+/***************************************************************************//**
+ * @brief ECDSA verification of the signature made by benchEcdsaSign()
+ ******************************************************************************/
+static int benchEcdsaVerify(size_t length)
+{
+  (void)length;
+  return mbedtls_ecdsa_read_signature(&signCtx, messageHash,
+                                      sizeof(messageHash), signature, signLen);
+}
+
+/***************************************************************************//**
+ * @brief ECDH public key generation
+ ******************************************************************************/
+static int benchEcdhGenPublic(size_t length)
+{
+  (void)length;
+  return mbedtls_ecdh_gen_public(&localCtx.grp, &localCtx.d, &localCtx.Q,
+                                 mbedtls_ctr_drbg_random, &ctrDrbg);
+}
+
+/***************************************************************************//**
+ * @brief ECDH shared secret computation with the peer public key
+ ******************************************************************************/
+static int benchEcdhShared(size_t length)
+{
+  (void)length;
+  return mbedtls_ecdh_compute_shared(&localCtx.grp, &localCtx.z, &peerCtx.Q,
+                                     &localCtx.d, mbedtls_ctr_drbg_random,
+                                     &ctrDrbg);
+}
+
+/***************************************************************************//**
+ * @brief Raw TRNG output, polled until length bytes are collected
+ ******************************************************************************/
+static int benchTrng(size_t length)
+{
+  int ret;
+  size_t olen;
+  size_t i = 0;
+
+  while (i < length) {
+    ret = mbedtls_hardware_poll(NULL, &benchBuffer[i], length - i, &olen);
+    if (ret != 0) {
+      return ret;
+    }
+    i += olen;
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief CTR_DRBG output
+ ******************************************************************************/
+static int benchCtrDrbg(size_t length)
+{
+  return mbedtls_ctr_drbg_random(&ctrDrbg, benchBuffer, length);
+}
+
+// Benchmark cases in the order they appear in the result table
+static const benchCase_TypeDef benchCases[] = {
+  { "aes128-ecb", benchAesEcb, 16, BENCH_ITER_SYMMETRIC },
+  { "aes128-ecb", benchAesEcb, 1024, BENCH_ITER_SYMMETRIC },
+  { "aes128-cbc-enc", benchAesCbcEnc, 16, BENCH_ITER_SYMMETRIC },
+  { "aes128-cbc-enc", benchAesCbcEnc, 64, BENCH_ITER_SYMMETRIC },
+  { "aes128-cbc-enc", benchAesCbcEnc, 256, BENCH_ITER_SYMMETRIC },
+  { "aes128-cbc-enc", benchAesCbcEnc, 1024, BENCH_ITER_SYMMETRIC },
+  { "aes128-cbc-dec", benchAesCbcDec, 16, BENCH_ITER_SYMMETRIC },
+  { "aes128-cbc-dec", benchAesCbcDec, 1024, BENCH_ITER_SYMMETRIC },
+  { "aes128-ctr", benchAesCtr, 16, BENCH_ITER_SYMMETRIC },
+  { "aes128-ctr", benchAesCtr, 64, BENCH_ITER_SYMMETRIC },
+  { "aes128-ctr", benchAesCtr, 256, BENCH_ITER_SYMMETRIC },
+  { "aes128-ctr", benchAesCtr, 1024, BENCH_ITER_SYMMETRIC },
+  { "aes256-cbc-enc", benchAes256CbcEnc, 16, BENCH_ITER_SYMMETRIC },
+  { "aes256-cbc-enc", benchAes256CbcEnc, 1024, BENCH_ITER_SYMMETRIC },
+  { "sha256", benchSha256, 64, BENCH_ITER_SYMMETRIC },
+  { "sha256", benchSha256, 256, BENCH_ITER_SYMMETRIC },
+  { "sha256", benchSha256, 1024, BENCH_ITER_SYMMETRIC },
+  { "hmac-sha256", benchHmacSha256, 64, BENCH_ITER_SYMMETRIC },
+  { "hmac-sha256", benchHmacSha256, 1024, BENCH_ITER_SYMMETRIC },
+  { "ecdsa-p256-genkey", benchEcdsaGenkey, 0, BENCH_ITER_ECC },
+  { "ecdsa-p256-sign", benchEcdsaSign, 0, BENCH_ITER_ECC },
+  { "ecdsa-p256-verify", benchEcdsaVerify, 0, BENCH_ITER_ECC },
+  { "ecdh-p256-genpub", benchEcdhGenPublic, 0, BENCH_ITER_ECC },
+  { "ecdh-p256-shared", benchEcdhShared, 0, BENCH_ITER_ECC },
+  { "trng", benchTrng, 1024, BENCH_ITER_SYMMETRIC },
+  { "ctr-drbg", benchCtrDrbg, 1024, BENCH_ITER_SYMMETRIC },
+};
+
+#define BENCH_CASE_COUNT  (sizeof(benchCases) / sizeof(benchCases[0]))
+
+/***************************************************************************//**
+ * @brief Clear the contexts used by the benchmark
+ ******************************************************************************/
+static void clearBenchContext(void)
+{
+  mbedtls_aes_free(&aesEnc128);
+  mbedtls_aes_free(&aesDec128);
+  mbedtls_aes_free(&aesEnc256);
+  mbedtls_md_free(&hmacCtx);
+  mbedtls_ecdsa_free(&signCtx);
+  mbedtls_ecdsa_free(&genkeyCtx);
+  mbedtls_ecdh_free(&localCtx);
+  mbedtls_ecdh_free(&peerCtx);
+  mbedtls_ctr_drbg_free(&ctrDrbg);
+  mbedtls_entropy_free(&entropy);
+}
+
+/***************************************************************************//**
+ * @brief Set up keys, key pairs and the CTR_DRBG used by the benchmark cases.
+ *   Nothing done here is included in the measured cycles.
+ * @return 0 if successful and an mbed TLS error code otherwise.
+ ******************************************************************************/
+static int setupBenchContext(void)
+{
+  int ret;
+  const char pers[] = "benchmark";  // String for CTR_DRBG
+
+  mbedtls_entropy_init(&entropy);
+  mbedtls_ctr_drbg_init(&ctrDrbg);
+  mbedtls_aes_init(&aesEnc128);
+  mbedtls_aes_init(&aesDec128);
+  mbedtls_aes_init(&aesEnc256);
+  mbedtls_md_init(&hmacCtx);
+  mbedtls_ecdsa_init(&signCtx);
+  mbedtls_ecdsa_init(&genkeyCtx);
+  mbedtls_ecdh_init(&localCtx);
+  mbedtls_ecdh_init(&peerCtx);
+
+  if ((ret = mbedtls_ctr_drbg_seed(&ctrDrbg, mbedtls_entropy_func, &entropy,
+                                   (const unsigned char *)pers,
+                                   sizeof(pers))) != 0) {
+    return ret;
+  }
+
+  // Symmetric keys
+  if ((ret = mbedtls_aes_setkey_enc(&aesEnc128, benchKey, 128)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_aes_setkey_dec(&aesDec128, benchKey, 128)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_aes_setkey_enc(&aesEnc256, benchKey, 256)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_md_setup(&hmacCtx,
+                              mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                              1)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_md_hmac_starts(&hmacCtx, benchKey,
+                                    sizeof(benchKey))) != 0) {
+    return ret;
+  }
+
+  // ECDSA signing key and a signature for the verify case
+  if ((ret = mbedtls_ecdsa_genkey(&signCtx, ECPARAMS, mbedtls_ctr_drbg_random,
+                                  &ctrDrbg)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_sha256_ret(benchKey, sizeof(benchKey),
+                                messageHash, 0)) != 0) {
+    return ret;
+  }
+  if ((ret = benchEcdsaSign(0)) != 0) {
+    return ret;
+  }
+
+  // ECDH key pairs for both sides
+  if ((ret = mbedtls_ecp_group_load(&localCtx.grp, ECPARAMS)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_ecp_group_load(&peerCtx.grp, ECPARAMS)) != 0) {
+    return ret;
+  }
+  if ((ret = benchEcdhGenPublic(0)) != 0) {
+    return ret;
+  }
+  return mbedtls_ecdh_gen_public(&peerCtx.grp, &peerCtx.d, &peerCtx.Q,
+                                 mbedtls_ctr_drbg_random, &ctrDrbg);
+}
+
+/***************************************************************************//**
+ * @brief Run one benchmark case and print its line of the result table.
+ *   Cycles are measured per iteration so that the minimum can be reported
+ *   together with the mean.
+ * @return 0 if successful and an mbed TLS error code otherwise.
+ ******************************************************************************/
+static int runBenchCase(const benchCase_TypeDef *benchCase)
+{
+  int ret = 0;
+  uint32_t i;
+  uint32_t cycles;              // Cycle counter
+  uint32_t minCycles = UINT32_MAX;
+  uint64_t sumCycles = 0;
+
+  memset(benchBuffer, 0x5a, sizeof(benchBuffer));
+  memset(benchIv, 0, sizeof(benchIv));
+
+  for (i = 0; i < benchCase->iterations; i++) {
+    DWT->CYCCNT = 0;
+    ret = benchCase->func(benchCase->length);
+    cycles = DWT->CYCCNT;
+
+    if (ret != 0) {
+      mbedtls_printf("BENCH-ERROR,%s,%" PRIu32 ",%d\n",
+                     benchCase->name, benchCase->length, ret);
+      return ret;
+    }
+    sumCycles += cycles;
+    if (cycles < minCycles) {
+      minCycles = cycles;
+    }
+  }
+
+  // BENCH,<operation>,<bytes>,<iterations>,<min cycles>,<mean cycles>
+  mbedtls_printf("BENCH,%s,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n",
+                 benchCase->name,
+                 benchCase->length,
+                 benchCase->iterations,
+                 minCycles,
+                 (uint32_t)(sumCycles / benchCase->iterations));
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Run all benchmark cases and print the result table
+ ******************************************************************************/
+static void runBenchmark(void)
+{
+  int ret;
+  uint32_t i;
+  uint32_t passed = 0;
+
+  // BENCH-BEGIN,<format>,<firmware version>,<backend>,<HCLK in Hz>
+  mbedtls_printf("BENCH-BEGIN,%d,%s,%s,%" PRIu32 "\n",
+                 BENCH_FORMAT_VERSION,
+                 BENCH_FW_VERSION,
+                 BENCH_BACKEND,
+                 CMU_ClockFreqGet(cmuClock_HCLK));
+
+  if ((ret = setupBenchContext()) != 0) {
+    mbedtls_printf("BENCH-ERROR,setup,0,%d\n", ret);
+  } else {
+    for (i = 0; i < BENCH_CASE_COUNT; i++) {
+      if (runBenchCase(&benchCases[i]) == 0) {
+        passed++;
+      }
+    }
+  }
+  clearBenchContext();
+
+  // BENCH-END,<number of result lines>
+  mbedtls_printf("BENCH-END,%" PRIu32 "\n", passed);
+}
+
+/***************************************************************************//**
+ * @brief Main function
+ ******************************************************************************/
+int main(void)
+{
+  int keyInput;
+
+  // HFXO kit specific parameters
+  CMU_HFXOInit_TypeDef hfxoInit = CMU_HFXOINIT_DEFAULT;
+
+  // Chip errata
+  CHIP_Init();
+
+  // Initialize HFXO with kit specific parameters
+  CMU_HFXOInit(&hfxoInit);
+
+  // Switch SYSCLK to HFXO
+  CMU_ClockSelectSet(cmuClock_SYSCLK, cmuSelect_HFXO);
+
+  // Power up trace and debug clocks. Needed for DWT.
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  // Enable DWT cycle counter. Used to measure clock cycles.
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  // Initialize LEUART/USART and map LF to CRLF
+  RETARGET_SerialInit();
+  RETARGET_SerialCrLf(1);
+
+  mbedtls_printf("\nCrypto benchmark, press 'r' to run again.\n");
+  runBenchmark();
+
+  while (1) {
+    keyInput = getchar();
+
+    // Key 'r' press?
+    if (keyInput == 'r') {
+      runBenchmark();
+    }
+  }
+}
@@ -0,0 +1,334 @@
+/***************************************************************************//**
+ * @file ecdsa_det.c
+ * @brief Deterministic ECDSA signing (RFC 6979) with a hardware scalar
+ * multiplication
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "ecdsa_det.h"
+#include "mbedtls/asn1write.h"
+#include "mbedtls/bignum.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/hmac_drbg.h"
+#include "mbedtls/platform_util.h"
+#include <string.h>
+
+// The nonce k is derived from the private key and the message hash with
+// HMAC-DRBG as specified by RFC 6979, so signing needs no entropy source and
+// no seeded DRBG. mbedtls_ecdsa_sign_det() cannot be used here: with
+// MBEDTLS_ECDSA_SIGN_ALT the SE and CRYPTOACC pick their own random nonce.
+// Instead R = k * G is computed with mbedtls_ecdh_compute_shared(), which
+// is the hardware scalar multiplication when MBEDTLS_ECDH_COMPUTE_SHARED_ALT
+// is defined and returns x(R), and s is computed with the bignum module.
+// The bignum operations are not constant time, so s is computed with the
+// private key and the nonce multiplied by a blinding scalar b, as done by
+// mbedtls_ecdsa_sign(). Like mbedtls_ecdsa_sign_det(), b comes from a
+// second HMAC-DRBG seeded from the private key and the hash.
+
+// Retries before giving up, each one is a 2^-128 event or less on P-256
+#define ECDSA_DET_MAX_TRIES     (10)
+
+// Label mixed into the seed of the DRBG used for blinding, so that the
+// blinding values differ from the nonces
+static const char blindLabel[] = "BLINDING CONTEXT";
+
+/***************************************************************************//**
+ * @brief Convert a hash or DRBG output to an integer, as in SEC1 4.1.3 step 5
+ * @param *grp Pointer to the group
+ * @param *x Pointer to the resulting integer
+ * @param *buf Pointer to the input
+ * @param bufLen Size of the input in bytes
+ * @param reduce Reduce the result modulo N (bits2octets in RFC 6979)
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+static int bitsToInt(const mbedtls_ecp_group *grp, mbedtls_mpi *x,
+                     const unsigned char *buf, size_t bufLen, int reduce)
+{
+  int ret;
+  size_t nBytes = (grp->nbits + 7) / 8;
+
+  if (bufLen > nBytes) {
+    bufLen = nBytes;
+  }
+  if ((ret = mbedtls_mpi_read_binary(x, buf, bufLen)) != 0) {
+    return ret;
+  }
+  if (bufLen * 8 > grp->nbits) {
+    if ((ret = mbedtls_mpi_shift_r(x, bufLen * 8 - grp->nbits)) != 0) {
+      return ret;
+    }
+  }
+  if (reduce && mbedtls_mpi_cmp_mpi(x, &grp->N) >= 0) {
+    ret = mbedtls_mpi_sub_mpi(x, x, &grp->N);
+  }
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Compute r = x(k * G) mod N
+ * @param *grp Pointer to the group
+ * @param *r Pointer to the resulting integer
+ * @param *k Pointer to the nonce
+ * @param *blind Pointer to the DRBG used for blinding in software
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+static int computeR(mbedtls_ecp_group *grp, mbedtls_mpi *r,
+                    const mbedtls_mpi *k, mbedtls_hmac_drbg_context *blind)
+{
+  int ret;
+
+#if defined(MBEDTLS_ECDH_COMPUTE_SHARED_ALT)
+  (void) blind;
+  ret = mbedtls_ecdh_compute_shared(grp, r, &grp->G, k, NULL, NULL);
+#else
+  ret = mbedtls_ecdh_compute_shared(grp, r, &grp->G, k,
+                                    mbedtls_hmac_drbg_random, blind);
+#endif
+  if (ret == 0) {
+    ret = mbedtls_mpi_mod_mpi(r, r, &grp->N);
+  }
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Compute a deterministic ECDSA signature (RFC 6979, section 3.2)
+ * @param *grp Pointer to the group
+ * @param *r Pointer to the first integer of the signature
+ * @param *s Pointer to the second integer of the signature
+ * @param *d Pointer to the private key
+ * @param *hash Pointer to the message hash
+ * @param hashLen Size of the hash in bytes
+ * @param mdAlg Hash algorithm of the HMAC-DRBG, normally the message hash
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int ecdsaDetSign(mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
+                 const mbedtls_mpi *d, const unsigned char *hash,
+                 size_t hashLen, mbedtls_md_type_t mdAlg)
+{
+  int ret;
+  int tries;
+  size_t nBytes;
+  mbedtls_mpi h;                        // Hash as an integer modulo N
+  mbedtls_mpi k;                        // Nonce
+  mbedtls_mpi b;                        // Blinding scalar
+  mbedtls_mpi t;                        // Scratch
+  mbedtls_hmac_drbg_context drbg;       // RFC 6979 nonce generator
+  mbedtls_hmac_drbg_context blind;      // Blinding values
+  const mbedtls_md_info_t *mdInfo;
+  unsigned char data[2 * MBEDTLS_ECP_MAX_BYTES];
+
+  mdInfo = mbedtls_md_info_from_type(mdAlg);
+  if (mdInfo == NULL || grp->N.p == NULL
+      || mbedtls_mpi_cmp_int(d, 1) < 0
+      || mbedtls_mpi_cmp_mpi(d, &grp->N) >= 0) {
+    return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+  }
+
+  nBytes = (grp->nbits + 7) / 8;
+  mbedtls_mpi_init(&h);
+  mbedtls_mpi_init(&k);
+  mbedtls_mpi_init(&b);
+  mbedtls_mpi_init(&t);
+  mbedtls_hmac_drbg_init(&drbg);
+  mbedtls_hmac_drbg_init(&blind);
+
+  // Seed material is int2octets(d) || bits2octets(hash)
+  if ((ret = bitsToInt(grp, &h, hash, hashLen, 1)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_mpi_write_binary(d, data, nBytes)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_mpi_write_binary(&h, &data[nBytes], nBytes)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_hmac_drbg_seed_buf(&drbg, mdInfo, data,
+                                        2 * nBytes)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_hmac_drbg_seed_buf(&blind, mdInfo, data,
+                                        2 * nBytes)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_hmac_drbg_update_ret(&blind,
+                                          (const unsigned char *)blindLabel,
+                                          sizeof(blindLabel) - 1)) != 0) {
+    goto cleanup;
+  }
+
+  for (tries = 0; tries < ECDSA_DET_MAX_TRIES; tries++) {
+    // Next candidate k, step h of RFC 6979 section 3.2. The DRBG update
+    // after each output is the K = HMAC_K(V || 0x00) step of a retry.
+    if ((ret = mbedtls_hmac_drbg_random(&drbg, data, nBytes)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = bitsToInt(grp, &k, data, nBytes, 0)) != 0) {
+      goto cleanup;
+    }
+    if (mbedtls_mpi_cmp_int(&k, 1) < 0
+        || mbedtls_mpi_cmp_mpi(&k, &grp->N) >= 0) {
+      continue;
+    }
+
+    if ((ret = computeR(grp, r, &k, &blind)) != 0) {
+      goto cleanup;
+    }
+    if (mbedtls_mpi_cmp_int(r, 0) == 0) {
+      continue;
+    }
+
+    // s = k^-1 * (h + r * d) mod N, computed as
+    // (b * h + (b * r) * d) * (b * k)^-1 so that d is only multiplied by
+    // b * r and only b * k is inverted
+    if ((ret = mbedtls_ecp_gen_privkey(grp, &b, mbedtls_hmac_drbg_random,
+                                       &blind)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mul_mpi(&t, &b, r)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mod_mpi(&t, &t, &grp->N)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mul_mpi(&t, &t, d)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mul_mpi(s, &b, &h)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_add_mpi(s, s, &t)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mod_mpi(s, s, &grp->N)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mul_mpi(&k, &k, &b)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mod_mpi(&k, &k, &grp->N)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_inv_mod(&k, &k, &grp->N)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mul_mpi(s, s, &k)) != 0) {
+      goto cleanup;
+    }
+    if ((ret = mbedtls_mpi_mod_mpi(s, s, &grp->N)) != 0) {
+      goto cleanup;
+    }
+    if (mbedtls_mpi_cmp_int(s, 0) != 0) {
+      break;
+    }
+  }
+  if (tries == ECDSA_DET_MAX_TRIES) {
+    ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+  }
+
+  cleanup:
+  // mbedtls_mpi_free() and mbedtls_hmac_drbg_free() wipe their contents
+  mbedtls_platform_zeroize(data, sizeof(data));
+  mbedtls_mpi_free(&h);
+  mbedtls_mpi_free(&k);
+  mbedtls_mpi_free(&b);
+  mbedtls_mpi_free(&t);
+  mbedtls_hmac_drbg_free(&drbg);
+  mbedtls_hmac_drbg_free(&blind);
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Compute a deterministic ECDSA signature and write it in ASN.1 DER
+ * @param *ctx Pointer to the ECDSA context holding the private key
+ * @param mdAlg Hash algorithm used to hash the message
+ * @param *hash Pointer to the message hash
+ * @param hashLen Size of the hash in bytes
+ * @param *sig Buffer of at least MBEDTLS_ECDSA_MAX_LEN bytes
+ * @param *sigLen Pointer to the resulting signature length
+ * @return 0 on success, or an mbed TLS error code
+ *
+ * Drop-in replacement for mbedtls_ecdsa_write_signature() without the RNG.
+ ******************************************************************************/
+int ecdsaDetWriteSignature(mbedtls_ecdsa_context *ctx,
+                           mbedtls_md_type_t mdAlg,
+                           const unsigned char *hash, size_t hashLen,
+                           unsigned char *sig, size_t *sigLen)
+{
+  int ret;
+  size_t len = 0;
+  unsigned char buf[MBEDTLS_ECDSA_MAX_LEN];
+  unsigned char *p = buf + sizeof(buf);
+  mbedtls_mpi r;
+  mbedtls_mpi s;
+
+  mbedtls_mpi_init(&r);
+  mbedtls_mpi_init(&s);
+
+  if ((ret = ecdsaDetSign(&ctx->grp, &r, &s, &ctx->d, hash, hashLen,
+                          mdAlg)) != 0) {
+    goto cleanup;
+  }
+
+  // SEQUENCE { INTEGER r, INTEGER s }, written backwards from the end
+  if ((ret = mbedtls_asn1_write_mpi(&p, buf, &s)) < 0) {
+    goto cleanup;
+  }
+  len += ret;
+  if ((ret = mbedtls_asn1_write_mpi(&p, buf, &r)) < 0) {
+    goto cleanup;
+  }
+  len += ret;
+  if ((ret = mbedtls_asn1_write_len(&p, buf, len)) < 0) {
+    goto cleanup;
+  }
+  len += ret;
+  if ((ret = mbedtls_asn1_write_tag(&p, buf, MBEDTLS_ASN1_CONSTRUCTED
+                                    | MBEDTLS_ASN1_SEQUENCE)) < 0) {
+    goto cleanup;
+  }
+  len += ret;
+
+  memcpy(sig, p, len);
+  *sigLen = len;
+  ret = 0;
+
+  cleanup:
+  mbedtls_mpi_free(&r);
+  mbedtls_mpi_free(&s);
+  return ret;
+}
@@ -0,0 +1,472 @@
+/***************************************************************************//**
+ * @file ecdsa_keyring.c
+ * @brief ECDSA verification against a set of trusted public keys with
+ * precomputed point multiplication tables. See readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "ecdsa_keyring.h"
+#include "mbedtls/asn1.h"
+#include "mbedtls/bignum.h"
+#include "mbedtls/ecdsa.h"
+#include <stdbool.h>
+#include <string.h>
+
+// Without hardware verification, u1 * G + u2 * Q is computed in software.
+// mbed TLS keeps the comb table of a point multiplication in the group
+// (mbedtls_ecp_group.T) only when the point is the group generator and
+// MBEDTLS_ECP_FIXED_POINT_OPTIM is 1. Each trusted key therefore gets a
+// private copy of the curve with the key as generator, so that the tables
+// of both G and Q are computed once and reused by every verification.
+#if !defined(MBEDTLS_ECDSA_VERIFY_ALT)
+#define KEYRING_SOFTWARE_TABLES
+#if (MBEDTLS_ECP_FIXED_POINT_OPTIM != 1)
+#error "ecdsa_keyring.c needs MBEDTLS_ECP_FIXED_POINT_OPTIM set to 1"
+#endif
+#endif
+
+// Trusted public key slot
+typedef struct {
+  bool used;
+  mbedtls_ecp_point Q;                  // Public key
+#if defined(KEYRING_SOFTWARE_TABLES)
+  mbedtls_ecp_group grp;                // Curve with Q as generator
+#endif
+} keyringSlot_TypeDef;
+
+static mbedtls_ecp_group keyringGroup;  // Curve, holds the table for G
+static keyringSlot_TypeDef keyringSlots[KEYRING_SLOTS];
+static bool keyringReady;
+
+#if defined(KEYRING_SOFTWARE_TABLES)
+/***************************************************************************//**
+ * @brief Compute and cache the comb table for the generator of a group
+ * @param *grp Pointer to the group
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+static int precomputeTable(mbedtls_ecp_group *grp)
+{
+  int ret;
+  mbedtls_mpi one;
+  mbedtls_ecp_point R;
+
+  mbedtls_mpi_init(&one);
+  mbedtls_ecp_point_init(&R);
+
+  // Any multiplication of the generator leaves its table in grp->T
+  ret = mbedtls_mpi_lset(&one, 1);
+  if (ret == 0) {
+    ret = mbedtls_ecp_mul(grp, &R, &one, &grp->G, NULL, NULL);
+  }
+
+  mbedtls_mpi_free(&one);
+  mbedtls_ecp_point_free(&R);
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Set up a copy of the curve with a public key as generator
+ * @param *grp Pointer to the group to set up, initialized by the caller
+ * @param *Q Pointer to the public key
+ * @return 0 on success, or an mbed TLS error code
+ *
+ * The curve parameters are copied into heap allocated MPIs instead of using
+ * mbedtls_ecp_group_copy(), which would load the constant curve data again
+ * and leave no room to replace the generator.
+ ******************************************************************************/
+static int setupKeyGroup(mbedtls_ecp_group *grp, const mbedtls_ecp_point *Q)
+{
+  int ret;
+
+  grp->id = keyringGroup.id;
+  grp->pbits = keyringGroup.pbits;
+  grp->nbits = keyringGroup.nbits;
+  grp->modp = keyringGroup.modp;
+  grp->h = 0;                           // MPIs are freed by the group
+
+  if ((ret = mbedtls_mpi_copy(&grp->P, &keyringGroup.P)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_mpi_copy(&grp->A, &keyringGroup.A)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_mpi_copy(&grp->B, &keyringGroup.B)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_mpi_copy(&grp->N, &keyringGroup.N)) != 0) {
+    return ret;
+  }
+  if ((ret = mbedtls_ecp_copy(&grp->G, Q)) != 0) {
+    return ret;
+  }
+  return precomputeTable(grp);
+}
+
+/***************************************************************************//**
+ * @brief Convert a hash to an integer modulo N, as in SEC1 4.1.4 step 5
+ * @param *e Pointer to the resulting integer
+ * @param *hash Pointer to the hash
+ * @param hashLen Size of the hash in bytes
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+static int hashToMpi(mbedtls_mpi *e, const unsigned char *hash, size_t hashLen)
+{
+  int ret;
+  size_t nBytes = (keyringGroup.nbits + 7) / 8;
+  size_t useLen = (hashLen > nBytes) ? nBytes : hashLen;
+
+  if ((ret = mbedtls_mpi_read_binary(e, hash, useLen)) != 0) {
+    return ret;
+  }
+  if (useLen * 8 > keyringGroup.nbits) {
+    if ((ret = mbedtls_mpi_shift_r(e, useLen * 8 - keyringGroup.nbits)) != 0) {
+      return ret;
+    }
+  }
+  if (mbedtls_mpi_cmp_mpi(e, &keyringGroup.N) >= 0) {
+    ret = mbedtls_mpi_sub_mpi(e, e, &keyringGroup.N);
+  }
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Verify a signature using the cached tables of G and of the key
+ * @param *slot Pointer to the key slot
+ * @param *hash Pointer to the hash
+ * @param hashLen Size of the hash in bytes
+ * @param *r Pointer to the r value of the signature
+ * @param *s Pointer to the s value of the signature
+ * @return 0 if the signature is valid, MBEDTLS_ERR_ECP_VERIFY_FAILED if not,
+ *   or another mbed TLS error code
+ ******************************************************************************/
+static int verifyTables(keyringSlot_TypeDef *slot,
+                        const unsigned char *hash, size_t hashLen,
+                        const mbedtls_mpi *r, const mbedtls_mpi *s)
+{
+  int ret;
+  mbedtls_mpi e, sInv, u1, u2, one;
+  mbedtls_ecp_point R, R1, R2;
+
+  // r and s must be in [1, N - 1]
+  if ((mbedtls_mpi_cmp_int(r, 1) < 0)
+      || (mbedtls_mpi_cmp_mpi(r, &keyringGroup.N) >= 0)
+      || (mbedtls_mpi_cmp_int(s, 1) < 0)
+      || (mbedtls_mpi_cmp_mpi(s, &keyringGroup.N) >= 0)) {
+    return MBEDTLS_ERR_ECP_VERIFY_FAILED;
+  }
+
+  mbedtls_mpi_init(&e);
+  mbedtls_mpi_init(&sInv);
+  mbedtls_mpi_init(&u1);
+  mbedtls_mpi_init(&u2);
+  mbedtls_mpi_init(&one);
+  mbedtls_ecp_point_init(&R);
+  mbedtls_ecp_point_init(&R1);
+  mbedtls_ecp_point_init(&R2);
+
+  // u1 = e / s mod N, u2 = r / s mod N
+  if ((ret = hashToMpi(&e, hash, hashLen)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_mpi_inv_mod(&sInv, s, &keyringGroup.N)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_mpi_mul_mpi(&u1, &e, &sInv)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_mpi_mod_mpi(&u1, &u1, &keyringGroup.N)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_mpi_mul_mpi(&u2, r, &sInv)) != 0) {
+    goto cleanup;
+  }
+  if ((ret = mbedtls_mpi_mod_mpi(&u2, &u2, &keyringGroup.N)) != 0) {
+    goto cleanup;
+  }
+
+  // R = u1 * G + u2 * Q, both multiplications use a cached comb table. A
+  // zero multiplier is not accepted by mbedtls_ecp_mul(), fall back to the
+  // table-less mbedtls_ecp_muladd() for these (negligibly rare) inputs.
+  if ((mbedtls_mpi_cmp_int(&u1, 0) == 0) || (mbedtls_mpi_cmp_int(&u2, 0) == 0)) {
+    ret = mbedtls_ecp_muladd(&keyringGroup, &R, &u1, &keyringGroup.G,
+                             &u2, &slot->Q);
+  } else {
+    ret = mbedtls_ecp_mul(&keyringGroup, &R1, &u1, &keyringGroup.G,
+                          NULL, NULL);
+    if (ret == 0) {
+      ret = mbedtls_ecp_mul(&slot->grp, &R2, &u2, &slot->grp.G, NULL, NULL);
+    }
+    if (ret == 0) {
+      ret = mbedtls_mpi_lset(&one, 1);
+    }
+    if (ret == 0) {
+      ret = mbedtls_ecp_muladd(&keyringGroup, &R, &one, &R1, &one, &R2);
+    }
+  }
+  if (ret != 0) {
+    goto cleanup;
+  }
+  if (mbedtls_ecp_is_zero(&R)) {
+    ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    goto cleanup;
+  }
+
+  // Valid if R.x mod N == r
+  if ((ret = mbedtls_mpi_mod_mpi(&R.X, &R.X, &keyringGroup.N)) != 0) {
+    goto cleanup;
+  }
+  if (mbedtls_mpi_cmp_mpi(&R.X, r) != 0) {
+    ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+  }
+
+  cleanup:
+  mbedtls_mpi_free(&e);
+  mbedtls_mpi_free(&sInv);
+  mbedtls_mpi_free(&u1);
+  mbedtls_mpi_free(&u2);
+  mbedtls_mpi_free(&one);
+  mbedtls_ecp_point_free(&R);
+  mbedtls_ecp_point_free(&R1);
+  mbedtls_ecp_point_free(&R2);
+  return ret;
+}
+#endif // KEYRING_SOFTWARE_TABLES
+
+/***************************************************************************//**
+ * @brief Load the curve and, on the software path, precompute the table for
+ *   its generator
+ * @param curve Curve of the trusted keys, e.g. MBEDTLS_ECP_DP_SECP256R1
+ * @return 0 on success, or an mbed TLS error code
+ ******************************************************************************/
+int keyringInit(mbedtls_ecp_group_id curve)
+{
+  int ret;
+  int i;
+
+  keyringFree();
+
+  mbedtls_ecp_group_init(&keyringGroup);
+  for (i = 0; i < KEYRING_SLOTS; i++) {
+    keyringSlots[i].used = false;
+    mbedtls_ecp_point_init(&keyringSlots[i].Q);
+#if defined(KEYRING_SOFTWARE_TABLES)
+    mbedtls_ecp_group_init(&keyringSlots[i].grp);
+#endif
+  }
+  keyringReady = true;
+
+  ret = mbedtls_ecp_group_load(&keyringGroup, curve);
+#if defined(KEYRING_SOFTWARE_TABLES)
+  if (ret == 0) {
+    ret = precomputeTable(&keyringGroup);
+  }
+#endif
+  if (ret != 0) {
+    keyringFree();
+  }
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Add a trusted public key
+ * @param *publicKey Pointer to the key in uncompressed point format
+ * @param publicKeyLen Size of the key in bytes
+ * @param *slot Pointer to the slot number assigned to the key
+ * @return 0 on success, KEYRING_ERR_FULL if no slot is free, or an mbed TLS
+ *   error code if the key is not a valid point of the curve
+ *
+ * On the software path this computes the comb table of the key, which costs
+ * about as much as one verification. Each later verification with the key
+ * skips that step.
+ ******************************************************************************/
+int keyringAdd(const unsigned char *publicKey, size_t publicKeyLen,
+               int *slot)
+{
+  int ret;
+  int i;
+  keyringSlot_TypeDef *entry;
+
+  if (!keyringReady || (slot == NULL)) {
+    return KEYRING_ERR_BAD_INPUT_DATA;
+  }
+  for (i = 0; (i < KEYRING_SLOTS) && keyringSlots[i].used; i++) {
+  }
+  if (i == KEYRING_SLOTS) {
+    return KEYRING_ERR_FULL;
+  }
+  entry = &keyringSlots[i];
+
+  ret = mbedtls_ecp_point_read_binary(&keyringGroup, &entry->Q,
+                                      publicKey, publicKeyLen);
+  if (ret == 0) {
+    ret = mbedtls_ecp_check_pubkey(&keyringGroup, &entry->Q);
+  }
+#if defined(KEYRING_SOFTWARE_TABLES)
+  if (ret == 0) {
+    ret = setupKeyGroup(&entry->grp, &entry->Q);
+  }
+#endif
+  if (ret != 0) {
+    mbedtls_ecp_point_free(&entry->Q);
+#if defined(KEYRING_SOFTWARE_TABLES)
+    mbedtls_ecp_group_free(&entry->grp);
+#endif
+    return ret;
+  }
+
+  entry->used = true;
+  *slot = i;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Remove a trusted public key and free its table
+ * @param slot Slot number returned by keyringAdd()
+ * @return 0 on success, or KEYRING_ERR_BAD_INPUT_DATA
+ ******************************************************************************/
+int keyringRemove(int slot)
+{
+  if (!keyringReady || (slot < 0) || (slot >= KEYRING_SLOTS)
+      || !keyringSlots[slot].used) {
+    return KEYRING_ERR_BAD_INPUT_DATA;
+  }
+  mbedtls_ecp_point_free(&keyringSlots[slot].Q);
+#if defined(KEYRING_SOFTWARE_TABLES)
+  mbedtls_ecp_group_free(&keyringSlots[slot].grp);
+#endif
+  keyringSlots[slot].used = false;
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Verify a signature given as r and s values
+ * @param slot Slot number of the trusted key
+ * @param *hash Pointer to the message hash
+ * @param hashLen Size of the hash in bytes
+ * @param *r Pointer to the r value of the signature
+ * @param *s Pointer to the s value of the signature
+ * @return 0 if the signature is valid, MBEDTLS_ERR_ECP_VERIFY_FAILED if not,
+ *   or another error code
+ ******************************************************************************/
+int keyringVerifyRaw(int slot,
+                     const unsigned char *hash, size_t hashLen,
+                     const mbedtls_mpi *r, const mbedtls_mpi *s)
+{
+  if (!keyringReady || (slot < 0) || (slot >= KEYRING_SLOTS)
+      || !keyringSlots[slot].used) {
+    return KEYRING_ERR_BAD_INPUT_DATA;
+  }
+#if defined(KEYRING_SOFTWARE_TABLES)
+  return verifyTables(&keyringSlots[slot], hash, hashLen, r, s);
+#else
+  // Hardware verification, the key is already parsed and validated
+  return mbedtls_ecdsa_verify(&keyringGroup, hash, hashLen,
+                              &keyringSlots[slot].Q, r, s);
+#endif
+}
+
+/***************************************************************************//**
+ * @brief Verify a DER encoded signature, as written by
+ *   mbedtls_ecdsa_write_signature()
+ * @param slot Slot number of the trusted key
+ * @param *hash Pointer to the message hash
+ * @param hashLen Size of the hash in bytes
+ * @param *signature Pointer to the signature
+ * @param signatureLen Size of the signature in bytes
+ * @return 0 if the signature is valid, MBEDTLS_ERR_ECP_VERIFY_FAILED if not,
+ *   KEYRING_ERR_BAD_INPUT_DATA if it is not a valid encoding, or another
+ *   error code
+ ******************************************************************************/
+int keyringVerify(int slot,
+                  const unsigned char *hash, size_t hashLen,
+                  const unsigned char *signature, size_t signatureLen)
+{
+  int ret;
+  size_t len;
+  unsigned char *p = (unsigned char *)signature;
+  const unsigned char *end = signature + signatureLen;
+  mbedtls_mpi r, s;
+
+  // ECDSA-Sig-Value ::= SEQUENCE { r INTEGER, s INTEGER }
+  ret = mbedtls_asn1_get_tag(&p, end, &len,
+                             MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE);
+  if ((ret != 0) || (p + len != end)) {
+    return KEYRING_ERR_BAD_INPUT_DATA;
+  }
+
+  mbedtls_mpi_init(&r);
+  mbedtls_mpi_init(&s);
+  if ((mbedtls_asn1_get_mpi(&p, end, &r) != 0)
+      || (mbedtls_asn1_get_mpi(&p, end, &s) != 0)
+      || (p != end)) {
+    ret = KEYRING_ERR_BAD_INPUT_DATA;
+  } else {
+    ret = keyringVerifyRaw(slot, hash, hashLen, &r, &s);
+  }
+  mbedtls_mpi_free(&r);
+  mbedtls_mpi_free(&s);
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Remove all keys and free the curve and its tables
+ ******************************************************************************/
+void keyringFree(void)
+{
+  int i;
+
+  if (!keyringReady) {
+    return;
+  }
+  for (i = 0; i < KEYRING_SLOTS; i++) {
+    mbedtls_ecp_point_free(&keyringSlots[i].Q);
+#if defined(KEYRING_SOFTWARE_TABLES)
+    mbedtls_ecp_group_free(&keyringSlots[i].grp);
+#endif
+    keyringSlots[i].used = false;
+  }
+  mbedtls_ecp_group_free(&keyringGroup);
+  keyringReady = false;
+}
+
+/***************************************************************************//**
+ * @brief Name of the verification backend
+ * @return "hardware" or "software (cached tables)"
+ ******************************************************************************/
+const char *keyringBackendName(void)
+{
+#if defined(KEYRING_SOFTWARE_TABLES)
+  return "software (cached tables)";
+#else
+  return "hardware";
+#endif
+}
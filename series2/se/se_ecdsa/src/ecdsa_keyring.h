@@ -0,0 +1,78 @@
+/***************************************************************************//**
+ * @file ecdsa_keyring.h
+ * @brief ECDSA verification against a set of trusted public keys with
+ * precomputed point multiplication tables. See readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef ECDSA_KEYRING_H
+#define ECDSA_KEYRING_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/ecp.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of trusted public keys that can be held at the same time
+#define KEYRING_SLOTS                   (4)
+
+// Returned if a slot number or signature encoding is invalid
+#define KEYRING_ERR_BAD_INPUT_DATA      (-0x5E80)
+// Returned by keyringAdd() if all slots are in use
+#define KEYRING_ERR_FULL                (-0x5E00)
+
+int keyringInit(mbedtls_ecp_group_id curve);
+int keyringAdd(const unsigned char *publicKey, size_t publicKeyLen,
+               int *slot);
+int keyringRemove(int slot);
+int keyringVerify(int slot,
+                  const unsigned char *hash, size_t hashLen,
+                  const unsigned char *signature, size_t signatureLen);
+int keyringVerifyRaw(int slot,
+                     const unsigned char *hash, size_t hashLen,
+                     const mbedtls_mpi *r, const mbedtls_mpi *s);
+void keyringFree(void);
+const char *keyringBackendName(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ECDSA_KEYRING_H
@@ -46,6 +46,8 @@
 #include "em_cmu.h"
 #include "em_device.h"
 #include "retargetserial.h"
+#include "ecdsa_det.h"
+#include "ecdsa_keyring.h"
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/ecdsa.h"
 #include "mbedtls/entropy.h"
@@ -62,6 +64,9 @@
 #define ECPARAMS        mbedtls_ecp_curve_list()->grp_id
 #endif
 
+// Number of repeated verifications against the trusted keyring
+#define KEYRING_VERIFY_COUNT  (8)
+
 // Global variables
 static mbedtls_ecdsa_context signCtx;           // ECDSA context for sign
 static mbedtls_ecdsa_context verifyCtx;         // ECDSA context for verify
@@ -84,6 +89,7 @@ static void clearEcdsaContext(void)
   mbedtls_ctr_drbg_free(&ctrDrbg);
   mbedtls_ecdsa_free(&signCtx);
   mbedtls_ecdsa_free(&verifyCtx);
+  keyringFree();
 }
 
 /***************************************************************************//**
@@ -201,18 +207,16 @@ static bool signMessage(void)
     return false;
   }
 
-  mbedtls_printf("  . Signing message hash with private key...");
+  mbedtls_printf("  . Signing message hash with private key (RFC 6979)...");
   memset(signature, 0, sizeof(signature));      // Clear signature buffer
 
-  // Compute the ECDSA signature of message
+  // Compute the ECDSA signature of message. The nonce is derived from the key
+  // and the hash, so signing does not use the DRBG seeded above.
   DWT->CYCCNT = 0;
-  if ((ret = mbedtls_ecdsa_write_signature(&signCtx, MBEDTLS_MD_SHA256,
-                                           messageHash, sizeof(messageHash),
-                                           signature, (size_t *)&signLen,
-                                           mbedtls_ctr_drbg_random, &ctrDrbg))
-      != 0) {
-    mbedtls_printf(" failed\n  ! mbedtls_ecdsa_write_signature returned %d\n",
-                   ret);
+  if ((ret = ecdsaDetWriteSignature(&signCtx, MBEDTLS_MD_SHA256,
+                                    messageHash, sizeof(messageHash),
+                                    signature, (size_t *)&signLen)) != 0) {
+    mbedtls_printf(" failed\n  ! ecdsaDetWriteSignature returned %d\n", ret);
     return false;
   }
   cycles = DWT->CYCCNT;
@@ -282,6 +286,69 @@ static bool verifySignature(void)
   return true;
 }
 
+/***************************************************************************//**
+ * @brief Verify the signed message repeatedly against a trusted keyring
+ * @return true if successful and false otherwise.
+ ******************************************************************************/
+static bool verifyWithKeyring(void)
+{
+  int ret;                      // Return code
+  int i;
+  int slot;                     // Keyring slot of the public key
+  size_t keyLen;                // Length of the public key
+  uint32_t cycles;              // Cycle counter
+  unsigned char publicKey[MBEDTLS_ECP_MAX_PT_LEN];
+
+  mbedtls_printf("  . Adding public key to the trusted keyring...");
+
+  // A device would hold the vendor public keys in flash, export the key of
+  // the signing context the same way
+  if ((ret = mbedtls_ecp_point_write_binary(&signCtx.grp, &signCtx.Q,
+                                            MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                            &keyLen, publicKey,
+                                            sizeof(publicKey))) != 0) {
+    mbedtls_printf(" failed\n  ! mbedtls_ecp_point_write_binary returned %d\n",
+                   ret);
+    return false;
+  }
+
+  // Setting up the keyring parses the key once and, without hardware
+  // verification, precomputes the point tables for G and for the key
+  DWT->CYCCNT = 0;
+  if ((ret = keyringInit(ECPARAMS)) != 0) {
+    mbedtls_printf(" failed\n  ! keyringInit returned %d\n", ret);
+    return false;
+  }
+  if ((ret = keyringAdd(publicKey, keyLen, &slot)) != 0) {
+    mbedtls_printf(" failed\n  ! keyringAdd returned %d\n", ret);
+    return false;
+  }
+  cycles = DWT->CYCCNT;
+
+  mbedtls_printf(" ok  (cycles: %" PRIu32 " time: %" PRIu32 " ms)\n",
+                 cycles,
+                 cycles / (CMU_ClockFreqGet(cmuClock_HCLK) / 1000));
+
+  mbedtls_printf("  . Verifying signature %d times with the keyring (%s)...",
+                 KEYRING_VERIFY_COUNT, keyringBackendName());
+
+  DWT->CYCCNT = 0;
+  for (i = 0; i < KEYRING_VERIFY_COUNT; i++) {
+    if ((ret = keyringVerify(slot, messageHash, sizeof(messageHash),
+                             signature, signLen)) != 0) {
+      mbedtls_printf(" failed\n  ! keyringVerify returned %d\n", ret);
+      return false;
+    }
+  }
+  cycles = DWT->CYCCNT / KEYRING_VERIFY_COUNT;
+
+  mbedtls_printf(" ok  (cycles per verification: %" PRIu32 " time: %" PRIu32
+                 " ms)\n",
+                 cycles,
+                 cycles / (CMU_ClockFreqGet(cmuClock_HCLK) / 1000));
+  return true;
+}
+
 /***************************************************************************//**
  * @brief Main function
  ******************************************************************************/
@@ -309,7 +376,7 @@ int main(void)
   RETARGET_SerialCrLf(1);
 
   // Start ECDSA process
-  // Seed entropy source
+  // Seed entropy source, only needed to generate the key pair
   if (!seedRandomNumber()) {
     goto cleanup;
   }
@@ -320,7 +387,12 @@ int main(void)
   }
 
   // Verify signed message
-  verifySignature();
+  if (!verifySignature()) {
+    goto cleanup;
+  }
+
+  // Verify signed message again with a precomputed trusted key
+  verifyWithKeyring();
 
   // Clean up before exit
   cleanup:
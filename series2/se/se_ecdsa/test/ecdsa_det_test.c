@@ -0,0 +1,286 @@
+/***************************************************************************//**
+ * @file ecdsa_det_test.c
+ * @brief Host test of ecdsa_det.c against the RFC 6979 test vectors and
+ * mbedtls_ecdsa_sign_det()
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, with the mbed TLS of the
+// Gecko SDK built for the host (make -C <mbedtls> lib). The default mbed TLS
+// configuration has no hardware, so the software scalar multiplication and
+// the blinded computation of s are tested:
+//
+//   gcc -Wall -Wextra -Isrc -I<mbedtls>/include test/ecdsa_det_test.c
+//       src/ecdsa_det.c -L<mbedtls>/library -lmbedcrypto -o ecdsa_det_test
+//   ./ecdsa_det_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "ecdsa_det.h"
+#include "mbedtls/sha256.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define RANDOM_MESSAGES                 (100)
+
+// RFC 6979 test vector: curve, private key, message, and the signature
+// (r, s) with SHA-256
+typedef struct {
+  mbedtls_ecp_group_id curve;
+  const char *d;
+  const char *message;
+  const char *r;
+  const char *s;
+} vector_TypeDef;
+
+static int checks;
+static int failures;
+
+// RFC 6979 A.2.3 (P-192), A.2.4 (P-224) and A.2.5 (P-256), with SHA-256
+static const vector_TypeDef vectors[] = {
+  {
+    MBEDTLS_ECP_DP_SECP192R1,
+    "6FAB034934E4C0FC9AE67F5B5659A9D7D1FEFD187EE09FD4",
+    "sample",
+    "4B0B8CE98A92866A2820E20AA6B75B56382E0F9BFD5ECB55",
+    "CCDB006926EA9565CBADC840829D8C384E06DE1F1E381B85"
+  },
+  {
+    MBEDTLS_ECP_DP_SECP192R1,
+    "6FAB034934E4C0FC9AE67F5B5659A9D7D1FEFD187EE09FD4",
+    "test",
+    "3A718BD8B4926C3B52EE6BBE67EF79B18CB6EB62B1AD97AE",
+    "5662E6848A4A19B1F1AE2F72ACD4B8BBE50F1EAC65D9124F"
+  },
+  {
+    MBEDTLS_ECP_DP_SECP224R1,
+    "F220266E1105BFE3083E03EC7A3A654651F45E37167E88600BF257C1",
+    "sample",
+    "61AA3DA010E8E8406C656BC477A7A7189895E7E840CDFE8FF42307BA",
+    "BC814050DAB5D23770879494F9E0A680DC1AF7161991BDE692B10101"
+  },
+  {
+    MBEDTLS_ECP_DP_SECP224R1,
+    "F220266E1105BFE3083E03EC7A3A654651F45E37167E88600BF257C1",
+    "test",
+    "AD04DDE87B84747A243A631EA47A1BA6D1FAA059149AD2440DE6FBA6",
+    "178D49B1AE90E3D8B629BE3DB5683915F4E8C99FDF6E666CF37ADCFD"
+  },
+  {
+    MBEDTLS_ECP_DP_SECP256R1,
+    "C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721",
+    "sample",
+    "EFD48B2AACB6A8FD1140DD9CD45E81D69D2C877B56AAF991C34D0EA84EAF3716",
+    "F7CB1C942D657C41D436C7A1B6E29F65F3E900DBB9AFF4064DC4AB2F843ACDA8"
+  },
+  {
+    MBEDTLS_ECP_DP_SECP256R1,
+    "C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721",
+    "test",
+    "F1ABB023518351CD71D881567B1EA663ED3EFCF6C5132B354F28D3B0B7D38367",
+    "019F4113742A2B14BD25926B49C649155F267E60D3814B4C0CC84250E46F0083"
+  }
+};
+
+/***************************************************************************//**
+ * @brief Compare an integer with a hex string
+ ******************************************************************************/
+static bool equalsHex(const mbedtls_mpi *x, const char *hex)
+{
+  bool equal;
+  mbedtls_mpi y;
+
+  mbedtls_mpi_init(&y);
+  equal = (mbedtls_mpi_read_string(&y, 16, hex) == 0)
+          && (mbedtls_mpi_cmp_mpi(x, &y) == 0);
+  mbedtls_mpi_free(&y);
+  return equal;
+}
+
+/***************************************************************************//**
+ * @brief Sign a hash with ecdsaDetSign() and ecdsaDetWriteSignature(), check
+ *   the result against mbedtls_ecdsa_sign_det() and verify it
+ * @return True if (r, s) was computed
+ ******************************************************************************/
+static bool signAndCompare(mbedtls_ecdsa_context *key,
+                           unsigned char *hash, mbedtls_mpi *r,
+                           mbedtls_mpi *s)
+{
+  bool ok;
+  mbedtls_mpi r2;
+  mbedtls_mpi s2;
+  unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+  unsigned char sig2[MBEDTLS_ECDSA_MAX_LEN];
+  size_t sigLen;
+  size_t sigLen2;
+
+  mbedtls_mpi_init(&r2);
+  mbedtls_mpi_init(&s2);
+  ok = (ecdsaDetSign(&key->grp, r, s, &key->d, hash, 32,
+                     MBEDTLS_MD_SHA256) == 0);
+  CHECK(ok);
+  CHECK(mbedtls_ecdsa_sign_det(&key->grp, &r2, &s2, &key->d, hash, 32,
+                               MBEDTLS_MD_SHA256) == 0);
+  CHECK(mbedtls_mpi_cmp_mpi(r, &r2) == 0);
+  CHECK(mbedtls_mpi_cmp_mpi(s, &s2) == 0);
+
+  // The DER signature is deterministic and verifies
+  CHECK(ecdsaDetWriteSignature(key, MBEDTLS_MD_SHA256, hash, 32,
+                               sig, &sigLen) == 0);
+  CHECK(ecdsaDetWriteSignature(key, MBEDTLS_MD_SHA256, hash, 32,
+                               sig2, &sigLen2) == 0);
+  CHECK((sigLen == sigLen2) && (memcmp(sig, sig2, sigLen) == 0));
+  CHECK(mbedtls_ecdsa_read_signature(key, hash, 32, sig, sigLen) == 0);
+  hash[0] ^= 0x01;
+  CHECK(mbedtls_ecdsa_read_signature(key, hash, 32, sig, sigLen) != 0);
+  hash[0] ^= 0x01;
+
+  mbedtls_mpi_free(&r2);
+  mbedtls_mpi_free(&s2);
+  return ok;
+}
+
+/***************************************************************************//**
+ * @brief RFC 6979 known-answer tests
+ ******************************************************************************/
+static void testVectors(void)
+{
+  size_t i;
+  mbedtls_ecdsa_context key;
+  mbedtls_mpi r;
+  mbedtls_mpi s;
+  unsigned char hash[32];
+
+  for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+    mbedtls_ecdsa_init(&key);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    CHECK(mbedtls_ecp_group_load(&key.grp, vectors[i].curve) == 0);
+    CHECK(mbedtls_mpi_read_string(&key.d, 16, vectors[i].d) == 0);
+    CHECK(mbedtls_ecp_mul(&key.grp, &key.Q, &key.d, &key.grp.G,
+                          NULL, NULL) == 0);
+    mbedtls_sha256_ret((const unsigned char *)vectors[i].message,
+                       strlen(vectors[i].message), hash, 0);
+    if (signAndCompare(&key, hash, &r, &s)) {
+      CHECK(equalsHex(&r, vectors[i].r));
+      CHECK(equalsHex(&s, vectors[i].s));
+    }
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    mbedtls_ecdsa_free(&key);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Signatures of many hashes with the P-256 key of RFC 6979
+ ******************************************************************************/
+static void testRandomMessages(void)
+{
+  int i;
+  mbedtls_ecdsa_context key;
+  mbedtls_mpi r;
+  mbedtls_mpi s;
+  unsigned char hash[32];
+
+  mbedtls_ecdsa_init(&key);
+  mbedtls_mpi_init(&r);
+  mbedtls_mpi_init(&s);
+  CHECK(mbedtls_ecp_group_load(&key.grp, MBEDTLS_ECP_DP_SECP256R1) == 0);
+  CHECK(mbedtls_mpi_read_string(&key.d, 16, vectors[4].d) == 0);
+  CHECK(mbedtls_ecp_mul(&key.grp, &key.Q, &key.d, &key.grp.G,
+                        NULL, NULL) == 0);
+
+  memset(hash, 0, sizeof(hash));
+  for (i = 0; i < RANDOM_MESSAGES; i++) {
+    mbedtls_sha256_ret(hash, sizeof(hash), hash, 0);
+    signAndCompare(&key, hash, &r, &s);
+  }
+
+  mbedtls_mpi_free(&r);
+  mbedtls_mpi_free(&s);
+  mbedtls_ecdsa_free(&key);
+}
+
+/***************************************************************************//**
+ * @brief Invalid private keys and hash algorithms are rejected
+ ******************************************************************************/
+static void testBadInput(void)
+{
+  mbedtls_ecp_group grp;
+  mbedtls_mpi d;
+  mbedtls_mpi r;
+  mbedtls_mpi s;
+  unsigned char hash[32] = { 0 };
+
+  mbedtls_ecp_group_init(&grp);
+  mbedtls_mpi_init(&d);
+  mbedtls_mpi_init(&r);
+  mbedtls_mpi_init(&s);
+  CHECK(mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1) == 0);
+
+  mbedtls_mpi_lset(&d, 0);
+  CHECK(ecdsaDetSign(&grp, &r, &s, &d, hash, 32, MBEDTLS_MD_SHA256)
+        == MBEDTLS_ERR_ECP_BAD_INPUT_DATA);
+  mbedtls_mpi_copy(&d, &grp.N);
+  CHECK(ecdsaDetSign(&grp, &r, &s, &d, hash, 32, MBEDTLS_MD_SHA256)
+        == MBEDTLS_ERR_ECP_BAD_INPUT_DATA);
+  mbedtls_mpi_lset(&d, 1);
+  CHECK(ecdsaDetSign(&grp, &r, &s, &d, hash, 32, MBEDTLS_MD_NONE)
+        == MBEDTLS_ERR_ECP_BAD_INPUT_DATA);
+  CHECK(ecdsaDetSign(&grp, &r, &s, &d, hash, 32, MBEDTLS_MD_SHA256) == 0);
+
+  mbedtls_mpi_free(&d);
+  mbedtls_mpi_free(&r);
+  mbedtls_mpi_free(&s);
+  mbedtls_ecp_group_free(&grp);
+}
+
+int main(void)
+{
+  testVectors();
+  testRandomMessages();
+  testBadInput();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
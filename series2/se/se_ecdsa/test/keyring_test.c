@@ -0,0 +1,253 @@
+/***************************************************************************//**
+ * @file keyring_test.c
+ * @brief Host test of ecdsa_keyring.c against the RFC 6979 P-256 test vectors
+ * and mbedtls_ecdsa_read_signature()
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory, with the mbed TLS of the
+// Gecko SDK built for the host (make -C <mbedtls> lib). The default mbed TLS
+// configuration has no ECDSA hardware, so the software tables are tested:
+//
+//   gcc -Wall -Wextra -Isrc -I<mbedtls>/include test/keyring_test.c
+//       src/ecdsa_keyring.c -L<mbedtls>/library -lmbedcrypto -o keyring_test
+//   ./keyring_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "ecdsa_keyring.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/sha256.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define RANDOM_SIGNATURES               (200)
+
+static int checks;
+static int failures;
+
+// RFC 6979 A.2.5: P-256 public key and the SHA-256 signatures of "sample"
+// and "test"
+static const char *vectorQx =
+  "60FED4BA255A9D31C961EB74C6356D68C049B8923B61FA6CE669622E60F29FB6";
+static const char *vectorQy =
+  "7903FE1008B8BC99A41AE9E95628BC64F2F1B20C2D7E9F5177A3C294D4462299";
+static const char *vectors[2][3] = {
+  {
+    "sample",
+    "EFD48B2AACB6A8FD1140DD9CD45E81D69D2C877B56AAF991C34D0EA84EAF3716",
+    "F7CB1C942D657C41D436C7A1B6E29F65F3E900DBB9AFF4064DC4AB2F843ACDA8"
+  },
+  {
+    "test",
+    "F1ABB023518351CD71D881567B1EA663ED3EFCF6C5132B354F28D3B0B7D38367",
+    "019F4113742A2B14BD25926B49C649155F267E60D3814B4C0CC84250E46F0083"
+  }
+};
+
+/***************************************************************************//**
+ * @brief Random number generator for key generation and signing. Not
+ *   cryptographically secure, but repeatable.
+ ******************************************************************************/
+static int testRandom(void *state, unsigned char *output, size_t length)
+{
+  (void)state;
+  while (length--) {
+    *output++ = (unsigned char)rand();
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief Parse a hex string into bytes
+ ******************************************************************************/
+static void hexToBytes(const char *hex, unsigned char *output, size_t length)
+{
+  size_t i;
+
+  for (i = 0; i < length; i++) {
+    sscanf(hex + 2 * i, "%2hhx", &output[i]);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Known-answer signatures, tampered inputs and invalid keys
+ ******************************************************************************/
+static void testVectors(void)
+{
+  unsigned char publicKey[65];
+  unsigned char hash[32];
+  mbedtls_mpi r;
+  mbedtls_mpi s;
+  int slot;
+  int unused;
+  int i;
+
+  publicKey[0] = 0x04;
+  hexToBytes(vectorQx, publicKey + 1, 32);
+  hexToBytes(vectorQy, publicKey + 33, 32);
+  CHECK(keyringAdd(publicKey, sizeof(publicKey), &slot) == 0);
+
+  mbedtls_mpi_init(&r);
+  mbedtls_mpi_init(&s);
+  for (i = 0; i < 2; i++) {
+    mbedtls_sha256_ret((const unsigned char *)vectors[i][0],
+                       strlen(vectors[i][0]), hash, 0);
+    mbedtls_mpi_read_string(&r, 16, vectors[i][1]);
+    mbedtls_mpi_read_string(&s, 16, vectors[i][2]);
+    CHECK(keyringVerifyRaw(slot, hash, 32, &r, &s) == 0);
+    CHECK(keyringVerifyRaw(slot, hash, 32, &s, &r)
+          == MBEDTLS_ERR_ECP_VERIFY_FAILED);
+    hash[5] ^= 0x01;
+    CHECK(keyringVerifyRaw(slot, hash, 32, &r, &s)
+          == MBEDTLS_ERR_ECP_VERIFY_FAILED);
+  }
+
+  // r out of range
+  mbedtls_mpi_lset(&r, 0);
+  CHECK(keyringVerifyRaw(slot, hash, 32, &r, &s)
+        == MBEDTLS_ERR_ECP_VERIFY_FAILED);
+
+  // A point that is not on the curve is rejected, and so are unused slots
+  publicKey[40] ^= 0x01;
+  CHECK(keyringAdd(publicKey, sizeof(publicKey), &unused) != 0);
+  CHECK(keyringVerifyRaw(slot + 1, hash, 32, &r, &s)
+        == KEYRING_ERR_BAD_INPUT_DATA);
+  CHECK(keyringVerifyRaw(-1, hash, 32, &r, &s) == KEYRING_ERR_BAD_INPUT_DATA);
+  CHECK(keyringVerifyRaw(KEYRING_SLOTS, hash, 32, &r, &s)
+        == KEYRING_ERR_BAD_INPUT_DATA);
+  mbedtls_mpi_free(&r);
+  mbedtls_mpi_free(&s);
+
+  CHECK(keyringRemove(slot) == 0);
+}
+
+/***************************************************************************//**
+ * @brief Random keys and signatures: the keyring must agree with
+ *   mbedtls_ecdsa_read_signature(), and reject other keys
+ ******************************************************************************/
+static void testRandomSignatures(void)
+{
+  mbedtls_ecdsa_context key[KEYRING_SLOTS];
+  unsigned char publicKey[65];
+  unsigned char hash[48];
+  unsigned char signature[MBEDTLS_ECDSA_MAX_LEN];
+  size_t signatureLen;
+  size_t hashLen;
+  size_t keyLen;
+  int slots[KEYRING_SLOTS];
+  int slot;
+  int expected;
+  int i;
+  int k;
+
+  for (i = 0; i < KEYRING_SLOTS; i++) {
+    mbedtls_ecdsa_init(&key[i]);
+    CHECK(mbedtls_ecdsa_genkey(&key[i], MBEDTLS_ECP_DP_SECP256R1,
+                               testRandom, NULL) == 0);
+    CHECK(mbedtls_ecp_point_write_binary(&key[i].grp, &key[i].Q,
+                                         MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                         &keyLen, publicKey,
+                                         sizeof(publicKey)) == 0);
+    CHECK(keyringAdd(publicKey, keyLen, &slots[i]) == 0);
+  }
+  CHECK(keyringAdd(publicKey, keyLen, &slot) == KEYRING_ERR_FULL);
+
+  // Hashes shorter and longer than the curve order are both used
+  for (k = 0; k < RANDOM_SIGNATURES; k++) {
+    i = k % KEYRING_SLOTS;
+    hashLen = (k % 3 == 0) ? 48 : ((k % 3 == 1) ? 20 : 32);
+    testRandom(NULL, hash, hashLen);
+    CHECK(mbedtls_ecdsa_write_signature(&key[i], MBEDTLS_MD_SHA256,
+                                        hash, hashLen,
+                                        signature, &signatureLen,
+                                        testRandom, NULL) == 0);
+    if (k % 5 == 1) {
+      hash[0] ^= 0x80;
+    } else if (k % 5 == 2) {
+      signature[signatureLen - 1] ^= 0x01;
+    }
+    expected = mbedtls_ecdsa_read_signature(&key[i], hash, hashLen,
+                                            signature, signatureLen);
+    CHECK((expected == 0) == ((k % 5 != 1) && (k % 5 != 2)));
+    CHECK((keyringVerify(slots[i], hash, hashLen, signature, signatureLen)
+           == 0) == (expected == 0));
+    CHECK(keyringVerify(slots[(i + 1) % KEYRING_SLOTS], hash, hashLen,
+                        signature, signatureLen) != 0);
+  }
+
+  // Invalid DER encodings
+  CHECK(keyringVerify(slots[0], hash, 32, signature, signatureLen - 1)
+        == KEYRING_ERR_BAD_INPUT_DATA);
+  CHECK(keyringVerify(slots[0], hash, 32, (const unsigned char *)"\x30\x00", 2)
+        == KEYRING_ERR_BAD_INPUT_DATA);
+
+  // A removed slot is rejected and then reused
+  CHECK(keyringRemove(slots[1]) == 0);
+  CHECK(keyringRemove(slots[1]) == KEYRING_ERR_BAD_INPUT_DATA);
+  CHECK(keyringVerify(slots[1], hash, 32, signature, signatureLen)
+        == KEYRING_ERR_BAD_INPUT_DATA);
+  CHECK(keyringAdd(publicKey, keyLen, &slot) == 0);
+  CHECK(slot == slots[1]);
+
+  for (i = 0; i < KEYRING_SLOTS; i++) {
+    mbedtls_ecdsa_free(&key[i]);
+  }
+}
+
+int main(void)
+{
+  srand(1);
+  CHECK(keyringInit(MBEDTLS_ECP_DP_SECP256R1) == 0);
+  printf("Keyring backend: %s\n", keyringBackendName());
+
+  testVectors();
+  testRandomSignatures();
+
+  // Freeing twice must be harmless
+  keyringFree();
+  keyringFree();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
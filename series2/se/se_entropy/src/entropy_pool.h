@@ -0,0 +1,115 @@
+/***************************************************************************//**
+ * @file entropy_pool.h
+ * @brief Buffered TRNG entropy pool with health tests and CTR-DRBG
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef ENTROPY_POOL_H
+#define ENTROPY_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Size of the RAM pool of health-tested raw TRNG bytes
+#define ENTROPY_POOL_SIZE               (256)
+
+// Maximum number of bytes read from the TRNG by one entropyPoolRefill() call
+#define ENTROPY_POOL_REFILL_CHUNK       (64)
+
+// Raw bytes discarded through the health tests before the pool is first used
+#define ENTROPY_POOL_STARTUP_SAMPLES    (1024)
+
+// Raw bytes hashed into each byte of DRBG seed material. The health test
+// cutoffs below assume at least 4 bits of min-entropy per raw byte.
+#define ENTROPY_POOL_OVERSAMPLE         (2)
+
+// Repetition Count Test cutoff, 1 + ceil(20 / H) for H = 4 (alpha = 2^-20)
+#define ENTROPY_POOL_RCT_CUTOFF         (6)
+
+// Adaptive Proportion Test window and cutoff for H = 4 (alpha = 2^-20)
+#define ENTROPY_POOL_APT_WINDOW         (512)
+#define ENTROPY_POOL_APT_CUTOFF         (62)
+
+// Number of DRBG requests between two reseeds from the pool
+#define ENTROPY_POOL_RESEED_INTERVAL    (256)
+
+// Returned if the pool has not been initialized or the arguments are invalid
+#define ENTROPY_POOL_ERR_BAD_INPUT_DATA (-0x5D00)
+
+// Returned once a health test has failed, until entropyPoolInit() is called
+#define ENTROPY_POOL_ERR_HEALTH         (-0x5C80)
+
+// Health state of the noise source, latched on the first failure
+typedef enum {
+  ENTROPY_POOL_HEALTH_OK = 0,           // All tests passed so far
+  ENTROPY_POOL_HEALTH_RCT_FAIL,         // Repetition Count Test failed
+  ENTROPY_POOL_HEALTH_APT_FAIL,         // Adaptive Proportion Test failed
+  ENTROPY_POOL_HEALTH_SOURCE_FAIL       // The TRNG returned an error
+} entropyPoolHealth_TypeDef;
+
+// Throughput, latency and health counters
+typedef struct {
+  uint32_t trngBytes;           // Raw bytes read from the TRNG
+  uint32_t trngCycles;          // Core cycles spent reading them
+  uint32_t requests;            // entropyGetRandom() calls
+  uint32_t randomBytes;         // Bytes returned by entropyGetRandom()
+  uint32_t lastCycles;          // Latency of the last entropyGetRandom() call
+  uint32_t maxCycles;           // Worst entropyGetRandom() latency
+  uint32_t reseeds;             // Seed material requests from the DRBG
+  uint32_t stalls;              // Reseeds that had to read the TRNG in line
+  uint32_t rctFailures;         // Repetition Count Test failures
+  uint32_t aptFailures;         // Adaptive Proportion Test failures
+  entropyPoolHealth_TypeDef health;
+} entropyPoolStats_TypeDef;
+
+// Noise source, same signature as mbedtls_hardware_poll()
+typedef int (*entropyPoolSource_TypeDef)(void *context,
+                                         unsigned char *output,
+                                         size_t length,
+                                         size_t *outputLength);
+
+int entropyPoolInit(entropyPoolSource_TypeDef source, void *context);
+int entropyPoolRefill(void);
+int entropyGetRandom(void *rng, unsigned char *output, size_t length);
+uint32_t entropyPoolLevel(void);
+void entropyPoolStatsGet(entropyPoolStats_TypeDef *stats);
+void entropyPoolFree(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENTROPY_POOL_H
@@ -39,7 +39,8 @@
 #include "em_device.h"
 #include "em_emu.h"
 #include "retargetserial.h"
-#include "mbedtls/entropy.h"
+#include "entropy_pool.h"
+#include "mbedtls/entropy_poll.h"
 #include <inttypes.h>
 #include <stdio.h>
 
@@ -73,7 +74,63 @@ static void setupPushButton0(void)
 }
 
 /***************************************************************************//**
- * @brief Generate random number through TRNG with mbed TLS entropy functions
+ * @brief Start the entropy service and fill the pool from the TRNG
+ * @return true if successful and false otherwise.
+ ******************************************************************************/
+static bool startEntropyService(void)
+{
+  int ret;                              // Return code
+  uint32_t cycles;                      // Cycle counter
+
+  mbedtls_printf("  . Starting entropy service (start-up tests, pool fill, "
+                 "DRBG seed)...");
+
+  DWT->CYCCNT = 0;
+  if ((ret = entropyPoolInit(mbedtls_hardware_poll, NULL)) != 0) {
+    mbedtls_printf(" failed\n  ! entropyPoolInit returned %d\n", ret);
+    return false;
+  }
+  cycles = DWT->CYCCNT;
+
+  mbedtls_printf(" ok  (cycles: %" PRIu32 " time: %" PRIu32 " us)\n",
+                 cycles,
+                 (cycles * 1000) / (CMU_ClockFreqGet(cmuClock_HCLK) / 1000));
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief Print throughput, latency and health of the entropy service
+ ******************************************************************************/
+static void printEntropyStats(void)
+{
+  uint32_t hclk = CMU_ClockFreqGet(cmuClock_HCLK);
+  entropyPoolStats_TypeDef stats;
+
+  entropyPoolStatsGet(&stats);
+
+  if (stats.trngCycles != 0) {
+    mbedtls_printf("  . TRNG: %" PRIu32 " bytes, %" PRIu32 " bytes/s\n",
+                   stats.trngBytes,
+                   (uint32_t)(((uint64_t)stats.trngBytes * hclk)
+                              / stats.trngCycles));
+  }
+  mbedtls_printf("  . Random: %" PRIu32 " requests, latency last %" PRIu32
+                 " us max %" PRIu32 " us\n",
+                 stats.requests,
+                 (uint32_t)(((uint64_t)stats.lastCycles * 1000000) / hclk),
+                 (uint32_t)(((uint64_t)stats.maxCycles * 1000000) / hclk));
+  mbedtls_printf("  . Pool: %" PRIu32 "/%d bytes, %" PRIu32 " reseeds, %"
+                 PRIu32 " stalls\n",
+                 entropyPoolLevel(), ENTROPY_POOL_SIZE,
+                 stats.reseeds, stats.stalls);
+  mbedtls_printf("  . Health: %s (RCT failures: %" PRIu32
+                 ", APT failures: %" PRIu32 ")\n",
+                 stats.health == ENTROPY_POOL_HEALTH_OK ? "ok" : "FAILED",
+                 stats.rctFailures, stats.aptFailures);
+}
+
+/***************************************************************************//**
+ * @brief Generate random number from the entropy service
  * @return true if successful and false otherwise.
  ******************************************************************************/
 static bool generateEntropyRandom(void)
@@ -81,23 +138,14 @@ static bool generateEntropyRandom(void)
   int ret;                              // Return code
   uint32_t i;
   uint32_t cycles;                      // Cycle counter
-  mbedtls_entropy_context entropy;      // Entropy context
 
   mbedtls_printf("  . Generating random number...");
 
-  // Initialize and gather entropy sources
-  mbedtls_entropy_init(&entropy);
-  mbedtls_entropy_gather(&entropy);
-
-  // Generate random number with mbedtls_entropy_func()
+  // Served by the DRBG, the TRNG is only read by the idle-time refill
   DWT->CYCCNT = 0;
-  for (i = 0; i < KEY_SIZE / MBEDTLS_ENTROPY_BLOCK_SIZE; i++) {
-    if ((ret = mbedtls_entropy_func(&entropy,
-                                    &randomNum[i * MBEDTLS_ENTROPY_BLOCK_SIZE],
-                                    MBEDTLS_ENTROPY_BLOCK_SIZE)) != 0) {
-      mbedtls_printf(" failed\n  ! mbedtls_entropy_func returned %d\n", ret);
-      return false;
-    }
+  if ((ret = entropyGetRandom(NULL, randomNum, KEY_SIZE)) != 0) {
+    mbedtls_printf(" failed\n  ! entropyGetRandom returned %d\n", ret);
+    return false;
   }
   cycles = DWT->CYCCNT;
 
@@ -113,9 +161,6 @@ static bool generateEntropyRandom(void)
     mbedtls_printf("  %d", randomNum[i]);
   }
   mbedtls_printf("\n");
-
-  // Clear entropy context to exit
-  mbedtls_entropy_free(&entropy);
   return true;
 }
 
@@ -148,17 +193,26 @@ int main(void)
   // Setup PB0
   setupPushButton0();
 
+  // Start the entropy service
+  mbedtls_printf("\nCore running at %" PRIu32 " kHz.\n",
+                 CMU_ClockFreqGet(cmuClock_HCLK) / 1000);
+  startEntropyService();
+
   // Wait forever in EM1 for PB0 press to generate random number
   while (1) {
-    mbedtls_printf("\nCore running at %" PRIu32 " kHz.\n",
-                   CMU_ClockFreqGet(cmuClock_HCLK) / 1000);
-    mbedtls_printf("Press PB0 to generate %d random numbers "
+    mbedtls_printf("\nPress PB0 to generate %d random numbers "
                    "(TRNG + mbed TLS).\n", KEY_SIZE);
 
+    // Top up the pool before sleeping so that requests do not wait on the TRNG
+    while (entropyPoolRefill() > 0) {
+    }
+
     // Wait key press
     EMU_EnterEM1();
 
     // Generate random number
-    generateEntropyRandom();
+    if (generateEntropyRandom()) {
+      printEntropyStats();
+    }
   }
 }
@@ -0,0 +1,16 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// Only the cycle counter is needed. The test advances it.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+typedef struct {
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+extern DWT_Type hostDwt;
+
+#define DWT                             (&hostDwt)
+
+#endif // EM_DEVICE_H
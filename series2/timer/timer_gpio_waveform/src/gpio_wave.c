@@ -0,0 +1,269 @@
+/***************************************************************************//**
+ * @file gpio_wave.c
+ * @brief GPIO waveform engine, plays a bit stream on GPIO pins with a TIMER
+ * triggered LDMA channel
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_ldma.h"
+#include "em_timer.h"
+#include "gpio_wave.h"
+
+// A waveform is encoded into one word per slot, and TIMER0 overflows once
+// per slot. Each overflow triggers one LDMA word transfer to the GPIO port,
+// so the edges are as regular as the timer, with the same LDMA latency for
+// each slot, while interrupts stay enabled and the core is free.
+//
+// Series 2 has set and clear aliases of DOUT, but an LDMA descriptor writes
+// one fixed address, so the encoder uses the toggle alias instead. A slot
+// word is the pins to toggle, 0 if the level does not change, and the other
+// pins of the port are not touched. In gpioWaveDout mode the full DOUT value
+// is written, which can drive different levels on several pins at once.
+
+#define MAX_XFER        ((_LDMA_CH_CTRL_XFERCNT_MASK >> _LDMA_CH_CTRL_XFERCNT_SHIFT) + 1)
+
+static gpioWaveInit_TypeDef config;
+static LDMA_Descriptor_t descriptors[GPIO_WAVE_MAX_DESCRIPTORS];
+static volatile bool playing;
+
+/***************************************************************************//**
+ * @brief Port word for one slot, given the level of the previous slot
+ ******************************************************************************/
+static uint32_t slotWord(const gpioWaveInit_TypeDef *init,
+                         uint32_t high,
+                         uint32_t *level)
+{
+  uint32_t word;
+
+  if (init->mode == gpioWaveToggle) {
+    word = (high != *level) ? init->pins : 0;
+  } else {
+    word = high ? (init->base | init->pins) : (init->base & ~init->pins);
+  }
+  *level = high;
+  return word;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Encode a bit stream into port words for gpioWavePlay().
+ *
+ * @details
+ *   Bits are sent most significant bit of each byte first. The pins are low
+ *   before the first slot, and the last word returns them to low.
+ *
+ * @param[in] init
+ *   Configuration, as later given to gpioWaveInit().
+ *
+ * @param[in] format
+ *   Slots per bit and the levels of a 0 and a 1 bit.
+ *
+ * @param[in] data
+ *   Bits to send.
+ *
+ * @param[in] bits
+ *   Number of bits to send.
+ *
+ * @param[out] words
+ *   Port words, GPIO_WAVE_WORDS(bits, format->slots) are written.
+ *
+ * @param[in] size
+ *   Size of words, in words.
+ *
+ * @return
+ *   Number of words, GPIO_WAVE_ERR_PARAM or GPIO_WAVE_ERR_SPACE on failure.
+ ******************************************************************************/
+int gpioWaveEncode(const gpioWaveInit_TypeDef *init,
+                   const gpioWaveFormat_TypeDef *format,
+                   const uint8_t *data,
+                   uint32_t bits,
+                   uint32_t *words,
+                   uint32_t size)
+{
+  uint32_t slots = format->slots;
+  uint32_t count = 0;
+  uint32_t level = 0;
+  uint32_t levels;
+  uint32_t i;
+  uint32_t s;
+
+  if (slots == 0 || slots > GPIO_WAVE_MAX_SLOTS || init->pins == 0
+      || init->mode > gpioWaveDout) {
+    return GPIO_WAVE_ERR_PARAM;
+  }
+  if (size == 0 || bits > (size - 1) / slots) {
+    return GPIO_WAVE_ERR_SPACE;
+  }
+
+  for (i = 0; i < bits; i++) {
+    levels = (data[i >> 3] & (0x80 >> (i & 7))) ? format->one : format->zero;
+    for (s = 0; s < slots; s++) {
+      words[count++] = slotWord(init, (levels >> s) & 1, &level);
+    }
+  }
+  words[count++] = slotWord(init, 0, &level);
+
+  return (int)count;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Configure the pins, TIMER0 and the LDMA.
+ *
+ * @details
+ *   The pins are set to push-pull and low. LDMA_Init() is called, so other
+ *   LDMA channels must be set up after this.
+ *
+ * @param[in] init
+ *   Configuration.
+ *
+ * @return
+ *   Slot rate in Hz, the timer clock divided by a whole number.
+ ******************************************************************************/
+uint32_t gpioWaveInit(const gpioWaveInit_TypeDef *init)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+  uint32_t freq;
+  uint32_t top;
+  uint32_t pin;
+
+  config = *init;
+  playing = false;
+
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+
+  if (config.mode == gpioWaveDout) {
+    GPIO_PortOutSetVal(config.port, config.base & ~config.pins, _GPIO_P_DOUT_MASK);
+  }
+  for (pin = 0; pin < 16; pin++) {
+    if (config.pins & (1UL << pin)) {
+      GPIO_PinModeSet(config.port, pin, gpioModePushPull, 0);
+    }
+  }
+
+  // Overflow once per slot, each overflow requests one LDMA transfer. The
+  // transfer writes the GPIO and never touches the TIMER, so the request
+  // has to be cleared when the LDMA serves it, or the LDMA sends the whole
+  // buffer in one burst.
+  timerInit.enable = false;
+  timerInit.dmaClrAct = true;
+  TIMER_Init(TIMER0, &timerInit);
+  freq = CMU_ClockFreqGet(cmuClock_TIMER0);
+  top = (freq + config.slotHz / 2) / config.slotHz;
+  if (top < 2) {
+    top = 2;
+  }
+  TIMER_TopSet(TIMER0, top - 1);
+
+  LDMA_Init(&ldmaInit);
+
+  return freq / top;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start sending a waveform.
+ *
+ * @details
+ *   The first word is written one slot after the call. The words must not
+ *   change until gpioWaveBusy() returns false. The LDMA done interrupt flag
+ *   of the channel is set when the last word has been written.
+ *
+ * @param[in] words
+ *   Port words from gpioWaveEncode().
+ *
+ * @param[in] count
+ *   Number of words, up to GPIO_WAVE_MAX_WORDS.
+ *
+ * @return
+ *   0 on success, GPIO_WAVE_ERR_PARAM or GPIO_WAVE_ERR_BUSY on failure.
+ ******************************************************************************/
+int gpioWavePlay(const uint32_t *words, uint32_t count)
+{
+  LDMA_TransferCfg_t transferConfig =
+    LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_TIMER0_UFOF);
+  volatile uint32_t *dest;
+  uint32_t chunk;
+  uint32_t i;
+
+  if (count == 0 || count > GPIO_WAVE_MAX_WORDS) {
+    return GPIO_WAVE_ERR_PARAM;
+  }
+  if (gpioWaveBusy()) {
+    return GPIO_WAVE_ERR_BUSY;
+  }
+
+  if (config.mode == gpioWaveToggle) {
+    dest = &GPIO->P_TGL[config.port].DOUT;
+  } else {
+    dest = &GPIO->P[config.port].DOUT;
+  }
+
+  // One linked descriptor per MAX_XFER words, done flag on the last one
+  for (i = 0; count > 0; i++) {
+    chunk = (count > MAX_XFER) ? MAX_XFER : count;
+    descriptors[i] = (LDMA_Descriptor_t)
+                     LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(words, dest, chunk, 1);
+    descriptors[i].xfer.size = ldmaCtrlSizeWord;
+    descriptors[i].xfer.doneIfs = 0;
+    words += chunk;
+    count -= chunk;
+  }
+  descriptors[i - 1].xfer.link = 0;
+  descriptors[i - 1].xfer.doneIfs = 1;
+
+  TIMER_Enable(TIMER0, false);
+  TIMER_CounterSet(TIMER0, 0);
+  playing = true;
+  LDMA_StartTransfer(config.ldmaChannel, &transferConfig, descriptors);
+  TIMER_Enable(TIMER0, true);
+
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check whether a waveform is being sent, and stop the timer once done.
+ ******************************************************************************/
+bool gpioWaveBusy(void)
+{
+  if (playing && LDMA_TransferDone(config.ldmaChannel)) {
+    TIMER_Enable(TIMER0, false);
+    playing = false;
+  }
+  return playing;
+}
@@ -0,0 +1,109 @@
+/***************************************************************************//**
+ * @file gpio_wave.h
+ * @brief GPIO waveform engine, plays a bit stream on GPIO pins with a TIMER
+ * triggered LDMA channel
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef GPIO_WAVE_H
+#define GPIO_WAVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "em_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Each data bit is sent as a fixed number of slots of one timer period. The
+// words of a waveform are written to the GPIO port one per slot, plus one
+// word at the end that returns the pins to low.
+#define GPIO_WAVE_MAX_SLOTS             (8)
+#define GPIO_WAVE_WORDS(bits, slots)    ((bits) * (slots) + 1)
+
+// Longest waveform, in words, that one gpioWavePlay() can send
+#define GPIO_WAVE_MAX_DESCRIPTORS       (4)
+#define GPIO_WAVE_MAX_WORDS             (GPIO_WAVE_MAX_DESCRIPTORS * 2048)
+
+// Invalid format, configuration or length
+#define GPIO_WAVE_ERR_PARAM             (-0x5400)
+// The output buffer is too small for the waveform
+#define GPIO_WAVE_ERR_SPACE             (-0x5380)
+// A waveform is still playing
+#define GPIO_WAVE_ERR_BUSY              (-0x5300)
+
+typedef enum {
+  gpioWaveToggle,                       // Words are written to the port
+                                        // toggle register, so the other pins
+                                        // of the port are not changed
+  gpioWaveDout,                         // Words are written to the port DOUT
+                                        // register, the other pins are set
+                                        // to the base levels
+} gpioWaveMode_TypeDef;
+
+// Levels of the slots of a 0 and a 1 bit, bit 0 is the first slot
+typedef struct {
+  uint8_t slots;
+  uint8_t zero;
+  uint8_t one;
+} gpioWaveFormat_TypeDef;
+
+// WS2812 LEDs at 800 kbit/s: 3 slots per bit at a slot rate of 2.4 MHz,
+// a 0 bit is high for 417 ns and a 1 bit is high for 833 ns
+#define GPIO_WAVE_FORMAT_WS2812         { 3, 0x1, 0x3 }
+#define GPIO_WAVE_WS2812_SLOT_HZ        (2400000)
+
+typedef struct {
+  GPIO_Port_TypeDef port;
+  uint32_t pins;                        // Pins that send the waveform
+  uint32_t base;                        // gpioWaveDout: levels of other pins
+  gpioWaveMode_TypeDef mode;
+  uint32_t slotHz;                      // Slot rate
+  unsigned int ldmaChannel;
+} gpioWaveInit_TypeDef;
+
+int gpioWaveEncode(const gpioWaveInit_TypeDef *init,
+                   const gpioWaveFormat_TypeDef *format,
+                   const uint8_t *data,
+                   uint32_t bits,
+                   uint32_t *words,
+                   uint32_t size);
+uint32_t gpioWaveInit(const gpioWaveInit_TypeDef *init);
+int gpioWavePlay(const uint32_t *words, uint32_t count);
+bool gpioWaveBusy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPIO_WAVE_H
@@ -0,0 +1,170 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief This project sends a moving rainbow to a strip of WS2812 LEDs.
+ * The waveform is played out on a GPIO pin by an LDMA channel triggered by
+ * TIMER0 overflows, with interrupts enabled. See readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_chip.h"
+#include "em_gpio.h"
+#include "em_ldma.h"
+#include "gpio_wave.h"
+
+// Note: change these to match the LED strip
+#define NUM_LEDS      8
+#define BRIGHTNESS    32
+
+// Time between frames in ms, longer than the WS2812 reset time
+#define FRAME_MS      20
+
+// Data pin, PA6 (Expansion Header Pin 14), and LDMA channel
+#define WAVE_PORT     gpioPortA
+#define WAVE_PIN      6
+#define WAVE_CH       0
+
+#define FRAME_BITS    (NUM_LEDS * 24)
+#define FRAME_WORDS   GPIO_WAVE_WORDS(FRAME_BITS, 3)
+
+static const gpioWaveInit_TypeDef waveInit = {
+  .port = WAVE_PORT,
+  .pins = 1 << WAVE_PIN,
+  .base = 0,
+  .mode = gpioWaveToggle,
+  .slotHz = GPIO_WAVE_WS2812_SLOT_HZ,
+  .ldmaChannel = WAVE_CH,
+};
+
+static const gpioWaveFormat_TypeDef ws2812 = GPIO_WAVE_FORMAT_WS2812;
+
+// Two frames, one is encoded while the other is sent
+static uint32_t frames[2][FRAME_WORDS];
+
+// Slot rate that the timer could be set to, for viewing in the debugger
+uint32_t slotHz;
+
+static volatile uint32_t msTicks;
+
+/**************************************************************************//**
+ * @brief
+ *    SysTick interrupt, keeps running while a frame is sent
+ *****************************************************************************/
+void SysTick_Handler(void)
+{
+  msTicks++;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    LDMA interrupt, only wakes the core when a frame has been sent
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  LDMA_IntClear(LDMA_IntGet());
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Color wheel, hue 0 to 255 to G, R, B
+ *****************************************************************************/
+static void wheel(uint8_t hue, uint8_t *grb)
+{
+  uint32_t up = (uint32_t)(hue % 85) * 3 * BRIGHTNESS / 255;
+  uint32_t down = BRIGHTNESS - up;
+
+  if (hue < 85) {
+    grb[0] = up;
+    grb[1] = down;
+    grb[2] = 0;
+  } else if (hue < 170) {
+    grb[0] = down;
+    grb[1] = 0;
+    grb[2] = up;
+  } else {
+    grb[0] = 0;
+    grb[1] = up;
+    grb[2] = down;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Encode a rainbow starting at hue
+ *****************************************************************************/
+static void encodeFrame(uint8_t hue, uint32_t *words)
+{
+  uint8_t grb[NUM_LEDS * 3];
+
+  for (uint32_t i = 0; i < NUM_LEDS; i++) {
+    wheel(hue + i * 256 / NUM_LEDS, &grb[i * 3]);
+  }
+  gpioWaveEncode(&waveInit, &ws2812, grb, FRAME_BITS, words, FRAME_WORDS);
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint32_t lastFrame;
+  uint32_t next = 0;
+  uint8_t hue = 0;
+
+  // Chip errata
+  CHIP_Init();
+
+  // Configure PA6, TIMER0 and the LDMA, and wake up when a frame is sent
+  slotHz = gpioWaveInit(&waveInit);
+  NVIC_ClearPendingIRQ(LDMA_IRQn);
+  NVIC_EnableIRQ(LDMA_IRQn);
+
+  // Setup SysTick Timer for 1 msec interrupts
+  SysTick_Config(CMU_ClockFreqGet(cmuClock_CORE) / 1000);
+  lastFrame = msTicks;
+
+  while (1) {
+    // Encode the next frame while the current one is sent
+    encodeFrame(hue++, frames[next]);
+
+    // Sleep until the current frame is sent and the frame time has passed
+    while (gpioWaveBusy() || msTicks - lastFrame < FRAME_MS) {
+      EMU_EnterEM1();
+    }
+    lastFrame += FRAME_MS;
+
+    gpioWavePlay(frames[next], FRAME_WORDS);
+    next ^= 1;
+  }
+}
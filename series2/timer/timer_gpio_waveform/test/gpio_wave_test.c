@@ -0,0 +1,339 @@
+/***************************************************************************//**
+ * @file gpio_wave_test.c
+ * @brief Host test of gpio_wave.c: encoding in both modes against a simulated
+ * port, and the LDMA descriptor chain of gpioWavePlay()
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/gpio_wave_test.c src/gpio_wave.c
+//       -o gpio_wave_test
+//   ./gpio_wave_test
+//
+// The emlib functions are implemented here and record the peripheral setup.
+// The encoded words are played on a simulated port, so the pin levels can be
+// checked slot by slot. The program prints one line per failed check and
+// exits with status 1 if any check failed.
+
+#include "em_cmu.h"
+#include "em_ldma.h"
+#include "em_timer.h"
+#include "gpio_wave.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define TIMER_HZ        (38400000UL)
+#define LDMA_CHANNEL    (2)
+#define RANDOM_WAVES    (2000)
+#define DATA_BYTES      (64)
+#define WORDS_SIZE      (GPIO_WAVE_WORDS(DATA_BYTES * 8, GPIO_WAVE_MAX_SLOTS))
+
+static int checks;
+static int failures;
+
+static uint32_t seed = 97;
+
+GPIO_TypeDef hostGpio;
+TIMER_TypeDef hostTimer0;
+
+// Peripheral state set by the emlib functions below
+static uint32_t timerTop;
+static bool timerEnabled;
+static bool pinPushPull[4][16];
+static uint32_t portDout[4];
+static const LDMA_Descriptor_t *ldmaChain;
+static bool ldmaDone = true;
+
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void)clock;
+  (void)enable;
+}
+
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock)
+{
+  (void)clock;
+  return TIMER_HZ;
+}
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin,
+                     GPIO_Mode_TypeDef mode, unsigned int out)
+{
+  (void)mode;
+  pinPushPull[port][pin] = true;
+  portDout[port] = (portDout[port] & ~(1UL << pin)) | ((out & 1) << pin);
+}
+
+void GPIO_PortOutSetVal(GPIO_Port_TypeDef port, uint32_t val, uint32_t mask)
+{
+  portDout[port] = (portDout[port] & ~mask) | (val & mask);
+}
+
+void TIMER_Init(TIMER_TypeDef *timer, const TIMER_Init_TypeDef *init)
+{
+  (void)timer;
+  CHECK(!init->enable);
+  CHECK(init->dmaClrAct);
+}
+
+void TIMER_TopSet(TIMER_TypeDef *timer, uint32_t val)
+{
+  (void)timer;
+  timerTop = val;
+}
+
+void TIMER_Enable(TIMER_TypeDef *timer, bool enable)
+{
+  (void)timer;
+  timerEnabled = enable;
+}
+
+void TIMER_CounterSet(TIMER_TypeDef *timer, uint32_t val)
+{
+  timer->CNT = val;
+}
+
+void LDMA_Init(const LDMA_Init_t *init)
+{
+  (void)init;
+}
+
+void LDMA_StartTransfer(int ch, const LDMA_TransferCfg_t *transfer,
+                        const LDMA_Descriptor_t *descriptor)
+{
+  CHECK(ch == LDMA_CHANNEL);
+  CHECK(transfer->ldmaReqSel == ldmaPeripheralSignal_TIMER0_UFOF);
+  ldmaChain = descriptor;
+  ldmaDone = false;
+}
+
+bool LDMA_TransferDone(int ch)
+{
+  CHECK(ch == LDMA_CHANNEL);
+  return ldmaDone;
+}
+
+/***************************************************************************//**
+ * @brief Play words on a simulated port, and return the level of the pins
+ * after each word
+ *
+ * @details Checks that only the waveform pins change, that they change
+ * together, and that other pins keep the base levels in gpioWaveDout mode.
+ ******************************************************************************/
+static void portPlay(const gpioWaveInit_TypeDef *init, const uint32_t *words,
+                     int count, uint8_t *levels)
+{
+  uint32_t port = 0;
+
+  for (int i = 0; i < count; i++) {
+    if (init->mode == gpioWaveToggle) {
+      CHECK((words[i] & ~init->pins) == 0);
+      port ^= words[i];
+    } else {
+      CHECK((words[i] & ~init->pins) == (init->base & ~init->pins));
+      port = words[i];
+    }
+    CHECK((port & init->pins) == 0 || (port & init->pins) == init->pins);
+    levels[i] = (port & init->pins) ? 1 : 0;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Random formats, pins and data in both modes, and the buffer size
+ * checks
+ ******************************************************************************/
+static void testEncode(void)
+{
+  static uint32_t words[WORDS_SIZE];
+  static uint8_t levels[WORDS_SIZE];
+  uint8_t data[DATA_BYTES];
+  gpioWaveInit_TypeDef init = {
+    gpioPortA, 0, 0, gpioWaveToggle, GPIO_WAVE_WS2812_SLOT_HZ, LDMA_CHANNEL
+  };
+
+  for (int it = 0; it < 2 * RANDOM_WAVES; it++) {
+    gpioWaveFormat_TypeDef format;
+    uint32_t bits = random32() % (DATA_BYTES * 8);
+    int count;
+
+    init.mode = (it < RANDOM_WAVES) ? gpioWaveToggle : gpioWaveDout;
+    init.pins = (random32() & 0xFFFF) | 1;
+    init.base = random32() & 0xFFFF;
+    format.slots = 1 + random32() % GPIO_WAVE_MAX_SLOTS;
+    format.zero = random32() & ((1 << format.slots) - 1);
+    format.one = random32() & ((1 << format.slots) - 1);
+    for (int i = 0; i < DATA_BYTES; i++) {
+      data[i] = (uint8_t)random32();
+    }
+
+    count = gpioWaveEncode(&init, &format, data, bits, words, WORDS_SIZE);
+    CHECK(count == (int)GPIO_WAVE_WORDS(bits, format.slots));
+    if (count <= 0) {
+      continue;
+    }
+    portPlay(&init, words, count, levels);
+    for (uint32_t b = 0; b < bits; b++) {
+      uint32_t bit = (data[b / 8] >> (7 - b % 8)) & 1;
+      uint32_t slotLevels = bit ? format.one : format.zero;
+
+      for (uint32_t s = 0; s < format.slots; s++) {
+        CHECK(levels[b * format.slots + s] == ((slotLevels >> s) & 1));
+      }
+    }
+    // The pins end low
+    CHECK(levels[count - 1] == 0);
+
+    CHECK(gpioWaveEncode(&init, &format, data, bits, words, count - 1)
+          == GPIO_WAVE_ERR_SPACE);
+  }
+}
+
+/***************************************************************************//**
+ * @brief Invalid formats and sizes, and one WS2812 byte word by word
+ ******************************************************************************/
+static void testWs2812(void)
+{
+  const gpioWaveFormat_TypeDef ws2812 = GPIO_WAVE_FORMAT_WS2812;
+  const gpioWaveFormat_TypeDef noSlots = { 0, 0, 0 };
+  const gpioWaveFormat_TypeDef tooMany = { GPIO_WAVE_MAX_SLOTS + 1, 0, 0 };
+  gpioWaveInit_TypeDef init = {
+    gpioPortA, 1UL << 6, 0, gpioWaveToggle, GPIO_WAVE_WS2812_SLOT_HZ,
+    LDMA_CHANNEL
+  };
+  uint8_t data[1] = { 0x80 };
+  uint32_t words[100];
+  uint32_t expect[25];
+
+  CHECK(gpioWaveEncode(&init, &noSlots, data, 8, words, 100)
+        == GPIO_WAVE_ERR_PARAM);
+  CHECK(gpioWaveEncode(&init, &tooMany, data, 8, words, 100)
+        == GPIO_WAVE_ERR_PARAM);
+  CHECK(gpioWaveEncode(&init, &ws2812, data, 8, words, 0)
+        == GPIO_WAVE_ERR_SPACE);
+  CHECK(gpioWaveEncode(&init, &ws2812, data, 0xFFFFFFFFUL, words, 100)
+        == GPIO_WAVE_ERR_SPACE);
+
+  // A 1 bit is high, high, low: toggle, -, toggle. A 0 bit is high, low,
+  // low: toggle, toggle, -. The end word changes nothing, as the pin is low.
+  memset(expect, 0, sizeof(expect));
+  expect[0] = 1UL << 6;
+  expect[2] = 1UL << 6;
+  for (int b = 1; b < 8; b++) {
+    expect[3 * b] = 1UL << 6;
+    expect[3 * b + 1] = 1UL << 6;
+  }
+  CHECK(gpioWaveEncode(&init, &ws2812, data, 8, words, 100) == 25);
+  CHECK(memcmp(words, expect, sizeof(expect)) == 0);
+}
+
+/***************************************************************************//**
+ * @brief Pin and timer setup, and the descriptor chain of a long and a short
+ * waveform
+ ******************************************************************************/
+static void testPlay(void)
+{
+  static uint32_t words[5000];
+  gpioWaveInit_TypeDef init = {
+    gpioPortA, 1UL << 6, 0, gpioWaveToggle, GPIO_WAVE_WS2812_SLOT_HZ,
+    LDMA_CHANNEL
+  };
+  const LDMA_Descriptor_t *d;
+
+  // 38.4 MHz / 2.4 MHz is 16 timer clocks per slot
+  portDout[gpioPortA] = 1UL << 6;
+  CHECK(gpioWaveInit(&init) == TIMER_HZ / 16 && timerTop == 15);
+  CHECK(pinPushPull[gpioPortA][6] && !(portDout[gpioPortA] & (1UL << 6)));
+
+  CHECK(gpioWavePlay(words, 0) == GPIO_WAVE_ERR_PARAM);
+  CHECK(gpioWavePlay(words, GPIO_WAVE_MAX_WORDS + 1) == GPIO_WAVE_ERR_PARAM);
+
+  // 5000 words take two full descriptors and one of 904 words, linked, with
+  // the done flag only on the last
+  CHECK(gpioWavePlay(words, 5000) == 0 && timerEnabled);
+  CHECK(hostTimer0.CNT == 0);
+  d = ldmaChain;
+  CHECK(d[0].xfer.xferCnt == 2047 && d[1].xfer.xferCnt == 2047);
+  CHECK(d[2].xfer.xferCnt == 903);
+  CHECK(d[0].xfer.srcAddr == words && d[1].xfer.srcAddr == words + 2048);
+  CHECK(d[2].xfer.srcAddr == words + 4096);
+  CHECK(d[0].xfer.link && d[1].xfer.link && !d[2].xfer.link);
+  CHECK(!d[0].xfer.doneIfs && !d[1].xfer.doneIfs && d[2].xfer.doneIfs);
+  for (int i = 0; i < 3; i++) {
+    CHECK(d[i].xfer.size == ldmaCtrlSizeWord);
+    CHECK(d[i].xfer.linkAddr == 4);
+    CHECK(d[i].xfer.dstAddr == &GPIO->P_TGL[gpioPortA].DOUT);
+  }
+
+  CHECK(gpioWaveBusy() && gpioWavePlay(words, 10) == GPIO_WAVE_ERR_BUSY);
+  ldmaDone = true;
+  CHECK(!gpioWaveBusy() && !timerEnabled);
+
+  // gpioWaveDout sets the other pins to the base levels and writes DOUT
+  init.mode = gpioWaveDout;
+  init.port = gpioPortC;
+  init.base = 0x0F0F;
+  init.pins = 0x0003;
+  gpioWaveInit(&init);
+  CHECK(portDout[gpioPortC] == 0x0F0C);
+  CHECK(gpioWavePlay(words, 2048) == 0);
+  d = ldmaChain;
+  CHECK(d[0].xfer.xferCnt == 2047 && !d[0].xfer.link && d[0].xfer.doneIfs);
+  CHECK(d[0].xfer.dstAddr == &GPIO->P[gpioPortC].DOUT);
+  ldmaDone = true;
+  CHECK(!gpioWaveBusy());
+}
+
+int main(void)
+{
+  testEncode();
+  testWs2812();
+  testPlay();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,16 @@
+// Host stand-in for em_cmu.h, used by the tests in the parent directory.
+// The functions are implemented by the test.
+#ifndef EM_CMU_H
+#define EM_CMU_H
+
+#include "em_device.h"
+
+typedef enum {
+  cmuClock_GPIO,
+  cmuClock_TIMER0
+} CMU_Clock_TypeDef;
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable);
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock);
+
+#endif // EM_CMU_H
@@ -0,0 +1,32 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// Only the registers and fields used by gpio_wave.c are provided.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  volatile uint32_t DOUT;
+} GPIO_P_TypeDef;
+
+typedef struct {
+  GPIO_P_TypeDef P[4];
+  GPIO_P_TypeDef P_TGL[4];
+} GPIO_TypeDef;
+
+typedef struct {
+  volatile uint32_t CNT;
+} TIMER_TypeDef;
+
+extern GPIO_TypeDef hostGpio;
+extern TIMER_TypeDef hostTimer0;
+
+#define GPIO                            (&hostGpio)
+#define TIMER0                          (&hostTimer0)
+
+#define _GPIO_P_DOUT_MASK               0xFFFFUL
+#define _LDMA_CH_CTRL_XFERCNT_SHIFT     4
+#define _LDMA_CH_CTRL_XFERCNT_MASK      0x7FF0UL
+
+#endif // EM_DEVICE_H
@@ -0,0 +1,23 @@
+// Host stand-in for em_gpio.h, used by the tests in the parent directory.
+// The functions are implemented by the test.
+#ifndef EM_GPIO_H
+#define EM_GPIO_H
+
+#include "em_device.h"
+
+typedef enum {
+  gpioPortA,
+  gpioPortB,
+  gpioPortC,
+  gpioPortD
+} GPIO_Port_TypeDef;
+
+typedef enum {
+  gpioModePushPull
+} GPIO_Mode_TypeDef;
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin,
+                     GPIO_Mode_TypeDef mode, unsigned int out);
+void GPIO_PortOutSetVal(GPIO_Port_TypeDef port, uint32_t val, uint32_t mask);
+
+#endif // EM_GPIO_H
@@ -0,0 +1,61 @@
+// Host stand-in for em_ldma.h, used by the tests in the parent directory.
+// The descriptor has only the fields that gpio_wave.c sets, and the
+// functions are implemented by the test.
+#ifndef EM_LDMA_H
+#define EM_LDMA_H
+
+#include "em_device.h"
+
+typedef enum {
+  ldmaCtrlSizeByte,
+  ldmaCtrlSizeHalf,
+  ldmaCtrlSizeWord
+} LDMA_CtrlSize_t;
+
+typedef enum {
+  ldmaPeripheralSignal_NONE,
+  ldmaPeripheralSignal_TIMER0_UFOF
+} LDMA_PeripheralSignal_t;
+
+typedef struct {
+  int unused;
+} LDMA_Init_t;
+
+typedef struct {
+  LDMA_PeripheralSignal_t ldmaReqSel;
+} LDMA_TransferCfg_t;
+
+typedef union {
+  struct {
+    uint32_t xferCnt;
+    uint32_t size;
+    uint32_t doneIfs;
+    uint32_t link;
+    int32_t linkAddr;
+    const void *srcAddr;
+    volatile void *dstAddr;
+  } xfer;
+} LDMA_Descriptor_t;
+
+#define LDMA_INIT_DEFAULT               { 0 }
+#define LDMA_TRANSFER_CFG_PERIPHERAL(signal) { signal }
+
+#define LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(src, dest, count, linkjmp) \
+  {                                                                 \
+    .xfer = {                                                       \
+      .xferCnt  = (count) - 1,                                      \
+      .size     = ldmaCtrlSizeByte,                                 \
+      .doneIfs  = 1,                                                \
+      .link     = 1,                                                \
+      .linkAddr = (linkjmp) * 4,                                    \
+      .srcAddr  = (src),                                            \
+      .dstAddr  = (dest)                                            \
+    }                                                               \
+  }
+
+void LDMA_Init(const LDMA_Init_t *init);
+void LDMA_StartTransfer(int ch, const LDMA_TransferCfg_t *transfer,
+                        const LDMA_Descriptor_t *descriptor);
+bool LDMA_TransferDone(int ch);
+
+#endif // EM_LDMA_H
@@ -0,0 +1,20 @@
+// Host stand-in for em_timer.h, used by the tests in the parent directory.
+// The functions are implemented by the test.
+#ifndef EM_TIMER_H
+#define EM_TIMER_H
+
+#include "em_device.h"
+
+typedef struct {
+  bool enable;
+  bool dmaClrAct;
+} TIMER_Init_TypeDef;
+
+#define TIMER_INIT_DEFAULT              { true, false }
+
+void TIMER_Init(TIMER_TypeDef *timer, const TIMER_Init_TypeDef *init);
+void TIMER_TopSet(TIMER_TypeDef *timer, uint32_t val);
+void TIMER_Enable(TIMER_TypeDef *timer, bool enable);
+void TIMER_CounterSet(TIMER_TypeDef *timer, uint32_t val);
+
+#endif // EM_TIMER_H
@@ -0,0 +1,370 @@
+/***************************************************************************//**
+ * @file crash_dump.c
+ * @brief Post-mortem crash dump of HardFault, watchdog warning and assert
+ * failures, kept in RAM over the reset and then in flash
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_msc.h"
+#include "crash_dump.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// The fault handlers write the dump to a RAM area that the startup code does
+// not initialize, then reset the device. RAM is kept over the reset, so
+// crashDumpInit() finds the dump on the next boot and appends it to a log in
+// the last page of flash, where it stays until crashDumpErase(). Nothing is
+// written to flash from the fault handler, where the MSC or the flash
+// contents may be the cause of the fault.
+//
+// The handlers are entered through short assembler stubs that pass the
+// exception stack frame and R4-R11 as they were at the time of the fault.
+// An assert traps to the HardFault handler with an undefined instruction,
+// so it is captured the same way.
+
+// RAM that the startup code does not initialize. The linker scripts
+// src/wdog_crash_dump.ld (GCC) and src/wdog_crash_dump.icf (IAR) leave
+// .noinit out of the startup initialization.
+#if defined(__ICCARM__)
+#define RETAINED          __no_init
+#elif defined(__GNUC__)
+#define RETAINED          __attribute__((section(".noinit")))
+#else
+#define RETAINED
+#endif
+
+// Flash page that holds the dumps, the last page of the main flash
+#define LOG_PAGE          (FLASH_BASE + FLASH_SIZE - FLASH_PAGE_SIZE)
+#define LOG_SLOTS         (FLASH_PAGE_SIZE / sizeof(crashDump_TypeDef))
+#define ERASED            (0xFFFFFFFFUL)
+
+// Stack frame words, without and with the floating point registers
+#define FRAME_WORDS       (8)
+#define FRAME_FP_WORDS    (26)
+
+static RETAINED crashDump_TypeDef ramDump;
+static volatile uint32_t activeTask = CRASH_DUMP_NO_TASK;
+static const char *volatile assertFile;
+static volatile uint32_t assertLine;
+
+// Called from the exception stubs only
+void crashDumpException(const uint32_t *frame, uint32_t excReturn,
+                        const uint32_t *r4r11, uint32_t reason);
+
+// CRC-32 (IEEE 802.3, reflected) nibble table
+static const uint32_t crcTable[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+  0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+  0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t dumpCrc(const crashDump_TypeDef *dump)
+{
+  const uint8_t *p = (const uint8_t *)dump;
+  uint32_t crc = 0xFFFFFFFFUL;
+  uint32_t i;
+
+  for (i = 0; i < offsetof(crashDump_TypeDef, crc); i++) {
+    crc ^= p[i];
+    crc = (crc >> 4) ^ crcTable[crc & 0xF];
+    crc = (crc >> 4) ^ crcTable[crc & 0xF];
+  }
+  return ~crc;
+}
+
+static bool dumpValid(const crashDump_TypeDef *dump)
+{
+  return dump->magic == CRASH_DUMP_MAGIC
+         && dump->version == CRASH_DUMP_VERSION
+         && dump->size == sizeof(crashDump_TypeDef)
+         && dump->crc == dumpCrc(dump);
+}
+
+static bool inRam(uint32_t addr, uint32_t bytes)
+{
+  return (addr & 3) == 0 && addr >= SRAM_BASE
+         && addr + bytes <= SRAM_BASE + SRAM_SIZE;
+}
+
+/***************************************************************************//**
+ * @brief Save the LDMA state, if the LDMA is clocked
+ ******************************************************************************/
+static void ldmaSave(crashDump_TypeDef *dump)
+{
+  uint32_t i;
+
+#if defined(_CMU_CLKEN0_MASK)
+  if (!(CMU->CLKEN0 & CMU_CLKEN0_LDMA)) {
+    return;
+  }
+#endif
+  dump->ldmaChen = LDMA->CHEN;
+  dump->ldmaChbusy = LDMA->CHBUSY;
+  dump->ldmaChdone = LDMA->CHDONE;
+  dump->ldmaIf = LDMA->IF;
+  for (i = 0; i < CRASH_DUMP_LDMA_CHANNELS && i < DMA_CHAN_COUNT; i++) {
+    dump->ldma[i].ctrl = LDMA->CH[i].CTRL;
+    dump->ldma[i].src = LDMA->CH[i].SRC;
+    dump->ldma[i].dst = LDMA->CH[i].DST;
+    dump->ldma[i].link = LDMA->CH[i].LINK;
+  }
+}
+
+/***************************************************************************//**
+ * @brief Write the dump to RAM and reset
+ *
+ * @param frame Exception stack frame.
+ * @param excReturn EXC_RETURN value of the exception.
+ * @param r4r11 R4-R11 at the time of the exception.
+ * @param reason crashDumpReason_TypeDef.
+ ******************************************************************************/
+void crashDumpException(const uint32_t *frame, uint32_t excReturn,
+                        const uint32_t *r4r11, uint32_t reason)
+{
+  crashDump_TypeDef *dump = &ramDump;
+  uint32_t sp = (uint32_t)frame;
+  uint32_t i;
+
+  // Keep the first dump if the previous one was not saved yet, it is the
+  // one closest to the cause
+  if (!dumpValid(dump)) {
+    memset(dump, 0, sizeof(*dump));
+    dump->magic = CRASH_DUMP_MAGIC;
+    dump->version = CRASH_DUMP_VERSION;
+    dump->size = sizeof(*dump);
+    dump->reason = reason;
+    if (reason == crashDumpReasonHardFault && assertFile != NULL) {
+      dump->reason = crashDumpReasonAssert;
+      dump->line = assertLine;
+      dump->file = (uint32_t)assertFile;
+    }
+
+    for (i = 0; i < 8; i++) {
+      dump->r[4 + i] = r4r11[i];
+    }
+    if (inRam(sp, FRAME_WORDS * 4)) {
+      dump->flags |= CRASH_DUMP_FLAG_FRAME;
+      for (i = 0; i < 4; i++) {
+        dump->r[i] = frame[i];
+      }
+      dump->r[12] = frame[4];
+      dump->lr = frame[5];
+      dump->pc = frame[6];
+      dump->xpsr = frame[7];
+
+      // SP before the exception, above the frame and its alignment word
+      sp += 4 * ((excReturn & (1UL << 4)) ? FRAME_WORDS : FRAME_FP_WORDS);
+      if (dump->xpsr & (1UL << 9)) {
+        sp += 4;
+      }
+      for (i = 0; i < CRASH_DUMP_STACK_WORDS && inRam(sp + 4 * i, 4); i++) {
+        dump->stack[i] = ((const uint32_t *)sp)[i];
+      }
+    }
+    dump->sp = sp;
+    dump->excReturn = excReturn;
+
+    dump->cfsr = SCB->CFSR;
+    dump->hfsr = SCB->HFSR;
+    dump->mmfar = SCB->MMFAR;
+    dump->bfar = SCB->BFAR;
+    dump->task = activeTask;
+    ldmaSave(dump);
+    dump->crc = dumpCrc(dump);
+  }
+
+  if (reason == crashDumpReasonWatchdog) {
+    // Let the watchdog reset the device, so that the reset cause shows it
+    while (1) {
+    }
+  }
+  NVIC_SystemReset();
+}
+
+// Exception stubs: R0 = stack frame, R1 = EXC_RETURN, R2 = saved R4-R11,
+// R3 = reason, the crashDumpReason_TypeDef value
+#define STUB_ASM(reason)                                     \
+  "tst lr, #4\n"                                             \
+  "ite eq\n"                                                 \
+  "mrseq r0, msp\n"                                          \
+  "mrsne r0, psp\n"                                          \
+  "mov r1, lr\n"                                             \
+  "push {r4-r11}\n"                                          \
+  "mov r2, sp\n"                                             \
+  "movs r3, #" #reason "\n"                                  \
+  "b crashDumpException\n"
+
+#if defined(__ICCARM__)
+#define STUB(name, reason) \
+  __stackless void name(void) { __asm volatile (STUB_ASM(reason)); }
+#elif defined(__GNUC__)
+#define STUB(name, reason) \
+  __attribute__((naked)) void name(void) { __asm volatile (STUB_ASM(reason)); }
+#endif
+
+STUB(HardFault_Handler, 1)
+STUB(MemManage_Handler, 1)
+STUB(BusFault_Handler, 1)
+STUB(UsageFault_Handler, 1)
+STUB(WDOG0_IRQHandler, 2)
+
+/***************************************************************************//**
+ * @brief Append a dump to the flash log, erasing the log when it is full
+ ******************************************************************************/
+static int logAppend(const crashDump_TypeDef *dump)
+{
+  uint32_t *slot = NULL;
+  MSC_Status_TypeDef status = mscReturnOk;
+  uint32_t i;
+
+  for (i = 0; i < LOG_SLOTS; i++) {
+    uint32_t *p = (uint32_t *)(LOG_PAGE + i * sizeof(crashDump_TypeDef));
+    if (*p == ERASED) {
+      slot = p;
+      break;
+    }
+  }
+
+#if defined(_CMU_CLKEN1_MASK)
+  CMU_ClockEnable(cmuClock_MSC, true);
+#endif
+  MSC_Init();
+  if (slot == NULL) {
+    slot = (uint32_t *)LOG_PAGE;
+    status = MSC_ErasePage(slot);
+  }
+  if (status == mscReturnOk) {
+    status = MSC_WriteWord(slot, dump, sizeof(*dump));
+  }
+  MSC_Deinit();
+
+  return status == mscReturnOk ? 0 : CRASH_DUMP_ERR_FLASH;
+}
+
+/***************************************************************************//**
+ * @brief Save the dump of the last crash, if any, to flash
+ *
+ * @details Call early in main(), before anything that could crash again.
+ *
+ * @return 1 if a dump was saved, 0 if there was none, or CRASH_DUMP_ERR_FLASH.
+ ******************************************************************************/
+int crashDumpInit(void)
+{
+  int ret = 0;
+
+  if (dumpValid(&ramDump)) {
+    ret = logAppend(&ramDump);
+    if (ret == 0) {
+      ret = 1;
+    }
+  }
+  ramDump.magic = 0;
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Set the active task, saved in the dump
+ *
+ * @param task Task number, or CRASH_DUMP_NO_TASK.
+ ******************************************************************************/
+void crashDumpTaskSet(uint32_t task)
+{
+  activeTask = task;
+}
+
+/***************************************************************************//**
+ * @brief Fail an assertion: capture a dump and reset
+ ******************************************************************************/
+void crashDumpAssert(const char *file, int line)
+{
+  assertLine = (uint32_t)line;
+  assertFile = file;
+  __DSB();
+  __ASM volatile ("udf #0");
+  while (1) {
+  }
+}
+
+/***************************************************************************//**
+ * @brief Number of dumps in the flash log, oldest first
+ ******************************************************************************/
+uint32_t crashDumpCount(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < LOG_SLOTS; i++) {
+    if (*(const uint32_t *)(LOG_PAGE + i * sizeof(crashDump_TypeDef)) == ERASED) {
+      break;
+    }
+  }
+  return i;
+}
+
+/***************************************************************************//**
+ * @brief Get a dump from the flash log
+ *
+ * @return The dump, or NULL if index is out of range or the dump is
+ * corrupted, e.g. by a reset while it was written.
+ ******************************************************************************/
+const crashDump_TypeDef *crashDumpGet(uint32_t index)
+{
+  const crashDump_TypeDef *dump;
+
+  if (index >= crashDumpCount()) {
+    return NULL;
+  }
+  dump = (const crashDump_TypeDef *)(LOG_PAGE + index * sizeof(crashDump_TypeDef));
+  return dumpValid(dump) ? dump : NULL;
+}
+
+/***************************************************************************//**
+ * @brief Erase the flash log
+ *
+ * @return 0 or CRASH_DUMP_ERR_FLASH.
+ ******************************************************************************/
+int crashDumpErase(void)
+{
+  MSC_Status_TypeDef status;
+
+#if defined(_CMU_CLKEN1_MASK)
+  CMU_ClockEnable(cmuClock_MSC, true);
+#endif
+  MSC_Init();
+  status = MSC_ErasePage((uint32_t *)LOG_PAGE);
+  MSC_Deinit();
+
+  return status == mscReturnOk ? 0 : CRASH_DUMP_ERR_FLASH;
+}
@@ -0,0 +1,118 @@
+/***************************************************************************//**
+ * @file crash_dump.h
+ * @brief Post-mortem crash dump of HardFault, watchdog warning and assert
+ * failures, kept in RAM over the reset and then in flash
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef CRASH_DUMP_H
+#define CRASH_DUMP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Dump format, decoded by test/crash_decode.py. All fields are 32-bit
+// little-endian words. Change the version when the layout changes.
+#define CRASH_DUMP_MAGIC                (0x504D4443UL)  // "CDMP"
+#define CRASH_DUMP_VERSION              (1)
+
+// Stack words saved from the stack pointer at the time of the crash
+#define CRASH_DUMP_STACK_WORDS          (32)
+// LDMA channels saved
+#define CRASH_DUMP_LDMA_CHANNELS        (8)
+
+// Task number when no task is active
+#define CRASH_DUMP_NO_TASK              (0xFFFFFFFFUL)
+
+// flags: r[], sp, lr, pc and xpsr hold the registers at the time of the
+// crash. Not set if the stack pointer was outside RAM.
+#define CRASH_DUMP_FLAG_FRAME           (0x1UL)
+
+// A flash write or erase failed
+#define CRASH_DUMP_ERR_FLASH            (-0x5600)
+
+typedef enum {
+  crashDumpReasonHardFault = 1,         // Also the configurable faults
+  crashDumpReasonWatchdog  = 2,         // Watchdog warning interrupt
+  crashDumpReasonAssert    = 3,
+} crashDumpReason_TypeDef;
+
+typedef struct {
+  uint32_t ctrl;
+  uint32_t src;
+  uint32_t dst;
+  uint32_t link;
+} crashDumpLdmaCh_TypeDef;
+
+typedef struct {
+  uint32_t magic;                       // CRASH_DUMP_MAGIC
+  uint32_t version;                     // CRASH_DUMP_VERSION
+  uint32_t size;                        // sizeof(crashDump_TypeDef)
+  uint32_t reason;                      // crashDumpReason_TypeDef
+  uint32_t flags;                       // CRASH_DUMP_FLAG_
+  uint32_t line;                        // Assert: line number
+  uint32_t file;                        // Assert: address of the file name
+  uint32_t r[13];                       // R0-R12
+  uint32_t sp;                          // SP before the exception
+  uint32_t lr;
+  uint32_t pc;
+  uint32_t xpsr;
+  uint32_t excReturn;                   // LR on exception entry
+  uint32_t cfsr;
+  uint32_t hfsr;
+  uint32_t mmfar;
+  uint32_t bfar;
+  uint32_t task;                        // Active task, or CRASH_DUMP_NO_TASK
+  uint32_t ldmaChen;
+  uint32_t ldmaChbusy;
+  uint32_t ldmaChdone;
+  uint32_t ldmaIf;
+  crashDumpLdmaCh_TypeDef ldma[CRASH_DUMP_LDMA_CHANNELS];
+  uint32_t stack[CRASH_DUMP_STACK_WORDS]; // From sp upwards
+  uint32_t crc;                         // CRC-32 of all words before
+} crashDump_TypeDef;
+
+int crashDumpInit(void);
+void crashDumpTaskSet(uint32_t task);
+void crashDumpAssert(const char *file, int line);
+uint32_t crashDumpCount(void);
+const crashDump_TypeDef *crashDumpGet(uint32_t index);
+int crashDumpErase(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CRASH_DUMP_H
@@ -0,0 +1,278 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief This project demonstrates a post-mortem crash dump. A HardFault, a
+ * watchdog warning or a failed assert saves the processor and LDMA state,
+ * which is written to flash on the next boot and printed over VCOM. See
+ * readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_gpio.h"
+#include "em_ldma.h"
+#include "em_rmu.h"
+#include "em_wdog.h"
+#include "bspconfig.h"
+#include "retargetserial.h"
+#include "crash_dump.h"
+
+// DEFINES
+
+// Tasks run by the main loop, the task number is saved in a crash dump
+#define TASK_BLINK        0
+#define TASK_COPY         1
+#define TASK_CONSOLE      2
+#define TASK_COUNT        3
+
+// LDMA channel and size of the memory copy done by the copy task
+#define COPY_CH           0
+#define COPY_WORDS        256
+
+// GLOBAL VARIABLES
+unsigned long resetCause;
+int crashDumpStatus;
+volatile uint32_t msTicks; // counts 1ms timeTicks
+
+static uint32_t copySrc[COPY_WORDS];
+static uint32_t copyDst[COPY_WORDS];
+static LDMA_Descriptor_t copyDesc;
+static bool feedWatchdog = true;
+static volatile uint32_t zero;
+
+/**************************************************************************//**
+ * @brief SysTick_Handler
+ * Interrupt Service Routine for system tick counter
+ *****************************************************************************/
+void SysTick_Handler(void)
+{
+  msTicks++;       // increment counter necessary in Delay()
+}
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  // Clear the done flags of the copy
+  LDMA_IntClear(LDMA_IntGet());
+}
+
+#if defined(DEBUG_EFM_USER)
+/**************************************************************************//**
+ * @brief Failed emlib assertions are captured as crash dumps
+ *****************************************************************************/
+void assertEFM(const char *file, int line)
+{
+  crashDumpAssert(file, line);
+}
+#endif
+
+/**************************************************************************//**
+ * @brief Print the crash dumps in the flash log, one line per dump with the
+ * dump words in hex, for test/crash_decode.py
+ *****************************************************************************/
+static void dumpList(void)
+{
+  uint32_t count = crashDumpCount();
+  const crashDump_TypeDef *dump;
+  const uint32_t *word;
+  uint32_t i;
+  uint32_t j;
+
+  printf("%lu crash dump(s) in flash\n", (unsigned long)count);
+  for (i = 0; i < count; i++)
+  {
+    dump = crashDumpGet(i);
+    if (dump == NULL)
+    {
+      printf("CRASH-DUMP,%lu,corrupted\n", (unsigned long)i);
+      continue;
+    }
+    printf("CRASH-DUMP,%lu,", (unsigned long)i);
+    word = (const uint32_t *)dump;
+    for (j = 0; j < sizeof(*dump) / 4; j++)
+      printf("%08lX", (unsigned long)word[j]);
+    printf("\n");
+  }
+}
+
+/**************************************************************************//**
+ * @brief Tasks
+ *****************************************************************************/
+static void blinkTask(void)
+{
+  static uint32_t last;
+
+  if (msTicks - last >= 100)
+  {
+    last = msTicks;
+    GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+  }
+}
+
+// Keeps an LDMA transfer going, so that a dump has LDMA state to show
+static void copyTask(void)
+{
+  LDMA_TransferCfg_t cfg = LDMA_TRANSFER_CFG_MEMORY();
+
+  if (!(LDMA->CHBUSY & (1 << COPY_CH)))
+  {
+    copySrc[0]++;
+    copyDesc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2M_WORD(copySrc, copyDst, COPY_WORDS);
+    LDMA_StartTransfer(COPY_CH, &cfg, &copyDesc);
+  }
+}
+
+// Commands from the VCOM port
+static void consoleTask(void)
+{
+  int c = RETARGET_ReadChar();
+
+  switch (c)
+  {
+    case 'h':
+      // Divide by zero, which traps to the HardFault handler
+      printf("HardFault\n");
+      SCB->CCR |= SCB_CCR_DIV_0_TRP_Msk;
+      zero = 1 / zero;
+      break;
+    case 'w':
+      printf("Watchdog feeding stopped\n");
+      feedWatchdog = false;
+      break;
+    case 'a':
+      printf("Assert\n");
+      crashDumpAssert(__FILE__, __LINE__);
+      break;
+    case 'd':
+      dumpList();
+      break;
+    case 'e':
+      printf("Erase: %d\n", crashDumpErase());
+      break;
+    default:
+      break;
+  }
+}
+
+static void (*const tasks[TASK_COUNT])(void) = {
+  [TASK_BLINK]   = blinkTask,
+  [TASK_COPY]    = copyTask,
+  [TASK_CONSOLE] = consoleTask,
+};
+
+/**************************************************************************//**
+ * @brief Watchdog initialization, with the warning interrupt at 75 % of the
+ * timeout
+ *****************************************************************************/
+static void initWDOG(void)
+{
+  // Enable clock for the WDOG module
+  CMU_ClockEnable(cmuClock_WDOG0, true);
+
+  // Watchdog Initialize settings
+  WDOG_Init_TypeDef wdogInit = WDOG_INIT_DEFAULT;
+  CMU_ClockSelectSet(cmuClock_WDOG0, cmuSelect_ULFRCO); /* ULFRCO as clock source */
+  wdogInit.debugRun = true;
+  wdogInit.em3Run = true;
+  wdogInit.perSel = wdogPeriod_2k; // 2049 clock cycles of a 1kHz clock  ~2 seconds period
+  wdogInit.warnSel = wdogWarnTime75pct;
+
+  // Initializing watchdog with chosen settings
+  WDOG_Init(&wdogInit);
+
+  // The warning interrupt is handled by crash_dump.c
+  WDOGn_IntClear(WDOG0, WDOG_IF_WARN);
+  WDOGn_IntEnable(WDOG0, WDOG_IEN_WARN);
+  NVIC_ClearPendingIRQ(WDOG0_IRQn);
+  NVIC_EnableIRQ(WDOG0_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint32_t task;
+
+  // Chip errata
+  CHIP_Init();
+
+  // Init DCDC regulator with kit specific parameters
+  #if defined( _EMU_DCDCCTRL_MASK )
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+  #endif
+
+  // Save the dump of the last crash to flash before anything else can crash
+  crashDumpStatus = crashDumpInit();
+
+  // Store the cause of the last reset, and clear the reset cause register
+  resetCause = RMU_ResetCauseGet();
+  RMU_ResetCauseClear();
+
+  // Configure LED0 and the VCOM port
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, 0);
+  RETARGET_SerialInit();
+  RETARGET_SerialCrLf(1);
+
+  printf("\nReset cause 0x%08lX, crash dump saved: %d\n", resetCause, crashDumpStatus);
+  dumpList();
+  printf("h: HardFault, w: watchdog, a: assert, d: list dumps, e: erase dumps\n");
+
+  // Setup SysTick Timer for 1 msec interrupts
+  if (SysTick_Config(CMU_ClockFreqGet(cmuClock_CORE) / 1000)) while (1) ;
+
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+  LDMA_Init(&ldmaInit);
+
+  initWDOG();
+
+  // Run the tasks in turn, and feed the WDOG
+  while (1)
+  {
+    for (task = 0; task < TASK_COUNT; task++)
+    {
+      crashDumpTaskSet(task);
+      tasks[task]();
+    }
+    crashDumpTaskSet(CRASH_DUMP_NO_TASK);
+
+    if (feedWatchdog)
+      WDOG_Feed();
+  }
+}
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Decode the crash dumps printed by the wdog_crash_dump example.
+
+Usage: crash_decode.py log.txt
+
+The log is the VCOM output of the example. Each dump is one line
+CRASH-DUMP,<index>,<words> where <words> are the 32-bit words of
+crashDump_TypeDef in crash_dump.h, 8 hex digits each. Look up the pc, lr and
+the code addresses on the stack in the map file or with addr2line.
+"""
+
+import struct
+import sys
+import zlib
+
+MAGIC = 0x504D4443
+FORMAT_VERSION = 1
+STACK_WORDS = 32
+LDMA_CHANNELS = 8
+
+REASONS = {1: 'HardFault', 2: 'Watchdog warning', 3: 'Assert'}
+FLAG_FRAME = 0x1
+NO_TASK = 0xFFFFFFFF
+
+# Fields of crashDump_TypeDef in order, as (name, words)
+LAYOUT = [
+    ('magic', 1), ('version', 1), ('size', 1), ('reason', 1), ('flags', 1),
+    ('line', 1), ('file', 1), ('r', 13), ('sp', 1), ('lr', 1), ('pc', 1),
+    ('xpsr', 1), ('excReturn', 1), ('cfsr', 1), ('hfsr', 1), ('mmfar', 1),
+    ('bfar', 1), ('task', 1), ('ldmaChen', 1), ('ldmaChbusy', 1),
+    ('ldmaChdone', 1), ('ldmaIf', 1), ('ldma', 4 * LDMA_CHANNELS),
+    ('stack', STACK_WORDS), ('crc', 1),
+]
+DUMP_WORDS = sum(words for _, words in LAYOUT)
+
+CFSR_BITS = [
+    (0, 'IACCVIOL'), (1, 'DACCVIOL'), (3, 'MUNSTKERR'), (4, 'MSTKERR'),
+    (5, 'MLSPERR'), (7, 'MMARVALID'), (8, 'IBUSERR'), (9, 'PRECISERR'),
+    (10, 'IMPRECISERR'), (11, 'UNSTKERR'), (12, 'STKERR'), (13, 'LSPERR'),
+    (15, 'BFARVALID'), (16, 'UNDEFINSTR'), (17, 'INVSTATE'), (18, 'INVPC'),
+    (19, 'NOCP'), (20, 'STKOF'), (24, 'UNALIGNED'), (25, 'DIVBYZERO'),
+]
+HFSR_BITS = [(1, 'VECTTBL'), (30, 'FORCED'), (31, 'DEBUGEVT')]
+
+
+def bits(value, names):
+    return ' '.join(name for bit, name in names if value & (1 << bit)) or '-'
+
+
+def parse(hex_words):
+    """Return the dump as a dict, or raise ValueError."""
+    if len(hex_words) != 8 * DUMP_WORDS:
+        raise ValueError('%d words, expected %d'
+                         % (len(hex_words) // 8, DUMP_WORDS))
+    words = [int(hex_words[i:i + 8], 16) for i in range(0, len(hex_words), 8)]
+    dump = {}
+    pos = 0
+    for name, count in LAYOUT:
+        dump[name] = words[pos] if count == 1 else words[pos:pos + count]
+        pos += count
+    if dump['magic'] != MAGIC:
+        raise ValueError('bad magic 0x%08X' % dump['magic'])
+    if dump['version'] != FORMAT_VERSION:
+        raise ValueError('unsupported format version %d' % dump['version'])
+    if dump['size'] != 4 * DUMP_WORDS:
+        raise ValueError('size %d, expected %d' % (dump['size'], 4 * DUMP_WORDS))
+    data = struct.pack('<%dI' % (DUMP_WORDS - 1), *words[:-1])
+    if zlib.crc32(data) & 0xFFFFFFFF != dump['crc']:
+        raise ValueError('CRC mismatch')
+    return dump
+
+
+def show(index, dump):
+    print('Dump %s: %s' % (index, REASONS.get(dump['reason'],
+                                              'reason %d' % dump['reason'])))
+    if dump['reason'] == 3:
+        print('  assert at line %d of the file name at 0x%08X'
+              % (dump['line'], dump['file']))
+    task = dump['task']
+    print('  task   %s' % ('none' if task == NO_TASK else task))
+    if dump['flags'] & FLAG_FRAME:
+        print('  pc     0x%08X' % dump['pc'])
+        print('  lr     0x%08X' % dump['lr'])
+        print('  xpsr   0x%08X' % dump['xpsr'])
+    else:
+        print('  no stack frame, the stack pointer was outside RAM')
+    print('  sp     0x%08X  EXC_RETURN 0x%08X' % (dump['sp'], dump['excReturn']))
+    for i in range(0, 13, 4):
+        print('  ' + '  '.join('r%-2d 0x%08X' % (j, dump['r'][j])
+                               for j in range(i, min(i + 4, 13))))
+    print('  CFSR   0x%08X  %s' % (dump['cfsr'], bits(dump['cfsr'], CFSR_BITS)))
+    print('  HFSR   0x%08X  %s' % (dump['hfsr'], bits(dump['hfsr'], HFSR_BITS)))
+    if dump['cfsr'] & (1 << 7):
+        print('  MMFAR  0x%08X' % dump['mmfar'])
+    if dump['cfsr'] & (1 << 15):
+        print('  BFAR   0x%08X' % dump['bfar'])
+    print('  LDMA   CHEN 0x%08X  CHBUSY 0x%08X  CHDONE 0x%08X  IF 0x%08X'
+          % (dump['ldmaChen'], dump['ldmaChbusy'], dump['ldmaChdone'],
+             dump['ldmaIf']))
+    for ch in range(LDMA_CHANNELS):
+        ctrl, src, dst, link = dump['ldma'][4 * ch:4 * ch + 4]
+        if dump['ldmaChen'] & (1 << ch) or ctrl:
+            print('    ch%d CTRL 0x%08X  SRC 0x%08X  DST 0x%08X  LINK 0x%08X'
+                  % (ch, ctrl, src, dst, link))
+    print('  stack')
+    for i in range(0, STACK_WORDS, 4):
+        print('    0x%08X: %s' % (dump['sp'] + 4 * i, ' '.join(
+            '%08X' % w for w in dump['stack'][i:i + 4])))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    errors = 0
+    with open(sys.argv[1], 'r', errors='replace') as log:
+        for line in log:
+            fields = line.strip().split(',')
+            if fields[0] != 'CRASH-DUMP' or len(fields) != 3:
+                continue
+            try:
+                show(fields[1], parse(fields[2]))
+            except ValueError as err:
+                print('Dump %s: %s' % (fields[1], err))
+                errors += 1
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == '__main__':
+    main()
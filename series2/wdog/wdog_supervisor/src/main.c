@@ -0,0 +1,201 @@
+/***************************************************************************//**
+ * @file main.c
+ * @brief This project demonstrates a watchdog supervisor. Each task must
+ * check in within its own deadline, and the watchdog is fed only while all
+ * tasks do. Holding Push Button 0 stalls one task, which leads to a WDOG
+ * reset that records the starving task in BURAM. See readme.txt for details.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "em_gpio.h"
+#include "em_device.h"
+#include "em_wdog.h"
+#include "em_emu.h"
+#include "em_cmu.h"
+#include "em_rmu.h"
+#include "em_chip.h"
+#include "bspconfig.h"
+#include "wdog_sup.h"
+
+// DEFINES
+
+// Supervisor poll period, and the period and deadline of each task, in ms
+#define POLL_MS             50
+#define BLINK_MS            100
+#define BLINK_DEADLINE_MS   300
+#define SENSOR_MS           500
+#define SENSOR_DEADLINE_MS  1000
+
+// GLOBAL VARIABLES
+unsigned long resetCause;
+volatile uint32_t msTicks; // counts 1ms timeTicks
+
+// Starving task and mask of late tasks before the last WDOG reset
+int starvedTask = WDOG_SUP_ERR_NONE;
+uint32_t starvedMask;
+
+static int blinkTask;
+static int sensorTask;
+
+// Function Declarations
+void initGPIO(void);
+void initWDOG(void);
+
+/**************************************************************************//**
+ * @brief SysTick_Handler
+ * Interrupt Service Routine for system tick counter, also polls the watchdog
+ * supervisor
+ *****************************************************************************/
+void SysTick_Handler(void)
+{
+  msTicks++;       // increment counter necessary in Delay()
+
+  if (msTicks % POLL_MS == 0)
+    wdogSupPoll(msTicks);
+}
+
+static void wdogFeed(void)
+{
+  WDOG_Feed();
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  wdogSupInit_TypeDef supInit = {
+    .feed = wdogFeed,
+    .retention = &BURAM->RET[0].REG,
+  };
+  uint32_t lastBlink = 0;
+  uint32_t lastSensor = 0;
+
+  // Chip errata
+  CHIP_Init();
+
+  // Init DCDC regulator with kit specific parameters
+  #if defined( _EMU_DCDCCTRL_MASK )
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+  #endif
+
+  #if defined( _CMU_CLKEN0_MASK )
+  CMU_ClockEnable(cmuClock_BURAM, true);
+  #endif
+
+  // Store the cause of the last reset, and clear the reset cause register
+  resetCause = RMU_ResetCauseGet();
+  // Clear Reset causes so we know which reset occurs the next time
+  RMU_ResetCauseClear();
+
+  // Read and clear the starving task record
+  if (resetCause & EMU_RSTCAUSE_WDOG0)
+    starvedTask = wdogSupStarvedGet(supInit.retention, &starvedMask);
+  wdogSupStarvedClear(supInit.retention);
+
+  // Configure the Push Buttons and the LEDs
+  initGPIO();
+
+  // Configure and Initialize the Watchdog timer and the supervisor
+  initWDOG();
+  wdogSupInit(&supInit);
+  blinkTask = wdogSupTaskAdd(BLINK_DEADLINE_MS, msTicks);
+  sensorTask = wdogSupTaskAdd(SENSOR_DEADLINE_MS, msTicks);
+
+  // Check if a WDOG reset triggered the last reset
+  if (resetCause & EMU_RSTCAUSE_WDOG0)
+  {
+    // Turn LED0 on, starvedTask shows which task starved
+    GPIO_PinOutSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+    WDOG_Enable(false);
+    while(1); //Stay here
+  }
+
+  // Setup SysTick Timer for 1 msec interrupts
+  if (SysTick_Config(CMU_ClockFreqGet(cmuClock_CORE) / 1000)) while (1) ;
+
+  // Run the tasks, each checks in when it has done its work
+  while (1)
+  {
+    // Blink task: toggle LED0
+    if (msTicks - lastBlink >= BLINK_MS)
+    {
+      lastBlink += BLINK_MS;
+      GPIO_PinOutToggle(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN);
+      wdogSupCheckin(blinkTask);
+    }
+
+    // Sensor task: stalls while PB0 is pressed, as if a sensor did not
+    // answer
+    if (msTicks - lastSensor >= SENSOR_MS
+        && GPIO_PinInGet(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN))
+    {
+      lastSensor = msTicks;
+      wdogSupCheckin(sensorTask);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief GPIO initialization
+ *****************************************************************************/
+void initGPIO(void)
+{
+  // Enable clock for the GPIO module
+  CMU_ClockEnable(cmuClock_GPIO, true);
+
+  // Configure LED0 as output
+  GPIO_PinModeSet(BSP_GPIO_LED0_PORT, BSP_GPIO_LED0_PIN, gpioModePushPull, 0);
+
+  // Configure PB0 as input
+  GPIO_PinModeSet(BSP_GPIO_PB0_PORT, BSP_GPIO_PB0_PIN, gpioModeInputPull, 1);
+}
+
+/**************************************************************************//**
+ * @brief Watchdog initialization
+ *****************************************************************************/
+void initWDOG(void)
+{
+  // Enable clock for the WDOG module
+  CMU_ClockEnable(cmuClock_WDOG0, true);
+
+  // Watchdog Initialize settings
+  WDOG_Init_TypeDef wdogInit = WDOG_INIT_DEFAULT;
+  CMU_ClockSelectSet(cmuClock_WDOG0, cmuSelect_ULFRCO); /* ULFRCO as clock source */
+  wdogInit.debugRun = true;
+  wdogInit.em3Run = true;
+  wdogInit.perSel = wdogPeriod_2k; // 2049 clock cycles of a 1kHz clock  ~2 seconds period
+
+  // Initializing watchdog with chosen settings
+  WDOG_Init(&wdogInit);
+}
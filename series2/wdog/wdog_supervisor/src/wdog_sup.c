@@ -0,0 +1,185 @@
+/***************************************************************************//**
+ * @file wdog_sup.c
+ * @brief Watchdog supervisor that feeds the WDOG only while every registered
+ * task checks in within its own deadline
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#include "wdog_sup.h"
+#include <stddef.h>
+
+// Each task sets its bit in wdogSupCheckins when it has made progress.
+// wdogSupPoll() is called periodically, e.g. from a timer interrupt. It
+// takes the bits that were set, notes the time of each task's last check-in,
+// and feeds the hardware watchdog only if every task checked in within its
+// deadline. Otherwise the lowest numbered late task and the mask of all late
+// tasks are written to retention memory, and the hardware watchdog resets
+// the device when it times out. A starving task is therefore detected
+// after its deadline plus at most the hardware watchdog timeout. A check-in
+// is timed when the poll sees it, so deadlines have the resolution of the
+// poll period.
+//
+// The retention record is the magic number and the task in one word and the
+// late mask in the other. A record is only accepted if the task is the
+// lowest bit of the mask. Tasks that check in again are taken out of the
+// record, so that it does not report a task that has recovered.
+
+#define RECORD_MAGIC      (0x5744UL)    // "WD"
+#define RECORD(task)      ((RECORD_MAGIC << 16) | (task))
+
+volatile uint32_t wdogSupCheckins;
+
+static wdogSupInit_TypeDef config;
+static uint32_t tasks;                  // Registered tasks
+static uint32_t deadlines[WDOG_SUP_MAX_TASKS];
+static uint32_t lastCheckin[WDOG_SUP_MAX_TASKS];
+
+// Index of the lowest set bit, x must not be 0
+static inline uint32_t lowestBit(uint32_t x)
+{
+  return __CLZ(__RBIT(x));
+}
+
+/***************************************************************************//**
+ * @brief Initialize the supervisor, with no tasks
+ ******************************************************************************/
+void wdogSupInit(const wdogSupInit_TypeDef *init)
+{
+  config = *init;
+  tasks = 0;
+  wdogSupCheckins = 0;
+}
+
+/***************************************************************************//**
+ * @brief Register a task
+ *
+ * @param deadline Longest time between check-ins, in the unit of now.
+ * @param now Current time. The task counts as checked in at this time.
+ *
+ * @return Task number for wdogSupCheckin(), or WDOG_SUP_ERR_PARAM.
+ ******************************************************************************/
+int wdogSupTaskAdd(uint32_t deadline, uint32_t now)
+{
+  uint32_t task;
+
+  if (deadline == 0 || tasks == 0xFFFFFFFFUL) {
+    return WDOG_SUP_ERR_PARAM;
+  }
+  task = lowestBit(~tasks);
+  deadlines[task] = deadline;
+  lastCheckin[task] = now;
+  tasks |= 1UL << task;
+  return (int)task;
+}
+
+/***************************************************************************//**
+ * @brief Check the tasks, and feed the watchdog if none is late
+ *
+ * @details Call more often than the hardware watchdog timeout, and not from
+ * an interrupt that preempts wdogSupTaskAdd().
+ *
+ * @param now Current time.
+ *
+ * @return Mask of the late tasks, 0 if the watchdog was fed.
+ ******************************************************************************/
+uint32_t wdogSupPoll(uint32_t now)
+{
+  uint32_t seen;
+  uint32_t late = 0;
+  uint32_t rest;
+  uint32_t recorded;
+  uint32_t i;
+
+  // Take the checkpoint bits and clear them in one exclusive access
+  do {
+    seen = __LDREXW(&wdogSupCheckins);
+  } while (__STREXW(0, &wdogSupCheckins) != 0);
+
+  for (rest = tasks; rest != 0; rest &= rest - 1) {
+    i = lowestBit(rest);
+    if (seen & (1UL << i)) {
+      lastCheckin[i] = now;
+    } else if (now - lastCheckin[i] > deadlines[i]) {
+      late |= 1UL << i;
+    }
+  }
+
+  if (late == 0) {
+    config.feed();
+  }
+  if (config.retention != NULL) {
+    recorded = config.retention[1];
+    if (late != 0) {
+      config.retention[1] = late;
+      config.retention[0] = RECORD(lowestBit(late));
+    } else if (recorded & seen) {
+      // Recorded tasks checked in again
+      recorded &= ~seen;
+      config.retention[1] = recorded;
+      config.retention[0] = recorded ? RECORD(lowestBit(recorded)) : 0;
+    }
+  }
+  return late;
+}
+
+/***************************************************************************//**
+ * @brief Get the task that starved before the last reset
+ *
+ * @param retention Retention words given to wdogSupInit().
+ * @param late Set to the mask of all late tasks, may be NULL.
+ *
+ * @return Lowest numbered late task, or WDOG_SUP_ERR_NONE.
+ ******************************************************************************/
+int wdogSupStarvedGet(const volatile uint32_t *retention, uint32_t *late)
+{
+  uint32_t record = retention[0];
+  uint32_t mask = retention[1];
+  uint32_t task = record & 0xFFFF;
+
+  if ((record >> 16) != RECORD_MAGIC || task >= WDOG_SUP_MAX_TASKS
+      || mask == 0 || lowestBit(mask) != task) {
+    return WDOG_SUP_ERR_NONE;
+  }
+  if (late != NULL) {
+    *late = mask;
+  }
+  return (int)task;
+}
+
+/***************************************************************************//**
+ * @brief Clear the starving task record, e.g. after it was reported
+ ******************************************************************************/
+void wdogSupStarvedClear(volatile uint32_t *retention)
+{
+  retention[0] = 0;
+  retention[1] = 0;
+}
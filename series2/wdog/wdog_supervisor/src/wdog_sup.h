@@ -0,0 +1,91 @@
+/***************************************************************************//**
+ * @file wdog_sup.h
+ * @brief Watchdog supervisor that feeds the WDOG only while every registered
+ * task checks in within its own deadline
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+#ifndef WDOG_SUP_H
+#define WDOG_SUP_H
+
+#include <stdint.h>
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tasks are identified by a bit in a 32-bit checkpoint mask
+#define WDOG_SUP_MAX_TASKS              (32)
+
+// Retention words used to record the starving task over the reset
+#define WDOG_SUP_RET_WORDS              (2)
+
+// Invalid parameter, or no free task
+#define WDOG_SUP_ERR_PARAM              (-0x5580)
+// No starving task was recorded
+#define WDOG_SUP_ERR_NONE               (-0x5500)
+
+typedef struct {
+  void (*feed)(void);                   // Feeds the hardware watchdog
+  volatile uint32_t *retention;         // WDOG_SUP_RET_WORDS words that are
+                                        // kept over a watchdog reset
+} wdogSupInit_TypeDef;
+
+// Checkpoint bits set since the last wdogSupPoll(), use wdogSupCheckin()
+extern volatile uint32_t wdogSupCheckins;
+
+/***************************************************************************//**
+ * @brief Check in a task, from thread or interrupt context
+ *
+ * @details Sets the task's checkpoint bit with an exclusive load and store,
+ * a few cycles when not interrupted.
+ ******************************************************************************/
+__STATIC_INLINE void wdogSupCheckin(uint32_t task)
+{
+  uint32_t bit = 1UL << task;
+
+  while (__STREXW(__LDREXW(&wdogSupCheckins) | bit, &wdogSupCheckins) != 0) {
+  }
+}
+
+void wdogSupInit(const wdogSupInit_TypeDef *init);
+int wdogSupTaskAdd(uint32_t deadline, uint32_t now);
+uint32_t wdogSupPoll(uint32_t now);
+int wdogSupStarvedGet(const volatile uint32_t *retention, uint32_t *late);
+void wdogSupStarvedClear(volatile uint32_t *retention);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WDOG_SUP_H
@@ -0,0 +1,45 @@
+// Host stand-in for em_device.h, used by the tests in the parent directory.
+// Only the CMSIS functions used by wdog_sup.c and wdog_sup.h are provided.
+// The exclusive store fails strexFailures times before it succeeds, as if
+// an interrupt had come between the load and the store.
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+#define __STATIC_INLINE                 static inline
+
+extern int strexFailures;
+
+static inline uint32_t __CLZ(uint32_t x)
+{
+  return (x != 0) ? (uint32_t)__builtin_clz(x) : 32;
+}
+
+static inline uint32_t __RBIT(uint32_t x)
+{
+  uint32_t r = 0;
+
+  for (int i = 0; i < 32; i++) {
+    r = (r << 1) | (x & 1);
+    x >>= 1;
+  }
+  return r;
+}
+
+static inline uint32_t __LDREXW(volatile uint32_t *addr)
+{
+  return *addr;
+}
+
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+  if (strexFailures > 0) {
+    strexFailures--;
+    return 1;
+  }
+  *addr = value;
+  return 0;
+}
+
+#endif // EM_DEVICE_H
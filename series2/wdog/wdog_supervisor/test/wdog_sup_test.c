@@ -0,0 +1,274 @@
+/***************************************************************************//**
+ * @file wdog_sup_test.c
+ * @brief Host test of wdog_sup.c: deadlines, feeding, the starving task record
+ * and random check-ins against a reference model
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2020 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Evaluation Quality
+ * This code has been minimally tested to ensure that it builds and is suitable 
+ * as a demonstration for evaluation purposes only. This code will be maintained
+ * at the sole discretion of Silicon Labs.
+ ******************************************************************************/
+
+// Build and run on a PC from the example directory:
+//
+//   gcc -Wall -Wextra -Itest/stubs -Isrc test/wdog_sup_test.c src/wdog_sup.c
+//       -o wdog_sup_test
+//   ./wdog_sup_test
+//
+// The program prints one line per failed check and exits with status 1 if
+// any check failed.
+
+#include "wdog_sup.h"
+#include <stdio.h>
+
+#define CHECK(cond)                                            \
+  do {                                                         \
+    checks++;                                                  \
+    if (!(cond)) {                                             \
+      failures++;                                              \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+    }                                                          \
+  } while (0)
+
+#define RANDOM_RUNS     (200)
+#define RANDOM_POLLS    (500)
+
+static int checks;
+static int failures;
+
+static uint32_t seed = 95;
+
+// Failures of the next exclusive stores, see stubs/em_device.h
+int strexFailures;
+
+static int feeds;
+static uint32_t retention[WDOG_SUP_RET_WORDS];
+
+static uint32_t random32(void)
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+static void feed(void)
+{
+  feeds++;
+}
+
+/***************************************************************************//**
+ * @brief Three tasks with different deadlines, as in main.c
+ ******************************************************************************/
+static void testDeadlines(void)
+{
+  wdogSupInit_TypeDef init = { feed, retention };
+  uint32_t mask;
+  int a, b, c;
+
+  feeds = 0;
+  wdogSupInit(&init);
+  wdogSupStarvedClear(retention);
+  CHECK(wdogSupStarvedGet(retention, NULL) == WDOG_SUP_ERR_NONE);
+  CHECK(wdogSupTaskAdd(0, 0) == WDOG_SUP_ERR_PARAM);
+  a = wdogSupTaskAdd(100, 0);
+  b = wdogSupTaskAdd(1000, 0);
+  c = wdogSupTaskAdd(50, 0);
+  CHECK(a == 0 && b == 1 && c == 2);
+
+  // No task is late at the start
+  CHECK(wdogSupPoll(10) == 0 && feeds == 1);
+
+  // a and c check in, b is silent but within its deadline. Check-ins retry
+  // after a failed exclusive store.
+  for (int i = 1; i <= 20; i++) {
+    wdogSupCheckin(a);
+    strexFailures = i % 3;
+    wdogSupCheckin(c);
+    CHECK(wdogSupPoll(10 + 40 * i) == 0);
+  }
+  CHECK(feeds == 21);
+
+  // b is late one tick after its deadline, and the feed is held back
+  wdogSupCheckin(a);
+  wdogSupCheckin(c);
+  CHECK(wdogSupPoll(1000) == 0);
+  wdogSupCheckin(a);
+  wdogSupCheckin(c);
+  CHECK(wdogSupPoll(1001) == 0x2 && feeds == 22);
+  CHECK(wdogSupStarvedGet(retention, &mask) == 1 && mask == 0x2);
+
+  // b recovers
+  wdogSupCheckin(b);
+  wdogSupCheckin(a);
+  wdogSupCheckin(c);
+  CHECK(wdogSupPoll(1010) == 0 && feeds == 23);
+  CHECK(wdogSupStarvedGet(retention, NULL) == WDOG_SUP_ERR_NONE);
+
+  // c stops: not late at its deadline, late one tick after
+  wdogSupCheckin(a);
+  wdogSupCheckin(b);
+  CHECK(wdogSupPoll(1060) == 0);
+  wdogSupCheckin(a);
+  wdogSupCheckin(b);
+  CHECK(wdogSupPoll(1061) == 0x4);
+
+  // a and c late: the lowest task is recorded, with the mask of both
+  CHECK(wdogSupPoll(1200) == 0x5);
+  CHECK(wdogSupStarvedGet(retention, &mask) == 0 && mask == 0x5);
+  wdogSupStarvedClear(retention);
+  CHECK(wdogSupStarvedGet(retention, NULL) == WDOG_SUP_ERR_NONE);
+}
+
+/***************************************************************************//**
+ * @brief Records that do not check out are ignored
+ ******************************************************************************/
+static void testRecord(void)
+{
+  // Task is not the lowest bit of the mask
+  retention[0] = (0x5744UL << 16) | 3;
+  retention[1] = 0x5;
+  CHECK(wdogSupStarvedGet(retention, NULL) == WDOG_SUP_ERR_NONE);
+
+  // Task out of range, and empty mask
+  retention[0] = (0x5744UL << 16) | 40;
+  retention[1] = 0;
+  CHECK(wdogSupStarvedGet(retention, NULL) == WDOG_SUP_ERR_NONE);
+
+  // Wrong magic
+  retention[0] = (0x5745UL << 16) | 0;
+  retention[1] = 0x1;
+  CHECK(wdogSupStarvedGet(retention, NULL) == WDOG_SUP_ERR_NONE);
+}
+
+/***************************************************************************//**
+ * @brief Time wrap, all 32 tasks, and a supervisor without retention
+ ******************************************************************************/
+static void testLimits(void)
+{
+  wdogSupInit_TypeDef init = { feed, retention };
+  uint32_t mask;
+
+  // The deadline holds across the wrap of the time
+  wdogSupInit(&init);
+  CHECK(wdogSupTaskAdd(100, 0xFFFFFFC0UL) == 0);
+  CHECK(wdogSupPoll(0x20) == 0);
+  CHECK(wdogSupPoll(0x25) == 0x1);
+
+  wdogSupInit(&init);
+  for (int i = 0; i < WDOG_SUP_MAX_TASKS; i++) {
+    CHECK(wdogSupTaskAdd(5, 0) == i);
+  }
+  CHECK(wdogSupTaskAdd(5, 0) == WDOG_SUP_ERR_PARAM);
+  for (int i = 0; i < WDOG_SUP_MAX_TASKS; i++) {
+    wdogSupCheckin(i);
+  }
+  CHECK(wdogSupPoll(100) == 0);
+  for (int i = 0; i < WDOG_SUP_MAX_TASKS - 1; i++) {
+    wdogSupCheckin(i);
+  }
+  CHECK(wdogSupPoll(106) == 0x80000000UL);
+  CHECK(wdogSupStarvedGet(retention, &mask) == 31 && mask == 0x80000000UL);
+
+  init.retention = NULL;
+  wdogSupInit(&init);
+  wdogSupStarvedClear(retention);
+  wdogSupTaskAdd(1, 0);
+  CHECK(wdogSupPoll(5) == 0x1);
+  CHECK(wdogSupStarvedGet(retention, NULL) == WDOG_SUP_ERR_NONE);
+}
+
+/***************************************************************************//**
+ * @brief Random tasks and check-ins against a model that keeps the time of
+ * each task's last check-in
+ ******************************************************************************/
+static void testRandom(void)
+{
+  wdogSupInit_TypeDef init = { feed, retention };
+  uint32_t deadline[WDOG_SUP_MAX_TASKS];
+  uint32_t last[WDOG_SUP_MAX_TASKS];
+
+  for (int run = 0; run < RANDOM_RUNS; run++) {
+    uint32_t now = random32() << 16;
+    int count;
+    int expectFeeds = 0;
+    uint32_t recorded = 0;
+
+    now |= random32();
+    count = 1 + (int)(random32() % WDOG_SUP_MAX_TASKS);
+    feeds = 0;
+    wdogSupInit(&init);
+    wdogSupStarvedClear(retention);
+    for (int i = 0; i < count; i++) {
+      deadline[i] = 1 + random32() % 1000;
+      last[i] = now;
+      CHECK(wdogSupTaskAdd(deadline[i], now) == i);
+    }
+    for (int p = 0; p < RANDOM_POLLS; p++) {
+      uint32_t seen = 0;
+      uint32_t late = 0;
+
+      now += 1 + random32() % 100;
+      for (int i = 0; i < count; i++) {
+        if (random32() % 8 != 0) {
+          strexFailures = (int)(random32() % 3);
+          wdogSupCheckin(i);
+          seen |= 1UL << i;
+        }
+      }
+      for (int i = 0; i < count; i++) {
+        if (seen & (1UL << i)) {
+          last[i] = now;
+        } else if (now - last[i] > deadline[i]) {
+          late |= 1UL << i;
+        }
+      }
+      expectFeeds += (late == 0);
+      CHECK(wdogSupPoll(now) == late);
+      recorded = late != 0 ? late : recorded & ~seen;
+      if (recorded != 0) {
+        uint32_t mask;
+
+        CHECK(wdogSupStarvedGet(retention, &mask)
+              == __builtin_ctz(recorded) && mask == recorded);
+      } else {
+        CHECK(wdogSupStarvedGet(retention, NULL) == WDOG_SUP_ERR_NONE);
+      }
+    }
+    CHECK(feeds == expectFeeds);
+  }
+}
+
+int main(void)
+{
+  testDeadlines();
+  testRecord();
+  testLimits();
+  testRandom();
+
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+}